@@ -19,6 +19,31 @@ fwupd_client_download_bytes2_async(FwupdClient *self,
 				   GCancellable *cancellable,
 				   GAsyncReadyCallback callback,
 				   gpointer callback_data) G_GNUC_NON_NULL(1, 2);
+void
+fwupd_client_download_bytes_conditional_async(FwupdClient *self,
+					      const gchar *url,
+					      FwupdClientDownloadFlags flags,
+					      const gchar *etag,
+					      const gchar *last_modified,
+					      GCancellable *cancellable,
+					      GAsyncReadyCallback callback,
+					      gpointer callback_data) G_GNUC_NON_NULL(1, 2);
+GBytes *
+fwupd_client_download_bytes_conditional_finish(FwupdClient *self,
+					       GAsyncResult *res,
+					       gchar **etag,
+					       gchar **last_modified,
+					       GError **error) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1, 2);
+void
+fwupd_client_download_file2_async(FwupdClient *self,
+				  GPtrArray *urls,
+				  GFile *file,
+				  FwupdClientDownloadFlags flags,
+				  GChecksumType checksum_kind,
+				  GCancellable *cancellable,
+				  GAsyncReadyCallback callback,
+				  gpointer callback_data) G_GNUC_NON_NULL(1, 2, 3);
 
 #ifdef HAVE_GIO_UNIX
 void
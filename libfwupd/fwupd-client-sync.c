@@ -1923,6 +1923,50 @@ fwupd_client_get_report_metadata(FwupdClient *self, GCancellable *cancellable, G
 	return g_steal_pointer(&helper->hash);
 }
 
+static void
+fwupd_client_get_metrics_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *)user_data;
+	helper->hash = fwupd_client_get_metrics_finish(FWUPD_CLIENT(source), res, &helper->error);
+	g_main_loop_quit(helper->loop);
+}
+
+/**
+ * fwupd_client_get_metrics:
+ * @self: a #FwupdClient
+ * @cancellable: (nullable): optional #GCancellable
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the timing and counter metrics recorded by the daemon.
+ *
+ * Returns: (transfer container) (element-type utf8 guint64): metric values
+ *
+ * Since: 2.0.9
+ **/
+GHashTable *
+fwupd_client_get_metrics(FwupdClient *self, GCancellable *cancellable, GError **error)
+{
+	g_autoptr(FwupdClientHelper) helper = NULL;
+
+	g_return_val_if_fail(FWUPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* connect */
+	if (!fwupd_client_connect(self, cancellable, error))
+		return NULL;
+
+	/* call async version and run loop until complete */
+	helper = fwupd_client_helper_new(self);
+	fwupd_client_get_metrics_async(self, cancellable, fwupd_client_get_metrics_cb, helper);
+	g_main_loop_run(helper->loop);
+	if (helper->hash == NULL) {
+		g_propagate_error(error, g_steal_pointer(&helper->error));
+		return NULL;
+	}
+	return g_steal_pointer(&helper->hash);
+}
+
 static void
 fwupd_client_modify_device_cb(GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -2480,6 +2524,14 @@ fwupd_client_download_bytes(FwupdClient *self,
 	return g_steal_pointer(&helper->bytes);
 }
 
+static void
+fwupd_client_download_file_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *)user_data;
+	helper->str = fwupd_client_download_file_finish(FWUPD_CLIENT(source), res, &helper->error);
+	g_main_loop_quit(helper->loop);
+}
+
 /**
  * fwupd_client_download_file:
  * @self: a #FwupdClient
@@ -2492,6 +2544,9 @@ fwupd_client_download_bytes(FwupdClient *self,
  * Downloads data from a remote server. The [method@Client.set_user_agent] function
  * should be called before this method is used.
  *
+ * The data is written to @file as it arrives, and interrupted transfers are resumed where
+ * possible.
+ *
  * Returns: %TRUE if the file was written
  *
  * Since: 1.5.2
@@ -2504,9 +2559,7 @@ fwupd_client_download_file(FwupdClient *self,
 			   GCancellable *cancellable,
 			   GError **error)
 {
-	gssize size;
-	g_autoptr(GBytes) bytes = NULL;
-	g_autoptr(GOutputStream) ostream = NULL;
+	g_autoptr(FwupdClientHelper) helper = NULL;
 
 	g_return_val_if_fail(FWUPD_IS_CLIENT(self), FALSE);
 	g_return_val_if_fail(url != NULL, FALSE);
@@ -2515,19 +2568,20 @@ fwupd_client_download_file(FwupdClient *self,
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 	g_return_val_if_fail(fwupd_client_get_user_agent(self) != NULL, FALSE);
 
-	/* download then write */
-	bytes = fwupd_client_download_bytes(self, url, flags, cancellable, error);
-	if (bytes == NULL)
-		return FALSE;
-	ostream =
-	    G_OUTPUT_STREAM(g_file_replace(file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, error));
-	if (ostream == NULL)
-		return FALSE;
-	size = g_output_stream_write_bytes(ostream, bytes, NULL, error);
-	if (size < 0)
+	/* call async version and run loop until complete */
+	helper = fwupd_client_helper_new(self);
+	fwupd_client_download_file_async(self,
+					 url,
+					 file,
+					 flags,
+					 cancellable,
+					 fwupd_client_download_file_cb,
+					 helper);
+	g_main_loop_run(helper->loop);
+	if (helper->str == NULL) {
+		g_propagate_error(error, g_steal_pointer(&helper->error));
 		return FALSE;
-
-	/* success */
+	}
 	return TRUE;
 }
 
@@ -196,6 +196,10 @@ GHashTable *
 fwupd_client_get_report_metadata(FwupdClient *self,
 				 GCancellable *cancellable,
 				 GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
+GHashTable *
+fwupd_client_get_metrics(FwupdClient *self,
+			 GCancellable *cancellable,
+			 GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
 GPtrArray *
 fwupd_client_get_remotes(FwupdClient *self,
 			 GCancellable *cancellable,
@@ -8,6 +8,7 @@
 
 #include <curl/curl.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #ifdef HAVE_GIO_UNIX
 #include <gio/gunixfdlist.h>
 #endif
@@ -15,6 +16,7 @@
 #include <sys/utsname.h>
 #endif
 
+#include <errno.h>
 #include <fcntl.h>
 #include <locale.h>
 #include <string.h>
@@ -88,6 +90,10 @@ typedef struct {
 	CURL *curl;
 	curl_mime *mime;
 	struct curl_slist *headers;
+	GFile *file;
+	GChecksumType checksum_kind;
+	gchar *etag;	      /* from the response */
+	gchar *last_modified; /* from the response */
 } FwupdCurlHelper;
 
 enum {
@@ -138,6 +144,10 @@ fwupd_client_curl_helper_free(FwupdCurlHelper *helper)
 		curl_slist_free_all(helper->headers);
 	if (helper->urls != NULL)
 		g_ptr_array_unref(helper->urls);
+	if (helper->file != NULL)
+		g_object_unref(helper->file);
+	g_free(helper->etag);
+	g_free(helper->last_modified);
 	g_free(helper);
 }
 
@@ -1767,6 +1777,107 @@ fwupd_client_get_report_metadata_finish(FwupdClient *self, GAsyncResult *res, GE
 	return g_task_propagate_pointer(G_TASK(res), error);
 }
 
+static GHashTable *
+fwupd_client_metrics_hash_from_variant(GVariant *value)
+{
+	GHashTable *hash;
+	gsize sz;
+	g_autoptr(GVariant) untuple = NULL;
+
+	hash = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	untuple = g_variant_get_child_value(value, 0);
+	sz = g_variant_n_children(untuple);
+	for (guint i = 0; i < sz; i++) {
+		g_autoptr(GVariant) data = NULL;
+		const gchar *key = NULL;
+		guint64 val = 0;
+		data = g_variant_get_child_value(untuple, i);
+		g_variant_get(data, "{&st}", &key, &val);
+		g_hash_table_insert(hash, g_strdup(key), g_memdup2(&val, sizeof(val)));
+	}
+	return hash;
+}
+
+static void
+fwupd_client_get_metrics_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK(user_data);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GVariant) val = NULL;
+
+	val = g_dbus_proxy_call_finish(G_DBUS_PROXY(source), res, &error);
+	if (val == NULL) {
+		fwupd_client_fixup_dbus_error(error);
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+
+	/* success */
+	g_task_return_pointer(task,
+			      fwupd_client_metrics_hash_from_variant(val),
+			      (GDestroyNotify)g_hash_table_unref);
+}
+
+/**
+ * fwupd_client_get_metrics_async:
+ * @self: a #FwupdClient
+ * @cancellable: (nullable): optional #GCancellable
+ * @callback: (scope async) (closure callback_data): the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Gets the timing and counter metrics recorded by the daemon.
+ *
+ * You must have called [method@Client.connect_async] on @self before using
+ * this method.
+ *
+ * Since: 2.0.9
+ **/
+void
+fwupd_client_get_metrics_async(FwupdClient *self,
+			       GCancellable *cancellable,
+			       GAsyncReadyCallback callback,
+			       gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail(FWUPD_IS_CLIENT(self));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+	g_return_if_fail(priv->proxy != NULL);
+
+	/* call into daemon */
+	task = g_task_new(self, cancellable, callback, callback_data);
+	g_dbus_proxy_call(priv->proxy,
+			  "GetMetrics",
+			  NULL,
+			  G_DBUS_CALL_FLAGS_NONE,
+			  FWUPD_CLIENT_DBUS_PROXY_TIMEOUT,
+			  cancellable,
+			  fwupd_client_get_metrics_cb,
+			  g_steal_pointer(&task));
+}
+
+/**
+ * fwupd_client_get_metrics_finish:
+ * @self: a #FwupdClient
+ * @res: (not nullable): the asynchronous result
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the result of [method@FwupdClient.get_metrics_async].
+ *
+ * Returns: (transfer container) (element-type utf8 guint64): metric values
+ *
+ * Since: 2.0.9
+ **/
+GHashTable *
+fwupd_client_get_metrics_finish(FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail(FWUPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(g_task_is_valid(res, self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+	return g_task_propagate_pointer(G_TASK(res), error);
+}
+
 static void
 fwupd_client_get_devices_cb(GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -3385,11 +3496,18 @@ typedef struct {
 	FwupdRelease *release;
 	FwupdInstallFlags install_flags;
 	FwupdClientDownloadFlags download_flags;
+	GFile *file_tmp;
 } FwupdClientInstallReleaseData;
 
 static void
 fwupd_client_install_release_data_free(FwupdClientInstallReleaseData *data)
 {
+	if (data->file_tmp != NULL) {
+		g_autoptr(GError) error_local = NULL;
+		if (!g_file_delete(data->file_tmp, NULL, &error_local))
+			g_debug("failed to delete temporary file: %s", error_local->message);
+		g_object_unref(data->file_tmp);
+	}
 	g_object_unref(data->device);
 	g_object_unref(data->release);
 	g_free(data);
@@ -3411,42 +3529,24 @@ fwupd_client_install_release_cb(GObject *source, GAsyncResult *res, gpointer use
 }
 
 static void
-fwupd_client_install_release_bytes_cb(GObject *source, GAsyncResult *res, gpointer user_data)
-{
-	g_autoptr(GError) error = NULL;
-	g_autoptr(GTask) task = G_TASK(user_data);
-
-	if (!fwupd_client_install_bytes_finish(FWUPD_CLIENT(source), res, &error)) {
-		g_task_return_error(task, g_steal_pointer(&error));
-		return;
-	}
-
-	/* success */
-	g_task_return_boolean(task, TRUE);
-}
-
-static void
-fwupd_client_install_release_download_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+fwupd_client_install_release_download_file_cb(GObject *source,
+					      GAsyncResult *res,
+					      gpointer user_data)
 {
-	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GTask) task = G_TASK(user_data);
 	FwupdClientInstallReleaseData *data = g_task_get_task_data(task);
-	GChecksumType checksum_type;
 	GCancellable *cancellable = g_task_get_cancellable(task);
 	const gchar *checksum_expected;
 	g_autofree gchar *checksum_actual = NULL;
 
-	blob = fwupd_client_download_bytes_finish(FWUPD_CLIENT(source), res, &error);
-	if (blob == NULL) {
+	/* the checksum was calculated as the data arrived */
+	checksum_actual = fwupd_client_download_file_finish(FWUPD_CLIENT(source), res, &error);
+	if (checksum_actual == NULL) {
 		g_task_return_error(task, g_steal_pointer(&error));
 		return;
 	}
-
-	/* verify checksum */
 	checksum_expected = fwupd_checksum_get_best(fwupd_release_get_checksums(data->release));
-	checksum_type = fwupd_checksum_guess_kind(checksum_expected);
-	checksum_actual = g_compute_checksum_for_bytes(checksum_type, blob);
 	if (g_strcmp0(checksum_expected, checksum_actual) != 0) {
 		g_task_return_new_error(task,
 					FWUPD_ERROR,
@@ -3457,13 +3557,42 @@ fwupd_client_install_release_download_cb(GObject *source, GAsyncResult *res, gpo
 		return;
 	}
 
-	fwupd_client_install_bytes_async(FWUPD_CLIENT(source),
-					 fwupd_device_get_id(data->device),
-					 blob,
-					 data->install_flags,
-					 cancellable,
-					 fwupd_client_install_release_bytes_cb,
-					 g_steal_pointer(&task));
+	/* the daemon gets a file descriptor */
+	fwupd_client_install_async(FWUPD_CLIENT(source),
+				   fwupd_device_get_id(data->device),
+				   g_file_peek_path(data->file_tmp),
+				   data->install_flags,
+				   cancellable,
+				   fwupd_client_install_release_cb,
+				   g_steal_pointer(&task));
+}
+
+static void
+fwupd_client_install_release_download(FwupdClient *self, GPtrArray *urls, GTask *task)
+{
+	FwupdClientInstallReleaseData *data = g_task_get_task_data(task);
+	GCancellable *cancellable = g_task_get_cancellable(task);
+	GChecksumType checksum_kind;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GFileIOStream) iostream = NULL;
+
+	/* stream to disk rather than keeping the whole payload in memory */
+	data->file_tmp = g_file_new_tmp("fwupd-XXXXXX.cab", &iostream, &error);
+	if (data->file_tmp == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		g_object_unref(task);
+		return;
+	}
+	checksum_kind = fwupd_checksum_guess_kind(
+	    fwupd_checksum_get_best(fwupd_release_get_checksums(data->release)));
+	fwupd_client_download_file2_async(self,
+					  urls,
+					  data->file_tmp,
+					  data->download_flags,
+					  checksum_kind,
+					  cancellable,
+					  fwupd_client_install_release_download_file_cb,
+					  task);
 }
 
 static gboolean
@@ -3598,12 +3727,9 @@ fwupd_client_install_release_remote_cb(GObject *source, GAsyncResult *res, gpoin
 	}
 
 	/* download file */
-	fwupd_client_download_bytes2_async(FWUPD_CLIENT(source),
-					   uris_built,
-					   data->download_flags,
-					   cancellable,
-					   fwupd_client_install_release_download_cb,
-					   g_steal_pointer(&task));
+	fwupd_client_install_release_download(FWUPD_CLIENT(source),
+					      uris_built,
+					      g_steal_pointer(&task));
 }
 
 static GPtrArray *
@@ -3685,12 +3811,9 @@ fwupd_client_install_release_async(FwupdClient *self,
 	/* work out what remote-specific URI fields this should use */
 	remote_id = fwupd_release_get_remote_id(release);
 	if (remote_id == NULL) {
-		fwupd_client_download_bytes2_async(self,
-						   fwupd_release_get_locations(release),
-						   download_flags,
-						   cancellable,
-						   fwupd_client_install_release_download_cb,
-						   g_steal_pointer(&task));
+		fwupd_client_install_release_download(self,
+						      fwupd_release_get_locations(release),
+						      g_steal_pointer(&task));
 		return;
 	}
 
@@ -4334,6 +4457,8 @@ typedef struct {
 	FwupdClientDownloadFlags download_flags;
 	GBytes *signature;
 	GBytes *metadata;
+	gchar *etag;
+	gchar *last_modified;
 } FwupdClientRefreshRemoteData;
 
 static void
@@ -4343,15 +4468,113 @@ fwupd_client_refresh_remote_data_free(FwupdClientRefreshRemoteData *data)
 		g_bytes_unref(data->signature);
 	if (data->metadata != NULL)
 		g_bytes_unref(data->metadata);
+	g_free(data->etag);
+	g_free(data->last_modified);
 	g_object_unref(data->remote);
 	g_free(data);
 }
 
+#define FWUPD_CLIENT_VALIDATORS_GROUP "fwupd Validators"
+
+/* the validators are only useful to the user that downloaded the signature */
+static gchar *
+fwupd_client_refresh_remote_build_validators_fn(FwupdRemote *remote)
+{
+	g_autofree gchar *basename = g_strdup_printf("%s.validators", fwupd_remote_get_id(remote));
+
+	/* if run from a systemd unit, use the cache directory set there */
+	if (g_getenv("CACHE_DIRECTORY") != NULL)
+		return g_build_filename(g_getenv("CACHE_DIRECTORY"), "remotes.d", basename, NULL);
+	return g_build_filename(g_get_user_cache_dir(), "fwupd", "remotes.d", basename, NULL);
+}
+
+static void
+fwupd_client_refresh_remote_load_validators(FwupdClientRefreshRemoteData *data)
+{
+	gsize bufsz = 0;
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *signature = NULL;
+	g_autofree guchar *buf = NULL;
+	g_autofree gchar *fn = fwupd_client_refresh_remote_build_validators_fn(data->remote);
+	g_autoptr(GKeyFile) kf = g_key_file_new();
+
+	if (!g_key_file_load_from_file(kf, fn, G_KEY_FILE_NONE, NULL))
+		return;
+
+	/* only valid if the daemon still has the signature that was downloaded */
+	checksum = g_key_file_get_string(kf, FWUPD_CLIENT_VALIDATORS_GROUP, "ChecksumSig", NULL);
+	if (checksum == NULL || g_strcmp0(checksum, fwupd_remote_get_checksum(data->remote)) != 0)
+		return;
+
+	/* sent back to the daemon if not modified, so that it can reset the age */
+	signature = g_key_file_get_string(kf, FWUPD_CLIENT_VALIDATORS_GROUP, "Signature", NULL);
+	if (signature == NULL)
+		return;
+	buf = g_base64_decode(signature, &bufsz);
+	if (bufsz == 0)
+		return;
+	data->signature = g_bytes_new_take(g_steal_pointer(&buf), bufsz);
+	data->etag = g_key_file_get_string(kf, FWUPD_CLIENT_VALIDATORS_GROUP, "ETag", NULL);
+	data->last_modified =
+	    g_key_file_get_string(kf, FWUPD_CLIENT_VALIDATORS_GROUP, "LastModified", NULL);
+}
+
+static gboolean
+fwupd_client_refresh_remote_save_validators(FwupdClientRefreshRemoteData *data, GError **error)
+{
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *dirname = NULL;
+	g_autofree gchar *fn = fwupd_client_refresh_remote_build_validators_fn(data->remote);
+	g_autofree gchar *signature = NULL;
+	g_autoptr(GKeyFile) kf = g_key_file_new();
+
+	/* nothing to save */
+	if (data->etag == NULL && data->last_modified == NULL) {
+		if (g_unlink(fn) != 0 && errno != ENOENT) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_WRITE,
+				    "failed to delete %s: %s",
+				    fn,
+				    g_strerror(errno));
+			return FALSE;
+		}
+		return TRUE;
+	}
+
+	checksum = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, data->signature);
+	g_key_file_set_string(kf, FWUPD_CLIENT_VALIDATORS_GROUP, "ChecksumSig", checksum);
+	signature = g_base64_encode(g_bytes_get_data(data->signature, NULL),
+				    g_bytes_get_size(data->signature));
+	g_key_file_set_string(kf, FWUPD_CLIENT_VALIDATORS_GROUP, "Signature", signature);
+	if (data->etag != NULL)
+		g_key_file_set_string(kf, FWUPD_CLIENT_VALIDATORS_GROUP, "ETag", data->etag);
+	if (data->last_modified != NULL) {
+		g_key_file_set_string(kf,
+				      FWUPD_CLIENT_VALIDATORS_GROUP,
+				      "LastModified",
+				      data->last_modified);
+	}
+	dirname = g_path_get_dirname(fn);
+	if (g_mkdir_with_parents(dirname, 0700) != 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_WRITE,
+			    "failed to create %s: %s",
+			    dirname,
+			    g_strerror(errno));
+		return FALSE;
+	}
+	return g_key_file_save_to_file(kf, fn, error);
+}
+
 static void
 fwupd_client_refresh_remote_update_cb(GObject *source, GAsyncResult *res, gpointer user_data)
 {
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GError) error_validators = NULL;
 	g_autoptr(GTask) task = G_TASK(user_data);
+	FwupdClientRefreshRemoteData *data = g_task_get_task_data(task);
 
 	/* save metadata */
 	if (!fwupd_client_update_metadata_bytes_finish(FWUPD_CLIENT(source), res, &error)) {
@@ -4359,10 +4582,32 @@ fwupd_client_refresh_remote_update_cb(GObject *source, GAsyncResult *res, gpoint
 		return;
 	}
 
+	/* the daemon now has this signature, so the next refresh can be conditional */
+	if (!fwupd_client_refresh_remote_save_validators(data, &error_validators))
+		g_info("failed to save validators: %s", error_validators->message);
+
 	/* success */
 	g_task_return_boolean(task, TRUE);
 }
 
+/* the daemon already has this signature, so only send the signature to reset the age */
+static void
+fwupd_client_refresh_remote_not_modified(GTask *task)
+{
+	FwupdClientRefreshRemoteData *data = g_task_get_task_data(task);
+	FwupdClient *self = g_task_get_source_object(task);
+	GCancellable *cancellable = g_task_get_cancellable(task);
+	g_autoptr(GBytes) metadata = g_bytes_new(NULL, 0);
+
+	fwupd_client_update_metadata_bytes_async(self,
+						 fwupd_remote_get_id(data->remote),
+						 metadata,
+						 data->signature,
+						 cancellable,
+						 fwupd_client_refresh_remote_update_cb,
+						 task);
+}
+
 static void
 fwupd_client_refresh_remote_metadata_cb(GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -4414,6 +4659,8 @@ fwupd_client_refresh_remote_metadata_cb(GObject *source, GAsyncResult *res, gpoi
 static void
 fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpointer user_data)
 {
+	g_autofree gchar *etag = NULL;
+	g_autofree gchar *last_modified = NULL;
 	g_autoptr(GBytes) bytes = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GTask) task = G_TASK(user_data);
@@ -4423,14 +4670,31 @@ fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpo
 	g_autoptr(GPtrArray) urls = g_ptr_array_new_with_free_func(g_free);
 
 	/* save signature */
-	bytes = fwupd_client_download_bytes_finish(FWUPD_CLIENT(source), res, &error);
+	bytes = fwupd_client_download_bytes_conditional_finish(FWUPD_CLIENT(source),
+							       res,
+							       &etag,
+							       &last_modified,
+							       &error);
 	if (bytes == NULL) {
+		if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO) &&
+		    data->signature != NULL) {
+			g_info("metadata signature of %s is not modified, skipping",
+			       fwupd_remote_get_id(data->remote));
+			fwupd_client_refresh_remote_not_modified(g_steal_pointer(&task));
+			return;
+		}
 		g_prefix_error(&error,
 			       "Failed to download metadata for %s: ",
 			       fwupd_remote_get_id(data->remote));
 		g_task_return_error(task, g_steal_pointer(&error));
 		return;
 	}
+	g_free(data->etag);
+	data->etag = g_steal_pointer(&etag);
+	g_free(data->last_modified);
+	data->last_modified = g_steal_pointer(&last_modified);
+	if (data->signature != NULL)
+		g_bytes_unref(data->signature);
 	data->signature = g_steal_pointer(&bytes);
 	if (!fwupd_remote_load_signature_bytes(data->remote, data->signature, &error)) {
 		g_prefix_error(&error, "Failed to load signature: ");
@@ -4449,7 +4713,7 @@ fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpo
 		if (g_strcmp0(checksum, fwupd_remote_get_checksum(data->remote)) == 0) {
 			g_info("metadata signature of %s is unchanged, skipping",
 			       fwupd_remote_get_id(data->remote));
-			g_task_return_boolean(task, TRUE);
+			fwupd_client_refresh_remote_not_modified(g_steal_pointer(&task));
 			return;
 		}
 	}
@@ -4493,6 +4757,10 @@ fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpo
  *
  * Refreshes a remote by downloading new metadata.
  *
+ * The `ETag` and `Last-Modified` values of the signature are saved in the user cache directory,
+ * and used to make the next request conditional. If the server says the signature has not been
+ * modified then nothing more is downloaded, and the daemon is just told the metadata is current.
+ *
  * NOTE: This method is thread-safe, but progress signals will be
  * emitted in the global default main context, if not explicitly set with
  * [method@Client.set_main_context].
@@ -4520,9 +4788,7 @@ fwupd_client_refresh_remote_async(FwupdClient *self,
 	data = g_new0(FwupdClientRefreshRemoteData, 1);
 	data->download_flags = download_flags;
 	data->remote = g_object_ref(remote);
-	g_task_set_task_data(task,
-			     g_steal_pointer(&data),
-			     (GDestroyNotify)fwupd_client_refresh_remote_data_free);
+	g_task_set_task_data(task, data, (GDestroyNotify)fwupd_client_refresh_remote_data_free);
 
 	/* nothing to do */
 	if (fwupd_remote_get_kind(remote) != FWUPD_REMOTE_KIND_DOWNLOAD) {
@@ -4550,12 +4816,16 @@ fwupd_client_refresh_remote_async(FwupdClient *self,
 		g_task_return_error(task, g_steal_pointer(&error));
 		return;
 	}
-	fwupd_client_download_bytes_async(self,
-					  uri,
-					  download_flags & ~FWUPD_CLIENT_DOWNLOAD_FLAG_ONLY_P2P,
-					  cancellable,
-					  fwupd_client_refresh_remote_signature_cb,
-					  g_steal_pointer(&task));
+	fwupd_client_refresh_remote_load_validators(data);
+	fwupd_client_download_bytes_conditional_async(
+	    self,
+	    uri,
+	    download_flags & ~FWUPD_CLIENT_DOWNLOAD_FLAG_ONLY_P2P,
+	    data->etag,
+	    data->last_modified,
+	    cancellable,
+	    fwupd_client_refresh_remote_signature_cb,
+	    g_steal_pointer(&task));
 }
 
 /**
@@ -5575,59 +5845,27 @@ fwupd_client_download_ipfs(FwupdClient *self,
 	return g_steal_pointer(&bstdout);
 }
 
-static GBytes *
-fwupd_client_download_http(FwupdClient *self, CURL *curl, const gchar *url, GError **error)
+static gboolean
+fwupd_client_download_check_status(CURL *curl, GByteArray *buf, GError **error)
 {
-	CURLcode res;
-	gchar errbuf[CURL_ERROR_SIZE] = {'\0'};
 	glong status_code = 0;
-	g_autoptr(GByteArray) buf = g_byte_array_new();
-
-	/* relax the SSL checks on localhost URLs and broken corporate proxies */
-	if (fwupd_client_is_localhost(url) || g_getenv("DISABLE_SSL_STRICT") != NULL) {
-		(void)curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-		(void)curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-	} else {
-		(void)curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-		(void)curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 1L);
-	}
-
-	fwupd_client_set_status(self, FWUPD_STATUS_DOWNLOADING);
-	(void)curl_easy_setopt(curl, CURLOPT_URL, url);
-	(void)curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errbuf);
-	(void)curl_easy_setopt(curl,
-			       CURLOPT_WRITEFUNCTION,
-			       fwupd_client_download_write_callback_cb);
-	(void)curl_easy_setopt(curl, CURLOPT_WRITEDATA, buf);
-	res = curl_easy_perform(curl);
-	fwupd_client_set_status(self, FWUPD_STATUS_IDLE);
-	fwupd_client_set_percentage(self, 100);
-	if (res != CURLE_OK) {
-		if (errbuf[0] != '\0') {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_FILE,
-				    "failed to download file: %s",
-				    errbuf);
-			return NULL;
-		}
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INVALID_FILE,
-			    "failed to download file: %s",
-			    curl_easy_strerror(res));
-		return NULL;
-	}
 
 	/* check for server limit */
 	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
 	g_info("status-code was %ld", status_code);
+	if (status_code == 304) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOTHING_TO_DO,
+				    "Not modified since the last download");
+		return FALSE;
+	}
 	if (status_code == 429) {
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_INVALID_FILE,
 				    "Failed to download due to server limit");
-		return NULL;
+		return FALSE;
 	}
 	if (status_code == 502 || status_code == 503 || status_code == 504) {
 		g_autofree gchar *str = g_strndup((const gchar *)buf->data, MIN(buf->len, 4000));
@@ -5638,14 +5876,14 @@ fwupd_client_download_http(FwupdClient *self, CURL *curl, const gchar *url, GErr
 				    "Transient failure to download, server response was %u: %s",
 				    (guint)status_code,
 				    str);
-			return NULL;
+			return FALSE;
 		}
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_TIMED_OUT,
 			    "Transient failure to download, server response was %u",
 			    (guint)status_code);
-		return NULL;
+		return FALSE;
 	}
 	if (status_code >= 400) {
 		g_autofree gchar *str = g_strndup((const gchar *)buf->data, MIN(buf->len, 4000));
@@ -5656,53 +5894,118 @@ fwupd_client_download_http(FwupdClient *self, CURL *curl, const gchar *url, GErr
 				    "Failed to download, server response was %u: %s",
 				    (guint)status_code,
 				    str);
-			return NULL;
+			return FALSE;
 		}
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_INVALID_FILE,
 			    "Failed to download, server response was %u",
 			    (guint)status_code);
-		return NULL;
+		return FALSE;
 	}
 
-	return g_bytes_new(buf->data, buf->len);
+	/* success */
+	return TRUE;
 }
 
-static gboolean
-fwupd_client_download_error_is_fatal(const GError *error)
+static void
+fwupd_client_download_set_ssl_verify(CURL *curl, const gchar *url)
 {
-	if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_TIMED_OUT))
-		return FALSE;
-	return TRUE;
+	/* relax the SSL checks on localhost URLs and broken corporate proxies */
+	if (fwupd_client_is_localhost(url) || g_getenv("DISABLE_SSL_STRICT") != NULL) {
+		(void)curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+		(void)curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+	} else {
+		(void)curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+		(void)curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 1L);
+	}
 }
 
 static GBytes *
-fwupd_client_download_http_retry(FwupdClient *self, CURL *curl, const gchar *url, GError **error)
+fwupd_client_download_http(FwupdClient *self, CURL *curl, const gchar *url, GError **error)
 {
-	FwupdClientPrivate *priv = GET_PRIVATE(self);
-	GNetworkMonitor *monitor = g_network_monitor_get_default();
-	gulong delay_ms = 2500;
-	g_autoptr(GError) error_monitor = NULL;
-	g_autoptr(GSocketConnectable) address = NULL;
-	g_autoptr(GUri) uri = NULL;
-
-	/* test if we can reach this network */
+	CURLcode res;
+	gchar errbuf[CURL_ERROR_SIZE] = {'\0'};
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+
+	fwupd_client_download_set_ssl_verify(curl, url);
+	fwupd_client_set_status(self, FWUPD_STATUS_DOWNLOADING);
+	(void)curl_easy_setopt(curl, CURLOPT_URL, url);
+	(void)curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errbuf);
+	(void)curl_easy_setopt(curl,
+			       CURLOPT_WRITEFUNCTION,
+			       fwupd_client_download_write_callback_cb);
+	(void)curl_easy_setopt(curl, CURLOPT_WRITEDATA, buf);
+	res = curl_easy_perform(curl);
+	fwupd_client_set_status(self, FWUPD_STATUS_IDLE);
+	fwupd_client_set_percentage(self, 100);
+	if (res != CURLE_OK) {
+		if (errbuf[0] != '\0') {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "failed to download file: %s",
+				    errbuf);
+			return NULL;
+		}
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_FILE,
+			    "failed to download file: %s",
+			    curl_easy_strerror(res));
+		return NULL;
+	}
+
+	if (!fwupd_client_download_check_status(curl, buf, error))
+		return NULL;
+	return g_bytes_new(buf->data, buf->len);
+}
+
+static gboolean
+fwupd_client_download_error_is_fatal(const GError *error)
+{
+	if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_TIMED_OUT))
+		return FALSE;
+	return TRUE;
+}
+
+static gboolean
+fwupd_client_download_check_reachable(const gchar *url, GError **error)
+{
+	GNetworkMonitor *monitor = g_network_monitor_get_default();
+	g_autoptr(GError) error_monitor = NULL;
+	g_autoptr(GSocketConnectable) address = NULL;
+	g_autoptr(GUri) uri = NULL;
+
 	uri = g_uri_parse(url, G_URI_FLAGS_NONE, error);
 	if (uri == NULL)
-		return NULL;
+		return FALSE;
 	address = g_network_address_parse(g_uri_get_host(uri), g_uri_get_port(uri), error);
 	if (address == NULL)
-		return NULL;
+		return FALSE;
 	if (!g_network_monitor_can_reach(monitor, address, NULL, &error_monitor)) {
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_NOT_REACHABLE,
 			    "network is unreachable: %s",
 			    error_monitor->message);
-		return NULL;
+		return FALSE;
 	}
 
+	/* success */
+	return TRUE;
+}
+
+static GBytes *
+fwupd_client_download_http_retry(FwupdClient *self, CURL *curl, const gchar *url, GError **error)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	gulong delay_ms = 2500;
+
+	/* test if we can reach this network */
+	if (!fwupd_client_download_check_reachable(url, error))
+		return NULL;
+
 	for (guint i = 0;; i++, delay_ms *= 2) {
 		g_autoptr(GBytes) blob = NULL;
 		g_autoptr(GError) error_local = NULL;
@@ -5862,6 +6165,504 @@ fwupd_client_download_bytes_finish(FwupdClient *self, GAsyncResult *res, GError
 	return g_task_propagate_pointer(G_TASK(res), error);
 }
 
+static size_t
+fwupd_client_download_header_callback_cb(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	FwupdCurlHelper *helper = (FwupdCurlHelper *)userdata;
+	gsize realsize = size * nmemb;
+	gchar *value;
+	g_autofree gchar *line = g_strndup(ptr, realsize);
+
+	/* each redirect has its own headers, and only the last response matters */
+	if (g_str_has_prefix(line, "HTTP/")) {
+		g_clear_pointer(&helper->etag, g_free);
+		g_clear_pointer(&helper->last_modified, g_free);
+		return realsize;
+	}
+	value = g_strstr_len(line, -1, ":");
+	if (value == NULL)
+		return realsize;
+	*value = '\0';
+	value = g_strstrip(value + 1);
+	if (g_ascii_strcasecmp(line, "ETag") == 0) {
+		g_free(helper->etag);
+		helper->etag = g_strdup(value);
+	} else if (g_ascii_strcasecmp(line, "Last-Modified") == 0) {
+		g_free(helper->last_modified);
+		helper->last_modified = g_strdup(value);
+	}
+	return realsize;
+}
+
+/* private */
+void
+fwupd_client_download_bytes_conditional_async(FwupdClient *self,
+					      const gchar *url,
+					      FwupdClientDownloadFlags flags,
+					      const gchar *etag,
+					      const gchar *last_modified,
+					      GCancellable *cancellable,
+					      GAsyncReadyCallback callback,
+					      gpointer callback_data)
+{
+	g_autoptr(GTask) task = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(FwupdCurlHelper) helper = NULL;
+	g_autoptr(GPtrArray) urls = g_ptr_array_new_with_free_func(g_free);
+
+	g_return_if_fail(FWUPD_IS_CLIENT(self));
+	g_return_if_fail(url != NULL);
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+	/* ensure networking set up */
+	task = g_task_new(self, cancellable, callback, callback_data);
+	helper = fwupd_client_curl_new(self, &error);
+	if (helper == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	g_ptr_array_add(urls, g_strdup(url));
+	helper->urls = fwupd_client_filter_locations(urls, flags, &error);
+	if (helper->urls == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+
+	/* the server replies with 304 if nothing has changed */
+	if (etag != NULL) {
+		g_autofree gchar *header = g_strdup_printf("If-None-Match: %s", etag);
+		helper->headers = curl_slist_append(helper->headers, header);
+	}
+	if (last_modified != NULL) {
+		g_autofree gchar *header = g_strdup_printf("If-Modified-Since: %s", last_modified);
+		helper->headers = curl_slist_append(helper->headers, header);
+	}
+	if (helper->headers != NULL)
+		(void)curl_easy_setopt(helper->curl, CURLOPT_HTTPHEADER, helper->headers);
+	(void)curl_easy_setopt(helper->curl,
+			       CURLOPT_HEADERFUNCTION,
+			       fwupd_client_download_header_callback_cb);
+	(void)curl_easy_setopt(helper->curl, CURLOPT_HEADERDATA, helper);
+	g_task_set_task_data(task,
+			     g_steal_pointer(&helper),
+			     (GDestroyNotify)fwupd_client_curl_helper_free);
+
+	/* download data */
+	g_task_run_in_thread(task, fwupd_client_download_bytes_thread_cb);
+}
+
+/* private */
+GBytes *
+fwupd_client_download_bytes_conditional_finish(FwupdClient *self,
+					       GAsyncResult *res,
+					       gchar **etag,
+					       gchar **last_modified,
+					       GError **error)
+{
+	FwupdCurlHelper *helper;
+
+	g_return_val_if_fail(FWUPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(g_task_is_valid(res, self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	helper = g_task_get_task_data(G_TASK(res));
+	if (etag != NULL)
+		*etag = g_strdup(helper->etag);
+	if (last_modified != NULL)
+		*last_modified = g_strdup(helper->last_modified);
+	return g_task_propagate_pointer(G_TASK(res), error);
+}
+
+typedef struct {
+	CURL *curl;
+	GFileIOStream *iostream;
+	GChecksum *checksum;
+	goffset offset;	       /* bytes written to the file */
+	goffset resume_from;   /* for the transfer in progress */
+	GByteArray *buf_error; /* body of any error response */
+	GError *error;
+} FwupdClientDownloadFileHelper;
+
+static void
+fwupd_client_download_file_helper_free(FwupdClientDownloadFileHelper *helper)
+{
+	if (helper->iostream != NULL)
+		g_object_unref(helper->iostream);
+	if (helper->error != NULL)
+		g_error_free(helper->error);
+	g_checksum_free(helper->checksum);
+	g_byte_array_unref(helper->buf_error);
+	g_free(helper);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FwupdClientDownloadFileHelper,
+			      fwupd_client_download_file_helper_free)
+
+/* throw away anything downloaded so far */
+static gboolean
+fwupd_client_download_file_helper_reset(FwupdClientDownloadFileHelper *helper, GError **error)
+{
+	if (!g_seekable_seek(G_SEEKABLE(helper->iostream), 0, G_SEEK_SET, NULL, error))
+		return FALSE;
+	if (!g_seekable_truncate(G_SEEKABLE(helper->iostream), 0, NULL, error))
+		return FALSE;
+	g_checksum_reset(helper->checksum);
+	helper->offset = 0;
+	return TRUE;
+}
+
+static gboolean
+fwupd_client_download_file_helper_write(FwupdClientDownloadFileHelper *helper,
+					const guint8 *buf,
+					gsize bufsz,
+					GError **error)
+{
+	GOutputStream *ostream = g_io_stream_get_output_stream(G_IO_STREAM(helper->iostream));
+	if (!g_output_stream_write_all(ostream, buf, bufsz, NULL, NULL, error))
+		return FALSE;
+	g_checksum_update(helper->checksum, (const guchar *)buf, bufsz);
+	helper->offset += bufsz;
+	return TRUE;
+}
+
+static size_t
+fwupd_client_download_file_write_callback_cb(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	FwupdClientDownloadFileHelper *helper = (FwupdClientDownloadFileHelper *)userdata;
+	gsize realsize = size * nmemb;
+	glong status_code = 0;
+
+	/* error pages never end up in the file */
+	(void)curl_easy_getinfo(helper->curl, CURLINFO_RESPONSE_CODE, &status_code);
+	if (status_code >= 300) {
+		if (helper->buf_error->len < 4000)
+			g_byte_array_append(helper->buf_error, (const guint8 *)ptr, realsize);
+		return realsize;
+	}
+
+	/* the server ignored the range and is sending everything again */
+	if (helper->resume_from > 0) {
+		if (status_code != 206) {
+			g_info("server does not support resuming, restarting download");
+			if (!fwupd_client_download_file_helper_reset(helper, &helper->error))
+				return 0;
+		}
+		helper->resume_from = 0;
+	}
+
+	/* returning a short count makes curl abort the transfer */
+	if (!fwupd_client_download_file_helper_write(helper,
+						     (const guint8 *)ptr,
+						     realsize,
+						     &helper->error))
+		return 0;
+	return realsize;
+}
+
+static gboolean
+fwupd_client_download_curl_code_is_transient(CURLcode res)
+{
+	return res == CURLE_PARTIAL_FILE || res == CURLE_RECV_ERROR || res == CURLE_SEND_ERROR ||
+	       res == CURLE_GOT_NOTHING || res == CURLE_OPERATION_TIMEDOUT;
+}
+
+static gboolean
+fwupd_client_download_http_file(FwupdClient *self,
+				FwupdClientDownloadFileHelper *helper,
+				const gchar *url,
+				GError **error)
+{
+	CURLcode res;
+	gchar errbuf[CURL_ERROR_SIZE] = {'\0'};
+	glong status_code = 0;
+
+	/* continue from where the last attempt got to */
+	if (helper->offset > 0)
+		g_info("resuming download from 0x%x", (guint)helper->offset);
+	helper->resume_from = helper->offset;
+	g_byte_array_set_size(helper->buf_error, 0);
+
+	fwupd_client_download_set_ssl_verify(helper->curl, url);
+	fwupd_client_set_status(self, FWUPD_STATUS_DOWNLOADING);
+	(void)curl_easy_setopt(helper->curl, CURLOPT_URL, url);
+	(void)curl_easy_setopt(helper->curl, CURLOPT_ERRORBUFFER, errbuf);
+	(void)curl_easy_setopt(helper->curl, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)helper->offset);
+	(void)curl_easy_setopt(helper->curl,
+			       CURLOPT_WRITEFUNCTION,
+			       fwupd_client_download_file_write_callback_cb);
+	(void)curl_easy_setopt(helper->curl, CURLOPT_WRITEDATA, helper);
+	res = curl_easy_perform(helper->curl);
+	(void)curl_easy_setopt(helper->curl, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)0);
+	fwupd_client_set_status(self, FWUPD_STATUS_IDLE);
+	fwupd_client_set_percentage(self, 100);
+	if (helper->error != NULL) {
+		g_propagate_error(error, g_steal_pointer(&helper->error));
+		return FALSE;
+	}
+	if (res != CURLE_OK) {
+		/* keep what we have so the next attempt can resume */
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    fwupd_client_download_curl_code_is_transient(res)
+				? FWUPD_ERROR_TIMED_OUT
+				: FWUPD_ERROR_INVALID_FILE,
+			    "failed to download file: %s",
+			    errbuf[0] != '\0' ? errbuf : curl_easy_strerror(res));
+		return FALSE;
+	}
+
+	/* we asked for a range that is not valid, so start again */
+	curl_easy_getinfo(helper->curl, CURLINFO_RESPONSE_CODE, &status_code);
+	if (status_code == 416) {
+		if (!fwupd_client_download_file_helper_reset(helper, error))
+			return FALSE;
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_TIMED_OUT,
+				    "Failed to resume download, restarting");
+		return FALSE;
+	}
+	return fwupd_client_download_check_status(helper->curl, helper->buf_error, error);
+}
+
+static gboolean
+fwupd_client_download_http_file_retry(FwupdClient *self,
+				      FwupdClientDownloadFileHelper *helper,
+				      const gchar *url,
+				      GError **error)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	gulong delay_ms = 2500;
+
+	/* test if we can reach this network */
+	if (!fwupd_client_download_check_reachable(url, error))
+		return FALSE;
+
+	for (guint i = 0;; i++, delay_ms *= 2) {
+		g_autoptr(GError) error_local = NULL;
+
+		if (fwupd_client_download_http_file(self, helper, url, &error_local))
+			return TRUE;
+		if (i >= priv->download_retries ||
+		    fwupd_client_download_error_is_fatal(error_local)) {
+			g_propagate_error(error, g_steal_pointer(&error_local));
+			break;
+		}
+		g_debug("ignoring and trying again: %s", error_local->message);
+		g_usleep(delay_ms * 1000);
+	}
+	return FALSE;
+}
+
+static gboolean
+fwupd_client_download_ipfs_file(FwupdClient *self,
+				FwupdClientDownloadFileHelper *helper,
+				const gchar *url,
+				GCancellable *cancellable,
+				GError **error)
+{
+	g_autoptr(GBytes) blob = NULL;
+
+	blob = fwupd_client_download_ipfs(self, url, cancellable, error);
+	if (blob == NULL)
+		return FALSE;
+	return fwupd_client_download_file_helper_write(helper,
+						       g_bytes_get_data(blob, NULL),
+						       g_bytes_get_size(blob),
+						       error);
+}
+
+static void
+fwupd_client_download_file_thread_cb(GTask *task,
+				     gpointer source_object,
+				     gpointer task_data,
+				     GCancellable *cancellable)
+{
+	FwupdClient *self = FWUPD_CLIENT(source_object);
+	FwupdCurlHelper *helper = g_task_get_task_data(task);
+	g_autoptr(FwupdClientDownloadFileHelper) file_helper =
+	    g_new0(FwupdClientDownloadFileHelper, 1);
+	g_autoptr(GError) error_file = NULL;
+
+	/* opened read-write so it can be truncated if the server cannot resume */
+	file_helper->curl = helper->curl;
+	file_helper->checksum = g_checksum_new(helper->checksum_kind);
+	file_helper->buf_error = g_byte_array_new();
+	file_helper->iostream = g_file_replace_readwrite(helper->file,
+							 NULL,
+							 FALSE,
+							 G_FILE_CREATE_NONE,
+							 cancellable,
+							 &error_file);
+	if (file_helper->iostream == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error_file));
+		return;
+	}
+
+	for (guint i = 0; i < helper->urls->len; i++) {
+		const gchar *url = g_ptr_array_index(helper->urls, i);
+		gboolean ret = FALSE;
+		g_autoptr(GError) error = NULL;
+		g_info("downloading %s", url);
+		if (!fwupd_client_curl_helper_set_proxy(self, helper, url, &error)) {
+			g_task_return_error(task, g_steal_pointer(&error));
+			return;
+		}
+
+		/* each URL is a different source, so never resume from another */
+		if (!fwupd_client_download_file_helper_reset(file_helper, &error)) {
+			g_task_return_error(task, g_steal_pointer(&error));
+			return;
+		}
+		if (fwupd_client_is_url_http(url)) {
+			ret = fwupd_client_download_http_file_retry(self, file_helper, url, &error);
+		} else if (fwupd_client_is_url_ipfs(url)) {
+			ret = fwupd_client_download_ipfs_file(self,
+							      file_helper,
+							      url,
+							      cancellable,
+							      &error);
+		} else {
+			g_set_error(&error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "not sure how to handle: %s",
+				    url);
+		}
+		if (ret)
+			break;
+		if (i == helper->urls->len - 1) {
+			g_task_return_error(task, g_steal_pointer(&error));
+			return;
+		}
+		fwupd_client_set_percentage(self, 0);
+		fwupd_client_set_status(self, FWUPD_STATUS_IDLE);
+		g_info("failed to download %s: %s, trying next URI…", url, error->message);
+	}
+
+	/* ensure everything is on disk */
+	if (!g_io_stream_close(G_IO_STREAM(file_helper->iostream), cancellable, &error_file)) {
+		g_task_return_error(task, g_steal_pointer(&error_file));
+		return;
+	}
+	g_task_return_pointer(task,
+			      g_strdup(g_checksum_get_string(file_helper->checksum)),
+			      g_free);
+}
+
+/* private */
+void
+fwupd_client_download_file2_async(FwupdClient *self,
+				  GPtrArray *urls,
+				  GFile *file,
+				  FwupdClientDownloadFlags flags,
+				  GChecksumType checksum_kind,
+				  GCancellable *cancellable,
+				  GAsyncReadyCallback callback,
+				  gpointer callback_data)
+{
+	g_autoptr(GTask) task = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(FwupdCurlHelper) helper = NULL;
+
+	g_return_if_fail(FWUPD_IS_CLIENT(self));
+	g_return_if_fail(urls != NULL);
+	g_return_if_fail(G_IS_FILE(file));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+	/* ensure networking set up */
+	task = g_task_new(self, cancellable, callback, callback_data);
+	helper = fwupd_client_curl_new(self, &error);
+	if (helper == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	helper->urls = fwupd_client_filter_locations(urls, flags, &error);
+	if (helper->urls == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	helper->file = g_object_ref(file);
+	helper->checksum_kind = checksum_kind;
+	g_task_set_task_data(task,
+			     g_steal_pointer(&helper),
+			     (GDestroyNotify)fwupd_client_curl_helper_free);
+
+	/* download data */
+	g_task_run_in_thread(task, fwupd_client_download_file_thread_cb);
+}
+
+/**
+ * fwupd_client_download_file_async:
+ * @self: a #FwupdClient
+ * @url: (not nullable): the remote URL
+ * @file: (not nullable): the file to write
+ * @flags: download flags, e.g. %FWUPD_CLIENT_DOWNLOAD_FLAG_NONE
+ * @cancellable: (nullable): optional #GCancellable
+ * @callback: (scope async) (closure callback_data): the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Downloads data from a remote server directly into a file, which means the payload is never
+ * held in memory. If the transfer fails part of the way through it is resumed using a HTTP range
+ * request when retrying, if the server supports it.
+ *
+ * The SHA256 checksum is calculated as the data arrives.
+ *
+ * NOTE: This method is thread-safe, but progress signals will be
+ * emitted in the global default main context, if not explicitly set with
+ * [method@Client.set_main_context].
+ *
+ * Since: 2.0.9
+ **/
+void
+fwupd_client_download_file_async(FwupdClient *self,
+				 const gchar *url,
+				 GFile *file,
+				 FwupdClientDownloadFlags flags,
+				 GCancellable *cancellable,
+				 GAsyncReadyCallback callback,
+				 gpointer callback_data)
+{
+	g_autoptr(GPtrArray) urls = g_ptr_array_new_with_free_func(g_free);
+
+	g_return_if_fail(FWUPD_IS_CLIENT(self));
+	g_return_if_fail(url != NULL);
+	g_return_if_fail(G_IS_FILE(file));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+	/* just proxy */
+	g_ptr_array_add(urls, g_strdup(url));
+	fwupd_client_download_file2_async(self,
+					  urls,
+					  file,
+					  flags,
+					  G_CHECKSUM_SHA256,
+					  cancellable,
+					  callback,
+					  callback_data);
+}
+
+/**
+ * fwupd_client_download_file_finish:
+ * @self: a #FwupdClient
+ * @res: (not nullable): the asynchronous result
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the result of [method@FwupdClient.download_file_async].
+ *
+ * Returns: (transfer full): the SHA256 checksum of the downloaded file, or %NULL for error
+ *
+ * Since: 2.0.9
+ **/
+gchar *
+fwupd_client_download_file_finish(FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail(FWUPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(g_task_is_valid(res, self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+	return g_task_propagate_pointer(G_TASK(res), error);
+}
+
 static void
 fwupd_client_upload_bytes_thread_cb(GTask *task,
 				    gpointer source_object,
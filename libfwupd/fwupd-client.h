@@ -435,6 +435,15 @@ fwupd_client_get_report_metadata_finish(FwupdClient *self,
 					GError **error) G_GNUC_WARN_UNUSED_RESULT
     G_GNUC_NON_NULL(1, 2);
 void
+fwupd_client_get_metrics_async(FwupdClient *self,
+			       GCancellable *cancellable,
+			       GAsyncReadyCallback callback,
+			       gpointer callback_data) G_GNUC_NON_NULL(1);
+GHashTable *
+fwupd_client_get_metrics_finish(FwupdClient *self,
+				GAsyncResult *res,
+				GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
+void
 fwupd_client_inhibit_async(FwupdClient *self,
 			   const gchar *reason,
 			   GCancellable *cancellable,
@@ -625,6 +634,18 @@ fwupd_client_download_bytes_finish(FwupdClient *self,
 				   GAsyncResult *res,
 				   GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
 void
+fwupd_client_download_file_async(FwupdClient *self,
+				 const gchar *url,
+				 GFile *file,
+				 FwupdClientDownloadFlags flags,
+				 GCancellable *cancellable,
+				 GAsyncReadyCallback callback,
+				 gpointer callback_data) G_GNUC_NON_NULL(1, 2, 3);
+gchar *
+fwupd_client_download_file_finish(FwupdClient *self,
+				  GAsyncResult *res,
+				  GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
+void
 fwupd_client_download_set_retries(FwupdClient *self, guint retries) G_GNUC_NON_NULL(1);
 void
 fwupd_client_upload_bytes_async(FwupdClient *self,
@@ -228,15 +228,14 @@ fwupd_guid_from_string(const gchar *guidstr,
 		       FwupdGuidFlags flags,
 		       GError **error)
 {
-	fwupd_guid_native_t gu = {0x0};
 	gboolean mixed_endian = flags & FWUPD_GUID_FLAG_MIXED_ENDIAN;
-	guint64 tmp;
-	g_auto(GStrv) split = NULL;
+	guint8 buf[16] = {0x0};
+	guint j = 0;
 
 	g_return_val_if_fail(guidstr != NULL, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	/* split into sections */
+	/* check sections, without allocating as this is used for GUID lookups */
 	if (strlen(guidstr) != 36) {
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
@@ -244,45 +243,43 @@ fwupd_guid_from_string(const gchar *guidstr,
 				    "GUID is not valid format");
 		return FALSE;
 	}
-	split = g_strsplit(guidstr, "-", 5);
-	if (g_strv_length(split) != 5) {
+	if (guidstr[8] != '-' || guidstr[13] != '-' || guidstr[18] != '-' || guidstr[23] != '-') {
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_INVALID_DATA,
 				    "GUID is not valid format, no dashes");
 		return FALSE;
 	}
-	if (strlen(split[0]) != 8 || strlen(split[1]) != 4 || strlen(split[2]) != 4 ||
-	    strlen(split[3]) != 4 || strlen(split[4]) != 12) {
-		g_set_error_literal(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_DATA,
-				    "GUID is not valid format, not GUID");
-		return FALSE;
-	}
 
-	/* parse */
-	if (!g_ascii_string_to_unsigned(split[0], 16, 0, 0xffffffff, &tmp, error))
-		return FALSE;
-	gu.a = mixed_endian ? GUINT32_TO_LE(tmp) : GUINT32_TO_BE(tmp); /* nocheck:blocked */
-	if (!g_ascii_string_to_unsigned(split[1], 16, 0, 0xffff, &tmp, error))
-		return FALSE;
-	gu.b = mixed_endian ? GUINT16_TO_LE(tmp) : GUINT16_TO_BE(tmp); /* nocheck:blocked */
-	if (!g_ascii_string_to_unsigned(split[2], 16, 0, 0xffff, &tmp, error))
-		return FALSE;
-	gu.c = mixed_endian ? GUINT16_TO_LE(tmp) : GUINT16_TO_BE(tmp); /* nocheck:blocked */
-	if (!g_ascii_string_to_unsigned(split[3], 16, 0, 0xffff, &tmp, error))
-		return FALSE;
-	gu.d = GUINT16_TO_BE(tmp); /* nocheck:blocked */
-	for (guint i = 0; i < 6; i++) {
-		gchar buffer[3] = {0x0};
-		memcpy(buffer, split[4] + (i * 2), 2); /* nocheck:blocked */
-		if (!g_ascii_string_to_unsigned(buffer, 16, 0, 0xff, &tmp, error))
+	/* parse as big endian */
+	for (guint i = 0; i < 36; i += 2) {
+		gint hi;
+		gint lo;
+		if (i == 8 || i == 13 || i == 18 || i == 23)
+			i++;
+		hi = g_ascii_xdigit_value(guidstr[i]);
+		lo = g_ascii_xdigit_value(guidstr[i + 1]);
+		if (hi < 0 || lo < 0) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_DATA,
+					    "GUID is not valid format, not GUID");
 			return FALSE;
-		gu.e[i] = tmp;
+		}
+		buf[j++] = (hi << 4) | lo;
+	}
+
+	/* mixed is bizaar, but specified as the DCE encoding */
+	if (mixed_endian) {
+		fwupd_guid_native_t gu = {0x0};
+		memcpy(&gu, buf, sizeof(gu)); /* nocheck:blocked */
+		gu.a = GUINT32_SWAP_LE_BE(gu.a);
+		gu.b = GUINT16_SWAP_LE_BE(gu.b);
+		gu.c = GUINT16_SWAP_LE_BE(gu.c);
+		memcpy(buf, &gu, sizeof(gu)); /* nocheck:blocked */
 	}
 	if (guid != NULL)
-		memcpy(guid, &gu, sizeof(gu)); /* nocheck:blocked */
+		memcpy(guid, buf, sizeof(buf)); /* nocheck:blocked */
 
 	/* success */
 	return TRUE;
@@ -35,7 +35,9 @@ typedef struct {
 	guint64 flags;
 	guint64 request_flags;
 	guint64 problems;
-	GPtrArray *guids;	 /* (nullable) (element-type utf-8) */
+	GArray *guids;		 /* (nullable) (element-type fwupd_guid_t) */
+	GHashTable *guids_set;	 /* (nullable) (element-type fwupd_guid_t) */
+	GPtrArray *guids_str;	 /* (nullable) (element-type utf-8), formatted on demand */
 	GPtrArray *vendor_ids;	 /* (nullable) (element-type utf-8) */
 	GPtrArray *protocols;	 /* (nullable) (element-type utf-8) */
 	GPtrArray *instance_ids; /* (nullable) (element-type utf-8) */
@@ -85,6 +87,7 @@ enum {
 	PROP_BATTERY_LEVEL,
 	PROP_BATTERY_THRESHOLD,
 	PROP_PROBLEMS,
+	PROP_GUIDS,
 	PROP_LAST
 };
 
@@ -696,12 +699,48 @@ fwupd_device_remove_children(FwupdDevice *self)
 	g_ptr_array_set_size(priv->children, 0);
 }
 
+static guint
+fwupd_device_guid_hash(gconstpointer key)
+{
+	const guint8 *buf = (const guint8 *)key;
+	guint hash = 5381;
+	for (gsize i = 0; i < sizeof(fwupd_guid_t); i++)
+		hash = (hash << 5) + hash + buf[i];
+	return hash;
+}
+
+static gboolean
+fwupd_device_guid_equal(gconstpointer a, gconstpointer b)
+{
+	return memcmp(a, b, sizeof(fwupd_guid_t)) == 0;
+}
+
 static void
-fwupd_device_ensure_guids(FwupdDevice *self)
+fwupd_device_remove_guids(FwupdDevice *self)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
-	if (priv->guids == NULL)
-		priv->guids = g_ptr_array_new_with_free_func(g_free);
+
+	if (priv->guids == NULL || priv->guids->len == 0)
+		return;
+	g_array_set_size(priv->guids, 0);
+	g_hash_table_remove_all(priv->guids_set);
+	if (priv->guids_str != NULL)
+		g_ptr_array_set_size(priv->guids_str, 0);
+	g_object_notify(G_OBJECT(self), "guids");
+}
+
+/* only appended to, so that strings already returned to the caller stay valid */
+static GPtrArray *
+fwupd_device_ensure_guids_str(FwupdDevice *self)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE(self);
+	if (priv->guids_str == NULL)
+		priv->guids_str = g_ptr_array_new_with_free_func(g_free);
+	for (guint i = priv->guids_str->len; priv->guids != NULL && i < priv->guids->len; i++) {
+		const fwupd_guid_t *guid = &g_array_index(priv->guids, fwupd_guid_t, i);
+		g_ptr_array_add(priv->guids_str, fwupd_guid_to_string(guid, FWUPD_GUID_FLAG_NONE));
+	}
+	return priv->guids_str;
 }
 
 /**
@@ -710,6 +749,9 @@ fwupd_device_ensure_guids(FwupdDevice *self)
  *
  * Gets the GUIDs.
  *
+ * The GUIDs are stored in binary form, and are only converted to lowercase strings when
+ * this function is called.
+ *
  * Returns: (element-type utf8) (transfer none): the GUIDs
  *
  * Since: 0.9.3
@@ -717,10 +759,49 @@ fwupd_device_ensure_guids(FwupdDevice *self)
 GPtrArray *
 fwupd_device_get_guids(FwupdDevice *self)
 {
-	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	g_return_val_if_fail(FWUPD_IS_DEVICE(self), NULL);
-	fwupd_device_ensure_guids(self);
-	return priv->guids;
+	return fwupd_device_ensure_guids_str(self);
+}
+
+static gboolean
+fwupd_device_has_guid_bin(FwupdDevice *self, const fwupd_guid_t *guid)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE(self);
+	if (priv->guids_set == NULL)
+		return FALSE;
+	return g_hash_table_contains(priv->guids_set, guid);
+}
+
+/* the array keeps the order the GUIDs were added, and the set is used to find them */
+static void
+fwupd_device_add_guid_bin(FwupdDevice *self, const fwupd_guid_t *guid)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE(self);
+	if (fwupd_device_has_guid_bin(self, guid))
+		return;
+	if (priv->guids == NULL) {
+		priv->guids = g_array_new(FALSE, FALSE, sizeof(fwupd_guid_t));
+		priv->guids_set = g_hash_table_new_full(fwupd_device_guid_hash,
+							fwupd_device_guid_equal,
+							g_free,
+							NULL);
+	}
+	g_array_append_vals(priv->guids, guid, 1);
+	g_hash_table_add(priv->guids_set, g_memdup2(guid, sizeof(fwupd_guid_t)));
+	g_object_notify(G_OBJECT(self), "guids");
+}
+
+/* strings that are not GUIDs are converted in the same way as instance IDs */
+static void
+fwupd_device_guid_from_string(const gchar *guid, fwupd_guid_t *guid_bin)
+{
+	g_autofree gchar *guid_tmp = NULL;
+
+	if (fwupd_guid_from_string(guid, guid_bin, FWUPD_GUID_FLAG_NONE, NULL))
+		return;
+	guid_tmp = fwupd_guid_hash_string(guid);
+	if (!fwupd_guid_from_string(guid_tmp, guid_bin, FWUPD_GUID_FLAG_NONE, NULL))
+		g_critical("failed to convert %s", guid_tmp);
 }
 
 /**
@@ -737,19 +818,14 @@ fwupd_device_get_guids(FwupdDevice *self)
 gboolean
 fwupd_device_has_guid(FwupdDevice *self, const gchar *guid)
 {
-	FwupdDevicePrivate *priv = GET_PRIVATE(self);
+	fwupd_guid_t guid_bin = {0x0};
 
 	g_return_val_if_fail(FWUPD_IS_DEVICE(self), FALSE);
 	g_return_val_if_fail(guid != NULL, FALSE);
 
-	if (priv->guids == NULL)
-		return FALSE;
-	for (guint i = 0; i < priv->guids->len; i++) {
-		const gchar *guid_tmp = g_ptr_array_index(priv->guids, i);
-		if (g_strcmp0(guid, guid_tmp) == 0)
-			return TRUE;
-	}
-	return FALSE;
+	/* compare the binary form, which is also case insensitive */
+	fwupd_device_guid_from_string(guid, &guid_bin);
+	return fwupd_device_has_guid_bin(self, &guid_bin);
 }
 
 /**
@@ -757,20 +833,30 @@ fwupd_device_has_guid(FwupdDevice *self, const gchar *guid)
  * @self: a #FwupdDevice
  * @guid: the GUID, e.g. `2082b5e0-7a64-478a-b1b2-e3404fab6dad`
  *
- * Adds the GUID if it does not already exist.
+ * Adds the GUID if it does not already exist. Strings that are not valid GUIDs are converted
+ * using fwupd_guid_hash_string().
  *
  * Since: 0.9.3
  **/
 void
 fwupd_device_add_guid(FwupdDevice *self, const gchar *guid)
 {
-	FwupdDevicePrivate *priv = GET_PRIVATE(self);
+	fwupd_guid_t guid_bin = {0x0};
+
 	g_return_if_fail(FWUPD_IS_DEVICE(self));
 	g_return_if_fail(guid != NULL);
-	if (fwupd_device_has_guid(self, guid))
-		return;
-	fwupd_device_ensure_guids(self);
-	g_ptr_array_add(priv->guids, g_strdup(guid));
+
+	fwupd_device_guid_from_string(guid, &guid_bin);
+	fwupd_device_add_guid_bin(self, &guid_bin);
+}
+
+/* used to clear the GUIDs from the daemon */
+static void
+fwupd_device_set_guids(FwupdDevice *self, GPtrArray *guids)
+{
+	fwupd_device_remove_guids(self);
+	for (guint i = 0; guids != NULL && i < guids->len; i++)
+		fwupd_device_add_guid(self, g_ptr_array_index(guids, i));
 }
 
 /**
@@ -790,7 +876,7 @@ fwupd_device_get_guid_default(FwupdDevice *self)
 	g_return_val_if_fail(FWUPD_IS_DEVICE(self), NULL);
 	if (priv->guids == NULL || priv->guids->len == 0)
 		return NULL;
-	return g_ptr_array_index(priv->guids, 0);
+	return g_ptr_array_index(fwupd_device_ensure_guids_str(self), 0);
 }
 
 static void
@@ -2047,8 +2133,8 @@ fwupd_device_incorporate(FwupdDevice *self, FwupdDevice *donor)
 		fwupd_device_set_version_bootloader_raw(self, priv_donor->version_bootloader_raw);
 	if (priv_donor->guids != NULL) {
 		for (guint i = 0; i < priv_donor->guids->len; i++) {
-			const gchar *tmp = g_ptr_array_index(priv_donor->guids, i);
-			fwupd_device_add_guid(self, tmp);
+			fwupd_guid_t *guid = &g_array_index(priv_donor->guids, fwupd_guid_t, i);
+			fwupd_device_add_guid_bin(self, guid);
 		}
 	}
 	if (priv_donor->instance_ids != NULL) {
@@ -2102,11 +2188,12 @@ fwupd_device_add_variant(FwupdCodec *codec, GVariantBuilder *builder, FwupdCodec
 				      g_variant_new_string(priv->composite_id));
 	}
 	if (priv->guids != NULL && priv->guids->len > 0) {
-		const gchar *const *tmp = (const gchar *const *)priv->guids->pdata;
+		GPtrArray *guids = fwupd_device_ensure_guids_str(self);
+		const gchar *const *tmp = (const gchar *const *)guids->pdata;
 		g_variant_builder_add(builder,
 				      "{sv}",
 				      FWUPD_RESULT_KEY_GUID,
-				      g_variant_new_strv(tmp, priv->guids->len));
+				      g_variant_new_strv(tmp, guids->len));
 	}
 	if (priv->icons != NULL && priv->icons->len > 0) {
 		const gchar *const *tmp = (const gchar *const *)priv->icons->pdata;
@@ -2953,10 +3040,11 @@ fwupd_device_add_json(FwupdCodec *codec, JsonBuilder *builder, FwupdCodecFlags f
 		json_builder_end_array(builder);
 	}
 	if (priv->guids != NULL && priv->guids->len > 0) {
+		GPtrArray *guids = fwupd_device_ensure_guids_str(self);
 		json_builder_set_member_name(builder, FWUPD_RESULT_KEY_GUID);
 		json_builder_begin_array(builder);
-		for (guint i = 0; i < priv->guids->len; i++) {
-			const gchar *guid = g_ptr_array_index(priv->guids, i);
+		for (guint i = 0; i < guids->len; i++) {
+			const gchar *guid = g_ptr_array_index(guids, i);
 			json_builder_add_string_value(builder, guid);
 		}
 		json_builder_end_array(builder);
@@ -3449,8 +3537,9 @@ fwupd_device_add_string(FwupdCodec *codec, guint idt, GString *str)
 		}
 	}
 	if (priv->guids != NULL) {
-		for (guint i = 0; i < priv->guids->len; i++) {
-			const gchar *guid = g_ptr_array_index(priv->guids, i);
+		GPtrArray *guids = fwupd_device_ensure_guids_str(self);
+		for (guint i = 0; i < guids->len; i++) {
+			const gchar *guid = g_ptr_array_index(guids, i);
 			if (fwupd_device_guid_helper_array_find(guid_helpers, guid) == NULL) {
 				FwupdDeviceGuidHelper *helper = g_new0(FwupdDeviceGuidHelper, 1);
 				helper->guid = g_strdup(guid);
@@ -3633,6 +3722,9 @@ fwupd_device_get_property(GObject *object, guint prop_id, GValue *value, GParamS
 	case PROP_BATTERY_THRESHOLD:
 		g_value_set_uint(value, priv->battery_threshold);
 		break;
+	case PROP_GUIDS:
+		g_value_set_boxed(value, fwupd_device_ensure_guids_str(self));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
 		break;
@@ -3683,6 +3775,9 @@ fwupd_device_set_property(GObject *object, guint prop_id, const GValue *value, G
 	case PROP_BATTERY_THRESHOLD:
 		fwupd_device_set_battery_threshold(self, g_value_get_uint(value));
 		break;
+	case PROP_GUIDS:
+		fwupd_device_set_guids(self, g_value_get_boxed(value));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
 		break;
@@ -3895,6 +3990,22 @@ fwupd_device_class_init(FwupdDeviceClass *klass)
 				  FWUPD_BATTERY_LEVEL_INVALID,
 				  G_PARAM_READWRITE | G_PARAM_STATIC_NAME);
 	g_object_class_install_property(object_class, PROP_BATTERY_THRESHOLD, pspec);
+
+	/**
+	 * FwupdDevice:guids:
+	 *
+	 * The device GUIDs, notified when a GUID is added or removed.
+	 *
+	 * Setting this replaces all the GUIDs, where %NULL removes them.
+	 *
+	 * Since: 2.0.9
+	 */
+	pspec = g_param_spec_boxed("guids",
+				   NULL,
+				   NULL,
+				   G_TYPE_PTR_ARRAY,
+				   G_PARAM_READWRITE | G_PARAM_STATIC_NAME);
+	g_object_class_install_property(object_class, PROP_GUIDS, pspec);
 }
 
 static void
@@ -3934,7 +4045,11 @@ fwupd_device_finalize(GObject *object)
 	g_free(priv->version_lowest);
 	g_free(priv->version_bootloader);
 	if (priv->guids != NULL)
-		g_ptr_array_unref(priv->guids);
+		g_array_unref(priv->guids);
+	if (priv->guids_set != NULL)
+		g_hash_table_unref(priv->guids_set);
+	if (priv->guids_str != NULL)
+		g_ptr_array_unref(priv->guids_str);
 	if (priv->vendor_ids != NULL)
 		g_ptr_array_unref(priv->vendor_ids);
 	if (priv->protocols != NULL)
@@ -1122,6 +1122,15 @@ typedef enum {
 	 * Since: 1.9.21
 	 */
 	FWUPD_INSTALL_FLAG_IGNORE_REQUIREMENTS = 1 << 9,
+	/**
+	 * FWUPD_INSTALL_FLAG_PARALLEL:
+	 *
+	 * Install firmware on devices that do not share a parent, proxy or composite device at the
+	 * same time.
+	 *
+	 * Since: 2.0.9
+	 */
+	FWUPD_INSTALL_FLAG_PARALLEL = 1 << 10,
 	/*< private >*/
 	FWUPD_INSTALL_FLAG_UNKNOWN = G_MAXUINT64,
 } FwupdInstallFlags;
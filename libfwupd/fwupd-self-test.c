@@ -128,7 +128,7 @@ fwupd_enums_func(void)
 			break;
 		g_assert_cmpint(fwupd_remote_flag_from_string(tmp), ==, i);
 	}
-	for (guint64 i = 1; i <= FWUPD_INSTALL_FLAG_IGNORE_REQUIREMENTS; i *= 2) {
+	for (guint64 i = 1; i <= FWUPD_INSTALL_FLAG_PARALLEL; i *= 2) {
 		const gchar *tmp = fwupd_install_flags_to_string(i);
 		if (tmp == NULL)
 			continue;
@@ -470,6 +470,35 @@ fwupd_request_func(void)
 			"950da62d4c753a26e64f7f7d687104ce38e32ca5");
 }
 
+static void
+fwupd_device_guids_func(void)
+{
+	g_autofree gchar *guid = fwupd_guid_hash_string("foo");
+	g_autoptr(FwupdDevice) dev = fwupd_device_new();
+
+	/* not a GUID, so converted */
+	fwupd_device_add_guid(dev, "foo");
+	g_assert_true(fwupd_device_has_guid(dev, "foo"));
+	g_assert_true(fwupd_device_has_guid(dev, guid));
+	g_assert_cmpstr(fwupd_device_get_guid_default(dev), ==, guid);
+
+	/* many GUIDs */
+	for (guint i = 0; i < 100; i++) {
+		g_autofree gchar *instance_id = g_strdup_printf("USB\\VID_1234&PID_%04X", i);
+		fwupd_device_add_guid(dev, instance_id);
+	}
+	fwupd_device_add_guid(dev, guid);
+	g_assert_cmpint(fwupd_device_get_guids(dev)->len, ==, 101);
+	g_assert_true(fwupd_device_has_guid(dev, "USB\\VID_1234&PID_0063"));
+	g_assert_false(fwupd_device_has_guid(dev, "USB\\VID_1234&PID_0064"));
+
+	/* cleared by the daemon */
+	g_object_set(dev, "guids", NULL, NULL);
+	g_assert_cmpint(fwupd_device_get_guids(dev)->len, ==, 0);
+	g_assert_false(fwupd_device_has_guid(dev, guid));
+	g_assert_null(fwupd_device_get_guid_default(dev));
+}
+
 static void
 fwupd_device_filter_func(void)
 {
@@ -802,6 +831,15 @@ fwupd_device_func(void)
 	fwupd_device_set_branch(dev, "community");
 	fwupd_device_add_guid(dev, "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
 	fwupd_device_add_guid(dev, "00000000-0000-0000-0000-000000000000");
+	fwupd_device_add_guid(dev, "2082B5E0-7A64-478A-B1B2-E3404FAB6DAD");
+	g_assert_cmpint(fwupd_device_get_guids(dev)->len, ==, 2);
+	g_assert_true(fwupd_device_has_guid(dev, "2082b5e0-7a64-478a-b1b2-e3404fab6dad"));
+	g_assert_true(fwupd_device_has_guid(dev, "2082B5E0-7A64-478A-B1B2-E3404FAB6DAD"));
+	g_assert_false(fwupd_device_has_guid(dev, "2082b5e0-7a64-478a-b1b2-e3404fab6dae"));
+	g_assert_false(fwupd_device_has_guid(dev, "foo"));
+	g_assert_cmpstr(fwupd_device_get_guid_default(dev),
+			==,
+			"2082b5e0-7a64-478a-b1b2-e3404fab6dad");
 	fwupd_device_add_instance_id(dev, "USB\\VID_1234&PID_0001");
 	fwupd_device_add_icon(dev, "input-gaming");
 	fwupd_device_add_icon(dev, "input-mouse");
@@ -1452,6 +1490,270 @@ fwupd_bios_settings_func(void)
 	g_assert_true(ret);
 }
 
+#define FWUPD_SELF_TEST_DOWNLOAD_SIZE	 0x10000
+#define FWUPD_SELF_TEST_DOWNLOAD_PARTIAL 0x4000
+
+typedef struct {
+	guint8 *buf;
+	gint range_offset;
+	gchar *checksum;
+	GError *error;
+	GMainLoop *loop;
+} FwupdSelfTestHttpHelper;
+
+/* a HTTP server that drops the first connection part of the way through */
+static gboolean
+fwupd_self_test_http_run_cb(GThreadedSocketService *service,
+			    GSocketConnection *connection,
+			    GObject *source_object,
+			    gpointer user_data)
+{
+	FwupdSelfTestHttpHelper *helper = (FwupdSelfTestHttpHelper *)user_data;
+	GOutputStream *ostream = g_io_stream_get_output_stream(G_IO_STREAM(connection));
+	gsize offset = 0;
+	g_autofree gchar *header = NULL;
+	g_autoptr(GDataInputStream) istream = NULL;
+
+	istream = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+	g_data_input_stream_set_newline_type(istream, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+	while (TRUE) {
+		g_autofree gchar *line = g_data_input_stream_read_line(istream, NULL, NULL, NULL);
+		if (line == NULL || line[0] == '\0')
+			break;
+		if (g_ascii_strncasecmp(line, "Range: bytes=", 13) == 0) {
+			offset = g_ascii_strtoull(line + 13, NULL, 10);
+			g_atomic_int_set(&helper->range_offset, (gint)offset);
+		}
+	}
+	if (offset == 0) {
+		header = g_strdup_printf("HTTP/1.1 200 OK\r\n"
+					 "Content-Length: %u\r\n"
+					 "Accept-Ranges: bytes\r\n"
+					 "Connection: close\r\n\r\n",
+					 (guint)FWUPD_SELF_TEST_DOWNLOAD_SIZE);
+		(void)g_output_stream_write_all(ostream, header, strlen(header), NULL, NULL, NULL);
+		(void)g_output_stream_write_all(ostream,
+						helper->buf,
+						FWUPD_SELF_TEST_DOWNLOAD_PARTIAL,
+						NULL,
+						NULL,
+						NULL);
+	} else {
+		header = g_strdup_printf("HTTP/1.1 206 Partial Content\r\n"
+					 "Content-Range: bytes %u-%u/%u\r\n"
+					 "Content-Length: %u\r\n"
+					 "Connection: close\r\n\r\n",
+					 (guint)offset,
+					 (guint)FWUPD_SELF_TEST_DOWNLOAD_SIZE - 1,
+					 (guint)FWUPD_SELF_TEST_DOWNLOAD_SIZE,
+					 (guint)(FWUPD_SELF_TEST_DOWNLOAD_SIZE - offset));
+		(void)g_output_stream_write_all(ostream, header, strlen(header), NULL, NULL, NULL);
+		(void)g_output_stream_write_all(ostream,
+						helper->buf + offset,
+						FWUPD_SELF_TEST_DOWNLOAD_SIZE - offset,
+						NULL,
+						NULL,
+						NULL);
+	}
+	(void)g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
+	return TRUE;
+}
+
+static void
+fwupd_client_download_file_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdSelfTestHttpHelper *helper = (FwupdSelfTestHttpHelper *)user_data;
+	helper->checksum =
+	    fwupd_client_download_file_finish(FWUPD_CLIENT(source), res, &helper->error);
+	g_main_loop_quit(helper->loop);
+}
+
+static void
+fwupd_client_download_file_func(void)
+{
+	gboolean ret;
+	guint16 port;
+	FwupdSelfTestHttpHelper helper = {NULL};
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *data = NULL;
+	g_autofree gchar *fn = NULL;
+	g_autofree gchar *url = NULL;
+	g_autoptr(FwupdClient) client = fwupd_client_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GSocketService) service = g_threaded_socket_service_new(1);
+	gsize datasz = 0;
+
+	/* serve some data from localhost */
+	helper.loop = g_main_loop_new(NULL, FALSE);
+	helper.buf = g_malloc0(FWUPD_SELF_TEST_DOWNLOAD_SIZE);
+	for (guint i = 0; i < FWUPD_SELF_TEST_DOWNLOAD_SIZE; i++)
+		helper.buf[i] = (guint8)(i * 7);
+	port = g_socket_listener_add_any_inet_port(G_SOCKET_LISTENER(service), NULL, &error);
+	g_assert_no_error(error);
+	g_assert_cmpint(port, !=, 0);
+	g_signal_connect(service, "run", G_CALLBACK(fwupd_self_test_http_run_cb), &helper);
+	g_socket_service_start(service);
+
+	/* the first attempt fails part of the way through, the retry resumes */
+	fwupd_client_set_user_agent_for_package(client, "fwupd", "2.0.0");
+	fwupd_client_download_set_retries(client, 1);
+	url = g_strdup_printf("http://localhost:%u/firmware.cab", port);
+	fn = g_build_filename(g_get_tmp_dir(), "fwupd-self-test-download.cab", NULL);
+	file = g_file_new_for_path(fn);
+	fwupd_client_download_file_async(client,
+					 url,
+					 file,
+					 FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+					 NULL,
+					 fwupd_client_download_file_cb,
+					 &helper);
+	g_main_loop_run(helper.loop);
+	g_socket_service_stop(service);
+	g_socket_listener_close(G_SOCKET_LISTENER(service));
+	g_assert_no_error(helper.error);
+	g_assert_nonnull(helper.checksum);
+	g_assert_cmpint(g_atomic_int_get(&helper.range_offset),
+			==,
+			FWUPD_SELF_TEST_DOWNLOAD_PARTIAL);
+
+	/* the file has everything, in the right order */
+	ret = g_file_get_contents(fn, &data, &datasz, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(datasz, ==, FWUPD_SELF_TEST_DOWNLOAD_SIZE);
+	g_assert_cmpint(memcmp(data, helper.buf, datasz), ==, 0);
+	checksum = g_compute_checksum_for_data(G_CHECKSUM_SHA256, helper.buf, datasz);
+	g_assert_cmpstr(helper.checksum, ==, checksum);
+	ret = g_file_delete(file, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_main_loop_unref(helper.loop);
+	g_free(helper.checksum);
+	g_free(helper.buf);
+}
+
+/* a HTTP server that only sends the data if the ETag does not match */
+static gboolean
+fwupd_self_test_http_conditional_run_cb(GThreadedSocketService *service,
+					GSocketConnection *connection,
+					GObject *source_object,
+					gpointer user_data)
+{
+	GOutputStream *ostream = g_io_stream_get_output_stream(G_IO_STREAM(connection));
+	gboolean not_modified = FALSE;
+	const gchar *response;
+	g_autoptr(GDataInputStream) istream = NULL;
+
+	istream = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+	g_data_input_stream_set_newline_type(istream, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+	while (TRUE) {
+		g_autofree gchar *line = g_data_input_stream_read_line(istream, NULL, NULL, NULL);
+		if (line == NULL || line[0] == '\0')
+			break;
+		if (g_strcmp0(line, "If-None-Match: \"abc\"") == 0)
+			not_modified = TRUE;
+	}
+	if (not_modified) {
+		response = "HTTP/1.1 304 Not Modified\r\n"
+			   "ETag: \"abc\"\r\n"
+			   "Connection: close\r\n\r\n";
+	} else {
+		response = "HTTP/1.1 200 OK\r\n"
+			   "ETag: \"abc\"\r\n"
+			   "Last-Modified: Wed, 21 Oct 2015 07:28:00 GMT\r\n"
+			   "Content-Length: 5\r\n"
+			   "Connection: close\r\n\r\n"
+			   "hello";
+	}
+	(void)g_output_stream_write_all(ostream, response, strlen(response), NULL, NULL, NULL);
+	(void)g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
+	return TRUE;
+}
+
+typedef struct {
+	GBytes *blob;
+	gchar *etag;
+	gchar *last_modified;
+	GError *error;
+	GMainLoop *loop;
+} FwupdSelfTestConditionalHelper;
+
+static void
+fwupd_client_download_conditional_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdSelfTestConditionalHelper *helper = (FwupdSelfTestConditionalHelper *)user_data;
+	helper->blob = fwupd_client_download_bytes_conditional_finish(FWUPD_CLIENT(source),
+								      res,
+								      &helper->etag,
+								      &helper->last_modified,
+								      &helper->error);
+	g_main_loop_quit(helper->loop);
+}
+
+static void
+fwupd_client_download_conditional_func(void)
+{
+	guint16 port;
+	FwupdSelfTestConditionalHelper helper = {NULL};
+	g_autofree gchar *etag = NULL;
+	g_autofree gchar *url = NULL;
+	g_autoptr(FwupdClient) client = fwupd_client_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GSocketService) service = g_threaded_socket_service_new(1);
+
+	port = g_socket_listener_add_any_inet_port(G_SOCKET_LISTENER(service), NULL, &error);
+	g_assert_no_error(error);
+	g_assert_cmpint(port, !=, 0);
+	g_signal_connect(service,
+			 "run",
+			 G_CALLBACK(fwupd_self_test_http_conditional_run_cb),
+			 NULL);
+	g_socket_service_start(service);
+	fwupd_client_set_user_agent_for_package(client, "fwupd", "2.0.0");
+	url = g_strdup_printf("http://localhost:%u/firmware.xml.gz.jcat", port);
+	helper.loop = g_main_loop_new(NULL, FALSE);
+
+	/* first time, so no validators */
+	fwupd_client_download_bytes_conditional_async(client,
+						      url,
+						      FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+						      NULL,
+						      NULL,
+						      NULL,
+						      fwupd_client_download_conditional_cb,
+						      &helper);
+	g_main_loop_run(helper.loop);
+	g_assert_no_error(helper.error);
+	g_assert_nonnull(helper.blob);
+	g_assert_cmpint(g_bytes_get_size(helper.blob), ==, 5);
+	g_assert_cmpstr(helper.etag, ==, "\"abc\"");
+	g_assert_cmpstr(helper.last_modified, ==, "Wed, 21 Oct 2015 07:28:00 GMT");
+	g_clear_pointer(&helper.blob, g_bytes_unref);
+	g_clear_pointer(&helper.last_modified, g_free);
+	etag = g_steal_pointer(&helper.etag);
+
+	/* nothing changed */
+	fwupd_client_download_bytes_conditional_async(client,
+						      url,
+						      FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+						      etag,
+						      NULL,
+						      NULL,
+						      fwupd_client_download_conditional_cb,
+						      &helper);
+	g_main_loop_run(helper.loop);
+	g_socket_service_stop(service);
+	g_socket_listener_close(G_SOCKET_LISTENER(service));
+	g_assert_error(helper.error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO);
+	g_assert_null(helper.blob);
+
+	g_clear_error(&helper.error);
+	g_free(helper.etag);
+	g_free(helper.last_modified);
+	g_main_loop_unref(helper.loop);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1483,9 +1785,13 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/request", fwupd_request_func);
 	g_test_add_func("/fwupd/device", fwupd_device_func);
 	g_test_add_func("/fwupd/device{filter}", fwupd_device_filter_func);
+	g_test_add_func("/fwupd/device{guids}", fwupd_device_guids_func);
 	g_test_add_func("/fwupd/security-attr", fwupd_security_attr_func);
 	g_test_add_func("/fwupd/bios-attrs", fwupd_bios_settings_func);
 	g_test_add_func("/fwupd/client_api", fwupd_client_api);
+	g_test_add_func("/fwupd/client{download-file}", fwupd_client_download_file_func);
+	g_test_add_func("/fwupd/client{download-conditional}",
+			fwupd_client_download_conditional_func);
 	if (g_test_undefined()) {
 		g_test_add_func("/fwupd/client_api{undefined_setter}",
 				fwupd_client_api_undefined_setter);
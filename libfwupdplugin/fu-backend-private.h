@@ -10,3 +10,6 @@
 
 gchar *
 fu_backend_get_emulation_array_member_name(FuBackend *self);
+void
+fu_backend_set_emulation_events(FuBackend *self, GHashTable *emulation_events)
+    G_GNUC_NON_NULL(1);
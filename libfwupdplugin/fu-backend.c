@@ -27,7 +27,8 @@ typedef struct {
 	gboolean done_setup;
 	gboolean can_invalidate;
 	GType device_gtype;
-	GHashTable *devices; /* device_id : * FuDevice */
+	GHashTable *devices;	      /* device_id : * FuDevice */
+	GHashTable *emulation_events; /* (nullable) backend_id : member : GPtrArray */
 	GThread *thread_init;
 } FuBackendPrivate;
 
@@ -360,6 +361,31 @@ fu_backend_setup(FuBackend *self, FuBackendSetupFlags flags, FuProgress *progres
 	return TRUE;
 }
 
+/**
+ * fu_backend_set_emulation_events:
+ * @self: a #FuBackend
+ * @emulation_events: (nullable): a hash table of backend ID to a hash table of JSON member name,
+ * e.g. `UsbEvents`, to a #GPtrArray of #FuDeviceEvent
+ *
+ * Sets the events to add to each emulated device created when loading from JSON, which is used
+ * when the events are not stored in the JSON itself. Only the events from the JSON member that
+ * the device would have loaded are added.
+ *
+ * Since: 2.0.9
+ **/
+void
+fu_backend_set_emulation_events(FuBackend *self, GHashTable *emulation_events)
+{
+	FuBackendPrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FU_IS_BACKEND(self));
+	if (priv->emulation_events != NULL) {
+		g_hash_table_unref(priv->emulation_events);
+		priv->emulation_events = NULL;
+	}
+	if (emulation_events != NULL)
+		priv->emulation_events = g_hash_table_ref(emulation_events);
+}
+
 static gboolean
 fu_backend_from_json(FwupdCodec *codec, JsonNode *json_node, GError **error)
 {
@@ -454,6 +480,22 @@ fu_backend_from_json(FwupdCodec *codec, JsonNode *json_node, GError **error)
 			return FALSE;
 		}
 
+		/* the events were stored outside of the JSON, e.g. in the binary emulation format */
+		if (priv->emulation_events != NULL) {
+			const gchar *backend_id = fu_device_get_backend_id(device_tmp);
+			const gchar *member = fu_device_get_events_member(device_tmp);
+			GHashTable *members = NULL;
+			GPtrArray *events = NULL;
+			if (backend_id != NULL)
+				members = g_hash_table_lookup(priv->emulation_events, backend_id);
+			if (members != NULL)
+				events = g_hash_table_lookup(members, member);
+			for (guint j = 0; events != NULL && j < events->len; j++) {
+				FuDeviceEvent *event = g_ptr_array_index(events, j);
+				fu_device_add_event(device_tmp, event);
+			}
+		}
+
 		/* does a device with this platform ID [and the same created date] already exist */
 		device_old = fu_backend_lookup_by_id(self, fu_device_get_backend_id(device_tmp));
 
@@ -782,6 +824,8 @@ fu_backend_finalize(GObject *object)
 	FuBackendPrivate *priv = GET_PRIVATE(self);
 	g_free(priv->name);
 	g_hash_table_unref(priv->devices);
+	if (priv->emulation_events != NULL)
+		g_hash_table_unref(priv->emulation_events);
 	G_OBJECT_CLASS(fu_backend_parent_class)->finalize(object);
 }
 
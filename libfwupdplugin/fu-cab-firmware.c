@@ -13,19 +13,21 @@
 #include "fu-byte-array.h"
 #include "fu-bytes.h"
 #include "fu-cab-firmware-private.h"
+#include "fu-cab-folder-input-stream.h"
 #include "fu-cab-image.h"
 #include "fu-cab-struct.h"
 #include "fu-chunk-array.h"
 #include "fu-common.h"
 #include "fu-composite-input-stream.h"
 #include "fu-input-stream.h"
-#include "fu-mem-private.h"
+#include "fu-mapped-input-stream.h"
 #include "fu-partial-input-stream.h"
 #include "fu-string.h"
 
 typedef struct {
 	gboolean compressed;
 	gboolean only_basename;
+	gboolean lazy_decompress;
 } FuCabFirmwarePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE(FuCabFirmware, fu_cab_firmware, FU_TYPE_FIRMWARE)
@@ -34,7 +36,7 @@ G_DEFINE_TYPE_WITH_PRIVATE(FuCabFirmware, fu_cab_firmware, FU_TYPE_FIRMWARE)
 #define FU_CAB_FIRMWARE_MAX_FILES   1024
 #define FU_CAB_FIRMWARE_MAX_FOLDERS 64
 
-#define FU_CAB_FIRMWARE_DECOMPRESS_BUFSZ 0x4000 /* bytes */
+#define FU_CAB_FIRMWARE_CHECKSUM_BATCHSZ 0x2000000 /* bytes */
 
 /**
  * fu_cab_firmware_get_compressed:
@@ -106,33 +108,121 @@ fu_cab_firmware_set_only_basename(FuCabFirmware *self, gboolean only_basename)
 	priv->only_basename = only_basename;
 }
 
+/**
+ * fu_cab_firmware_get_lazy_decompress:
+ * @self: a #FuCabFirmware
+ *
+ * Gets if compressed data is only inflated when the image stream is read.
+ *
+ * Returns: boolean
+ *
+ * Since: 2.0.9
+ **/
+gboolean
+fu_cab_firmware_get_lazy_decompress(FuCabFirmware *self)
+{
+	FuCabFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_CAB_FIRMWARE(self), FALSE);
+	return priv->lazy_decompress;
+}
+
+/**
+ * fu_cab_firmware_set_lazy_decompress:
+ * @self: a #FuCabFirmware
+ * @lazy_decompress: boolean
+ *
+ * Sets if compressed data should only be inflated when the image stream is read, rather than all
+ * at once when the archive is parsed.
+ *
+ * This uses much less memory for large archives, but the parsed stream must remain valid for the
+ * lifetime of the images, and reading the images out of order is slower as each folder has to be
+ * inflated from the start.
+ *
+ * Since: 2.0.9
+ **/
+void
+fu_cab_firmware_set_lazy_decompress(FuCabFirmware *self, gboolean lazy_decompress)
+{
+	FuCabFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FU_IS_CAB_FIRMWARE(self));
+	priv->lazy_decompress = lazy_decompress;
+}
+
+typedef struct {
+	gsize offset;	   /* of the CFDATA header */
+	gsize data_offset; /* of the data, after the CFDATA header */
+	guint16 comp;
+	guint16 uncomp;
+	guint32 checksum;
+} FuCabFirmwareBlock;
+
+typedef struct {
+	FuCabCompression compression;
+	GArray *blocks;		   /* of FuCabFirmwareBlock */
+	GInputStream *folder_data; /* nullable */
+	GBytes *blob;		   /* nullable, compressed data for all the blocks */
+	GError *error;
+} FuCabFirmwareFolder;
+
 typedef struct {
 	GInputStream *stream;
+	gsize streamsz;
 	FuFirmwareParseFlags parse_flags;
 	gsize rsvd_folder;
 	gsize rsvd_block;
 	gsize size_total;
-	FuCabCompression compression;
-	GPtrArray *folder_data; /* of FuCompositeInputStream */
-	z_stream zstrm;
-	guint8 *decompress_buf;
-	gsize decompress_bufsz;
+	GPtrArray *folders; /* of FuCabFirmwareFolder */
 	gsize ndatabsz;
 } FuCabFirmwareParseHelper;
 
+typedef struct {
+	FuCabFirmwareBlock *block; /* no-ref */
+	GBytes *blob;
+	GError *error;
+} FuCabFirmwareChecksumHelper;
+
+static FuCabFirmwareFolder *
+fu_cab_firmware_folder_new(void)
+{
+	FuCabFirmwareFolder *folder = g_new0(FuCabFirmwareFolder, 1);
+	folder->blocks = g_array_new(FALSE, FALSE, sizeof(FuCabFirmwareBlock));
+	return folder;
+}
+
+static void
+fu_cab_firmware_folder_free(FuCabFirmwareFolder *folder)
+{
+	g_array_unref(folder->blocks);
+	if (folder->folder_data != NULL)
+		g_object_unref(folder->folder_data);
+	if (folder->blob != NULL)
+		g_bytes_unref(folder->blob);
+	if (folder->error != NULL)
+		g_error_free(folder->error);
+	g_free(folder);
+}
+
 static void
 fu_cab_firmware_parse_helper_free(FuCabFirmwareParseHelper *helper)
 {
-	inflateEnd(&helper->zstrm);
 	if (helper->stream != NULL)
 		g_object_unref(helper->stream);
-	if (helper->folder_data != NULL)
-		g_ptr_array_unref(helper->folder_data);
-	g_free(helper->decompress_buf);
+	if (helper->folders != NULL)
+		g_ptr_array_unref(helper->folders);
+	g_free(helper);
+}
+
+static void
+fu_cab_firmware_checksum_helper_free(FuCabFirmwareChecksumHelper *helper)
+{
+	g_bytes_unref(helper->blob);
+	if (helper->error != NULL)
+		g_error_free(helper->error);
 	g_free(helper);
 }
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuCabFirmwareParseHelper, fu_cab_firmware_parse_helper_free)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuCabFirmwareFolder, fu_cab_firmware_folder_free)
 
 /* compute the MS cabinet checksum */
 gboolean
@@ -161,16 +251,6 @@ fu_cab_firmware_compute_checksum(const guint8 *buf, gsize bufsz, guint32 *checks
 	return TRUE;
 }
 
-static gboolean
-fu_cab_firmware_compute_checksum_stream_cb(const guint8 *buf,
-					   gsize bufsz,
-					   gpointer user_data,
-					   GError **error)
-{
-	guint32 *checksum = (guint32 *)user_data;
-	return fu_cab_firmware_compute_checksum(buf, bufsz, checksum, error);
-}
-
 static voidpf
 fu_cab_firmware_zalloc(voidpf opaque, uInt items, uInt size)
 {
@@ -196,33 +276,36 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(z_stream_deflater, fu_cab_firmware_zstream_deflate
 static gboolean
 fu_cab_firmware_parse_data(FuCabFirmware *self,
 			   FuCabFirmwareParseHelper *helper,
+			   FuCabFirmwareFolder *folder,
 			   gsize *offset,
-			   GInputStream *folder_data,
 			   GError **error)
 {
-	gsize blob_comp;
-	gsize blob_uncomp;
-	gsize hdr_sz;
+	FuCabFirmwareBlock block = {.offset = *offset};
 	gsize size_max = fu_firmware_get_size_max(FU_FIRMWARE(self));
-	g_autoptr(FuStructCabData) st = NULL;
-	g_autoptr(GInputStream) partial_stream = NULL;
-
-	/* parse header */
-	st = fu_struct_cab_data_parse_stream(helper->stream, *offset, error);
-	if (st == NULL)
+	guint8 buf[FU_STRUCT_CAB_DATA_SIZE] = {0x0};
+	FuStructCabData st = {0x0};
+
+	/* parse header, there can be thousands of these so avoid allocating */
+	if (!fu_struct_cab_data_parse_stream_view(&st,
+						  helper->stream,
+						  *offset,
+						  buf,
+						  sizeof(buf),
+						  error))
 		return FALSE;
 
 	/* sanity check */
-	blob_comp = fu_struct_cab_data_get_comp(st);
-	blob_uncomp = fu_struct_cab_data_get_uncomp(st);
-	if (helper->compression == FU_CAB_COMPRESSION_NONE && blob_comp != blob_uncomp) {
+	block.comp = fu_struct_cab_data_get_comp(&st);
+	block.uncomp = fu_struct_cab_data_get_uncomp(&st);
+	block.checksum = fu_struct_cab_data_get_checksum(&st);
+	if (folder->compression == FU_CAB_COMPRESSION_NONE && block.comp != block.uncomp) {
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_NOT_SUPPORTED,
 				    "mismatched compressed data");
 		return FALSE;
 	}
-	helper->size_total += blob_uncomp;
+	helper->size_total += block.uncomp;
 	if (size_max > 0 && helper->size_total > size_max) {
 		g_autofree gchar *sz_val = g_format_size(helper->size_total);
 		g_autofree gchar *sz_max = g_format_size(size_max);
@@ -234,131 +317,97 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 			    sz_max);
 		return FALSE;
 	}
-
-	hdr_sz = st->len + helper->rsvd_block;
-
-	/* verify checksum */
-	partial_stream =
-	    fu_partial_input_stream_new(helper->stream, *offset + hdr_sz, blob_comp, error);
-	if (partial_stream == NULL) {
-		g_prefix_error(error, "failed to cut cabinet checksum: ");
+	block.data_offset = *offset + st.len + helper->rsvd_block;
+	if (block.data_offset + block.comp > helper->streamsz) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "CFDATA @0x%x of 0x%x bytes is outside the archive",
+			    (guint)*offset,
+			    (guint)block.comp);
 		return FALSE;
 	}
-	if ((helper->parse_flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) == 0) {
-		guint32 checksum = fu_struct_cab_data_get_checksum(st);
-		if (checksum != 0) {
-			guint32 checksum_actual = 0;
-			g_autoptr(GByteArray) hdr = g_byte_array_new();
+	g_array_append_val(folder->blocks, block);
 
-			if (!fu_input_stream_chunkify(partial_stream,
-						      fu_cab_firmware_compute_checksum_stream_cb,
-						      &checksum_actual,
-						      error))
-				return FALSE;
-			fu_byte_array_append_uint16(hdr, blob_comp, G_LITTLE_ENDIAN);
-			fu_byte_array_append_uint16(hdr, blob_uncomp, G_LITTLE_ENDIAN);
-			if (!fu_cab_firmware_compute_checksum(hdr->data,
-							      hdr->len,
-							      &checksum_actual,
-							      error))
-				return FALSE;
-			if (checksum_actual != checksum) {
-				g_set_error(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_NOT_SUPPORTED,
-					    "invalid checksum at 0x%x, expected 0x%x, got 0x%x",
-					    (guint)*offset,
-					    checksum,
-					    checksum_actual);
+	/* success */
+	*offset = block.data_offset + block.comp;
+	return TRUE;
+}
+
+static FuCabFirmwareBlock *
+fu_cab_firmware_folder_get_block(FuCabFirmwareFolder *folder, guint idx)
+{
+	return &g_array_index(folder->blocks, FuCabFirmwareBlock, idx);
+}
+
+/* the blocks of each folder are contiguous in the archive */
+static gsize
+fu_cab_firmware_folder_get_data_end(FuCabFirmwareFolder *folder, guint idx)
+{
+	FuCabFirmwareBlock *block = fu_cab_firmware_folder_get_block(folder, idx);
+	return block->data_offset + block->comp;
+}
+
+static gboolean
+fu_cab_firmware_folder_ensure_data(FuCabFirmware *self,
+				   FuCabFirmwareParseHelper *helper,
+				   FuCabFirmwareFolder *folder,
+				   GError **error)
+{
+	FuCabFirmwarePrivate *priv = GET_PRIVATE(self);
+	gsize blob_offset = fu_cab_firmware_folder_get_block(folder, 0)->data_offset;
+	gsize blob_end = fu_cab_firmware_folder_get_data_end(folder, folder->blocks->len - 1);
+	g_autoptr(GInputStream) stream = NULL;
+
+	/* not compressed, so just use the archive data directly */
+	if (folder->compression == FU_CAB_COMPRESSION_NONE) {
+		folder->folder_data = fu_composite_input_stream_new();
+		for (guint i = 0; i < folder->blocks->len; i++) {
+			FuCabFirmwareBlock *block = fu_cab_firmware_folder_get_block(folder, i);
+			g_autoptr(GInputStream) partial_stream = NULL;
+			partial_stream = fu_partial_input_stream_new(helper->stream,
+								     block->data_offset,
+								     block->comp,
+								     error);
+			if (partial_stream == NULL) {
+				g_prefix_error(error, "failed to cut cabinet data: ");
 				return FALSE;
 			}
+			fu_composite_input_stream_add_partial_stream(
+			    FU_COMPOSITE_INPUT_STREAM(folder->folder_data),
+			    FU_PARTIAL_INPUT_STREAM(partial_stream));
 		}
+		return TRUE;
 	}
 
-	/* decompress Zlib data after removing *another *header... */
-	if (helper->compression == FU_CAB_COMPRESSION_MSZIP) {
-		int zret;
-		g_autofree gchar *kind = NULL;
-		g_autoptr(GByteArray) buf = g_byte_array_new();
-		g_autoptr(GBytes) bytes_comp = NULL;
-		g_autoptr(GBytes) bytes_uncomp = NULL;
-
-		/* check compressed header */
-		bytes_comp = fu_input_stream_read_bytes(helper->stream,
-							*offset + hdr_sz,
-							blob_comp,
-							NULL,
-							error);
-		if (bytes_comp == NULL)
-			return FALSE;
-		kind = fu_memstrsafe(g_bytes_get_data(bytes_comp, NULL),
-				     g_bytes_get_size(bytes_comp),
-				     0x0,
-				     2,
-				     error);
-		if (kind == NULL)
-			return FALSE;
-		if (g_strcmp0(kind, "CK") != 0) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_SUPPORTED,
-				    "compressed header invalid: %s",
-				    kind);
-			return FALSE;
-		}
-		if (helper->decompress_buf == NULL)
-			helper->decompress_buf = g_malloc0(helper->decompress_bufsz);
-		helper->zstrm.avail_in = g_bytes_get_size(bytes_comp) - 2;
-		helper->zstrm.next_in = (z_const Bytef *)g_bytes_get_data(bytes_comp, NULL) + 2;
-		while (1) {
-			helper->zstrm.avail_out = helper->decompress_bufsz;
-			helper->zstrm.next_out = helper->decompress_buf;
-			zret = inflate(&helper->zstrm, Z_BLOCK);
-			if (zret == Z_STREAM_END)
-				break;
-			g_byte_array_append(buf,
-					    helper->decompress_buf,
-					    helper->decompress_bufsz - helper->zstrm.avail_out);
-			if (zret != Z_OK) {
-				g_set_error(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_NOT_SUPPORTED,
-					    "inflate error @0x%x: %s",
-					    (guint)*offset,
-					    zError(zret));
-				return FALSE;
-			}
-		}
-		zret = inflateReset(&helper->zstrm);
-		if (zret != Z_OK) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_SUPPORTED,
-				    "failed to reset inflate: %s",
-				    zError(zret));
-			return FALSE;
-		}
-		zret = inflateSetDictionary(&helper->zstrm, buf->data, buf->len);
-		if (zret != Z_OK) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_SUPPORTED,
-				    "failed to set inflate dictionary: %s",
-				    zError(zret));
-			return FALSE;
-		}
-		bytes_uncomp =
-		    g_byte_array_free_to_bytes(g_steal_pointer(&buf)); /* nocheck:blocked */
-		fu_composite_input_stream_add_bytes(FU_COMPOSITE_INPUT_STREAM(folder_data),
-						    bytes_uncomp);
+	/* inflate from the archive when each block is required */
+	if (priv->lazy_decompress) {
+		stream = g_object_ref(helper->stream);
+		blob_offset = 0;
 	} else {
-		fu_composite_input_stream_add_partial_stream(
-		    FU_COMPOSITE_INPUT_STREAM(folder_data),
-		    FU_PARTIAL_INPUT_STREAM(partial_stream));
+		/* decompressed later in a thread, so do not share the archive stream */
+		folder->blob = fu_input_stream_read_bytes(helper->stream,
+							  blob_offset,
+							  blob_end - blob_offset,
+							  NULL,
+							  error);
+		if (folder->blob == NULL)
+			return FALSE;
+		stream = fu_mapped_input_stream_new(folder->blob);
+	}
+	folder->folder_data = fu_cab_folder_input_stream_new(stream, error);
+	if (folder->folder_data == NULL)
+		return FALSE;
+	for (guint i = 0; i < folder->blocks->len; i++) {
+		FuCabFirmwareBlock *block = fu_cab_firmware_folder_get_block(folder, i);
+		fu_cab_folder_input_stream_add_block(
+		    FU_CAB_FOLDER_INPUT_STREAM(folder->folder_data),
+		    block->data_offset - blob_offset,
+		    block->comp,
+		    block->uncomp);
 	}
 
 	/* success */
-	*offset += blob_comp + hdr_sz;
 	return TRUE;
 }
 
@@ -367,10 +416,11 @@ fu_cab_firmware_parse_folder(FuCabFirmware *self,
 			     FuCabFirmwareParseHelper *helper,
 			     guint idx,
 			     gsize offset,
-			     GInputStream *folder_data,
 			     GError **error)
 {
 	FuCabFirmwarePrivate *priv = GET_PRIVATE(self);
+	gsize streamsz = 0;
+	g_autoptr(FuCabFirmwareFolder) folder = fu_cab_firmware_folder_new();
 	g_autoptr(GByteArray) st = NULL;
 
 	/* parse header */
@@ -386,37 +436,247 @@ fu_cab_firmware_parse_folder(FuCabFirmware *self,
 				    "no CFDATA blocks");
 		return FALSE;
 	}
-	helper->compression = fu_struct_cab_folder_get_compression(st);
-	if (helper->compression != FU_CAB_COMPRESSION_NONE)
+	folder->compression = fu_struct_cab_folder_get_compression(st);
+	if (folder->compression != FU_CAB_COMPRESSION_NONE)
 		priv->compressed = TRUE;
-	if (helper->compression != FU_CAB_COMPRESSION_NONE &&
-	    helper->compression != FU_CAB_COMPRESSION_MSZIP) {
+	if (folder->compression != FU_CAB_COMPRESSION_NONE &&
+	    folder->compression != FU_CAB_COMPRESSION_MSZIP) {
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_NOT_SUPPORTED,
 			    "compression %s not supported",
-			    fu_cab_compression_to_string(helper->compression));
+			    fu_cab_compression_to_string(folder->compression));
 		return FALSE;
 	}
 
 	/* parse CDATA, either using the stream offset or the per-spec FuStructCabFolder.ndatab */
 	if (helper->ndatabsz > 0) {
 		for (gsize off = fu_struct_cab_folder_get_offset(st); off < helper->ndatabsz;) {
-			if (!fu_cab_firmware_parse_data(self, helper, &off, folder_data, error))
+			if (!fu_cab_firmware_parse_data(self, helper, folder, &off, error))
 				return FALSE;
 		}
 	} else {
 		gsize off = fu_struct_cab_folder_get_offset(st);
 		for (guint16 i = 0; i < fu_struct_cab_folder_get_ndatab(st); i++) {
-			if (!fu_cab_firmware_parse_data(self, helper, &off, folder_data, error))
+			if (!fu_cab_firmware_parse_data(self, helper, folder, &off, error))
 				return FALSE;
 		}
 	}
+	if (folder->blocks->len == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "no folder data");
+		return FALSE;
+	}
+	if (!fu_cab_firmware_folder_ensure_data(self, helper, folder, error))
+		return FALSE;
+	if (!fu_input_stream_size(folder->folder_data, &streamsz, error))
+		return FALSE;
+	if (streamsz == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "no folder data");
+		return FALSE;
+	}
+
+	/* success */
+	g_ptr_array_add(helper->folders, g_steal_pointer(&folder));
+	return TRUE;
+}
+
+static void
+fu_cab_firmware_verify_block_cb(gpointer data, gpointer user_data)
+{
+	FuCabFirmwareChecksumHelper *helper = (FuCabFirmwareChecksumHelper *)data;
+	FuCabFirmwareBlock *block = helper->block;
+	guint32 checksum_actual = 0;
+	g_autoptr(GByteArray) hdr = g_byte_array_new();
+
+	/* first do the 'checksum' on the data, then the partial header */
+	if (!fu_cab_firmware_compute_checksum(g_bytes_get_data(helper->blob, NULL),
+					      g_bytes_get_size(helper->blob),
+					      &checksum_actual,
+					      &helper->error))
+		return;
+	fu_byte_array_append_uint16(hdr, block->comp, G_LITTLE_ENDIAN);
+	fu_byte_array_append_uint16(hdr, block->uncomp, G_LITTLE_ENDIAN);
+	if (!fu_cab_firmware_compute_checksum(hdr->data,
+					      hdr->len,
+					      &checksum_actual,
+					      &helper->error))
+		return;
+	if (checksum_actual != block->checksum) {
+		g_set_error(&helper->error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "invalid checksum at 0x%x, expected 0x%x, got 0x%x",
+			    (guint)block->offset,
+			    block->checksum,
+			    checksum_actual);
+	}
+}
+
+/* verify the blocks [idx_start, idx_end) in parallel, where @blob starts at @blob_offset */
+static gboolean
+fu_cab_firmware_verify_blob(FuCabFirmwareFolder *folder,
+			    GBytes *blob,
+			    gsize blob_offset,
+			    guint idx_start,
+			    guint idx_end,
+			    GError **error)
+{
+	GThreadPool *pool;
+	g_autoptr(GPtrArray) helpers =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_cab_firmware_checksum_helper_free);
+
+	for (guint i = idx_start; i < idx_end; i++) {
+		FuCabFirmwareBlock *block = fu_cab_firmware_folder_get_block(folder, i);
+		FuCabFirmwareChecksumHelper *helper;
+
+		if (block->checksum == 0)
+			continue;
+		helper = g_new0(FuCabFirmwareChecksumHelper, 1);
+		helper->block = block;
+		helper->blob =
+		    g_bytes_new_from_bytes(blob, block->data_offset - blob_offset, block->comp);
+		g_ptr_array_add(helpers, helper);
+	}
+	if (helpers->len == 0)
+		return TRUE;
+	pool = g_thread_pool_new(fu_cab_firmware_verify_block_cb,
+				 NULL,
+				 (gint)MIN(helpers->len, g_get_num_processors()),
+				 FALSE,
+				 error);
+	if (pool == NULL)
+		return FALSE;
+	for (guint i = 0; i < helpers->len; i++) {
+		if (!g_thread_pool_push(pool, g_ptr_array_index(helpers, i), error)) {
+			g_thread_pool_free(pool, FALSE, TRUE);
+			return FALSE;
+		}
+	}
+	g_thread_pool_free(pool, FALSE, TRUE);
+
+	/* report the first failure */
+	for (guint i = 0; i < helpers->len; i++) {
+		FuCabFirmwareChecksumHelper *helper = g_ptr_array_index(helpers, i);
+		if (helper->error != NULL) {
+			g_propagate_error(error, g_steal_pointer(&helper->error));
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_cab_firmware_verify_folder(FuCabFirmwareParseHelper *helper,
+			      FuCabFirmwareFolder *folder,
+			      GError **error)
+{
+	/* already loaded */
+	if (folder->blob != NULL) {
+		FuCabFirmwareBlock *block0 = fu_cab_firmware_folder_get_block(folder, 0);
+		return fu_cab_firmware_verify_blob(folder,
+						   folder->blob,
+						   block0->data_offset,
+						   0,
+						   folder->blocks->len,
+						   error);
+	}
+
+	/* do not load the entire folder into memory at once */
+	for (guint idx_start = 0; idx_start < folder->blocks->len;) {
+		FuCabFirmwareBlock *block = fu_cab_firmware_folder_get_block(folder, idx_start);
+		guint idx_end = idx_start + 1;
+		gsize blob_end;
+		g_autoptr(GBytes) blob = NULL;
+
+		while (idx_end < folder->blocks->len &&
+		       fu_cab_firmware_folder_get_data_end(folder, idx_end) - block->data_offset <=
+			   FU_CAB_FIRMWARE_CHECKSUM_BATCHSZ)
+			idx_end++;
+		blob_end = fu_cab_firmware_folder_get_data_end(folder, idx_end - 1);
+		blob = fu_input_stream_read_bytes(helper->stream,
+						  block->data_offset,
+						  blob_end - block->data_offset,
+						  NULL,
+						  error);
+		if (blob == NULL)
+			return FALSE;
+		if (!fu_cab_firmware_verify_blob(folder,
+						 blob,
+						 block->data_offset,
+						 idx_start,
+						 idx_end,
+						 error))
+			return FALSE;
+		idx_start = idx_end;
+	}
 
 	/* success */
 	return TRUE;
 }
 
+static void
+fu_cab_firmware_decompress_folder_cb(gpointer data, gpointer user_data)
+{
+	FuCabFirmwareFolder *folder = (FuCabFirmwareFolder *)data;
+	gsize streamsz = 0;
+	g_autoptr(GBytes) blob = NULL;
+
+	if (!fu_input_stream_size(folder->folder_data, &streamsz, &folder->error))
+		return;
+	blob = fu_input_stream_read_bytes(folder->folder_data, 0x0, streamsz, NULL, &folder->error);
+	if (blob == NULL)
+		return;
+	g_object_unref(folder->folder_data);
+	folder->folder_data = fu_mapped_input_stream_new(blob);
+	g_clear_pointer(&folder->blob, g_bytes_unref);
+}
+
+/* each folder is independent, and so can be inflated in parallel */
+static gboolean
+fu_cab_firmware_decompress_folders(FuCabFirmwareParseHelper *helper, GError **error)
+{
+	GThreadPool *pool;
+	g_autoptr(GPtrArray) folders = g_ptr_array_new();
+
+	for (guint i = 0; i < helper->folders->len; i++) {
+		FuCabFirmwareFolder *folder = g_ptr_array_index(helper->folders, i);
+		if (folder->blob != NULL)
+			g_ptr_array_add(folders, folder);
+	}
+	if (folders->len == 0)
+		return TRUE;
+	pool = g_thread_pool_new(fu_cab_firmware_decompress_folder_cb,
+				 NULL,
+				 (gint)MIN(folders->len, g_get_num_processors()),
+				 FALSE,
+				 error);
+	if (pool == NULL)
+		return FALSE;
+	for (guint i = 0; i < folders->len; i++) {
+		if (!g_thread_pool_push(pool, g_ptr_array_index(folders, i), error)) {
+			g_thread_pool_free(pool, FALSE, TRUE);
+			return FALSE;
+		}
+	}
+	g_thread_pool_free(pool, FALSE, TRUE);
+
+	/* report the first failure */
+	for (guint i = 0; i < folders->len; i++) {
+		FuCabFirmwareFolder *folder = g_ptr_array_index(folders, i);
+		if (folder->error != NULL) {
+			g_propagate_error(error, g_steal_pointer(&folder->error));
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
 static gboolean
 fu_cab_firmware_parse_file(FuCabFirmware *self,
 			   FuCabFirmwareParseHelper *helper,
@@ -424,7 +684,7 @@ fu_cab_firmware_parse_file(FuCabFirmware *self,
 			   GError **error)
 {
 	FuCabFirmwarePrivate *priv = GET_PRIVATE(self);
-	GInputStream *folder_data;
+	FuCabFirmwareFolder *folder;
 	guint16 date;
 	guint16 index;
 	guint16 time;
@@ -444,7 +704,7 @@ fu_cab_firmware_parse_file(FuCabFirmware *self,
 
 	/* sanity check */
 	index = fu_struct_cab_file_get_index(st);
-	if (index >= helper->folder_data->len) {
+	if (index >= helper->folders->len) {
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_NOT_SUPPORTED,
@@ -452,7 +712,7 @@ fu_cab_firmware_parse_file(FuCabFirmware *self,
 			    index);
 		return FALSE;
 	}
-	folder_data = g_ptr_array_index(helper->folder_data, index);
+	folder = g_ptr_array_index(helper->folders, index);
 
 	/* parse filename */
 	*offset += FU_STRUCT_CAB_FILE_SIZE;
@@ -483,7 +743,7 @@ fu_cab_firmware_parse_file(FuCabFirmware *self,
 	} else {
 		fu_firmware_set_id(FU_FIRMWARE(img), filename->str);
 	}
-	stream = fu_partial_input_stream_new(folder_data,
+	stream = fu_partial_input_stream_new(folder->folder_data,
 					     fu_struct_cab_file_get_uoffset(st),
 					     fu_struct_cab_file_get_usize(st),
 					     error);
@@ -520,29 +780,15 @@ fu_cab_firmware_validate(FuFirmware *firmware, GInputStream *stream, gsize offse
 }
 
 static FuCabFirmwareParseHelper *
-fu_cab_firmware_parse_helper_new(GInputStream *stream, FuFirmwareParseFlags flags, GError **error)
+fu_cab_firmware_parse_helper_new(GInputStream *stream, gsize streamsz, FuFirmwareParseFlags flags)
 {
-	int zret;
-	g_autoptr(FuCabFirmwareParseHelper) helper = g_new0(FuCabFirmwareParseHelper, 1);
-
-	/* zlib */
-	helper->zstrm.zalloc = fu_cab_firmware_zalloc;
-	helper->zstrm.zfree = fu_cab_firmware_zfree;
-	zret = inflateInit2(&helper->zstrm, -MAX_WBITS);
-	if (zret != Z_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_NOT_SUPPORTED,
-			    "failed to initialize inflate: %s",
-			    zError(zret));
-		return NULL;
-	}
-
+	FuCabFirmwareParseHelper *helper = g_new0(FuCabFirmwareParseHelper, 1);
 	helper->stream = g_object_ref(stream);
+	helper->streamsz = streamsz;
 	helper->parse_flags = flags;
-	helper->folder_data = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	helper->decompress_bufsz = FU_CAB_FIRMWARE_DECOMPRESS_BUFSZ;
-	return g_steal_pointer(&helper);
+	helper->folders =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_cab_firmware_folder_free);
+	return helper;
 }
 
 static gboolean
@@ -620,9 +866,7 @@ fu_cab_firmware_parse(FuFirmware *firmware,
 	}
 
 	/* create helper */
-	helper = fu_cab_firmware_parse_helper_new(stream, flags, error);
-	if (helper == NULL)
-		return FALSE;
+	helper = fu_cab_firmware_parse_helper_new(stream, streamsz, flags);
 
 	/* if the only folder is >= 2GB then FuStructCabFolder.ndatab will overflow */
 	if (streamsz >= 0x8000 * 0xFFFF && fu_struct_cab_header_get_nr_folders(st) == 1)
@@ -643,22 +887,22 @@ fu_cab_firmware_parse(FuFirmware *firmware,
 
 	/* parse CFFOLDER */
 	for (guint i = 0; i < fu_struct_cab_header_get_nr_folders(st); i++) {
-		g_autoptr(GInputStream) folder_data = fu_composite_input_stream_new();
-		if (!fu_cab_firmware_parse_folder(self, helper, i, offset, folder_data, error))
-			return FALSE;
-		if (!fu_input_stream_size(folder_data, &streamsz, error))
-			return FALSE;
-		if (streamsz == 0) {
-			g_set_error_literal(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_NOT_SUPPORTED,
-					    "no folder data");
+		if (!fu_cab_firmware_parse_folder(self, helper, i, offset, error))
 			return FALSE;
-		}
-		g_ptr_array_add(helper->folder_data, g_steal_pointer(&folder_data));
 		offset += FU_STRUCT_CAB_FOLDER_SIZE + helper->rsvd_folder;
 	}
 
+	/* verify CFDATA checksums, then inflate any folders that are not being loaded lazily */
+	if ((flags & FU_FIRMWARE_PARSE_FLAG_IGNORE_CHECKSUM) == 0) {
+		for (guint i = 0; i < helper->folders->len; i++) {
+			FuCabFirmwareFolder *folder = g_ptr_array_index(helper->folders, i);
+			if (!fu_cab_firmware_verify_folder(helper, folder, error))
+				return FALSE;
+		}
+	}
+	if (!fu_cab_firmware_decompress_folders(helper, error))
+		return FALSE;
+
 	/* parse CFFILEs */
 	for (guint i = 0; i < fu_struct_cab_header_get_nr_files(st); i++) {
 		if (!fu_cab_firmware_parse_file(self, helper, &off_cffile, error))
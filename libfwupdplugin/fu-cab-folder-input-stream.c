@@ -0,0 +1,431 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuCabFolderInputStream"
+
+#include "config.h"
+
+#include <zlib.h>
+
+#include "fwupd-codec.h"
+#include "fwupd-error.h"
+
+#include "fu-cab-folder-input-stream.h"
+#include "fu-input-stream.h"
+#include "fu-mem-private.h"
+
+/**
+ * FuCabFolderInputStream:
+ *
+ * A input stream that inflates the MSZIP-compressed CFDATA blocks of a cabinet folder on demand.
+ *
+ * Each block uses the uncompressed data of the previous block as the inflate dictionary, and so
+ * only the most recently inflated block is kept in memory. Reading forwards is cheap, but seeking
+ * backwards means inflating again from the first block of the folder.
+ */
+
+typedef struct {
+	gsize offset; /* of the compressed data in the base stream */
+	gsize comp_size;
+	gsize uncomp_size;
+} FuCabFolderInputStreamBlock;
+
+struct _FuCabFolderInputStream {
+	GInputStream parent_instance;
+	GInputStream *base_stream;
+	GArray *blocks; /* of FuCabFolderInputStreamBlock */
+	gsize total_size;
+	goffset pos;
+	z_stream zstrm;
+	guint8 *decompress_buf;
+	guint blocks_idx;	/* the number of blocks inflated */
+	GByteArray *block_buf;	/* uncompressed data for blocks_idx-1 */
+	gsize block_buf_offset; /* offset of block_buf in the folder */
+};
+
+static void
+fu_cab_folder_input_stream_seekable_iface_init(GSeekableIface *iface);
+static void
+fu_cab_folder_input_stream_codec_iface_init(FwupdCodecInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(FuCabFolderInputStream,
+			fu_cab_folder_input_stream,
+			G_TYPE_INPUT_STREAM,
+			G_IMPLEMENT_INTERFACE(G_TYPE_SEEKABLE,
+					      fu_cab_folder_input_stream_seekable_iface_init)
+			    G_IMPLEMENT_INTERFACE(FWUPD_TYPE_CODEC,
+						  fu_cab_folder_input_stream_codec_iface_init))
+
+#define FU_CAB_FOLDER_INPUT_STREAM_DECOMPRESS_BUFSZ 0x4000 /* bytes */
+
+static void
+fu_cab_folder_input_stream_add_string(FwupdCodec *codec, guint idt, GString *str)
+{
+	FuCabFolderInputStream *self = FU_CAB_FOLDER_INPUT_STREAM(codec);
+	fwupd_codec_string_append_hex(str, idt, "Pos", self->pos);
+	fwupd_codec_string_append_hex(str, idt, "TotalSize", self->total_size);
+	fwupd_codec_string_append_int(str, idt, "Blocks", self->blocks->len);
+	fwupd_codec_string_append_int(str, idt, "BlocksIdx", self->blocks_idx);
+}
+
+static void
+fu_cab_folder_input_stream_codec_iface_init(FwupdCodecInterface *iface)
+{
+	iface->add_string = fu_cab_folder_input_stream_add_string;
+}
+
+static voidpf
+fu_cab_folder_input_stream_zalloc(voidpf opaque, uInt items, uInt size)
+{
+	return g_malloc0_n(items, size);
+}
+
+static void
+fu_cab_folder_input_stream_zfree(voidpf opaque, voidpf address)
+{
+	g_free(address);
+}
+
+/**
+ * fu_cab_folder_input_stream_add_block:
+ * @self: a #FuCabFolderInputStream
+ * @offset: offset of the compressed data in the base stream, *after* the CFDATA header
+ * @comp_size: compressed size in bytes
+ * @uncomp_size: uncompressed size in bytes
+ *
+ * Adds a CFDATA block, which must be added in the order they appear in the folder.
+ *
+ * Since: 2.0.9
+ **/
+void
+fu_cab_folder_input_stream_add_block(FuCabFolderInputStream *self,
+				     gsize offset,
+				     gsize comp_size,
+				     gsize uncomp_size)
+{
+	FuCabFolderInputStreamBlock block = {
+	    .offset = offset,
+	    .comp_size = comp_size,
+	    .uncomp_size = uncomp_size,
+	};
+	g_return_if_fail(FU_IS_CAB_FOLDER_INPUT_STREAM(self));
+	g_array_append_val(self->blocks, block);
+	self->total_size += uncomp_size;
+}
+
+static goffset
+fu_cab_folder_input_stream_tell(GSeekable *seekable)
+{
+	FuCabFolderInputStream *self = FU_CAB_FOLDER_INPUT_STREAM(seekable);
+	g_return_val_if_fail(FU_IS_CAB_FOLDER_INPUT_STREAM(self), -1);
+	return self->pos;
+}
+
+static gboolean
+fu_cab_folder_input_stream_can_seek(GSeekable *seekable)
+{
+	return TRUE;
+}
+
+static gboolean
+fu_cab_folder_input_stream_seek(GSeekable *seekable,
+				goffset offset,
+				GSeekType type,
+				GCancellable *cancellable,
+				GError **error)
+{
+	FuCabFolderInputStream *self = FU_CAB_FOLDER_INPUT_STREAM(seekable);
+	goffset pos;
+
+	g_return_val_if_fail(FU_IS_CAB_FOLDER_INPUT_STREAM(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (type == G_SEEK_CUR) {
+		pos = self->pos + offset;
+	} else if (type == G_SEEK_END) {
+		pos = (goffset)self->total_size + offset;
+	} else {
+		pos = offset;
+	}
+
+	/* use the same error as GMemoryInputStream */
+	if (pos < 0 || (gsize)pos > self->total_size) {
+		g_set_error(error,
+			    G_IO_ERROR,
+			    G_IO_ERROR_INVALID_ARGUMENT,
+			    "cannot seek to 0x%x as stream only 0x%x bytes in size",
+			    (guint)pos,
+			    (guint)self->total_size);
+		return FALSE;
+	}
+	self->pos = pos;
+	return TRUE;
+}
+
+static gboolean
+fu_cab_folder_input_stream_can_truncate(GSeekable *seekable)
+{
+	return FALSE;
+}
+
+static gboolean
+fu_cab_folder_input_stream_truncate(GSeekable *seekable,
+				    goffset offset,
+				    GCancellable *cancellable,
+				    GError **error)
+{
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "cannot truncate FuCabFolderInputStream");
+	return FALSE;
+}
+
+static void
+fu_cab_folder_input_stream_seekable_iface_init(GSeekableIface *iface)
+{
+	iface->tell = fu_cab_folder_input_stream_tell;
+	iface->can_seek = fu_cab_folder_input_stream_can_seek;
+	iface->seek = fu_cab_folder_input_stream_seek;
+	iface->can_truncate = fu_cab_folder_input_stream_can_truncate;
+	iface->truncate_fn = fu_cab_folder_input_stream_truncate;
+}
+
+/* decompress Zlib data after removing *another *header... */
+static gboolean
+fu_cab_folder_input_stream_inflate_block(FuCabFolderInputStream *self,
+					 FuCabFolderInputStreamBlock *block,
+					 GError **error)
+{
+	int zret;
+	g_autofree gchar *kind = NULL;
+	g_autoptr(GBytes) bytes_comp = NULL;
+
+	/* check compressed header */
+	bytes_comp = fu_input_stream_read_bytes(self->base_stream,
+						block->offset,
+						block->comp_size,
+						NULL,
+						error);
+	if (bytes_comp == NULL)
+		return FALSE;
+	kind = fu_memstrsafe(g_bytes_get_data(bytes_comp, NULL),
+			     g_bytes_get_size(bytes_comp),
+			     0x0,
+			     2,
+			     error);
+	if (kind == NULL)
+		return FALSE;
+	if (g_strcmp0(kind, "CK") != 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "compressed header invalid: %s",
+			    kind);
+		return FALSE;
+	}
+	if (self->decompress_buf == NULL)
+		self->decompress_buf = g_malloc0(FU_CAB_FOLDER_INPUT_STREAM_DECOMPRESS_BUFSZ);
+	g_byte_array_set_size(self->block_buf, 0);
+	self->zstrm.avail_in = g_bytes_get_size(bytes_comp) - 2;
+	self->zstrm.next_in = (z_const Bytef *)g_bytes_get_data(bytes_comp, NULL) + 2;
+	while (1) {
+		self->zstrm.avail_out = FU_CAB_FOLDER_INPUT_STREAM_DECOMPRESS_BUFSZ;
+		self->zstrm.next_out = self->decompress_buf;
+		zret = inflate(&self->zstrm, Z_BLOCK);
+		if (zret == Z_STREAM_END)
+			break;
+		g_byte_array_append(self->block_buf,
+				    self->decompress_buf,
+				    FU_CAB_FOLDER_INPUT_STREAM_DECOMPRESS_BUFSZ -
+					self->zstrm.avail_out);
+		if (zret != Z_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "inflate error @0x%x: %s",
+				    (guint)block->offset,
+				    zError(zret));
+			return FALSE;
+		}
+	}
+	if (self->block_buf->len != block->uncomp_size) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "inflated size @0x%x invalid, expected 0x%x and got 0x%x",
+			    (guint)block->offset,
+			    (guint)block->uncomp_size,
+			    self->block_buf->len);
+		return FALSE;
+	}
+	zret = inflateReset(&self->zstrm);
+	if (zret != Z_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "failed to reset inflate: %s",
+			    zError(zret));
+		return FALSE;
+	}
+	zret = inflateSetDictionary(&self->zstrm, self->block_buf->data, self->block_buf->len);
+	if (zret != Z_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "failed to set inflate dictionary: %s",
+			    zError(zret));
+		return FALSE;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+/* inflate blocks until the one containing the current position is in block_buf */
+static gboolean
+fu_cab_folder_input_stream_ensure_block(FuCabFolderInputStream *self, GError **error)
+{
+	/* already inflated */
+	if (self->blocks_idx > 0 && (gsize)self->pos >= self->block_buf_offset &&
+	    (gsize)self->pos < self->block_buf_offset + self->block_buf->len)
+		return TRUE;
+
+	/* the dictionary for each block is the previous block, so we have to start again */
+	if (self->blocks_idx > 0 && (gsize)self->pos < self->block_buf_offset) {
+		int zret = inflateReset(&self->zstrm);
+		if (zret != Z_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "failed to reset inflate: %s",
+				    zError(zret));
+			return FALSE;
+		}
+		g_byte_array_set_size(self->block_buf, 0);
+		self->block_buf_offset = 0;
+		self->blocks_idx = 0;
+	}
+
+	/* inflate forwards */
+	while (self->blocks_idx == 0 ||
+	       (gsize)self->pos >= self->block_buf_offset + self->block_buf->len) {
+		FuCabFolderInputStreamBlock *block;
+		if (self->blocks_idx >= self->blocks->len) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "offset is 0x%x out of range",
+				    (guint)self->pos);
+			return FALSE;
+		}
+		block = &g_array_index(self->blocks, FuCabFolderInputStreamBlock, self->blocks_idx);
+		self->block_buf_offset += self->block_buf->len;
+		if (!fu_cab_folder_input_stream_inflate_block(self, block, error))
+			return FALSE;
+		self->blocks_idx++;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static gssize
+fu_cab_folder_input_stream_read(GInputStream *stream,
+				void *buffer,
+				gsize count,
+				GCancellable *cancellable,
+				GError **error)
+{
+	FuCabFolderInputStream *self = FU_CAB_FOLDER_INPUT_STREAM(stream);
+	gsize offset;
+
+	g_return_val_if_fail(FU_IS_CAB_FOLDER_INPUT_STREAM(self), -1);
+	g_return_val_if_fail(error == NULL || *error == NULL, -1);
+
+	if ((gsize)self->pos >= self->total_size)
+		return 0;
+	if (!fu_cab_folder_input_stream_ensure_block(self, error))
+		return -1;
+	offset = self->pos - self->block_buf_offset;
+	count = MIN(count, self->block_buf->len - offset);
+	if (!fu_memcpy_safe(buffer,
+			    count,
+			    0x0,
+			    self->block_buf->data,
+			    self->block_buf->len,
+			    offset,
+			    count,
+			    error))
+		return -1;
+	self->pos += count;
+	return count;
+}
+
+/**
+ * fu_cab_folder_input_stream_new:
+ * @stream: a base #GInputStream of the entire cabinet archive
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates a stream that inflates the CFDATA blocks of a MSZIP folder on demand.
+ *
+ * Returns: (transfer full): a #FuCabFolderInputStream, or %NULL on error
+ *
+ * Since: 2.0.9
+ **/
+GInputStream *
+fu_cab_folder_input_stream_new(GInputStream *stream, GError **error)
+{
+	int zret;
+	g_autoptr(FuCabFolderInputStream) self =
+	    g_object_new(FU_TYPE_CAB_FOLDER_INPUT_STREAM, NULL);
+
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	self->base_stream = g_object_ref(stream);
+	zret = inflateInit2(&self->zstrm, -MAX_WBITS);
+	if (zret != Z_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "failed to initialize inflate: %s",
+			    zError(zret));
+		return NULL;
+	}
+	return G_INPUT_STREAM(g_steal_pointer(&self));
+}
+
+static void
+fu_cab_folder_input_stream_finalize(GObject *object)
+{
+	FuCabFolderInputStream *self = FU_CAB_FOLDER_INPUT_STREAM(object);
+	inflateEnd(&self->zstrm);
+	if (self->base_stream != NULL)
+		g_object_unref(self->base_stream);
+	g_array_unref(self->blocks);
+	g_byte_array_unref(self->block_buf);
+	g_free(self->decompress_buf);
+	G_OBJECT_CLASS(fu_cab_folder_input_stream_parent_class)->finalize(object);
+}
+
+static void
+fu_cab_folder_input_stream_class_init(FuCabFolderInputStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	GInputStreamClass *istream_class = G_INPUT_STREAM_CLASS(klass);
+	istream_class->read_fn = fu_cab_folder_input_stream_read;
+	object_class->finalize = fu_cab_folder_input_stream_finalize;
+}
+
+static void
+fu_cab_folder_input_stream_init(FuCabFolderInputStream *self)
+{
+	self->blocks = g_array_new(FALSE, FALSE, sizeof(FuCabFolderInputStreamBlock));
+	self->block_buf = g_byte_array_new();
+	self->zstrm.zalloc = fu_cab_folder_input_stream_zalloc;
+	self->zstrm.zfree = fu_cab_folder_input_stream_zfree;
+}
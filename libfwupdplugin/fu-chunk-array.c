@@ -28,6 +28,10 @@ struct _FuChunkArray {
 	gsize packet_sz;
 	GArray *offsets; /* of gsize */
 	gsize total_size;
+	gsize readahead_sz; /* 0 for disabled */
+	GBytes *block;
+	guint block_idx_start;
+	guint block_idx_end; /* exclusive */
 };
 
 G_DEFINE_TYPE(FuChunkArray, fu_chunk_array, G_TYPE_OBJECT)
@@ -79,6 +83,60 @@ fu_chunk_array_calculate_chunk_for_offset(FuChunkArray *self,
 		*chunksz = chunksz_tmp;
 }
 
+/* the block is always made up of whole chunks, so no chunk ever straddles two blocks */
+static void
+fu_chunk_array_readahead_range(FuChunkArray *self,
+			       guint idx_start,
+			       guint *idx_end,
+			       gsize *offset,
+			       gsize *bufsz)
+{
+	gsize offset_start = g_array_index(self->offsets, gsize, idx_start);
+	gsize offset_end = offset_start;
+	guint idx = idx_start;
+
+	do {
+		gsize chunksz = 0;
+		gsize offset_tmp = g_array_index(self->offsets, gsize, idx);
+		fu_chunk_array_calculate_chunk_for_offset(self, offset_tmp, NULL, NULL, &chunksz);
+		if (idx > idx_start && offset_tmp + chunksz - offset_start > self->readahead_sz)
+			break;
+		offset_end = offset_tmp + chunksz;
+		idx++;
+	} while (idx < self->offsets->len);
+
+	*idx_end = idx;
+	*offset = offset_start;
+	*bufsz = offset_end - offset_start;
+}
+
+static gboolean
+fu_chunk_array_ensure_block(FuChunkArray *self, guint idx, GError **error)
+{
+	gsize offset = 0;
+	gsize bufsz = 0;
+	guint idx_end = 0;
+	g_autoptr(GBytes) blob = NULL;
+
+	/* already in the current block */
+	if (self->block != NULL && idx >= self->block_idx_start && idx < self->block_idx_end)
+		return TRUE;
+
+	/* read synchronously, as the stream may be shared with the caller */
+	fu_chunk_array_readahead_range(self, idx, &idx_end, &offset, &bufsz);
+	blob = fu_input_stream_read_bytes(self->stream, offset, bufsz, NULL, error);
+	if (blob == NULL)
+		return FALSE;
+	if (self->block != NULL)
+		g_bytes_unref(self->block);
+	self->block = g_steal_pointer(&blob);
+	self->block_idx_start = idx;
+	self->block_idx_end = idx_end;
+
+	/* success */
+	return TRUE;
+}
+
 /**
  * fu_chunk_array_index:
  * @self: a #FuChunkArray
@@ -120,6 +178,20 @@ fu_chunk_array_index(FuChunkArray *self, guint idx, GError **error)
 	if (self->blob != NULL) {
 		g_autoptr(GBytes) blob_chk = g_bytes_new_from_bytes(self->blob, offset, chunksz);
 		chk = fu_chunk_bytes_new(blob_chk);
+	} else if (self->stream != NULL && self->readahead_sz > 0) {
+		g_autoptr(GBytes) blob_chk = NULL;
+		if (!fu_chunk_array_ensure_block(self, idx, error)) {
+			g_prefix_error(error,
+				       "failed to get stream at 0x%x for 0x%x: ",
+				       (guint)offset,
+				       (guint)chunksz);
+			return NULL;
+		}
+		blob_chk = g_bytes_new_from_bytes(
+		    self->block,
+		    offset - g_array_index(self->offsets, gsize, self->block_idx_start),
+		    chunksz);
+		chk = fu_chunk_bytes_new(blob_chk);
 	} else if (self->stream != NULL) {
 		g_autoptr(GBytes) blob_chk =
 		    fu_input_stream_read_bytes(self->stream, offset, chunksz, NULL, error);
@@ -141,6 +213,70 @@ fu_chunk_array_index(FuChunkArray *self, guint idx, GError **error)
 	return g_steal_pointer(&chk);
 }
 
+/**
+ * fu_chunk_array_iterate:
+ * @self: a #FuChunkArray
+ * @idx: (inout): the index of the next chunk, which the caller sets to 0 to start
+ * @out_chk: (out) (transfer full): the next #FuChunk, or %NULL when there are no more chunks
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the next chunk in order, which allows stream-backed arrays to read ahead.
+ *
+ * The position is owned by the caller, so stopping early or failing to read a chunk does not
+ * affect any other iteration of @self.
+ *
+ * Returns: %TRUE for success, or %FALSE if the chunk could not be read
+ *
+ * Since: 2.0.9
+ **/
+gboolean
+fu_chunk_array_iterate(FuChunkArray *self, guint *idx, FuChunk **out_chk, GError **error)
+{
+	FuChunk *chk;
+
+	g_return_val_if_fail(FU_IS_CHUNK_ARRAY(self), FALSE);
+	g_return_val_if_fail(idx != NULL, FALSE);
+	g_return_val_if_fail(out_chk != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* finished */
+	if (*idx >= self->offsets->len) {
+		*out_chk = NULL;
+		return TRUE;
+	}
+	chk = fu_chunk_array_index(self, *idx, error);
+	if (chk == NULL)
+		return FALSE;
+	(*idx)++;
+	*out_chk = chk;
+	return TRUE;
+}
+
+/**
+ * fu_chunk_array_set_readahead:
+ * @self: a #FuChunkArray
+ * @readahead_sz: the block size in bytes, or 0 to disable
+ *
+ * Sets how much data is read from the stream in one go. Each block is made up of whole chunks,
+ * and the chunks returned reference the block rather than being a copy.
+ *
+ * This is only used for arrays created using fu_chunk_array_new_from_stream(), which by default
+ * read each chunk from the stream when it is requested.
+ *
+ * Since: 2.0.9
+ **/
+void
+fu_chunk_array_set_readahead(FuChunkArray *self, gsize readahead_sz)
+{
+	g_return_if_fail(FU_IS_CHUNK_ARRAY(self));
+
+	if (self->block != NULL) {
+		g_bytes_unref(self->block);
+		self->block = NULL;
+	}
+	self->readahead_sz = readahead_sz;
+}
+
 static void
 fu_chunk_array_ensure_offsets(FuChunkArray *self)
 {
@@ -228,6 +364,11 @@ fu_chunk_array_new_virtual(gsize bufsz, gsize addr_offset, gsize page_sz, gsize
  * Chunks a linear stream into packets, ensuring each packet is less that a specific
  * transfer size.
  *
+ * If @stream is a #FuMappedInputStream then each chunk references the mapped data rather than
+ * being a copy.
+ *
+ * The stream can be read in blocks, see fu_chunk_array_set_readahead() for details.
+ *
  * Returns: (transfer full): a #FuChunkArray, or #NULL on error
  *
  * Since: 2.0.2
@@ -263,6 +404,8 @@ static void
 fu_chunk_array_finalize(GObject *object)
 {
 	FuChunkArray *self = FU_CHUNK_ARRAY(object);
+	if (self->block != NULL)
+		g_bytes_unref(self->block);
 	g_array_unref(self->offsets);
 	if (self->blob != NULL)
 		g_bytes_unref(self->blob);
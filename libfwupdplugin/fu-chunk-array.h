@@ -29,3 +29,8 @@ guint
 fu_chunk_array_length(FuChunkArray *self) G_GNUC_NON_NULL(1);
 FuChunk *
 fu_chunk_array_index(FuChunkArray *self, guint idx, GError **error) G_GNUC_NON_NULL(1);
+gboolean
+fu_chunk_array_iterate(FuChunkArray *self, guint *idx, FuChunk **out_chk, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2, 3);
+void
+fu_chunk_array_set_readahead(FuChunkArray *self, gsize readahead_sz) G_GNUC_NON_NULL(1);
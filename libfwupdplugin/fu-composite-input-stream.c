@@ -104,7 +104,7 @@ fu_composite_input_stream_add_bytes(FuCompositeInputStream *self, GBytes *bytes)
 	g_return_if_fail(FU_IS_COMPOSITE_INPUT_STREAM(self));
 	g_return_if_fail(bytes != NULL);
 
-	stream = g_memory_input_stream_new_from_bytes(bytes);
+	stream = fu_mapped_input_stream_new(bytes);
 	partial_stream = fu_partial_input_stream_new(stream, 0x0, g_bytes_get_size(bytes), NULL);
 	fu_composite_input_stream_add_partial_stream(self, FU_PARTIAL_INPUT_STREAM(partial_stream));
 }
@@ -8,6 +8,8 @@
 
 #include "config.h"
 
+#include <glib/gstdio.h>
+
 #include "fu-bios-settings-private.h"
 #include "fu-common-private.h"
 #include "fu-config-private.h"
@@ -19,8 +21,9 @@
 #include "fu-efi-hard-drive-device-path.h"
 #include "fu-fdt-firmware.h"
 #include "fu-hwids-private.h"
+#include "fu-input-stream.h"
 #include "fu-path.h"
-#include "fu-pefile-firmware.h"
+#include "fu-pefile-firmware-private.h"
 #include "fu-smbios-private.h"
 #include "fu-volume-private.h"
 
@@ -38,6 +41,7 @@ typedef struct {
 	FuSmbios *smbios;
 	FuSmbiosChassisKind chassis_kind;
 	FuQuirks *quirks;
+	FuMetrics *metrics;
 	FuEfivars *efivars;
 	GPtrArray *backends;
 	GHashTable *runtime_versions;
@@ -164,6 +168,24 @@ fu_context_get_efivars(FuContext *self)
 	return priv->efivars;
 }
 
+/**
+ * fu_context_get_metrics:
+ * @self: a #FuContext
+ *
+ * Gets the registry of counters and latency histograms shared by the daemon and all plugins.
+ *
+ * Returns: (transfer none): a #FuMetrics
+ *
+ * Since: 2.0.9
+ **/
+FuMetrics *
+fu_context_get_metrics(FuContext *self)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_CONTEXT(self), NULL);
+	return priv->metrics;
+}
+
 /**
  * fu_context_get_smbios:
  * @self: a #FuContext
@@ -920,13 +942,17 @@ const gchar *
 fu_context_lookup_quirk_by_id(FuContext *self, const gchar *guid, const gchar *key)
 {
 	FuContextPrivate *priv = GET_PRIVATE(self);
+	const gchar *value;
+	gint64 start = g_get_monotonic_time();
 
 	g_return_val_if_fail(FU_IS_CONTEXT(self), NULL);
 	g_return_val_if_fail(guid != NULL, NULL);
 	g_return_val_if_fail(key != NULL, NULL);
 
 	/* exact ID */
-	return fu_quirks_lookup_by_id(priv->quirks, guid, key);
+	value = fu_quirks_lookup_by_id(priv->quirks, guid, key);
+	fu_metrics_add_duration_since(priv->metrics, "QuirkLookup", start);
+	return value;
 }
 
 typedef struct {
@@ -973,14 +999,20 @@ fu_context_lookup_quirk_by_id_iter(FuContext *self,
 	    .iter_cb = iter_cb,
 	    .user_data = user_data,
 	};
+	gboolean ret;
+	gint64 start = g_get_monotonic_time();
+
 	g_return_val_if_fail(FU_IS_CONTEXT(self), FALSE);
 	g_return_val_if_fail(guid != NULL, FALSE);
 	g_return_val_if_fail(iter_cb != NULL, FALSE);
-	return fu_quirks_lookup_by_id_iter(priv->quirks,
-					   guid,
-					   key,
-					   fu_context_lookup_quirk_by_id_iter_cb,
-					   &helper);
+
+	ret = fu_quirks_lookup_by_id_iter(priv->quirks,
+					  guid,
+					  key,
+					  fu_context_lookup_quirk_by_id_iter_cb,
+					  &helper);
+	fu_metrics_add_duration_since(priv->metrics, "QuirkLookupIter", start);
+	return ret;
 }
 
 /**
@@ -1871,6 +1903,32 @@ fu_context_get_esp_volume_by_hard_drive_device_path(FuContext *self,
 	return NULL;
 }
 
+typedef struct {
+	gchar *filename;
+	guint64 idx;
+	gboolean has_stat;
+	guint64 dev;
+	guint64 inode;
+	gint64 mtime;
+	gint64 ctime;
+	guint64 size;
+	gchar *blocks; /* nullable */
+	FuFirmware *firmware; /* nullable */
+	GError *error;	      /* nullable */
+} FuContextEspFileHelper;
+
+static void
+fu_context_esp_file_helper_free(FuContextEspFileHelper *helper)
+{
+	g_free(helper->filename);
+	g_free(helper->blocks);
+	if (helper->firmware != NULL)
+		g_object_unref(helper->firmware);
+	if (helper->error != NULL)
+		g_error_free(helper->error);
+	g_free(helper);
+}
+
 static FuFirmware *
 fu_context_esp_load_pe_file(const gchar *filename, GError **error)
 {
@@ -1884,6 +1942,128 @@ fu_context_esp_load_pe_file(const gchar *filename, GError **error)
 	return g_steal_pointer(&firmware);
 }
 
+/* runs in a worker thread */
+static void
+fu_context_esp_load_pe_file_cb(gpointer data, gpointer user_data)
+{
+	FuContextEspFileHelper *helper = (FuContextEspFileHelper *)data;
+	helper->firmware = fu_context_esp_load_pe_file(helper->filename, &helper->error);
+}
+
+static gchar *
+fu_context_esp_checksums_filename(void)
+{
+	g_autofree gchar *cachedir = fu_path_from_kind(FU_PATH_KIND_CACHEDIR_PKG);
+	return g_build_filename(cachedir, "esp-checksums.ini", NULL);
+}
+
+#define FU_CONTEXT_ESP_CHECKSUMS_BLOCK_SIZE 0x1000
+
+/* hash the first and last blocks so that in-place rewrites that preserve the times are caught */
+static gchar *
+fu_context_esp_checksums_blocks(FuContextEspFileHelper *helper)
+{
+	gsize blocksz = MIN(helper->size, FU_CONTEXT_ESP_CHECKSUMS_BLOCK_SIZE);
+	gsize offset_last = 0;
+	g_autoptr(GChecksum) csum = g_checksum_new(G_CHECKSUM_SHA256);
+	g_autoptr(GBytes) blob_first = NULL;
+	g_autoptr(GBytes) blob_last = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	stream = fu_input_stream_from_path(helper->filename, &error_local);
+	if (stream == NULL) {
+		g_debug("not caching %s: %s", helper->filename, error_local->message);
+		return NULL;
+	}
+	blob_first = fu_input_stream_read_bytes(stream, 0x0, blocksz, NULL, &error_local);
+	if (blob_first == NULL) {
+		g_debug("not caching %s: %s", helper->filename, error_local->message);
+		return NULL;
+	}
+	if (helper->size > FU_CONTEXT_ESP_CHECKSUMS_BLOCK_SIZE)
+		offset_last = helper->size - FU_CONTEXT_ESP_CHECKSUMS_BLOCK_SIZE;
+	blob_last = fu_input_stream_read_bytes(stream, offset_last, blocksz, NULL, &error_local);
+	if (blob_last == NULL) {
+		g_debug("not caching %s: %s", helper->filename, error_local->message);
+		return NULL;
+	}
+	g_checksum_update(csum,
+			  g_bytes_get_data(blob_first, NULL),
+			  g_bytes_get_size(blob_first));
+	g_checksum_update(csum, g_bytes_get_data(blob_last, NULL), g_bytes_get_size(blob_last));
+	return g_strdup(g_checksum_get_string(csum));
+}
+
+/* the file is assumed to be unchanged if the stat data and the first and last blocks match */
+static FuFirmware *
+fu_context_esp_checksums_lookup(GKeyFile *kf, FuContextEspFileHelper *helper)
+{
+	g_autofree gchar *blocks = NULL;
+	g_autofree gchar *checksum = NULL;
+	g_autoptr(FuFirmware) firmware = NULL;
+
+	if (!helper->has_stat || helper->blocks == NULL)
+		return NULL;
+	if (g_key_file_get_uint64(kf, helper->filename, "Device", NULL) != helper->dev ||
+	    g_key_file_get_uint64(kf, helper->filename, "Inode", NULL) != helper->inode ||
+	    g_key_file_get_int64(kf, helper->filename, "Mtime", NULL) != helper->mtime ||
+	    g_key_file_get_int64(kf, helper->filename, "Ctime", NULL) != helper->ctime ||
+	    g_key_file_get_uint64(kf, helper->filename, "Size", NULL) != helper->size)
+		return NULL;
+	blocks = g_key_file_get_string(kf, helper->filename, "Blocks", NULL);
+	if (g_strcmp0(blocks, helper->blocks) != 0)
+		return NULL;
+	checksum = g_key_file_get_string(kf, helper->filename, "Checksum", NULL);
+	if (checksum == NULL)
+		return NULL;
+	firmware = fu_pefile_firmware_new();
+	fu_firmware_set_filename(firmware, helper->filename);
+	fu_pefile_firmware_set_authenticode_hash(FU_PEFILE_FIRMWARE(firmware), checksum);
+	return g_steal_pointer(&firmware);
+}
+
+static void
+fu_context_esp_checksums_save(GKeyFile *kf_old, GPtrArray *helpers)
+{
+	g_autofree gchar *data_new = NULL;
+	g_autofree gchar *data_old = NULL;
+	g_autofree gchar *filename = fu_context_esp_checksums_filename();
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GKeyFile) kf = g_key_file_new();
+
+	/* only the files seen this time, so that removed files are not kept forever */
+	for (guint i = 0; i < helpers->len; i++) {
+		FuContextEspFileHelper *helper = g_ptr_array_index(helpers, i);
+		g_autofree gchar *checksum = NULL;
+		if (!helper->has_stat || helper->blocks == NULL || helper->firmware == NULL)
+			continue;
+		checksum = fu_firmware_get_checksum(helper->firmware, G_CHECKSUM_SHA256, NULL);
+		if (checksum == NULL)
+			continue;
+		g_key_file_set_uint64(kf, helper->filename, "Device", helper->dev);
+		g_key_file_set_uint64(kf, helper->filename, "Inode", helper->inode);
+		g_key_file_set_int64(kf, helper->filename, "Mtime", helper->mtime);
+		g_key_file_set_int64(kf, helper->filename, "Ctime", helper->ctime);
+		g_key_file_set_uint64(kf, helper->filename, "Size", helper->size);
+		g_key_file_set_string(kf, helper->filename, "Blocks", helper->blocks);
+		g_key_file_set_string(kf, helper->filename, "Checksum", checksum);
+	}
+
+	/* nothing changed */
+	data_old = g_key_file_to_data(kf_old, NULL, NULL);
+	data_new = g_key_file_to_data(kf, NULL, NULL);
+	if (g_strcmp0(data_old, data_new) == 0)
+		return;
+
+	/* not fatal, e.g. running as a user */
+	if (!fu_path_mkdir_parent(filename, &error_local) ||
+	    !g_file_set_contents(filename, data_new, -1, &error_local)) {
+		g_debug("failed to save ESP checksums: %s", error_local->message);
+		return;
+	}
+}
+
 static gchar *
 fu_context_build_uefi_basename_for_arch(const gchar *app_name)
 {
@@ -1908,10 +2088,30 @@ fu_context_build_uefi_basename_for_arch(const gchar *app_name)
 	return NULL;
 }
 
+static void
+fu_context_esp_files_add(GPtrArray *helpers, const gchar *filename, FuEfiLoadOption *entry)
+{
+	FuContextEspFileHelper *helper = g_new0(FuContextEspFileHelper, 1);
+	GStatBuf statbuf = {0};
+
+	helper->filename = g_strdup(filename);
+	helper->idx = fu_firmware_get_idx(FU_FIRMWARE(entry));
+	if (g_stat(filename, &statbuf) == 0) {
+		helper->has_stat = TRUE;
+		helper->dev = statbuf.st_dev;
+		helper->inode = statbuf.st_ino;
+		helper->mtime = statbuf.st_mtime;
+		helper->ctime = statbuf.st_ctime;
+		helper->size = statbuf.st_size;
+	}
+	g_ptr_array_add(helpers, helper);
+}
+
 static gboolean
 fu_context_get_esp_files_for_entry(FuContext *self,
 				   FuEfiLoadOption *entry,
-				   GPtrArray *files,
+				   GPtrArray *helpers,
+				   GPtrArray *volume_lockers,
 				   FuContextEspFileFlags flags,
 				   GError **error)
 {
@@ -1970,31 +2170,12 @@ fu_context_get_esp_files_for_entry(FuContext *self,
 	mount_point = fu_volume_get_mount_point(volume);
 	filename = g_build_filename(mount_point, dp_filename, NULL);
 	g_debug("check for 1st stage bootloader: %s", filename);
-	if (flags & FU_CONTEXT_ESP_FILE_FLAG_INCLUDE_FIRST_STAGE) {
-		g_autoptr(FuFirmware) firmware = NULL;
-		g_autoptr(GError) error_local = NULL;
-
-		/* ignore if the file cannot be loaded as a PE file */
-		firmware = fu_context_esp_load_pe_file(filename, &error_local);
-		if (firmware == NULL) {
-			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) ||
-			    g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
-				g_debug("ignoring: %s", error_local->message);
-			} else {
-				g_propagate_error(error, g_steal_pointer(&error_local));
-				return FALSE;
-			}
-		} else {
-			fu_firmware_set_idx(firmware, fu_firmware_get_idx(FU_FIRMWARE(entry)));
-			g_ptr_array_add(files, g_steal_pointer(&firmware));
-		}
-	}
+	if (flags & FU_CONTEXT_ESP_FILE_FLAG_INCLUDE_FIRST_STAGE)
+		fu_context_esp_files_add(helpers, filename, entry);
 
 	/* the 2nd stage bootloader, typically grub */
 	if (flags & FU_CONTEXT_ESP_FILE_FLAG_INCLUDE_SECOND_STAGE &&
 	    g_str_has_suffix(filename, shim_name)) {
-		g_autoptr(FuFirmware) firmware = NULL;
-		g_autoptr(GError) error_local = NULL;
 		g_autoptr(GString) filename2 = g_string_new(filename);
 		const gchar *path;
 
@@ -2008,53 +2189,53 @@ fu_context_get_esp_files_for_entry(FuContext *self,
 			g_string_replace(filename2, shim_name, grub_name, 1);
 		}
 		g_debug("check for 2nd stage bootloader: %s", filename2->str);
-
-		/* ignore if the file cannot be loaded as a PE file */
-		firmware = fu_context_esp_load_pe_file(filename2->str, &error_local);
-		if (firmware == NULL) {
-			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) ||
-			    g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
-				g_debug("ignoring: %s", error_local->message);
-			} else {
-				g_propagate_error(error, g_steal_pointer(&error_local));
-				return FALSE;
-			}
-		} else {
-			fu_firmware_set_idx(firmware, fu_firmware_get_idx(FU_FIRMWARE(entry)));
-			g_ptr_array_add(files, g_steal_pointer(&firmware));
-		}
+		fu_context_esp_files_add(helpers, filename2->str, entry);
 	}
 
 	/* revocations, typically for SBAT */
 	if (flags & FU_CONTEXT_ESP_FILE_FLAG_INCLUDE_REVOCATIONS &&
 	    g_str_has_suffix(filename, shim_name)) {
 		g_autoptr(GString) filename2 = g_string_new(filename);
-		g_autoptr(FuFirmware) firmware = NULL;
-		g_autoptr(GError) error_local = NULL;
-
 		g_string_replace(filename2, shim_name, "revocations.efi", 1);
 		g_debug("check for revocation: %s", filename2->str);
-
-		/* ignore if the file cannot be loaded as a PE file */
-		firmware = fu_context_esp_load_pe_file(filename2->str, &error_local);
-		if (firmware == NULL) {
-			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) ||
-			    g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
-				g_debug("ignoring: %s", error_local->message);
-			} else {
-				g_propagate_error(error, g_steal_pointer(&error_local));
-				return FALSE;
-			}
-		} else {
-			fu_firmware_set_idx(firmware, fu_firmware_get_idx(FU_FIRMWARE(entry)));
-			g_ptr_array_add(files, g_steal_pointer(&firmware));
-		}
+		fu_context_esp_files_add(helpers, filename2->str, entry);
 	}
 
+	/* keep the volume mounted until the files have been loaded */
+	g_ptr_array_add(volume_lockers, g_steal_pointer(&volume_locker));
+
 	/* success */
 	return TRUE;
 }
 
+/* each file is parsed and hashed in a worker thread, as there may be many boot entries */
+static gboolean
+fu_context_esp_load_pe_files(GPtrArray *helpers, GError **error)
+{
+	GThreadPool *pool;
+
+	if (helpers->len == 0)
+		return TRUE;
+	pool = g_thread_pool_new(fu_context_esp_load_pe_file_cb,
+				 NULL,
+				 (gint)MIN(helpers->len, g_get_num_processors()),
+				 FALSE,
+				 error);
+	if (pool == NULL)
+		return FALSE;
+	for (guint i = 0; i < helpers->len; i++) {
+		FuContextEspFileHelper *helper = g_ptr_array_index(helpers, i);
+		if (helper->firmware != NULL)
+			continue;
+		if (!g_thread_pool_push(pool, helper, error)) {
+			g_thread_pool_free(pool, FALSE, TRUE);
+			return FALSE;
+		}
+	}
+	g_thread_pool_free(pool, FALSE, TRUE);
+	return TRUE;
+}
+
 /**
  * fu_context_get_esp_files:
  * @self: a #FuContext
@@ -2063,6 +2244,10 @@ fu_context_get_esp_files_for_entry(FuContext *self,
  *
  * Gets the PE files for all the entries listed in `BootOrder`.
  *
+ * If %FU_CONTEXT_ESP_FILE_FLAG_USE_CHECKSUM_CACHE is set then files that have not changed since
+ * the last call are not parsed, and only fu_firmware_get_checksum() can be used on the returned
+ * firmware. This flag should not be used when the checksum is used for a security decision.
+ *
  * Returns: (transfer full) (element-type FuPefileFirmware): PE firmware data
  *
  * Since: 2.0.0
@@ -2071,8 +2256,13 @@ GPtrArray *
 fu_context_get_esp_files(FuContext *self, FuContextEspFileFlags flags, GError **error)
 {
 	FuContextPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GKeyFile) kf = g_key_file_new();
 	g_autoptr(GPtrArray) entries = NULL;
 	g_autoptr(GPtrArray) files = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_autoptr(GPtrArray) helpers =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_context_esp_file_helper_free);
+	g_autoptr(GPtrArray) volume_lockers =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 
 	g_return_val_if_fail(FU_IS_CONTEXT(self), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
@@ -2083,7 +2273,12 @@ fu_context_get_esp_files(FuContext *self, FuContextEspFileFlags flags, GError **
 	for (guint i = 0; i < entries->len; i++) {
 		FuEfiLoadOption *entry = g_ptr_array_index(entries, i);
 		g_autoptr(GError) error_local = NULL;
-		if (!fu_context_get_esp_files_for_entry(self, entry, files, flags, &error_local)) {
+		if (!fu_context_get_esp_files_for_entry(self,
+							entry,
+							helpers,
+							volume_lockers,
+							flags,
+							&error_local)) {
 			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND) ||
 			    g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
 				g_debug("ignoring %s: %s",
@@ -2096,6 +2291,43 @@ fu_context_get_esp_files(FuContext *self, FuContextEspFileFlags flags, GError **
 		}
 	}
 
+	/* use the cached checksum if the file has not changed */
+	if (flags & FU_CONTEXT_ESP_FILE_FLAG_USE_CHECKSUM_CACHE) {
+		g_autofree gchar *filename = fu_context_esp_checksums_filename();
+		g_autoptr(GError) error_local = NULL;
+		if (!g_key_file_load_from_file(kf, filename, G_KEY_FILE_NONE, &error_local)) {
+			if (!g_error_matches(error_local, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+				g_debug("ignoring %s: %s", filename, error_local->message);
+		}
+		for (guint i = 0; i < helpers->len; i++) {
+			FuContextEspFileHelper *helper = g_ptr_array_index(helpers, i);
+			if (helper->has_stat)
+				helper->blocks = fu_context_esp_checksums_blocks(helper);
+			helper->firmware = fu_context_esp_checksums_lookup(kf, helper);
+		}
+	}
+	if (!fu_context_esp_load_pe_files(helpers, error))
+		return NULL;
+	if (flags & FU_CONTEXT_ESP_FILE_FLAG_USE_CHECKSUM_CACHE)
+		fu_context_esp_checksums_save(kf, helpers);
+
+	/* ignore if the file does not exist or cannot be loaded as a PE file */
+	for (guint i = 0; i < helpers->len; i++) {
+		FuContextEspFileHelper *helper = g_ptr_array_index(helpers, i);
+		if (helper->error != NULL) {
+			if (g_error_matches(helper->error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND) ||
+			    g_error_matches(helper->error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) ||
+			    g_error_matches(helper->error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
+				g_debug("ignoring: %s", helper->error->message);
+				continue;
+			}
+			g_propagate_error(error, g_steal_pointer(&helper->error));
+			return NULL;
+		}
+		fu_firmware_set_idx(helper->firmware, helper->idx);
+		g_ptr_array_add(files, g_steal_pointer(&helper->firmware));
+	}
+
 	/* success */
 	return g_steal_pointer(&files);
 }
@@ -2289,6 +2521,7 @@ fu_context_finalize(GObject *object)
 	g_object_unref(priv->config);
 	g_hash_table_unref(priv->hwid_flags);
 	g_object_unref(priv->quirks);
+	g_object_unref(priv->metrics);
 	g_object_unref(priv->smbios);
 	g_object_unref(priv->host_bios_settings);
 	g_hash_table_unref(priv->firmware_gtypes);
@@ -2465,6 +2698,7 @@ fu_context_init(FuContext *self)
 						      (GDestroyNotify)g_ptr_array_unref);
 	priv->firmware_gtypes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 	priv->quirks = fu_quirks_new(self);
+	priv->metrics = fu_metrics_new();
 	priv->host_bios_settings = fu_bios_settings_new();
 	priv->esp_volumes = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	priv->runtime_versions = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
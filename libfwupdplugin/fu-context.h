@@ -14,6 +14,7 @@
 #include "fu-efi-hard-drive-device-path.h"
 #include "fu-efivars.h"
 #include "fu-firmware.h"
+#include "fu-metrics.h"
 #include "fu-smbios-struct.h"
 
 #define FU_TYPE_CONTEXT (fu_context_get_type())
@@ -262,6 +263,8 @@ const gchar *
 fu_context_get_esp_location(FuContext *self);
 FuEfivars *
 fu_context_get_efivars(FuContext *self) G_GNUC_NON_NULL(1);
+FuMetrics *
+fu_context_get_metrics(FuContext *self) G_GNUC_NON_NULL(1);
 
 /**
  * FuContextEspFileFlags:
@@ -301,6 +304,18 @@ typedef enum {
 	 * Since: 2.0.0
 	 **/
 	FU_CONTEXT_ESP_FILE_FLAG_INCLUDE_REVOCATIONS = 1 << 2,
+	/**
+	 * FU_CONTEXT_ESP_FILE_FLAG_USE_CHECKSUM_CACHE:
+	 *
+	 * Only the Authenticode checksum is required, so files that appear unchanged since they
+	 * were last hashed do not need to be parsed again.
+	 *
+	 * This must not be used when the checksum is used for a security decision, e.g. when
+	 * checking if a dbx update would revoke a bootloader.
+	 *
+	 * Since: 2.0.9
+	 **/
+	FU_CONTEXT_ESP_FILE_FLAG_USE_CHECKSUM_CACHE = 1 << 3,
 	/**
 	 * FU_CONTEXT_ESP_FILE_FLAG_UNKNOWN:
 	 *
@@ -8,6 +8,15 @@
 
 #include "config.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define FU_CRC_HAVE_SSE42
+#endif
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define FU_CRC_HAVE_ARMV8
+#endif
+
 #include "fu-common.h"
 #include "fu-crc-private.h"
 #include "fu-mem.h"
@@ -58,18 +67,6 @@ const struct {
     {FU_CRC_KIND_B8_AUTOSAR, 8, 0x2F, 0xFF, FALSE, 0xFF},
 };
 
-static guint8
-fu_crc_reflect8(guint8 data)
-{
-	guint8 val = 0;
-	for (guint8 bit = 0; bit < 8; bit++) {
-		if (data & 0x01)
-			FU_BIT_SET(val, 7 - bit);
-		data = (data >> 1);
-	}
-	return val;
-}
-
 static guint32
 fu_crc_reflect(guint32 data, guint bitwidth)
 {
@@ -82,31 +79,199 @@ fu_crc_reflect(guint32 data, guint bitwidth)
 	return val;
 }
 
+/* 8 and 16 bit kinds use one table, 32 bit kinds use eight for slice-by-8 */
+#define FU_CRC_TABLE_SLICES 8
+
+static gsize crc_tables[FU_CRC_KIND_LAST] = {0};
+
+static const guint32 *
+fu_crc_get_table(FuCrcKind kind)
+{
+	if (g_once_init_enter(&crc_tables[kind])) {
+		const guint bitwidth = crc_map[kind].bitwidth;
+		const guint slices = bitwidth == 32 ? FU_CRC_TABLE_SLICES : 1;
+		const guint32 mask = G_MAXUINT32 >> (32 - bitwidth);
+		guint32 *table = g_new0(guint32, 256 * slices);
+
+		if (crc_map[kind].reflected) {
+			const guint32 poly = fu_crc_reflect(crc_map[kind].poly, bitwidth);
+			for (guint i = 0; i < 256; i++) {
+				guint32 val = i;
+				for (guint8 bit = 0; bit < 8; bit++)
+					val = (val & 0x01) ? (val >> 1) ^ poly : (val >> 1);
+				table[i] = val;
+			}
+			for (guint j = 1; j < slices; j++) {
+				for (guint i = 0; i < 256; i++) {
+					guint32 val = table[((j - 1) * 256) + i];
+					table[(j * 256) + i] = (val >> 8) ^ table[val & 0xFF];
+				}
+			}
+		} else {
+			const guint32 topbit = 1ul << (bitwidth - 1);
+			for (guint i = 0; i < 256; i++) {
+				guint32 val = (guint32)i << (bitwidth - 8);
+				for (guint8 bit = 0; bit < 8; bit++)
+					val = (val & topbit) ? (val << 1) ^ crc_map[kind].poly : (val << 1);
+				table[i] = val & mask;
+			}
+			for (guint j = 1; j < slices; j++) {
+				for (guint i = 0; i < 256; i++) {
+					guint32 val = table[((j - 1) * 256) + i];
+					table[(j * 256) + i] = (val << 8) ^ table[val >> 24];
+				}
+			}
+		}
+		g_once_init_leave(&crc_tables[kind], (gsize)table);
+	}
+	return (const guint32 *)crc_tables[kind];
+}
+
+/* @crc is the reflected register, and the MSB-first polynomial is not used at all */
+static guint32
+fu_crc_step_reflected(const guint32 *table, const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	for (gsize i = 0; i < bufsz; i++)
+		crc = (crc >> 8) ^ table[(crc ^ buf[i]) & 0xFF];
+	return crc;
+}
+
+static guint32
+fu_crc_step_normal(const guint32 *table, guint bitwidth, const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	const guint32 mask = G_MAXUINT32 >> (32 - bitwidth);
+	for (gsize i = 0; i < bufsz; i++)
+		crc = ((crc << 8) ^ table[((crc >> (bitwidth - 8)) ^ buf[i]) & 0xFF]) & mask;
+	return crc;
+}
+
+static guint32
+fu_crc32_step_reflected_slice8(const guint32 *table, const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	while (bufsz >= 8) {
+		guint32 val = fu_memread_uint32(buf + 4, G_LITTLE_ENDIAN);
+		crc ^= fu_memread_uint32(buf, G_LITTLE_ENDIAN);
+		crc = table[(7 * 256) + (crc & 0xFF)] ^ table[(6 * 256) + ((crc >> 8) & 0xFF)] ^
+		      table[(5 * 256) + ((crc >> 16) & 0xFF)] ^ table[(4 * 256) + (crc >> 24)] ^
+		      table[(3 * 256) + (val & 0xFF)] ^ table[(2 * 256) + ((val >> 8) & 0xFF)] ^
+		      table[(1 * 256) + ((val >> 16) & 0xFF)] ^ table[val >> 24];
+		buf += 8;
+		bufsz -= 8;
+	}
+	return fu_crc_step_reflected(table, buf, bufsz, crc);
+}
+
+static guint32
+fu_crc32_step_normal_slice8(const guint32 *table, const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	while (bufsz >= 8) {
+		guint32 val = fu_memread_uint32(buf + 4, G_BIG_ENDIAN);
+		crc ^= fu_memread_uint32(buf, G_BIG_ENDIAN);
+		crc = table[(7 * 256) + (crc >> 24)] ^ table[(6 * 256) + ((crc >> 16) & 0xFF)] ^
+		      table[(5 * 256) + ((crc >> 8) & 0xFF)] ^ table[(4 * 256) + (crc & 0xFF)] ^
+		      table[(3 * 256) + (val >> 24)] ^ table[(2 * 256) + ((val >> 16) & 0xFF)] ^
+		      table[(1 * 256) + ((val >> 8) & 0xFF)] ^ table[val & 0xFF];
+		buf += 8;
+		bufsz -= 8;
+	}
+	return fu_crc_step_normal(table, 32, buf, bufsz, crc);
+}
+
+#ifdef FU_CRC_HAVE_SSE42
+/* the CRC32 instruction only supports the Castagnoli polynomial */
+__attribute__((target("sse4.2"))) static guint32
+fu_crc32c_step_sse42(const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	guint64 crc64 = crc;
+	while (bufsz >= 8) {
+		crc64 = _mm_crc32_u64(crc64, fu_memread_uint64(buf, G_LITTLE_ENDIAN));
+		buf += 8;
+		bufsz -= 8;
+	}
+	crc = (guint32)crc64;
+	for (gsize i = 0; i < bufsz; i++)
+		crc = _mm_crc32_u8(crc, buf[i]);
+	return crc;
+}
+#endif
+
+#ifdef FU_CRC_HAVE_ARMV8
+static guint32
+fu_crc32_step_armv8(guint32 poly, const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	while (bufsz >= 8) {
+		guint64 val = fu_memread_uint64(buf, G_LITTLE_ENDIAN);
+		crc = poly == 0x1EDC6F41 ? __crc32cd(crc, val) : __crc32d(crc, val);
+		buf += 8;
+		bufsz -= 8;
+	}
+	for (gsize i = 0; i < bufsz; i++)
+		crc = poly == 0x1EDC6F41 ? __crc32cb(crc, buf[i]) : __crc32b(crc, buf[i]);
+	return crc;
+}
+#endif
+
+/* @crc is the reflected register */
+static guint32
+fu_crc32_step_reflected(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint32 crc)
+{
+#ifdef FU_CRC_HAVE_SSE42
+	if (crc_map[kind].poly == 0x1EDC6F41 && __builtin_cpu_supports("sse4.2"))
+		return fu_crc32c_step_sse42(buf, bufsz, crc);
+#endif
+#ifdef FU_CRC_HAVE_ARMV8
+	if (crc_map[kind].poly == 0x04C11DB7 || crc_map[kind].poly == 0x1EDC6F41)
+		return fu_crc32_step_armv8(crc_map[kind].poly, buf, bufsz, crc);
+#endif
+	return fu_crc32_step_reflected_slice8(fu_crc_get_table(kind), buf, bufsz, crc);
+}
+
 /**
- * fu_crc8_step:
- * @kind: a #FuCrcKind, typically %FU_CRC_KIND_B8_MAXIM_DOW
+ * fu_crc_kind_get_bitwidth:
+ * @kind: a #FuCrcKind
+ *
+ * Returns the width of the CRC kind.
+ *
+ * Returns: number of bits, typically 8, 16 or 32
+ *
+ * Since: 2.0.9
+ **/
+guint
+fu_crc_kind_get_bitwidth(FuCrcKind kind)
+{
+	g_return_val_if_fail(kind < FU_CRC_KIND_LAST, 0);
+	return crc_map[kind].bitwidth;
+}
+
+/**
+ * fu_crc_step_bitwise:
+ * @kind: a #FuCrcKind
  * @buf: memory buffer
  * @bufsz: size of @buf
  * @crc: initial CRC value
  *
- * Computes the cyclic redundancy check section value for the given memory buffer.
+ * Computes the cyclic redundancy check section value for the given memory buffer one bit at a
+ * time, without using any lookup tables or hardware acceleration.
  *
- * NOTE: When all data has been added, you should call fu_crc8_done() to return the final value.
+ * This is only useful for verifying and benchmarking the other implementations.
  *
  * Returns: CRC value
  *
- * Since: 2.0.0
+ * Since: 2.0.9
  **/
-guint8
-fu_crc8_step(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint8 crc)
+guint32
+fu_crc_step_bitwise(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint32 crc)
 {
-	const guint bitwidth = sizeof(crc) * 8;
+	guint bitwidth;
+	guint32 mask;
 
 	g_return_val_if_fail(kind < FU_CRC_KIND_LAST, 0x0);
-	g_return_val_if_fail(crc_map[kind].bitwidth == 8, 0x0);
 
+	bitwidth = crc_map[kind].bitwidth;
+	mask = G_MAXUINT32 >> (32 - bitwidth);
 	for (gsize i = 0; i < bufsz; ++i) {
-		crc ^= crc_map[kind].reflected ? fu_crc_reflect8(buf[i]) : buf[i];
+		guint32 tmp = crc_map[kind].reflected ? fu_crc_reflect(buf[i], 8) : buf[i];
+		crc ^= tmp << (bitwidth - 8);
 		for (guint8 bit = 0; bit < 8; bit++) {
 			if (crc & (1ul << (bitwidth - 1))) {
 				crc = (crc << 1) ^ crc_map[kind].poly;
@@ -114,10 +279,40 @@ fu_crc8_step(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint8 crc)
 				crc = (crc << 1);
 			}
 		}
+		crc &= mask;
 	}
 	return crc;
 }
 
+/**
+ * fu_crc8_step:
+ * @kind: a #FuCrcKind, typically %FU_CRC_KIND_B8_MAXIM_DOW
+ * @buf: memory buffer
+ * @bufsz: size of @buf
+ * @crc: initial CRC value
+ *
+ * Computes the cyclic redundancy check section value for the given memory buffer.
+ *
+ * NOTE: When all data has been added, you should call fu_crc8_done() to return the final value.
+ *
+ * Returns: CRC value
+ *
+ * Since: 2.0.0
+ **/
+guint8
+fu_crc8_step(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint8 crc)
+{
+	g_return_val_if_fail(kind < FU_CRC_KIND_LAST, 0x0);
+	g_return_val_if_fail(crc_map[kind].bitwidth == 8, 0x0);
+
+	if (crc_map[kind].reflected) {
+		guint32 tmp = fu_crc_reflect(crc, 8);
+		tmp = fu_crc_step_reflected(fu_crc_get_table(kind), buf, bufsz, tmp);
+		return fu_crc_reflect(tmp, 8);
+	}
+	return fu_crc_step_normal(fu_crc_get_table(kind), 8, buf, bufsz, crc);
+}
+
 /**
  * fu_crc8_done:
  * @kind: a #FuCrcKind, typically %FU_CRC_KIND_B8_MAXIM_DOW
@@ -195,23 +390,15 @@ fu_crc8_bytes(FuCrcKind kind, GBytes *blob)
 guint16
 fu_crc16_step(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint16 crc)
 {
-	const guint bitwidth = sizeof(crc) * 8;
-
 	g_return_val_if_fail(kind < FU_CRC_KIND_LAST, 0x0);
 	g_return_val_if_fail(crc_map[kind].bitwidth == 16, 0x0);
 
-	for (gsize i = 0; i < bufsz; ++i) {
-		guint16 tmp = crc_map[kind].reflected ? fu_crc_reflect8(buf[i]) : buf[i];
-		crc ^= tmp << (bitwidth - 8);
-		for (guint8 bit = 0; bit < 8; bit++) {
-			if (crc & (1ul << (bitwidth - 1))) {
-				crc = (crc << 1) ^ crc_map[kind].poly;
-			} else {
-				crc = (crc << 1);
-			}
-		}
+	if (crc_map[kind].reflected) {
+		guint32 tmp = fu_crc_reflect(crc, 16);
+		tmp = fu_crc_step_reflected(fu_crc_get_table(kind), buf, bufsz, tmp);
+		return fu_crc_reflect(tmp, 16);
 	}
-	return crc;
+	return fu_crc_step_normal(fu_crc_get_table(kind), 16, buf, bufsz, crc);
 }
 
 /**
@@ -291,23 +478,15 @@ fu_crc16_bytes(FuCrcKind kind, GBytes *blob)
 guint32
 fu_crc32_step(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint32 crc)
 {
-	const guint bitwidth = sizeof(crc) * 8;
-
 	g_return_val_if_fail(kind < FU_CRC_KIND_LAST, 0x0);
 	g_return_val_if_fail(crc_map[kind].bitwidth == 32, 0x0);
 
-	for (gsize i = 0; i < bufsz; ++i) {
-		guint32 tmp = crc_map[kind].reflected ? fu_crc_reflect8(buf[i]) : buf[i];
-		crc ^= tmp << (bitwidth - 8);
-		for (guint8 bit = 0; bit < 8; bit++) {
-			if (crc & (1ul << (bitwidth - 1))) {
-				crc = (crc << 1) ^ crc_map[kind].poly;
-			} else {
-				crc = (crc << 1);
-			}
-		}
+	/* the register is kept MSB-first between calls */
+	if (crc_map[kind].reflected) {
+		crc = fu_crc32_step_reflected(kind, buf, bufsz, fu_crc_reflect(crc, 32));
+		return fu_crc_reflect(crc, 32);
 	}
-	return crc;
+	return fu_crc32_step_normal_slice8(fu_crc_get_table(kind), buf, bufsz, crc);
 }
 
 /**
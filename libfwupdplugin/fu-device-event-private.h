@@ -15,3 +15,9 @@ const gchar *
 fu_device_event_get_id(FuDeviceEvent *self) G_GNUC_NON_NULL(1);
 gchar *
 fu_device_event_build_id(const gchar *id) G_GNUC_NON_NULL(1);
+gboolean
+fu_device_event_append_binary(FuDeviceEvent *self, GByteArray *buf, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_device_event_parse_binary(FuDeviceEvent *self, GBytes *blob, GError **error)
+    G_GNUC_NON_NULL(1, 2);
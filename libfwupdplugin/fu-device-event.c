@@ -8,7 +8,10 @@
 
 #include "config.h"
 
+#include "fu-byte-array.h"
+#include "fu-bytes.h"
 #include "fu-device-event-private.h"
+#include "fu-device-struct.h"
 #include "fu-mem.h"
 
 /**
@@ -180,7 +183,7 @@ fu_device_event_set_i64(FuDeviceEvent *self, const gchar *key, gint64 value)
  * @key: (not nullable): a unique key, e.g. `Name`
  * @value: (not nullable): a #GBytes
  *
- * Sets a blob on the event. Note: blobs are stored internally as BASE-64 strings.
+ * Sets a blob on the event. Note: blobs are saved as BASE-64 strings when exported to JSON.
  *
  * Since: 2.0.0
  **/
@@ -191,11 +194,10 @@ fu_device_event_set_bytes(FuDeviceEvent *self, const gchar *key, GBytes *value)
 	g_return_if_fail(key != NULL);
 	g_return_if_fail(value != NULL);
 	g_ptr_array_add(self->values,
-			fu_device_event_blob_new(
-			    G_TYPE_STRING,
-			    key,
-			    g_base64_encode(g_bytes_get_data(value, NULL), g_bytes_get_size(value)),
-			    g_free));
+			fu_device_event_blob_new(G_TYPE_BYTES,
+						 key,
+						 g_bytes_ref(value),
+						 (GDestroyNotify)g_bytes_unref));
 }
 
 /**
@@ -205,7 +207,8 @@ fu_device_event_set_bytes(FuDeviceEvent *self, const gchar *key, GBytes *value)
  * @buf: (nullable): a buffer
  * @bufsz: size of @buf
  *
- * Sets a memory buffer on the event. Note: memory buffers are stored internally as BASE-64 strings.
+ * Sets a memory buffer on the event. Note: memory buffers are saved as BASE-64 strings when
+ * exported to JSON.
  *
  * Since: 2.0.0
  **/
@@ -214,9 +217,11 @@ fu_device_event_set_data(FuDeviceEvent *self, const gchar *key, const guint8 *bu
 {
 	g_return_if_fail(FU_IS_DEVICE_EVENT(self));
 	g_return_if_fail(key != NULL);
-	g_ptr_array_add(
-	    self->values,
-	    fu_device_event_blob_new(G_TYPE_STRING, key, g_base64_encode(buf, bufsz), g_free));
+	g_ptr_array_add(self->values,
+			fu_device_event_blob_new(G_TYPE_BYTES,
+						 key,
+						 g_bytes_new(buf, bufsz),
+						 (GDestroyNotify)g_bytes_unref));
 }
 
 /**
@@ -271,22 +276,24 @@ fu_device_event_check_error(FuDeviceEvent *self, GError **error)
 	return FALSE;
 }
 
-static gpointer
-fu_device_event_lookup(FuDeviceEvent *self, const gchar *key, GType gtype, GError **error)
+static FuDeviceEventBlob *
+fu_device_event_lookup_blob(FuDeviceEvent *self, const gchar *key, GError **error)
 {
-	FuDeviceEventBlob *blob = NULL;
-
 	for (guint i = 0; i < self->values->len; i++) {
-		FuDeviceEventBlob *blob_tmp = g_ptr_array_index(self->values, i);
-		if (g_strcmp0(blob_tmp->key, key) == 0) {
-			blob = blob_tmp;
-			break;
-		}
+		FuDeviceEventBlob *blob = g_ptr_array_index(self->values, i);
+		if (g_strcmp0(blob->key, key) == 0)
+			return blob;
 	}
-	if (blob == NULL) {
-		g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "no event for key %s", key);
+	g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "no event for key %s", key);
+	return NULL;
+}
+
+static gpointer
+fu_device_event_lookup(FuDeviceEvent *self, const gchar *key, GType gtype, GError **error)
+{
+	FuDeviceEventBlob *blob = fu_device_event_lookup_blob(self, key, error);
+	if (blob == NULL)
 		return NULL;
-	}
 	if (blob->gtype != gtype) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -304,7 +311,8 @@ fu_device_event_lookup(FuDeviceEvent *self, const gchar *key, GType gtype, GErro
  * @key: (not nullable): a unique key, e.g. `Name`
  * @error: (nullable): optional return location for an error
  *
- * Gets a string value from the event.
+ * Gets a string value from the event. Values set using fu_device_event_set_bytes() or
+ * fu_device_event_set_data() are not strings, and fu_device_event_get_bytes() should be used.
  *
  * Returns: (nullable): string, or %NULL on error
  *
@@ -359,6 +367,7 @@ fu_device_event_get_i64(FuDeviceEvent *self, const gchar *key, GError **error)
 GBytes *
 fu_device_event_get_bytes(FuDeviceEvent *self, const gchar *key, GError **error)
 {
+	FuDeviceEventBlob *blob;
 	const gchar *blobstr;
 	gsize bufsz = 0;
 	g_autofree guchar *buf = NULL;
@@ -367,6 +376,11 @@ fu_device_event_get_bytes(FuDeviceEvent *self, const gchar *key, GError **error)
 	g_return_val_if_fail(key != NULL, NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
+	blob = fu_device_event_lookup_blob(self, key, error);
+	if (blob == NULL)
+		return NULL;
+	if (blob->gtype == G_TYPE_BYTES)
+		return g_bytes_ref(blob->data);
 	blobstr = fu_device_event_lookup(self, key, G_TYPE_STRING, error);
 	if (blobstr == NULL)
 		return NULL;
@@ -399,6 +413,7 @@ fu_device_event_copy_data(FuDeviceEvent *self,
 			  gsize *actual_length,
 			  GError **error)
 {
+	FuDeviceEventBlob *blob;
 	const gchar *blobstr;
 	gsize bufsz_src = 0;
 	g_autofree guchar *buf_src = NULL;
@@ -407,6 +422,20 @@ fu_device_event_copy_data(FuDeviceEvent *self,
 	g_return_val_if_fail(key != NULL, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
+	/* no need to decode */
+	blob = fu_device_event_lookup_blob(self, key, error);
+	if (blob == NULL)
+		return FALSE;
+	if (blob->gtype == G_TYPE_BYTES) {
+		gsize bufsz_tmp = 0;
+		const guint8 *buf_tmp = g_bytes_get_data(blob->data, &bufsz_tmp);
+		if (actual_length != NULL)
+			*actual_length = bufsz_tmp;
+		if (buf != NULL && bufsz_tmp > 0)
+			return fu_memcpy_safe(buf, bufsz, 0x0, buf_tmp, bufsz_tmp, 0x0, bufsz_tmp, error);
+		return TRUE;
+	}
+
 	blobstr = fu_device_event_lookup(self, key, G_TYPE_STRING, error);
 	if (blobstr == NULL)
 		return FALSE;
@@ -436,9 +465,15 @@ fu_device_event_add_json(FwupdCodec *codec, JsonBuilder *builder, FwupdCodecFlag
 		if (blob->gtype == G_TYPE_INT) {
 			json_builder_set_member_name(builder, blob->key);
 			json_builder_add_int_value(builder, *((gint64 *)blob->data));
-		} else if (blob->gtype == G_TYPE_BYTES || blob->gtype == G_TYPE_STRING) {
+		} else if (blob->gtype == G_TYPE_STRING) {
 			json_builder_set_member_name(builder, blob->key);
 			json_builder_add_string_value(builder, (const gchar *)blob->data);
+		} else if (blob->gtype == G_TYPE_BYTES) {
+			g_autofree gchar *str =
+			    g_base64_encode(g_bytes_get_data(blob->data, NULL),
+					    g_bytes_get_size(blob->data));
+			json_builder_set_member_name(builder, blob->key);
+			json_builder_add_string_value(builder, str);
 		} else {
 			g_warning("invalid GType %s, ignoring", g_type_name(blob->gtype));
 		}
@@ -497,6 +532,242 @@ fu_device_event_from_json(FwupdCodec *codec, JsonNode *json_node, GError **error
 	return TRUE;
 }
 
+static gboolean
+fu_device_event_append_binary_value(GByteArray *buf,
+				    FuDeviceEventValueKind kind,
+				    const gchar *key,
+				    const guint8 *data,
+				    gsize datasz,
+				    GError **error)
+{
+	gsize keysz = strlen(key);
+	if (keysz > G_MAXUINT16) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "key size 0x%x is too large",
+			    (guint)keysz);
+		return FALSE;
+	}
+	if (datasz > G_MAXUINT32) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "value size 0x%x for %s is too large",
+			    (guint)datasz,
+			    key);
+		return FALSE;
+	}
+	fu_byte_array_append_uint8(buf, kind);
+	fu_byte_array_append_uint16(buf, keysz, G_LITTLE_ENDIAN);
+	g_byte_array_append(buf, (const guint8 *)key, keysz);
+	fu_byte_array_append_uint32(buf, datasz, G_LITTLE_ENDIAN);
+	if (datasz > 0)
+		g_byte_array_append(buf, data, datasz);
+	return TRUE;
+}
+
+/**
+ * fu_device_event_append_binary:
+ * @self: a #FuDeviceEvent
+ * @buf: a #GByteArray
+ * @error: (nullable): optional return location for an error
+ *
+ * Appends the event in the compact binary emulation format, which is the ID followed by each
+ * length-prefixed value. The uncompressed ID is used if known.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.0.9
+ **/
+gboolean
+fu_device_event_append_binary(FuDeviceEvent *self, GByteArray *buf, GError **error)
+{
+	const gchar *id;
+	gsize idsz;
+
+	g_return_val_if_fail(FU_IS_DEVICE_EVENT(self), FALSE);
+	g_return_val_if_fail(buf != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	id = self->id_uncompressed != NULL ? self->id_uncompressed : self->id;
+	idsz = id != NULL ? strlen(id) : 0;
+	if (idsz > G_MAXUINT32) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "ID size 0x%x is too large",
+			    (guint)idsz);
+		return FALSE;
+	}
+	fu_byte_array_append_uint32(buf, idsz, G_LITTLE_ENDIAN);
+	if (idsz > 0)
+		g_byte_array_append(buf, (const guint8 *)id, idsz);
+	for (guint i = 0; i < self->values->len; i++) {
+		FuDeviceEventBlob *blob = g_ptr_array_index(self->values, i);
+		if (blob->gtype == G_TYPE_INT) {
+			guint8 tmp[8] = {0};
+			fu_memwrite_uint64(tmp, *((gint64 *)blob->data), G_LITTLE_ENDIAN);
+			if (!fu_device_event_append_binary_value(buf,
+								 FU_DEVICE_EVENT_VALUE_KIND_INT64,
+								 blob->key,
+								 tmp,
+								 sizeof(tmp),
+								 error))
+				return FALSE;
+		} else if (blob->gtype == G_TYPE_BYTES) {
+			if (!fu_device_event_append_binary_value(buf,
+								 FU_DEVICE_EVENT_VALUE_KIND_BYTES,
+								 blob->key,
+								 g_bytes_get_data(blob->data, NULL),
+								 g_bytes_get_size(blob->data),
+								 error))
+				return FALSE;
+		} else if (blob->gtype == G_TYPE_STRING) {
+			const gchar *str = (const gchar *)blob->data;
+			if (!fu_device_event_append_binary_value(buf,
+								 FU_DEVICE_EVENT_VALUE_KIND_STRING,
+								 blob->key,
+								 (const guint8 *)str,
+								 str != NULL ? strlen(str) : 0,
+								 error))
+				return FALSE;
+		}
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static gchar *
+fu_device_event_read_binary_str(GBytes *blob, gsize offset, gsize strsz, GError **error)
+{
+	const gchar *str;
+	g_autoptr(GBytes) bytes = NULL;
+
+	if (strsz == 0)
+		return g_strdup("");
+	bytes = fu_bytes_new_offset(blob, offset, strsz, error);
+	if (bytes == NULL)
+		return NULL;
+	str = g_bytes_get_data(bytes, NULL);
+	if (memchr(str, '\0', strsz) != NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "string contains NUL");
+		return NULL;
+	}
+	return g_strndup(str, strsz);
+}
+
+/**
+ * fu_device_event_parse_binary:
+ * @self: a #FuDeviceEvent
+ * @blob: a #GBytes
+ * @error: (nullable): optional return location for an error
+ *
+ * Parses an event written using fu_device_event_append_binary(). Any binary values reference
+ * @blob rather than being copied, and so @blob may be a mapped file.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.0.9
+ **/
+gboolean
+fu_device_event_parse_binary(FuDeviceEvent *self, GBytes *blob, GError **error)
+{
+	gsize bufsz = 0;
+	gsize offset = 0;
+	guint32 idsz = 0;
+	const guint8 *buf = g_bytes_get_data(blob, &bufsz);
+
+	g_return_val_if_fail(FU_IS_DEVICE_EVENT(self), FALSE);
+	g_return_val_if_fail(blob != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* ID, which is either the uncompressed ID or the hash */
+	if (!fu_memread_uint32_safe(buf, bufsz, offset, &idsz, G_LITTLE_ENDIAN, error))
+		return FALSE;
+	offset += sizeof(idsz);
+	if (idsz > 0) {
+		g_autofree gchar *id = fu_device_event_read_binary_str(blob, offset, idsz, error);
+		if (id == NULL)
+			return FALSE;
+		fu_device_event_set_id(self, id);
+		offset += idsz;
+	}
+
+	/* values */
+	while (offset < bufsz) {
+		guint8 kind = 0;
+		guint16 keysz = 0;
+		guint32 datasz = 0;
+		g_autofree gchar *key = NULL;
+		g_autoptr(GBytes) data = NULL;
+
+		if (!fu_memread_uint8_safe(buf, bufsz, offset, &kind, error))
+			return FALSE;
+		offset += sizeof(kind);
+		if (!fu_memread_uint16_safe(buf, bufsz, offset, &keysz, G_LITTLE_ENDIAN, error))
+			return FALSE;
+		offset += sizeof(keysz);
+		if (keysz == 0) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_DATA,
+					    "event value has no key");
+			return FALSE;
+		}
+		key = fu_device_event_read_binary_str(blob, offset, keysz, error);
+		if (key == NULL)
+			return FALSE;
+		offset += keysz;
+		if (!fu_memread_uint32_safe(buf, bufsz, offset, &datasz, G_LITTLE_ENDIAN, error))
+			return FALSE;
+		offset += sizeof(datasz);
+		data = fu_bytes_new_offset(blob, offset, datasz, error);
+		if (data == NULL)
+			return FALSE;
+
+		if (kind == FU_DEVICE_EVENT_VALUE_KIND_STRING) {
+			g_autofree gchar *str =
+			    fu_device_event_read_binary_str(blob, offset, datasz, error);
+			if (str == NULL)
+				return FALSE;
+			fu_device_event_set_str(self, key, str);
+		} else if (kind == FU_DEVICE_EVENT_VALUE_KIND_INT64) {
+			if (datasz != sizeof(guint64)) {
+				g_set_error(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_DATA,
+					    "invalid size 0x%x for %s",
+					    (guint)datasz,
+					    key);
+				return FALSE;
+			}
+			fu_device_event_set_i64(self,
+						key,
+						(gint64)fu_memread_uint64(buf + offset,
+									  G_LITTLE_ENDIAN));
+		} else if (kind == FU_DEVICE_EVENT_VALUE_KIND_BYTES) {
+			fu_device_event_set_bytes(self, key, data);
+		} else {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "invalid event value kind 0x%x for key %s",
+				    kind,
+				    key);
+			return FALSE;
+		}
+		offset += datasz;
+	}
+
+	/* success */
+	return TRUE;
+}
+
 static void
 fu_device_event_init(FuDeviceEvent *self)
 {
@@ -99,3 +99,5 @@ fu_device_add_json(FuDevice *self, JsonBuilder *builder, FwupdCodecFlags flags)
     G_GNUC_NON_NULL(1, 2);
 gboolean
 fu_device_from_json(FuDevice *self, JsonObject *json_object, GError **error) G_GNUC_NON_NULL(1, 2);
+const gchar *
+fu_device_get_events_member(FuDevice *self) G_GNUC_NON_NULL(1);
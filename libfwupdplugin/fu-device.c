@@ -71,6 +71,10 @@ typedef struct {
 	GPtrArray *parent_backend_ids;	/* (nullable) */
 	GPtrArray *events;		/* (nullable) (element-type FuDeviceEvent) */
 	guint event_idx;
+	GHashTable *events_index;	/* (nullable) id_hash:FuDeviceEventIndexItem */
+	guint events_indexed;
+	guint events_generation;	/* incremented when event_idx goes back to zero */
+	GHashTable *event_id_hashes;	/* (nullable) id:id_hash */
 	guint remove_delay;    /* ms */
 	guint acquiesce_delay; /* ms */
 	guint request_cnts[FWUPD_REQUEST_KIND_LAST];
@@ -113,11 +117,20 @@ typedef struct {
 } FuDeviceInhibit;
 
 typedef struct {
-	gchar *instance_id;
-	gchar *guid;
+	gchar *instance_id; /* (nullable) */
+	fwupd_guid_t guid;
 	FuDeviceInstanceFlag flags;
 } FuDeviceInstanceIdItem;
 
+typedef struct {
+	GArray *positions; /* (element-type guint), ascending */
+	guint cursor;	   /* first position that might be >= event_idx */
+	guint generation;
+} FuDeviceEventIndexItem;
+
+/* the number of unique event IDs to remember the hash for */
+#define FU_DEVICE_EVENT_ID_HASHES_MAX 1024
+
 enum {
 	PROP_0,
 	PROP_PHYSICAL_ID,
@@ -2542,21 +2555,39 @@ static void
 fu_device_instance_id_free(FuDeviceInstanceIdItem *item)
 {
 	g_free(item->instance_id);
-	g_free(item->guid);
 	g_free(item);
 }
 
+static gchar *
+fu_device_instance_id_item_get_guid(FuDeviceInstanceIdItem *item)
+{
+	return fwupd_guid_to_string(&item->guid, FWUPD_GUID_FLAG_NONE);
+}
+
+/* @guid is only set if @instance_id is a GUID, in which case it is compared in binary form */
+static gboolean
+fu_device_instance_id_item_matches(FuDeviceInstanceIdItem *item,
+				   const gchar *instance_id,
+				   const fwupd_guid_t *guid)
+{
+	if (g_strcmp0(instance_id, item->instance_id) == 0)
+		return TRUE;
+	return guid != NULL && memcmp(&item->guid, guid, sizeof(fwupd_guid_t)) == 0;
+}
+
 static FuDeviceInstanceIdItem *
 fu_device_get_instance_id(FuDevice *self, const gchar *instance_id)
 {
 	FuDevicePrivate *priv = GET_PRIVATE(self);
+	fwupd_guid_t guid = {0x0};
+	gboolean is_guid;
+
 	if (priv->instance_ids == NULL)
 		return NULL;
+	is_guid = fwupd_guid_from_string(instance_id, &guid, FWUPD_GUID_FLAG_NONE, NULL);
 	for (guint i = 0; i < priv->instance_ids->len; i++) {
 		FuDeviceInstanceIdItem *item = g_ptr_array_index(priv->instance_ids, i);
-		if (g_strcmp0(instance_id, item->instance_id) == 0)
-			return item;
-		if (g_strcmp0(instance_id, item->guid) == 0)
+		if (fu_device_instance_id_item_matches(item, instance_id, is_guid ? &guid : NULL))
 			return item;
 	}
 	return NULL;
@@ -2583,16 +2614,20 @@ gboolean
 fu_device_has_instance_id(FuDevice *self, const gchar *instance_id, FuDeviceInstanceFlag flags)
 {
 	FuDevicePrivate *priv = GET_PRIVATE(self);
+	fwupd_guid_t guid = {0x0};
+	gboolean is_guid;
 
 	g_return_val_if_fail(FU_IS_DEVICE(self), FALSE);
 	g_return_val_if_fail(instance_id != NULL, FALSE);
 
-	for (guint i = 0; priv->instance_ids != NULL && i < priv->instance_ids->len; i++) {
+	if (priv->instance_ids == NULL)
+		return FALSE;
+	is_guid = fwupd_guid_from_string(instance_id, &guid, FWUPD_GUID_FLAG_NONE, NULL);
+	for (guint i = 0; i < priv->instance_ids->len; i++) {
 		FuDeviceInstanceIdItem *item = g_ptr_array_index(priv->instance_ids, i);
 		if ((item->flags & flags) == 0)
 			continue;
-		if (g_strcmp0(item->instance_id, instance_id) == 0 ||
-		    g_strcmp0(item->guid, instance_id) == 0)
+		if (fu_device_instance_id_item_matches(item, instance_id, is_guid ? &guid : NULL))
 			return TRUE;
 	}
 	return FALSE;
@@ -2633,17 +2668,21 @@ fu_device_add_instance_id_full(FuDevice *self, const gchar *instance_id, FuDevic
 		if ((item->flags & FU_DEVICE_INSTANCE_FLAG_QUIRKS) == 0 &&
 		    (flags & FU_DEVICE_INSTANCE_FLAG_QUIRKS) > 0) {
 			/* visible -> visible+quirks */
-			fu_device_add_guid_quirks(self, item->guid);
+			g_autofree gchar *guid = fu_device_instance_id_item_get_guid(item);
+			fu_device_add_guid_quirks(self, guid);
 		}
 		item->flags |= flags;
 	} else {
+		g_autofree gchar *guid = NULL;
 		item = g_new0(FuDeviceInstanceIdItem, 1);
 		if (fwupd_guid_is_valid(instance_id)) {
-			item->guid = g_strdup(instance_id);
+			guid = g_strdup(instance_id);
 		} else {
 			item->instance_id = g_strdup(instance_id);
-			item->guid = fwupd_guid_hash_string(instance_id);
+			guid = fwupd_guid_hash_string(instance_id);
 		}
+		if (!fwupd_guid_from_string(guid, &item->guid, FWUPD_GUID_FLAG_NONE, NULL))
+			g_warning("%s is not a valid GUID", guid);
 		item->flags |= flags;
 		if (priv->instance_ids == NULL)
 			priv->instance_ids = g_ptr_array_new_with_free_func(
@@ -2651,15 +2690,18 @@ fu_device_add_instance_id_full(FuDevice *self, const gchar *instance_id, FuDevic
 		g_ptr_array_add(priv->instance_ids, item);
 
 		/* we want the quirks to match so the plugin is set */
-		if (flags & FU_DEVICE_INSTANCE_FLAG_QUIRKS)
-			fu_device_add_guid_quirks(self, item->guid);
+		if (flags & FU_DEVICE_INSTANCE_FLAG_QUIRKS) {
+			g_autofree gchar *guid = fu_device_instance_id_item_get_guid(item);
+			fu_device_add_guid_quirks(self, guid);
+		}
 	}
 
 	/* already done by ->setup(), so this must be ->registered() */
 	if (priv->done_setup) {
+		g_autofree gchar *guid = fu_device_instance_id_item_get_guid(item);
 		if (item->instance_id != NULL)
 			fwupd_device_add_instance_id(FWUPD_DEVICE(self), item->instance_id);
-		fwupd_device_add_guid(FWUPD_DEVICE(self), item->guid);
+		fwupd_device_add_guid(FWUPD_DEVICE(self), guid);
 	}
 }
 
@@ -2704,7 +2746,7 @@ fu_device_get_counterpart_guids(FuDevice *self)
 	for (guint i = 0; priv->instance_ids != NULL && i < priv->instance_ids->len; i++) {
 		FuDeviceInstanceIdItem *item = g_ptr_array_index(priv->instance_ids, i);
 		if (item->flags & FU_DEVICE_INSTANCE_FLAG_COUNTERPART)
-			g_ptr_array_add(guids, g_strdup(item->guid));
+			g_ptr_array_add(guids, fu_device_instance_id_item_get_guid(item));
 	}
 	return g_steal_pointer(&guids);
 }
@@ -4838,13 +4880,13 @@ fu_device_to_string_impl(FuDevice *self, guint idt, GString *str)
 	for (guint i = 0; priv->instance_ids != NULL && i < priv->instance_ids->len; i++) {
 		FuDeviceInstanceIdItem *item = g_ptr_array_index(priv->instance_ids, i);
 		g_autofree gchar *flags_str = fu_device_instance_flag_to_string_trunc(item->flags);
+		g_autofree gchar *guid = fu_device_instance_id_item_get_guid(item);
 		g_autofree gchar *title = g_strdup_printf("InstanceId[%s]", flags_str);
 		if (item->instance_id != NULL) {
-			g_autofree gchar *tmp2 =
-			    g_strdup_printf("%s ← %s", item->guid, item->instance_id);
+			g_autofree gchar *tmp2 = g_strdup_printf("%s ← %s", guid, item->instance_id);
 			fwupd_codec_string_append(str, idt, title, tmp2);
 		} else {
-			fwupd_codec_string_append(str, idt, title, item->guid);
+			fwupd_codec_string_append(str, idt, title, guid);
 		}
 	}
 	fwupd_codec_string_append(str, idt, "EquivalentId", priv->equivalent_id);
@@ -5866,7 +5908,7 @@ fu_device_rescan(FuDevice *self, GError **error)
 	if (priv->instance_ids != NULL)
 		g_ptr_array_set_size(priv->instance_ids, 0);
 	g_ptr_array_set_size(fu_device_get_instance_ids(self), 0);
-	g_ptr_array_set_size(fu_device_get_guids(self), 0);
+	g_object_set(self, "guids", NULL, NULL);
 
 	/* subclassed */
 	if (device_class->rescan != NULL) {
@@ -5932,6 +5974,7 @@ fu_device_convert_instance_ids(FuDevice *self)
 	if (priv->instance_ids != NULL) {
 		for (guint i = 0; i < priv->instance_ids->len; i++) {
 			FuDeviceInstanceIdItem *item = g_ptr_array_index(priv->instance_ids, i);
+			g_autofree gchar *guid = NULL;
 			if ((item->flags & FU_DEVICE_INSTANCE_FLAG_VISIBLE) == 0)
 				continue;
 			if ((item->flags & FU_DEVICE_INSTANCE_FLAG_GENERIC) > 0 &&
@@ -5940,7 +5983,8 @@ fu_device_convert_instance_ids(FuDevice *self)
 				continue;
 			if (item->instance_id != NULL)
 				fwupd_device_add_instance_id(FWUPD_DEVICE(self), item->instance_id);
-			fwupd_device_add_guid(FWUPD_DEVICE(self), item->guid);
+			guid = fu_device_instance_id_item_get_guid(item);
+			fwupd_device_add_guid(FWUPD_DEVICE(self), guid);
 		}
 	}
 
@@ -6310,10 +6354,12 @@ fu_device_incorporate_instance_ids(FuDevice *self, FuDevice *donor)
 		    fu_device_has_private_flag(self, FU_DEVICE_PRIVATE_FLAG_NO_GENERIC_GUIDS)) {
 			continue;
 		}
-		if (item->instance_id != NULL)
+		if (item->instance_id != NULL) {
 			fu_device_add_instance_id_full(self, item->instance_id, item->flags);
-		else
-			fu_device_add_instance_id_full(self, item->guid, item->flags);
+		} else {
+			g_autofree gchar *guid = fu_device_instance_id_item_get_guid(item);
+			fu_device_add_instance_id_full(self, guid, item->flags);
+		}
 	}
 }
 
@@ -7444,6 +7490,78 @@ fu_device_ensure_events(FuDevice *self)
 	priv->events = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 }
 
+static void
+fu_device_event_index_item_free(FuDeviceEventIndexItem *item)
+{
+	g_array_unref(item->positions);
+	g_free(item);
+}
+
+/* index any events added since the last call, which is normally all of them the first time */
+static void
+fu_device_ensure_events_index(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+
+	if (priv->events_index == NULL) {
+		priv->events_index =
+		    g_hash_table_new_full(g_str_hash,
+					  g_str_equal,
+					  g_free,
+					  (GDestroyNotify)fu_device_event_index_item_free);
+	}
+
+	/* something removed events from the array, so start again */
+	if (priv->events_indexed > priv->events->len) {
+		g_hash_table_remove_all(priv->events_index);
+		priv->events_indexed = 0;
+	}
+	for (guint i = priv->events_indexed; i < priv->events->len; i++) {
+		FuDeviceEvent *event = g_ptr_array_index(priv->events, i);
+		const gchar *id_hash = fu_device_event_get_id(event);
+		FuDeviceEventIndexItem *item;
+
+		if (id_hash == NULL)
+			continue;
+		item = g_hash_table_lookup(priv->events_index, id_hash);
+		if (item == NULL) {
+			item = g_new0(FuDeviceEventIndexItem, 1);
+			item->positions = g_array_new(FALSE, FALSE, sizeof(guint));
+			item->generation = priv->events_generation;
+			g_hash_table_insert(priv->events_index, g_strdup(id_hash), item);
+		}
+		g_array_append_val(item->positions, i);
+	}
+	priv->events_indexed = priv->events->len;
+}
+
+static void
+fu_device_clear_events_index(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	g_clear_pointer(&priv->events_index, g_hash_table_unref);
+	priv->events_indexed = 0;
+}
+
+/* emulations typically use the same few IDs many times, so avoid the SHA1 each time */
+static const gchar *
+fu_device_event_id_hash(FuDevice *self, const gchar *id)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	gchar *id_hash;
+
+	if (priv->event_id_hashes == NULL)
+		priv->event_id_hashes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	id_hash = g_hash_table_lookup(priv->event_id_hashes, id);
+	if (id_hash != NULL)
+		return id_hash;
+	if (g_hash_table_size(priv->event_id_hashes) >= FU_DEVICE_EVENT_ID_HASHES_MAX)
+		g_hash_table_remove_all(priv->event_id_hashes);
+	id_hash = fu_device_event_build_id(id);
+	g_hash_table_insert(priv->event_id_hashes, g_strdup(id), id_hash);
+	return id_hash;
+}
+
 /**
  * fu_device_add_event:
  * @self: a #FuDevice
@@ -7518,7 +7636,7 @@ FuDeviceEvent *
 fu_device_load_event(FuDevice *self, const gchar *id, GError **error)
 {
 	FuDevicePrivate *priv = GET_PRIVATE(self);
-	g_autofree gchar *id_hash = NULL;
+	FuDeviceEventIndexItem *item;
 
 	g_return_val_if_fail(FU_IS_DEVICE(self), NULL);
 	g_return_val_if_fail(id != NULL, NULL);
@@ -7538,30 +7656,35 @@ fu_device_load_event(FuDevice *self, const gchar *id, GError **error)
 	if (priv->event_idx >= priv->events->len) {
 		g_debug("resetting event index");
 		priv->event_idx = 0;
+		priv->events_generation++;
 	}
 
-	/* look for the next event in the sequence */
-	id_hash = fu_device_event_build_id(id);
-	for (guint i = priv->event_idx; i < priv->events->len; i++) {
-		FuDeviceEvent *event = g_ptr_array_index(priv->events, i);
-		if (g_strcmp0(fu_device_event_get_id(event), id_hash) == 0) {
+	/* look for the next event in the sequence, where each index cursor only moves forward
+	 * until the sequence restarts, so replaying in order is O(1) for each event */
+	fu_device_ensure_events_index(self);
+	item = g_hash_table_lookup(priv->events_index, fu_device_event_id_hash(self, id));
+	if (item != NULL) {
+		if (item->generation != priv->events_generation) {
+			item->generation = priv->events_generation;
+			item->cursor = 0;
+		}
+		while (item->cursor < item->positions->len &&
+		       g_array_index(item->positions, guint, item->cursor) < priv->event_idx)
+			item->cursor++;
+		if (item->cursor < item->positions->len) {
+			guint i = g_array_index(item->positions, guint, item->cursor++);
 			priv->event_idx = i + 1;
-			return event;
+			return g_ptr_array_index(priv->events, i);
 		}
-	}
 
-	/* look for *any* event that matches */
-	for (guint i = 0; i < priv->events->len; i++) {
-		FuDeviceEvent *event = g_ptr_array_index(priv->events, i);
-		if (g_strcmp0(fu_device_event_get_id(event), id_hash) == 0) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_FOUND,
-				    "found out-of-order event %s at position %u",
-				    id,
-				    i);
-			return NULL;
-		}
+		/* there is *an* event that matches, but earlier in the sequence */
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "found out-of-order event %s at position %u",
+			    id,
+			    g_array_index(item->positions, guint, 0));
+		return NULL;
 	}
 
 	/* nothing found */
@@ -7623,6 +7746,7 @@ fu_device_clear_events(FuDevice *self)
 		return;
 	g_ptr_array_set_size(priv->events, 0);
 	priv->event_idx = 0;
+	fu_device_clear_events_index(self);
 }
 
 /**
@@ -7702,6 +7826,18 @@ fu_device_from_json(FuDevice *self, JsonObject *json_object, GError **error)
 	return TRUE;
 }
 
+/* private; the JSON member the emulated events are saved into, e.g. `UsbEvents` */
+const gchar *
+fu_device_get_events_member(FuDevice *self)
+{
+	FuDeviceClass *device_class = FU_DEVICE_GET_CLASS(self);
+
+	/* subclassed */
+	if (device_class->get_events_member != NULL)
+		return device_class->get_events_member(self);
+	return "Events";
+}
+
 static void
 fu_device_dispose(GObject *object)
 {
@@ -8020,6 +8156,10 @@ fu_device_finalize(GObject *object)
 		g_ptr_array_unref(priv->parent_backend_ids);
 	if (priv->events != NULL)
 		g_ptr_array_unref(priv->events);
+	if (priv->events_index != NULL)
+		g_hash_table_unref(priv->events_index);
+	if (priv->event_id_hashes != NULL)
+		g_hash_table_unref(priv->event_id_hashes);
 	if (priv->retry_recs != NULL)
 		g_ptr_array_unref(priv->retry_recs);
 	if (priv->instance_ids != NULL)
@@ -95,6 +95,7 @@ struct _FuDeviceClass {
 	gboolean (*from_json)(FuDevice *self,
 			      JsonObject *json_object,
 			      GError **error) G_GNUC_WARN_UNUSED_RESULT;
+	const gchar *(*get_events_member)(FuDevice *self);
 #endif
 };
 
@@ -9,3 +9,10 @@ enum FuDeviceInstanceFlag {
     Generic = 1 << 2, // added by a baseclass
     Counterpart = 1 << 3,
 }
+
+#[repr(u8)]
+enum FuDeviceEventValueKind {
+    String = 0x01,
+    Int64 = 0x02,
+    Bytes = 0x03,
+}
@@ -76,22 +76,27 @@ fu_efi_device_path_list_parse(FuFirmware *firmware,
 	if (!fu_input_stream_size(stream, &streamsz, error))
 		return FALSE;
 	while (offset < streamsz) {
+		guint8 buf[FU_STRUCT_EFI_DEVICE_PATH_SIZE] = {0x0};
+		FuStructEfiDevicePath st_dp = {0x0};
 		g_autoptr(FuEfiDevicePath) efi_dp = NULL;
-		g_autoptr(GByteArray) st_dp = NULL;
 
 		/* parse the header so we can work out what GType to create */
-		st_dp = fu_struct_efi_device_path_parse_stream(stream, offset, error);
-		if (st_dp == NULL)
+		if (!fu_struct_efi_device_path_parse_stream_view(&st_dp,
+								 stream,
+								 offset,
+								 buf,
+								 sizeof(buf),
+								 error))
 			return FALSE;
-		if (fu_struct_efi_device_path_get_type(st_dp) == FU_EFI_DEVICE_PATH_TYPE_END)
+		if (fu_struct_efi_device_path_get_type(&st_dp) == FU_EFI_DEVICE_PATH_TYPE_END)
 			break;
-		if (fu_struct_efi_device_path_get_type(st_dp) == FU_EFI_DEVICE_PATH_TYPE_MEDIA &&
-		    fu_struct_efi_device_path_get_subtype(st_dp) ==
+		if (fu_struct_efi_device_path_get_type(&st_dp) == FU_EFI_DEVICE_PATH_TYPE_MEDIA &&
+		    fu_struct_efi_device_path_get_subtype(&st_dp) ==
 			FU_EFI_HARD_DRIVE_DEVICE_PATH_SUBTYPE_FILE_PATH) {
 			efi_dp = FU_EFI_DEVICE_PATH(fu_efi_file_path_device_path_new());
-		} else if (fu_struct_efi_device_path_get_type(st_dp) ==
+		} else if (fu_struct_efi_device_path_get_type(&st_dp) ==
 			       FU_EFI_DEVICE_PATH_TYPE_MEDIA &&
-			   fu_struct_efi_device_path_get_subtype(st_dp) ==
+			   fu_struct_efi_device_path_get_subtype(&st_dp) ==
 			       FU_EFI_HARD_DRIVE_DEVICE_PATH_SUBTYPE_HARD_DRIVE) {
 			efi_dp = FU_EFI_DEVICE_PATH(fu_efi_hard_drive_device_path_new());
 		} else {
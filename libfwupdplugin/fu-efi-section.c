@@ -94,7 +94,7 @@ fu_efi_section_parse_lzma_sections(FuEfiSection *self,
 		g_prefix_error(error, "failed to decompress: ");
 		return FALSE;
 	}
-	stream_uncomp = g_memory_input_stream_new_from_bytes(blob_uncomp);
+	stream_uncomp = fu_mapped_input_stream_new(blob_uncomp);
 	if (!fu_efi_parse_sections(FU_FIRMWARE(self), stream_uncomp, 0, flags, error)) {
 		g_prefix_error(error, "failed to parse sections: ");
 		return FALSE;
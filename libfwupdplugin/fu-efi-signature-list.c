@@ -291,7 +291,42 @@ fu_efi_signature_list_class_init(FuEfiSignatureListClass *klass)
 static void
 fu_efi_signature_list_init(FuEfiSignatureList *self)
 {
+	/* c1c41626-504c-4092-aca9-41f936934328 and a5c059a1-94e4-4aa7-87b5-ab155c2bf072 */
+	const guint8 magic_sha256[] = {0x26,
+				       0x16,
+				       0xc4,
+				       0xc1,
+				       0x4c,
+				       0x50,
+				       0x92,
+				       0x40,
+				       0xac,
+				       0xa9,
+				       0x41,
+				       0xf9,
+				       0x36,
+				       0x93,
+				       0x43,
+				       0x28};
+	const guint8 magic_x509[] = {0xa1,
+				     0x59,
+				     0xc0,
+				     0xa5,
+				     0xe4,
+				     0x94,
+				     0xa7,
+				     0x4a,
+				     0x87,
+				     0xb5,
+				     0xab,
+				     0x15,
+				     0x5c,
+				     0x2b,
+				     0xf0,
+				     0x72};
 	fu_firmware_add_flag(FU_FIRMWARE(self), FU_FIRMWARE_FLAG_ALWAYS_SEARCH);
+	fu_firmware_add_magic(FU_FIRMWARE(self), magic_sha256, sizeof(magic_sha256), 0);
+	fu_firmware_add_magic(FU_FIRMWARE(self), magic_x509, sizeof(magic_x509), 0);
 	fu_firmware_set_images_max(FU_FIRMWARE(self), 2000);
 	g_type_ensure(FU_TYPE_EFI_SIGNATURE);
 }
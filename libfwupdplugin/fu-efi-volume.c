@@ -314,7 +314,12 @@ static void
 fu_efi_volume_init(FuEfiVolume *self)
 {
 	FuEfiVolumePrivate *priv = GET_PRIVATE(self);
+	const guint8 magic[] = {'_', 'F', 'V', 'H'};
 	priv->attrs = 0xfeff;
+	fu_firmware_add_magic(FU_FIRMWARE(self),
+			      magic,
+			      sizeof(magic),
+			      FU_STRUCT_EFI_VOLUME_OFFSET_SIGNATURE);
 	g_type_ensure(FU_TYPE_EFI_FILESYSTEM);
 }
 
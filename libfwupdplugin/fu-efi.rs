@@ -258,7 +258,7 @@ enum FuEfiDevicePathType {
     End = 0x7F,
 }
 
-#[derive(ParseStream, New, Default)]
+#[derive(ParseStream, ParseStreamView, New, Default)]
 #[repr(C, packed)]
 struct FuStructEfiDevicePath {
     type: FuEfiDevicePathType,
@@ -14,6 +14,7 @@
 #include "fu-common.h"
 #include "fu-firmware.h"
 #include "fu-input-stream.h"
+#include "fu-mem-search.h"
 #include "fu-mem.h"
 #include "fu-partial-input-stream.h"
 #include "fu-string.h"
@@ -46,8 +47,14 @@ typedef struct {
 	gsize size_max;
 	guint images_max;
 	guint depth;
-	GPtrArray *chunks;  /* nullable, element-type FuChunk */
-	GPtrArray *patches; /* nullable, element-type FuFirmwarePatch */
+	GPtrArray *chunks;           /* nullable, element-type FuChunk */
+	GPtrArray *patches;          /* nullable, element-type FuFirmwarePatch */
+	FuMemSearch *magic;          /* nullable */
+	GArray *magic_offsets;       /* nullable, element-type gsize */
+	GHashTable *image_checksums; /* nullable, checksum:FuFirmware (noref) */
+	GChecksumType image_checksums_kind;
+	GHashTable *checksums;	/* nullable, GChecksumType:utf8 */
+	GMutex checksums_mutex; /* for checksums */
 } FuFirmwarePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE(FuFirmware, fu_firmware, G_TYPE_OBJECT)
@@ -620,6 +627,32 @@ fu_firmware_get_idx(FuFirmware *self)
 	return priv->idx;
 }
 
+/* the images, or the contents of an image, have changed */
+static void
+fu_firmware_invalidate_image_checksums(FuFirmware *self)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_clear_pointer(&priv->image_checksums, g_hash_table_unref);
+}
+
+static void
+fu_firmware_invalidate_parent_image_checksums(FuFirmware *self)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	if (priv->parent != NULL)
+		fu_firmware_invalidate_image_checksums(priv->parent);
+}
+
+/* the payload data has changed */
+static void
+fu_firmware_invalidate_checksums(FuFirmware *self)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->checksums_mutex);
+	g_clear_pointer(&priv->checksums, g_hash_table_unref);
+	fu_firmware_invalidate_parent_image_checksums(self);
+}
+
 /**
  * fu_firmware_set_bytes:
  * @self: a #FuPlugin
@@ -643,6 +676,7 @@ fu_firmware_set_bytes(FuFirmware *self, GBytes *bytes)
 
 	/* the input stream is no longer valid */
 	g_clear_object(&priv->stream);
+	fu_firmware_invalidate_checksums(self);
 }
 
 /**
@@ -770,7 +804,7 @@ fu_firmware_get_stream(FuFirmware *self, GError **error)
 	if (priv->stream != NULL)
 		return g_object_ref(priv->stream);
 	if (priv->bytes != NULL)
-		return g_memory_input_stream_new_from_bytes(priv->bytes);
+		return fu_mapped_input_stream_new(priv->bytes);
 	g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "no stream or bytes set");
 	return NULL;
 }
@@ -799,7 +833,8 @@ fu_firmware_set_stream(FuFirmware *self, GInputStream *stream, GError **error)
 	} else {
 		priv->streamsz = 0;
 	}
-	g_set_object(&priv->stream, stream);
+	if (g_set_object(&priv->stream, stream))
+		fu_firmware_invalidate_checksums(self);
 	return TRUE;
 }
 
@@ -887,6 +922,70 @@ fu_firmware_add_chunk(FuFirmware *self, FuChunk *chk)
 	g_ptr_array_add(priv->chunks, g_object_ref(chk));
 }
 
+/* does not use ->get_checksum() */
+static GPtrArray *
+fu_firmware_compute_checksums(FuFirmware *self,
+			      const GChecksumType *csum_kinds,
+			      guint csum_kinds_len,
+			      GError **error)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GArray) csum_kinds_new = g_array_new(FALSE, FALSE, sizeof(GChecksumType));
+	g_autoptr(GPtrArray) checksums = g_ptr_array_new_with_free_func(g_free);
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	/* write, which is not remembered as the properties may change */
+	if (priv->bytes == NULL && priv->stream == NULL) {
+		g_autoptr(GBytes) blob = fu_firmware_write(self, error);
+		if (blob == NULL)
+			return NULL;
+		for (guint i = 0; i < csum_kinds_len; i++) {
+			gchar *checksum = g_compute_checksum_for_bytes(csum_kinds[i], blob);
+			g_ptr_array_add(checksums, checksum);
+		}
+		return g_steal_pointer(&checksums);
+	}
+
+	/* only read the payload for checksums not already computed; the lock is held while reading
+	 * so that two threads do not read the same stream at the same time */
+	locker = g_mutex_locker_new(&priv->checksums_mutex);
+	if (priv->checksums == NULL) {
+		priv->checksums =
+		    g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+	}
+	for (guint i = 0; i < csum_kinds_len; i++) {
+		if (!g_hash_table_contains(priv->checksums, GINT_TO_POINTER(csum_kinds[i])))
+			g_array_append_val(csum_kinds_new, csum_kinds[i]);
+	}
+	if (csum_kinds_new->len > 0) {
+		g_autoptr(GInputStream) stream = NULL;
+		g_autoptr(GPtrArray) checksums_new = NULL;
+
+		stream = fu_firmware_get_stream(self, error);
+		if (stream == NULL)
+			return NULL;
+		checksums_new =
+		    fu_input_stream_compute_checksums(stream,
+						      (const GChecksumType *)csum_kinds_new->data,
+						      csum_kinds_new->len,
+						      error);
+		if (checksums_new == NULL)
+			return NULL;
+		for (guint i = 0; i < csum_kinds_new->len; i++) {
+			GChecksumType csum_kind = g_array_index(csum_kinds_new, GChecksumType, i);
+			g_hash_table_insert(priv->checksums,
+					    GINT_TO_POINTER(csum_kind),
+					    g_strdup(g_ptr_array_index(checksums_new, i)));
+		}
+	}
+	for (guint i = 0; i < csum_kinds_len; i++) {
+		const gchar *checksum =
+		    g_hash_table_lookup(priv->checksums, GINT_TO_POINTER(csum_kinds[i]));
+		g_ptr_array_add(checksums, g_strdup(checksum));
+	}
+	return g_steal_pointer(&checksums);
+}
+
 /**
  * fu_firmware_get_checksum:
  * @self: a #FuPlugin
@@ -902,9 +1001,8 @@ fu_firmware_add_chunk(FuFirmware *self, FuChunk *chk)
 gchar *
 fu_firmware_get_checksum(FuFirmware *self, GChecksumType csum_kind, GError **error)
 {
-	FuFirmwarePrivate *priv = GET_PRIVATE(self);
 	FuFirmwareClass *klass = FU_FIRMWARE_GET_CLASS(self);
-	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GPtrArray) checksums = NULL;
 
 	g_return_val_if_fail(FU_IS_FIRMWARE(self), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
@@ -921,17 +1019,55 @@ fu_firmware_get_checksum(FuFirmware *self, GChecksumType csum_kind, GError **err
 		}
 	}
 
-	/* internal data */
-	if (priv->bytes != NULL)
-		return g_compute_checksum_for_bytes(csum_kind, priv->bytes);
-	if (priv->stream != NULL)
-		return fu_input_stream_compute_checksum(priv->stream, csum_kind, error);
-
-	/* write */
-	blob = fu_firmware_write(self, error);
-	if (blob == NULL)
+	/* internal data, or written */
+	checksums = fu_firmware_compute_checksums(self, &csum_kind, 1, error);
+	if (checksums == NULL)
 		return NULL;
-	return g_compute_checksum_for_bytes(csum_kind, blob);
+	return g_strdup(g_ptr_array_index(checksums, 0));
+}
+
+/**
+ * fu_firmware_get_checksums:
+ * @self: a #FuPlugin
+ * @csum_kinds: (array length=csum_kinds_len): checksum types, e.g. %G_CHECKSUM_SHA256
+ * @csum_kinds_len: the number of elements in @csum_kinds
+ * @error: (nullable): optional return location for an error
+ *
+ * Returns multiple checksums of the payload data, reading the payload at most once.
+ *
+ * The checksums of the payload bytes or stream are remembered until the payload is changed, so
+ * calling fu_firmware_get_checksum() afterwards for any of @csum_kinds does not read the
+ * payload again.
+ *
+ * Returns: (transfer container) (element-type utf8): checksum strings in the same order as
+ * @csum_kinds, or %NULL if the checksums are not available
+ *
+ * Since: 2.0.9
+ **/
+GPtrArray *
+fu_firmware_get_checksums(FuFirmware *self,
+			  const GChecksumType *csum_kinds,
+			  guint csum_kinds_len,
+			  GError **error)
+{
+	FuFirmwareClass *klass = FU_FIRMWARE_GET_CLASS(self);
+	g_autoptr(GPtrArray) checksums = g_ptr_array_new_with_free_func(g_free);
+
+	g_return_val_if_fail(FU_IS_FIRMWARE(self), NULL);
+	g_return_val_if_fail(csum_kinds != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* subclassed, so each checksum may be computed differently */
+	if (klass->get_checksum != NULL) {
+		for (guint i = 0; i < csum_kinds_len; i++) {
+			gchar *checksum = fu_firmware_get_checksum(self, csum_kinds[i], error);
+			if (checksum == NULL)
+				return NULL;
+			g_ptr_array_add(checksums, checksum);
+		}
+		return g_steal_pointer(&checksums);
+	}
+	return fu_firmware_compute_checksums(self, csum_kinds, csum_kinds_len, error);
 }
 
 /**
@@ -1007,6 +1143,7 @@ fu_firmware_validate_for_offset(FuFirmware *self,
 				GError **error)
 {
 	FuFirmwareClass *klass = FU_FIRMWARE_GET_CLASS(self);
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
 	gsize streamsz = 0;
 
 	/* not implemented */
@@ -1036,6 +1173,38 @@ fu_firmware_validate_for_offset(FuFirmware *self,
 		return TRUE;
 	}
 
+	/* only try the offsets where the magic was actually found */
+	if (priv->magic != NULL) {
+		gsize offset_search = *offset;
+		while (offset_search < streamsz) {
+			gsize offset_found = 0;
+			gsize offset_magic;
+			guint idx = 0;
+
+			if (!fu_mem_search_find_stream(priv->magic,
+						       stream,
+						       offset_search,
+						       &offset_found,
+						       &idx,
+						       NULL))
+				break;
+			offset_search = offset_found + 1;
+			offset_magic = g_array_index(priv->magic_offsets, gsize, idx);
+			if (offset_found < *offset + offset_magic)
+				continue;
+			if (klass->validate(self, stream, offset_found - offset_magic, NULL)) {
+				fu_firmware_set_offset(self, offset_found - offset_magic);
+				*offset = offset_found - offset_magic;
+				return TRUE;
+			}
+		}
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "did not find magic");
+		return FALSE;
+	}
+
 	/* increment the offset, looking for the magic */
 	for (gsize offset_tmp = *offset; offset_tmp < streamsz; offset_tmp++) {
 		if (klass->validate(self, stream, offset_tmp, NULL)) {
@@ -1146,6 +1315,9 @@ fu_firmware_parse_stream(FuFirmware *self,
 		}
 	}
 
+	/* the checksum is going to change */
+	fu_firmware_invalidate_checksums(self);
+
 	/* cache */
 	if (flags & FU_FIRMWARE_PARSE_FLAG_CACHE_BLOB) {
 		g_autoptr(GBytes) blob = NULL;
@@ -1212,7 +1384,7 @@ fu_firmware_parse_bytes(FuFirmware *self,
 	g_return_val_if_fail(fw != NULL, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	stream = g_memory_input_stream_new_from_bytes(fw);
+	stream = fu_mapped_input_stream_new(fw);
 	return fu_firmware_parse_stream(self, stream, offset, flags, error);
 }
 
@@ -1605,6 +1777,9 @@ fu_firmware_add_patch(FuFirmware *self, gsize offset, GBytes *blob)
 	g_return_if_fail(FU_IS_FIRMWARE(self));
 	g_return_if_fail(blob != NULL);
 
+	/* the written image may now have a different checksum */
+	fu_firmware_invalidate_parent_image_checksums(self);
+
 	/* ensure exists */
 	if (priv->patches == NULL) {
 		priv->patches =
@@ -1807,6 +1982,7 @@ fu_firmware_add_image_full(FuFirmware *self, FuFirmware *img, GError **error)
 			}
 		}
 	}
+	fu_firmware_invalidate_image_checksums(self);
 
 	/* sanity check */
 	if (priv->images_max > 0 && priv->images->len >= priv->images_max) {
@@ -1855,6 +2031,39 @@ fu_firmware_add_image(FuFirmware *self, FuFirmware *img)
 		g_critical("failed to add image: %s", error_local->message);
 }
 
+/**
+ * fu_firmware_add_magic:
+ * @self: a #FuFirmware
+ * @buf: magic bytes
+ * @bufsz: size of @buf
+ * @offset: offset of the magic from the start of the firmware
+ *
+ * Adds a magic value that the `->validate()` vfunc checks for. When searching for the start of
+ * the firmware only the offsets where any registered magic is found are validated, rather than
+ * every byte of the stream.
+ *
+ * This should be called in the subclass `_init()` function, and must only be used when the
+ * `->validate()` vfunc always fails if none of the magic values are present.
+ *
+ * Since: 2.0.9
+ **/
+void
+fu_firmware_add_magic(FuFirmware *self, const guint8 *buf, gsize bufsz, gsize offset)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+
+	g_return_if_fail(FU_IS_FIRMWARE(self));
+	g_return_if_fail(buf != NULL);
+	g_return_if_fail(bufsz > 0);
+
+	if (priv->magic == NULL) {
+		priv->magic = fu_mem_search_new();
+		priv->magic_offsets = g_array_new(FALSE, FALSE, sizeof(gsize));
+	}
+	fu_mem_search_add_needle(priv->magic, buf, bufsz);
+	g_array_append_val(priv->magic_offsets, offset);
+}
+
 /**
  * fu_firmware_set_images_max:
  * @self: a #FuPlugin
@@ -1911,8 +2120,10 @@ fu_firmware_remove_image(FuFirmware *self, FuFirmware *img, GError **error)
 	g_return_val_if_fail(FU_IS_FIRMWARE(img), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	if (g_ptr_array_remove(priv->images, img))
+	if (g_ptr_array_remove(priv->images, img)) {
+		fu_firmware_invalidate_image_checksums(self);
 		return TRUE;
+	}
 
 	/* did not exist */
 	g_set_error(error,
@@ -1948,6 +2159,7 @@ fu_firmware_remove_image_by_idx(FuFirmware *self, guint64 idx, GError **error)
 	if (img == NULL)
 		return FALSE;
 	g_ptr_array_remove(priv->images, img);
+	fu_firmware_invalidate_image_checksums(self);
 	return TRUE;
 }
 
@@ -1976,6 +2188,7 @@ fu_firmware_remove_image_by_id(FuFirmware *self, const gchar *id, GError **error
 	if (img == NULL)
 		return FALSE;
 	g_ptr_array_remove(priv->images, img);
+	fu_firmware_invalidate_image_checksums(self);
 	return TRUE;
 }
 
@@ -2131,6 +2344,42 @@ fu_firmware_get_image_by_idx(FuFirmware *self, guint64 idx, GError **error)
 	return NULL;
 }
 
+/* index the images so that looking up each signature in a large dbx is not quadratic */
+static void
+fu_firmware_ensure_image_checksums(FuFirmware *self, GChecksumType csum_kind)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GHashTable) image_checksums = NULL;
+
+	/* already valid */
+	if (priv->image_checksums != NULL && priv->image_checksums_kind == csum_kind)
+		return;
+
+	image_checksums = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	for (guint i = 0; i < priv->images->len; i++) {
+		FuFirmware *img = g_ptr_array_index(priv->images, i);
+		g_autofree gchar *checksum_tmp = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		/* if this expensive then the subclassed FuFirmware can
+		 * cache the result as required */
+		checksum_tmp = fu_firmware_get_checksum(img, csum_kind, &error_local);
+		if (checksum_tmp == NULL) {
+			g_debug("ignoring image %u as no checksum: %s", i, error_local->message);
+			continue;
+		}
+
+		/* the first image wins */
+		if (g_hash_table_contains(image_checksums, checksum_tmp))
+			continue;
+		g_hash_table_insert(image_checksums, g_steal_pointer(&checksum_tmp), img);
+	}
+	if (priv->image_checksums != NULL)
+		g_hash_table_unref(priv->image_checksums);
+	priv->image_checksums = g_steal_pointer(&image_checksums);
+	priv->image_checksums_kind = csum_kind;
+}
+
 /**
  * fu_firmware_get_image_by_checksum:
  * @self: a #FuPlugin
@@ -2148,6 +2397,7 @@ FuFirmware *
 fu_firmware_get_image_by_checksum(FuFirmware *self, const gchar *checksum, GError **error)
 {
 	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	FuFirmware *img;
 	GChecksumType csum_kind;
 
 	g_return_val_if_fail(FU_IS_FIRMWARE(self), NULL);
@@ -2155,18 +2405,10 @@ fu_firmware_get_image_by_checksum(FuFirmware *self, const gchar *checksum, GErro
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
 	csum_kind = fwupd_checksum_guess_kind(checksum);
-	for (guint i = 0; i < priv->images->len; i++) {
-		FuFirmware *img = g_ptr_array_index(priv->images, i);
-		g_autofree gchar *checksum_tmp = NULL;
-
-		/* if this expensive then the subclassed FuFirmware can
-		 * cache the result as required */
-		checksum_tmp = fu_firmware_get_checksum(img, csum_kind, error);
-		if (checksum_tmp == NULL)
-			return NULL;
-		if (g_strcmp0(checksum_tmp, checksum) == 0)
-			return g_object_ref(img);
-	}
+	fu_firmware_ensure_image_checksums(self, csum_kind);
+	img = g_hash_table_lookup(priv->image_checksums, checksum);
+	if (img != NULL)
+		return g_object_ref(img);
 	g_set_error(error,
 		    FWUPD_ERROR,
 		    FWUPD_ERROR_NOT_FOUND,
@@ -2482,6 +2724,7 @@ fu_firmware_init(FuFirmware *self)
 {
 	FuFirmwarePrivate *priv = GET_PRIVATE(self);
 	priv->images = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_mutex_init(&priv->checksums_mutex);
 }
 
 static void
@@ -2500,6 +2743,15 @@ fu_firmware_finalize(GObject *object)
 		g_ptr_array_unref(priv->chunks);
 	if (priv->patches != NULL)
 		g_ptr_array_unref(priv->patches);
+	if (priv->magic != NULL)
+		g_object_unref(priv->magic);
+	if (priv->magic_offsets != NULL)
+		g_array_unref(priv->magic_offsets);
+	if (priv->image_checksums != NULL)
+		g_hash_table_unref(priv->image_checksums);
+	if (priv->checksums != NULL)
+		g_hash_table_unref(priv->checksums);
+	g_mutex_clear(&priv->checksums_mutex);
 	if (priv->parent != NULL)
 		g_object_remove_weak_pointer(G_OBJECT(priv->parent), (gpointer *)&priv->parent);
 	g_ptr_array_unref(priv->images);
@@ -372,6 +372,9 @@ fu_firmware_set_size_max(FuFirmware *self, gsize size_max) G_GNUC_NON_NULL(1);
 gsize
 fu_firmware_get_size_max(FuFirmware *self) G_GNUC_NON_NULL(1);
 void
+fu_firmware_add_magic(FuFirmware *self, const guint8 *buf, gsize bufsz, gsize offset)
+    G_GNUC_NON_NULL(1, 2);
+void
 fu_firmware_set_images_max(FuFirmware *self, guint images_max) G_GNUC_NON_NULL(1);
 guint
 fu_firmware_get_images_max(FuFirmware *self) G_GNUC_NON_NULL(1);
@@ -446,6 +449,11 @@ fu_firmware_write_file(FuFirmware *self, GFile *file, GError **error) G_GNUC_WAR
 gchar *
 fu_firmware_get_checksum(FuFirmware *self, GChecksumType csum_kind, GError **error)
     G_GNUC_NON_NULL(1);
+GPtrArray *
+fu_firmware_get_checksums(FuFirmware *self,
+			  const GChecksumType *csum_kinds,
+			  guint csum_kinds_len,
+			  GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
 gboolean
 fu_firmware_check_compatible(FuFirmware *self,
 			     FuFirmware *other,
@@ -83,6 +83,9 @@ main(int argc, char **argv)
 	if (do_list && argc > 1) {
 		g_autofree gchar *str = NULL;
 		g_autoptr(GFile) file = g_file_new_for_path(argv[1]);
+
+		/* the file contents are not required */
+		fu_cab_firmware_set_lazy_decompress(cab_firmware, TRUE);
 		if (!fu_firmware_parse_file(FU_FIRMWARE(cab_firmware),
 					    file,
 					    FU_FIRMWARE_PARSE_FLAG_NONE,
@@ -34,13 +34,28 @@ struct _FuHwids {
 	GObject parent_instance;
 	GHashTable *hash_values;	 /* BiosVersion->"1.2.3 " */
 	GHashTable *hash_values_display; /* BiosVersion->"1.2.3" */
-	GHashTable *hash_guid;		 /* a-c-b-d->1 */
+	GHashTable *hash_guid;		 /* (element-type fwupd_guid_t) */
 	GPtrArray *array_guids;		 /* a-c-b-d */
 	GHashTable *chids;		 /* "HardwareID-5"->"Manufacturer&ProductName" */
 };
 
 G_DEFINE_TYPE(FuHwids, fu_hwids, G_TYPE_OBJECT)
 
+/* the GUIDs are hashes, so any four bytes are well distributed */
+static guint
+fu_hwids_guid_hash(gconstpointer key)
+{
+	guint32 tmp = 0;
+	memcpy(&tmp, key, sizeof(tmp)); /* nocheck:blocked */
+	return tmp;
+}
+
+static gboolean
+fu_hwids_guid_equal(gconstpointer a, gconstpointer b)
+{
+	return memcmp(a, b, sizeof(fwupd_guid_t)) == 0;
+}
+
 /**
  * fu_hwids_get_value:
  * @self: a #FuHwids
@@ -73,7 +88,10 @@ fu_hwids_get_value(FuHwids *self, const gchar *key)
 gboolean
 fu_hwids_has_guid(FuHwids *self, const gchar *guid)
 {
-	return g_hash_table_lookup(self->hash_guid, guid) != NULL;
+	fwupd_guid_t guid_bin = {0x0};
+	if (!fwupd_guid_from_string(guid, &guid_bin, FWUPD_GUID_FLAG_NONE, NULL))
+		return FALSE;
+	return g_hash_table_contains(self->hash_guid, &guid_bin);
 }
 
 /**
@@ -354,9 +372,17 @@ fu_hwids_get_guid(FuHwids *self, const gchar *keys, GError **error)
 void
 fu_hwids_add_guid(FuHwids *self, const gchar *guid)
 {
+	fwupd_guid_t guid_bin = {0x0};
+	g_autoptr(GError) error_local = NULL;
+
 	g_return_if_fail(FU_IS_HWIDS(self));
 	g_return_if_fail(guid != NULL);
-	g_hash_table_insert(self->hash_guid, g_strdup(guid), GUINT_TO_POINTER(1));
+
+	if (!fwupd_guid_from_string(guid, &guid_bin, FWUPD_GUID_FLAG_NONE, &error_local)) {
+		g_warning("ignoring HWID %s: %s", guid, error_local->message);
+		return;
+	}
+	g_hash_table_add(self->hash_guid, g_memdup2(&guid_bin, sizeof(guid_bin)));
 	g_ptr_array_add(self->array_guids, g_strdup(guid));
 }
 
@@ -425,7 +451,7 @@ fu_hwids_init(FuHwids *self)
 {
 	self->hash_values = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
 	self->hash_values_display = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
-	self->hash_guid = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	self->hash_guid = g_hash_table_new_full(fu_hwids_guid_hash, fu_hwids_guid_equal, g_free, NULL);
 	self->chids = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
 	self->array_guids = g_ptr_array_new_with_free_func(g_free);
 
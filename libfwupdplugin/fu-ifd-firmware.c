@@ -447,6 +447,13 @@ static void
 fu_ifd_firmware_init(FuIfdFirmware *self)
 {
 	FuIfdFirmwarePrivate *priv = GET_PRIVATE(self);
+	const guint8 magic[] = {0x5A, 0xA5, 0xF0, 0x0F};
+
+	/* only validate where the FDBAR signature is found */
+	fu_firmware_add_magic(FU_FIRMWARE(self),
+			      magic,
+			      sizeof(magic),
+			      FU_STRUCT_IFD_FDBAR_OFFSET_SIGNATURE);
 
 	/* some good defaults */
 	priv->new_layout = TRUE;
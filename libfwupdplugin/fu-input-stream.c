@@ -8,12 +8,46 @@
 
 #include "config.h"
 
+#include <glib/gstdio.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 #include "fu-chunk-array.h"
 #include "fu-crc-private.h"
 #include "fu-input-stream.h"
+#include "fu-mapped-input-stream.h"
 #include "fu-mem-private.h"
+#include "fu-mem-search.h"
+#include "fu-partial-input-stream-private.h"
+#include "fu-path.h"
 #include "fu-sum.h"
 
+/* a mapping raises SIGBUS if the file is truncated and keeps the volume busy, so only map
+ * files in our own directories that nobody else can write to */
+static gboolean
+fu_input_stream_path_is_mappable(const gchar *path)
+{
+	FuPathKind path_kinds[] = {FU_PATH_KIND_CACHEDIR_PKG, FU_PATH_KIND_LOCALSTATEDIR_PKG};
+	GStatBuf statbuf = {0};
+	g_autoptr(GFile) file = NULL;
+
+	if (g_stat(path, &statbuf) != 0 || !S_ISREG(statbuf.st_mode))
+		return FALSE;
+#ifndef _WIN32
+	if (statbuf.st_uid != geteuid() || (statbuf.st_mode & (S_IWGRP | S_IWOTH)) != 0)
+		return FALSE;
+#endif
+	file = g_file_new_for_path(path);
+	for (guint i = 0; i < G_N_ELEMENTS(path_kinds); i++) {
+		g_autofree gchar *dirname = fu_path_from_kind(path_kinds[i]);
+		g_autoptr(GFile) file_dir = g_file_new_for_path(dirname);
+		if (g_file_has_prefix(file, file_dir))
+			return TRUE;
+	}
+	return FALSE;
+}
+
 /**
  * fu_input_stream_from_path:
  * @path: a filename
@@ -21,6 +55,11 @@
  *
  * Opens the file as n input stream.
  *
+ * Regular files in the package cache and local state directories that are owned by the
+ * daemon are mapped into memory, and so reading from the stream using
+ * fu_input_stream_read_bytes() does not copy the data. All other files, for instance on
+ * removable media or the ESP, are read normally.
+ *
  * Returns: (transfer full): a #GInputStream, or %NULL on error
  *
  * Since: 2.0.0
@@ -34,6 +73,10 @@ fu_input_stream_from_path(const gchar *path, GError **error)
 	g_return_val_if_fail(path != NULL, NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
+	/* map files we own so that the data is not copied when read */
+	if (fu_input_stream_path_is_mappable(path))
+		return fu_mapped_input_stream_new_from_path(path, error);
+
 	file = g_file_new_for_path(path);
 	stream = g_file_read(file, NULL, error);
 	if (stream == NULL)
@@ -41,6 +84,30 @@ fu_input_stream_from_path(const gchar *path, GError **error)
 	return G_INPUT_STREAM(g_steal_pointer(&stream));
 }
 
+/* the data backing @stream, with @offset and @count adjusted to be relative to it */
+static GBytes *
+fu_input_stream_lookup_mapped_bytes(GInputStream *stream, gsize *offset, gsize *count)
+{
+	GBytes *bytes;
+
+	while (FU_IS_PARTIAL_INPUT_STREAM(stream)) {
+		FuPartialInputStream *partial_stream = FU_PARTIAL_INPUT_STREAM(stream);
+		gsize size = fu_partial_input_stream_get_size(partial_stream);
+		if (*offset >= size)
+			return NULL;
+		*count = MIN(*count, size - *offset);
+		*offset += fu_partial_input_stream_get_offset(partial_stream);
+		stream = fu_partial_input_stream_get_base_stream(partial_stream);
+	}
+	if (!FU_IS_MAPPED_INPUT_STREAM(stream))
+		return NULL;
+	bytes = fu_mapped_input_stream_get_bytes(FU_MAPPED_INPUT_STREAM(stream));
+	if (*offset >= g_bytes_get_size(bytes))
+		return NULL;
+	*count = MIN(*count, g_bytes_get_size(bytes) - *offset);
+	return bytes;
+}
+
 /**
  * fu_input_stream_read_safe:
  * @stream: a #GInputStream
@@ -74,6 +141,24 @@ fu_input_stream_read_safe(GInputStream *stream,
 
 	if (!fu_memchk_write(bufsz, offset, count, error))
 		return FALSE;
+
+	/* no need to read */
+	if (count > 0) {
+		gsize offset_mapped = seek_set;
+		gsize count_mapped = count;
+		GBytes *bytes =
+		    fu_input_stream_lookup_mapped_bytes(stream, &offset_mapped, &count_mapped);
+		if (bytes != NULL && count_mapped == count) {
+			const guint8 *data = g_bytes_get_data(bytes, NULL);
+			memcpy(buf + offset, data + offset_mapped, count); /* nocheck:blocked */
+			return g_seekable_seek(G_SEEKABLE(stream),
+					       seek_set + count,
+					       G_SEEK_SET,
+					       NULL,
+					       error);
+		}
+	}
+
 	if (!g_seekable_seek(G_SEEKABLE(stream), seek_set, G_SEEK_SET, NULL, error)) {
 		g_prefix_error(error, "seek to 0x%x: ", (guint)seek_set);
 		return FALSE;
@@ -341,6 +426,9 @@ fu_input_stream_read_byte_array(GInputStream *stream,
  *
  * Read a #GBytes from a stream in a safe way.
  *
+ * If @stream is a #FuMappedInputStream, or a #FuPartialInputStream of one, then the returned
+ * #GBytes references the mapped data rather than being a copy.
+ *
  * NOTE: The returned buffer may be smaller than @count!
  *
  * Returns: (transfer full): buffer
@@ -358,6 +446,24 @@ fu_input_stream_read_bytes(GInputStream *stream,
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
 	g_return_val_if_fail(progress == NULL || FU_IS_PROGRESS(progress), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* return a view of the mapped data rather than a copy */
+	if (count > 0) {
+		gsize offset_mapped = offset;
+		gsize count_mapped = count;
+		GBytes *bytes =
+		    fu_input_stream_lookup_mapped_bytes(stream, &offset_mapped, &count_mapped);
+		if (bytes != NULL) {
+			if (!g_seekable_seek(G_SEEKABLE(stream),
+					     offset + count_mapped,
+					     G_SEEK_SET,
+					     NULL,
+					     error))
+				return NULL;
+			return g_bytes_new_from_bytes(bytes, offset_mapped, count_mapped);
+		}
+	}
+
 	buf = fu_input_stream_read_byte_array(stream, offset, count, progress, error);
 	if (buf == NULL)
 		return NULL;
@@ -472,6 +578,59 @@ fu_input_stream_compute_checksum(GInputStream *stream, GChecksumType checksum_ty
 	return g_strdup(g_checksum_get_string(csum));
 }
 
+static gboolean
+fu_input_stream_compute_checksums_cb(const guint8 *buf,
+				     gsize bufsz,
+				     gpointer user_data,
+				     GError **error)
+{
+	GPtrArray *csums = (GPtrArray *)user_data;
+	for (guint i = 0; i < csums->len; i++) {
+		GChecksum *csum = g_ptr_array_index(csums, i);
+		g_checksum_update(csum, buf, bufsz);
+	}
+	return TRUE;
+}
+
+/**
+ * fu_input_stream_compute_checksums:
+ * @stream: a #GInputStream
+ * @checksum_types: (array length=checksum_types_len): #GChecksumType values
+ * @checksum_types_len: the number of elements in @checksum_types
+ * @error: (nullable): optional return location for an error
+ *
+ * Generates multiple checksums of the entire stream, reading the stream only once.
+ *
+ * Returns: (transfer container) (element-type utf8): the hexadecimal representation of each
+ * checksum in the same order as @checksum_types, or %NULL on error
+ *
+ * Since: 2.0.9
+ **/
+GPtrArray *
+fu_input_stream_compute_checksums(GInputStream *stream,
+				  const GChecksumType *checksum_types,
+				  guint checksum_types_len,
+				  GError **error)
+{
+	g_autoptr(GPtrArray) checksums = g_ptr_array_new_with_free_func(g_free);
+	g_autoptr(GPtrArray) csums = NULL;
+
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(checksum_types != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	csums = g_ptr_array_new_with_free_func((GDestroyNotify)g_checksum_free);
+	for (guint i = 0; i < checksum_types_len; i++)
+		g_ptr_array_add(csums, g_checksum_new(checksum_types[i]));
+	if (!fu_input_stream_chunkify(stream, fu_input_stream_compute_checksums_cb, csums, error))
+		return NULL;
+	for (guint i = 0; i < csums->len; i++) {
+		GChecksum *csum = g_ptr_array_index(csums, i);
+		g_ptr_array_add(checksums, g_strdup(g_checksum_get_string(csum)));
+	}
+	return g_steal_pointer(&checksums);
+}
+
 static gboolean
 fu_input_stream_compute_sum8_cb(const guint8 *buf, gsize bufsz, gpointer user_data, GError **error)
 {
@@ -714,6 +873,8 @@ fu_input_stream_chunkify(GInputStream *stream,
  *
  * Find a memory buffer within an input stream, without loading the entire stream into a buffer.
  *
+ * Use a #FuMemSearch directly to search for more than one buffer in a single pass.
+ *
  * Returns: %TRUE if @buf was found
  *
  * Since: 2.0.0
@@ -725,55 +886,21 @@ fu_input_stream_find(GInputStream *stream,
 		     gsize *offset,
 		     GError **error)
 {
-	g_autoptr(GByteArray) buf_acc = g_byte_array_new();
-	const gsize blocksz = 0x10000;
-	gsize offset_add = 0;
-	gsize offset_cur = 0;
+	g_autoptr(FuMemSearch) search = fu_mem_search_new();
 
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
 	g_return_val_if_fail(buf != NULL, FALSE);
 	g_return_val_if_fail(bufsz != 0, FALSE);
-	g_return_val_if_fail(bufsz < blocksz, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	while (offset_cur < bufsz) {
-		g_autoptr(GByteArray) buf_tmp = NULL;
-		g_autoptr(GError) error_local = NULL;
-
-		/* read more data */
-		buf_tmp = fu_input_stream_read_byte_array(stream,
-							  offset_cur,
-							  blocksz,
-							  NULL,
-							  &error_local);
-		if (buf_tmp == NULL) {
-			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE))
-				break;
-			g_propagate_error(error, g_steal_pointer(&error_local));
-			return FALSE;
-		}
-		g_byte_array_append(buf_acc, buf_tmp->data, buf_tmp->len);
-
-		/* we found something */
-		if (fu_memmem_safe(buf_acc->data, buf_acc->len, buf, bufsz, offset, NULL)) {
-			if (offset != NULL)
-				*offset += offset_add;
-			return TRUE;
-		}
-
-		/* truncate the buffer */
-		if (buf_acc->len > bufsz) {
-			offset_add += buf_acc->len - bufsz;
-			g_byte_array_remove_range(buf_acc, 0, buf_acc->len - bufsz);
-		}
-
-		/* move the offset */
-		offset_cur += buf_tmp->len;
+	fu_mem_search_add_needle(search, buf, bufsz);
+	if (!fu_mem_search_find_stream(search, stream, 0x0, offset, NULL, NULL)) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "failed to find buffer of size 0x%x",
+			    (guint)bufsz);
+		return FALSE;
 	}
-	g_set_error(error,
-		    FWUPD_ERROR,
-		    FWUPD_ERROR_NOT_FOUND,
-		    "failed to find buffer of size 0x%x",
-		    (guint)bufsz);
-	return FALSE;
+	return TRUE;
 }
@@ -208,6 +208,17 @@ fu_ioctl_add_const_buffer(FuIoctl *self,
 	fu_ioctl_add_buffer(self, key, (guint8 *)buf, bufsz, FALSE, fixup_cb);
 }
 
+static void
+fu_ioctl_add_metrics(FuIoctl *self, gint64 start_us)
+{
+	FuContext *ctx = fu_device_get_context(FU_DEVICE(self->udev_device));
+	if (ctx == NULL)
+		return;
+	fu_metrics_add_duration_since(fu_context_get_metrics(ctx),
+				      fu_udev_device_get_ioctl_metrics_id(self->udev_device),
+				      start_us);
+}
+
 /**
  * fu_ioctl_execute:
  * @self: a #FuIoctl
@@ -240,6 +251,8 @@ fu_ioctl_execute(FuIoctl *self,
 		 GError **error)
 {
 	FuDeviceEvent *event = NULL;
+	gboolean ret;
+	gint64 start_us;
 	g_autoptr(GString) event_id = NULL;
 
 	/* need event ID */
@@ -297,14 +310,10 @@ fu_ioctl_execute(FuIoctl *self,
 				return FALSE;
 		}
 	}
-	if (!fu_udev_device_ioctl(self->udev_device,
-				  request,
-				  buf,
-				  bufsz,
-				  rc,
-				  timeout,
-				  flags,
-				  error))
+	start_us = g_get_monotonic_time();
+	ret = fu_udev_device_ioctl(self->udev_device, request, buf, bufsz, rc, timeout, flags, error);
+	fu_ioctl_add_metrics(self, start_us);
+	if (!ret)
 		return FALSE;
 
 	/* save response */
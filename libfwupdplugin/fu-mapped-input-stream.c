@@ -0,0 +1,258 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuMappedInputStream"
+
+#include "config.h"
+
+#include "fwupd-codec.h"
+
+#include "fu-bytes.h"
+#include "fu-mapped-input-stream.h"
+
+/**
+ * FuMappedInputStream:
+ *
+ * A seekable input stream backed by a #GBytes, which is typically a mapped file.
+ *
+ * Unlike a #GMemoryInputStream the bytes can be retrieved, which allows fu_input_stream_read_bytes()
+ * to return a view of the data rather than a copy -- even when the stream is wrapped in one or
+ * more #FuPartialInputStream objects.
+ */
+
+struct _FuMappedInputStream {
+	GInputStream parent_instance;
+	GBytes *bytes;
+	gsize pos;
+};
+
+static void
+fu_mapped_input_stream_seekable_iface_init(GSeekableIface *iface);
+static void
+fu_mapped_input_stream_codec_iface_init(FwupdCodecInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(FuMappedInputStream,
+			fu_mapped_input_stream,
+			G_TYPE_INPUT_STREAM,
+			G_IMPLEMENT_INTERFACE(G_TYPE_SEEKABLE,
+					      fu_mapped_input_stream_seekable_iface_init)
+			    G_IMPLEMENT_INTERFACE(FWUPD_TYPE_CODEC,
+						  fu_mapped_input_stream_codec_iface_init))
+
+static void
+fu_mapped_input_stream_add_string(FwupdCodec *codec, guint idt, GString *str)
+{
+	FuMappedInputStream *self = FU_MAPPED_INPUT_STREAM(codec);
+	fwupd_codec_string_append_hex(str, idt, "Pos", self->pos);
+	fwupd_codec_string_append_hex(str, idt, "Size", g_bytes_get_size(self->bytes));
+}
+
+static void
+fu_mapped_input_stream_codec_iface_init(FwupdCodecInterface *iface)
+{
+	iface->add_string = fu_mapped_input_stream_add_string;
+}
+
+static goffset
+fu_mapped_input_stream_tell(GSeekable *seekable)
+{
+	FuMappedInputStream *self = FU_MAPPED_INPUT_STREAM(seekable);
+	return self->pos;
+}
+
+static gboolean
+fu_mapped_input_stream_can_seek(GSeekable *seekable)
+{
+	return TRUE;
+}
+
+static gboolean
+fu_mapped_input_stream_seek(GSeekable *seekable,
+			    goffset offset,
+			    GSeekType type,
+			    GCancellable *cancellable,
+			    GError **error)
+{
+	FuMappedInputStream *self = FU_MAPPED_INPUT_STREAM(seekable);
+	goffset pos;
+
+	g_return_val_if_fail(FU_IS_MAPPED_INPUT_STREAM(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (type == G_SEEK_CUR) {
+		pos = (goffset)self->pos + offset;
+	} else if (type == G_SEEK_END) {
+		pos = (goffset)g_bytes_get_size(self->bytes) + offset;
+	} else {
+		pos = offset;
+	}
+
+	/* use the same error as GMemoryInputStream */
+	if (pos < 0 || (gsize)pos > g_bytes_get_size(self->bytes)) {
+		g_set_error(error,
+			    G_IO_ERROR,
+			    G_IO_ERROR_INVALID_ARGUMENT,
+			    "cannot seek to 0x%x as stream only 0x%x bytes in size",
+			    (guint)pos,
+			    (guint)g_bytes_get_size(self->bytes));
+		return FALSE;
+	}
+	self->pos = pos;
+	return TRUE;
+}
+
+static gboolean
+fu_mapped_input_stream_can_truncate(GSeekable *seekable)
+{
+	return FALSE;
+}
+
+static gboolean
+fu_mapped_input_stream_truncate(GSeekable *seekable,
+				goffset offset,
+				GCancellable *cancellable,
+				GError **error)
+{
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "cannot truncate FuMappedInputStream");
+	return FALSE;
+}
+
+static void
+fu_mapped_input_stream_seekable_iface_init(GSeekableIface *iface)
+{
+	iface->tell = fu_mapped_input_stream_tell;
+	iface->can_seek = fu_mapped_input_stream_can_seek;
+	iface->seek = fu_mapped_input_stream_seek;
+	iface->can_truncate = fu_mapped_input_stream_can_truncate;
+	iface->truncate_fn = fu_mapped_input_stream_truncate;
+}
+
+/**
+ * fu_mapped_input_stream_new:
+ * @bytes: a #GBytes
+ *
+ * Creates an input stream where content is read directly from @bytes.
+ *
+ * Returns: (transfer full): a #FuMappedInputStream
+ *
+ * Since: 2.0.9
+ **/
+GInputStream *
+fu_mapped_input_stream_new(GBytes *bytes)
+{
+	FuMappedInputStream *self;
+	g_return_val_if_fail(bytes != NULL, NULL);
+	self = g_object_new(FU_TYPE_MAPPED_INPUT_STREAM, NULL);
+	self->bytes = g_bytes_ref(bytes);
+	return G_INPUT_STREAM(self);
+}
+
+/**
+ * fu_mapped_input_stream_new_from_path:
+ * @path: a filename
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates an input stream for a file, mapping it into memory if possible.
+ *
+ * Returns: (transfer full): a #FuMappedInputStream, or %NULL on error
+ *
+ * Since: 2.0.9
+ **/
+GInputStream *
+fu_mapped_input_stream_new_from_path(const gchar *path, GError **error)
+{
+	g_autoptr(GBytes) bytes = NULL;
+
+	g_return_val_if_fail(path != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	bytes = fu_bytes_get_contents(path, error);
+	if (bytes == NULL)
+		return NULL;
+	return fu_mapped_input_stream_new(bytes);
+}
+
+/**
+ * fu_mapped_input_stream_get_bytes:
+ * @self: a #FuMappedInputStream
+ *
+ * Gets the data backing the stream.
+ *
+ * Returns: (transfer none): a #GBytes
+ *
+ * Since: 2.0.9
+ **/
+GBytes *
+fu_mapped_input_stream_get_bytes(FuMappedInputStream *self)
+{
+	g_return_val_if_fail(FU_IS_MAPPED_INPUT_STREAM(self), NULL);
+	return self->bytes;
+}
+
+static gssize
+fu_mapped_input_stream_read(GInputStream *stream,
+			    void *buffer,
+			    gsize count,
+			    GCancellable *cancellable,
+			    GError **error)
+{
+	FuMappedInputStream *self = FU_MAPPED_INPUT_STREAM(stream);
+	gsize bufsz = 0;
+	const guint8 *buf = g_bytes_get_data(self->bytes, &bufsz);
+
+	g_return_val_if_fail(FU_IS_MAPPED_INPUT_STREAM(self), -1);
+	g_return_val_if_fail(error == NULL || *error == NULL, -1);
+
+	if (self->pos >= bufsz)
+		return 0;
+	count = MIN(count, bufsz - self->pos);
+	memcpy(buffer, buf + self->pos, count); /* nocheck:blocked */
+	self->pos += count;
+	return count;
+}
+
+static gssize
+fu_mapped_input_stream_skip(GInputStream *stream,
+			    gsize count,
+			    GCancellable *cancellable,
+			    GError **error)
+{
+	FuMappedInputStream *self = FU_MAPPED_INPUT_STREAM(stream);
+	gsize bufsz = g_bytes_get_size(self->bytes);
+
+	if (self->pos >= bufsz)
+		return 0;
+	count = MIN(count, bufsz - self->pos);
+	self->pos += count;
+	return count;
+}
+
+static void
+fu_mapped_input_stream_finalize(GObject *object)
+{
+	FuMappedInputStream *self = FU_MAPPED_INPUT_STREAM(object);
+	if (self->bytes != NULL)
+		g_bytes_unref(self->bytes);
+	G_OBJECT_CLASS(fu_mapped_input_stream_parent_class)->finalize(object);
+}
+
+static void
+fu_mapped_input_stream_class_init(FuMappedInputStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	GInputStreamClass *istream_class = G_INPUT_STREAM_CLASS(klass);
+	istream_class->read_fn = fu_mapped_input_stream_read;
+	istream_class->skip = fu_mapped_input_stream_skip;
+	object_class->finalize = fu_mapped_input_stream_finalize;
+}
+
+static void
+fu_mapped_input_stream_init(FuMappedInputStream *self)
+{
+}
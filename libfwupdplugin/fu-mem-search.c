@@ -0,0 +1,308 @@
+/*
+ * Copyright 2024 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuMemSearch"
+
+#include "config.h"
+
+#include <string.h>
+
+#include "fu-input-stream.h"
+#include "fu-mem-search.h"
+
+/**
+ * FuMemSearch:
+ *
+ * Finds one or more needles in a buffer or stream.
+ *
+ * The needles are preprocessed once into a Horspool skip table, which is shared by all the needles
+ * so that they can be found in a single pass. If all the needles start with the same byte then
+ * memchr() is used to skip to the next candidate, which is vectorized on most platforms.
+ */
+
+struct _FuMemSearch {
+	GObject parent_instance;
+	GPtrArray *needles; /* of GBytes */
+	gsize needle_min;
+	gsize needle_max;
+	gsize shift[256];
+	gboolean first[256];
+	gint first_common; /* or -1 if the needles start with different bytes */
+	gboolean done_setup;
+};
+
+G_DEFINE_TYPE(FuMemSearch, fu_mem_search, G_TYPE_OBJECT)
+
+/* the largest block read from a stream at once */
+#define FU_MEM_SEARCH_STREAM_BLOCKSZ 0x10000
+
+/**
+ * fu_mem_search_add_needle:
+ * @self: a #FuMemSearch
+ * @buf: a buffer
+ * @bufsz: size of @buf, which must be non-zero
+ *
+ * Adds a needle to search for.
+ *
+ * Returns: the needle index, which is returned by fu_mem_search_find() when found
+ *
+ * Since: 2.0.9
+ **/
+guint
+fu_mem_search_add_needle(FuMemSearch *self, const guint8 *buf, gsize bufsz)
+{
+	g_return_val_if_fail(FU_IS_MEM_SEARCH(self), G_MAXUINT);
+	g_return_val_if_fail(buf != NULL, G_MAXUINT);
+	g_return_val_if_fail(bufsz > 0, G_MAXUINT);
+
+	g_ptr_array_add(self->needles, g_bytes_new(buf, bufsz));
+	self->done_setup = FALSE;
+	return self->needles->len - 1;
+}
+
+/**
+ * fu_mem_search_get_needle_count:
+ * @self: a #FuMemSearch
+ *
+ * Gets the number of needles added.
+ *
+ * Returns: integer
+ *
+ * Since: 2.0.9
+ **/
+guint
+fu_mem_search_get_needle_count(FuMemSearch *self)
+{
+	g_return_val_if_fail(FU_IS_MEM_SEARCH(self), G_MAXUINT);
+	return self->needles->len;
+}
+
+static void
+fu_mem_search_ensure_setup(FuMemSearch *self)
+{
+	if (self->done_setup)
+		return;
+
+	self->needle_min = G_MAXSIZE;
+	self->needle_max = 0;
+	for (guint i = 0; i < self->needles->len; i++) {
+		GBytes *needle = g_ptr_array_index(self->needles, i);
+		self->needle_min = MIN(self->needle_min, g_bytes_get_size(needle));
+		self->needle_max = MAX(self->needle_max, g_bytes_get_size(needle));
+	}
+
+	/* the shift is limited by the shortest needle, as all needles are checked at each offset */
+	for (guint c = 0; c < G_N_ELEMENTS(self->shift); c++) {
+		self->shift[c] = self->needle_min;
+		self->first[c] = FALSE;
+	}
+	self->first_common = -1;
+	for (guint i = 0; i < self->needles->len; i++) {
+		GBytes *needle = g_ptr_array_index(self->needles, i);
+		const guint8 *buf = g_bytes_get_data(needle, NULL);
+		for (gsize j = 0; j + 1 < self->needle_min; j++)
+			self->shift[buf[j]] = MIN(self->shift[buf[j]], self->needle_min - 1 - j);
+		self->first[buf[0]] = TRUE;
+		if (i == 0)
+			self->first_common = buf[0];
+		else if (self->first_common != buf[0])
+			self->first_common = -1;
+	}
+	self->done_setup = TRUE;
+}
+
+/**
+ * fu_mem_search_find:
+ * @self: a #FuMemSearch
+ * @buf: a buffer
+ * @bufsz: size of @buf
+ * @offset: offset into @buf to start searching from
+ * @offset_found: (out) (optional): offset into @buf the needle was found
+ * @idx: (out) (optional): the index of the needle that was found
+ * @error: (nullable): optional return location for an error
+ *
+ * Finds the first occurrence of any needle in a buffer.
+ *
+ * Returns: %TRUE if a needle was found
+ *
+ * Since: 2.0.9
+ **/
+gboolean
+fu_mem_search_find(FuMemSearch *self,
+		   const guint8 *buf,
+		   gsize bufsz,
+		   gsize offset,
+		   gsize *offset_found,
+		   guint *idx,
+		   GError **error)
+{
+	g_return_val_if_fail(FU_IS_MEM_SEARCH(self), FALSE);
+	g_return_val_if_fail(buf != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* nothing to find */
+	if (self->needles->len == 0) {
+		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "no needles added");
+		return FALSE;
+	}
+	fu_mem_search_ensure_setup(self);
+
+	while (offset <= bufsz && bufsz - offset >= self->needle_min) {
+		/* skip to the next candidate */
+		if (self->first_common >= 0) {
+			const guint8 *tmp = memchr(buf + offset,
+						   self->first_common,
+						   bufsz - offset - self->needle_min + 1);
+			if (tmp == NULL)
+				break;
+			offset = tmp - buf;
+		}
+
+		/* check each needle */
+		if (self->first[buf[offset]]) {
+			for (guint i = 0; i < self->needles->len; i++) {
+				GBytes *needle = g_ptr_array_index(self->needles, i);
+				gsize needlesz = 0;
+				const guint8 *needlebuf = g_bytes_get_data(needle, &needlesz);
+				if (needlesz > bufsz - offset)
+					continue;
+				if (memcmp(buf + offset, needlebuf, needlesz) == 0) {
+					if (offset_found != NULL)
+						*offset_found = offset;
+					if (idx != NULL)
+						*idx = i;
+					return TRUE;
+				}
+			}
+		}
+
+		/* skip using the last byte of the window */
+		offset += self->shift[buf[offset + self->needle_min - 1]];
+	}
+
+	/* not found */
+	g_set_error(error,
+		    FWUPD_ERROR,
+		    FWUPD_ERROR_NOT_FOUND,
+		    "no needle was found in haystack of 0x%x bytes",
+		    (guint)bufsz);
+	return FALSE;
+}
+
+/**
+ * fu_mem_search_find_stream:
+ * @self: a #FuMemSearch
+ * @stream: a #GInputStream
+ * @offset: offset into @stream to start searching from
+ * @offset_found: (out) (optional): offset into @stream the needle was found
+ * @idx: (out) (optional): the index of the needle that was found
+ * @error: (nullable): optional return location for an error
+ *
+ * Finds the first occurrence of any needle in a stream, without loading the entire stream into
+ * memory.
+ *
+ * Returns: %TRUE if a needle was found
+ *
+ * Since: 2.0.9
+ **/
+gboolean
+fu_mem_search_find_stream(FuMemSearch *self,
+			  GInputStream *stream,
+			  gsize offset,
+			  gsize *offset_found,
+			  guint *idx,
+			  GError **error)
+{
+	gsize overlap;
+
+	g_return_val_if_fail(FU_IS_MEM_SEARCH(self), FALSE);
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* nothing to find */
+	if (self->needles->len == 0) {
+		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "no needles added");
+		return FALSE;
+	}
+	fu_mem_search_ensure_setup(self);
+
+	/* each block overlaps the next so that needles can span blocks */
+	overlap = self->needle_max - 1;
+	while (TRUE) {
+		gsize offset_tmp = 0;
+		g_autoptr(GBytes) blob = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		blob = fu_input_stream_read_bytes(stream,
+						  offset,
+						  FU_MEM_SEARCH_STREAM_BLOCKSZ + overlap,
+						  NULL,
+						  &error_local);
+		if (blob == NULL) {
+			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE))
+				break;
+			g_propagate_error(error, g_steal_pointer(&error_local));
+			return FALSE;
+		}
+		if (fu_mem_search_find(self,
+				       g_bytes_get_data(blob, NULL),
+				       g_bytes_get_size(blob),
+				       0x0,
+				       &offset_tmp,
+				       idx,
+				       NULL)) {
+			if (offset_found != NULL)
+				*offset_found = offset + offset_tmp;
+			return TRUE;
+		}
+		if (g_bytes_get_size(blob) < FU_MEM_SEARCH_STREAM_BLOCKSZ + overlap)
+			break;
+		offset += FU_MEM_SEARCH_STREAM_BLOCKSZ;
+	}
+
+	/* not found */
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "no needle was found in stream");
+	return FALSE;
+}
+
+static void
+fu_mem_search_init(FuMemSearch *self)
+{
+	self->needles = g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+}
+
+static void
+fu_mem_search_finalize(GObject *object)
+{
+	FuMemSearch *self = FU_MEM_SEARCH(object);
+	g_ptr_array_unref(self->needles);
+	G_OBJECT_CLASS(fu_mem_search_parent_class)->finalize(object);
+}
+
+static void
+fu_mem_search_class_init(FuMemSearchClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_mem_search_finalize;
+}
+
+/**
+ * fu_mem_search_new:
+ *
+ * Creates a new object to search for one or more needles.
+ *
+ * Returns: (transfer full): a #FuMemSearch
+ *
+ * Since: 2.0.9
+ **/
+FuMemSearch *
+fu_mem_search_new(void)
+{
+	return g_object_new(FU_TYPE_MEM_SEARCH, NULL);
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2024 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupd.h>
+
+#define FU_TYPE_MEM_SEARCH (fu_mem_search_get_type())
+
+G_DECLARE_FINAL_TYPE(FuMemSearch, fu_mem_search, FU, MEM_SEARCH, GObject)
+
+FuMemSearch *
+fu_mem_search_new(void);
+guint
+fu_mem_search_add_needle(FuMemSearch *self, const guint8 *buf, gsize bufsz) G_GNUC_NON_NULL(1, 2);
+guint
+fu_mem_search_get_needle_count(FuMemSearch *self) G_GNUC_NON_NULL(1);
+gboolean
+fu_mem_search_find(FuMemSearch *self,
+		   const guint8 *buf,
+		   gsize bufsz,
+		   gsize offset,
+		   gsize *offset_found,
+		   guint *idx,
+		   GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_mem_search_find_stream(FuMemSearch *self,
+			  GInputStream *stream,
+			  gsize offset,
+			  gsize *offset_found,
+			  guint *idx,
+			  GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
@@ -11,6 +11,7 @@
 #include "fwupd-error.h"
 
 #include "fu-mem-private.h"
+#include "fu-mem-search.h"
 #include "fu-string.h"
 
 /**
@@ -498,12 +499,11 @@ fu_memmem_safe(const guint8 *haystack,
 		return TRUE;
 	}
 #else
-	for (gsize i = 0; i < haystack_sz - needle_sz; i++) {
-		if (memcmp(haystack + i, needle, needle_sz) == 0) {
-			if (offset != NULL)
-				*offset = i;
+	{
+		g_autoptr(FuMemSearch) search = fu_mem_search_new();
+		fu_mem_search_add_needle(search, needle, needle_sz);
+		if (fu_mem_search_find(search, haystack, haystack_sz, 0x0, offset, NULL, NULL))
 			return TRUE;
-		}
 	}
 #endif
 
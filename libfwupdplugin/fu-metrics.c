@@ -0,0 +1,369 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuMetrics"
+
+#include "config.h"
+
+#include "fu-metrics.h"
+
+/**
+ * FuMetrics:
+ *
+ * Counters and latency histograms for hot paths such as quirk lookups, USB transfers and ioctls.
+ *
+ * Each duration is recorded into a power-of-two histogram of microseconds, so recording is a
+ * fixed amount of work and the memory used does not grow with the number of samples. All the
+ * methods are thread-safe.
+ */
+
+/* the last bucket holds everything longer than ~8s */
+#define FU_METRICS_BUCKETS 24
+
+typedef struct {
+	guint64 value; /* counter value, or number of durations */
+	guint64 total_us;
+	guint64 max_us;
+	guint64 buckets[FU_METRICS_BUCKETS];
+	gboolean is_duration;
+} FuMetricsItem;
+
+struct _FuMetrics {
+	GObject parent_instance;
+	GMutex mutex;
+	GHashTable *items; /* utf8:FuMetricsItem */
+};
+
+G_DEFINE_TYPE(FuMetrics, fu_metrics, G_TYPE_OBJECT)
+
+/* the caller must hold the mutex */
+static FuMetricsItem *
+fu_metrics_ensure_item_unlocked(FuMetrics *self, const gchar *id, gboolean is_duration)
+{
+	FuMetricsItem *item = g_hash_table_lookup(self->items, id);
+	if (item == NULL) {
+		item = g_new0(FuMetricsItem, 1);
+		item->is_duration = is_duration;
+		g_hash_table_insert(self->items, g_strdup(id), item);
+	}
+	return item;
+}
+
+/* the caller must hold the mutex */
+static void
+fu_metrics_add_duration_unlocked(FuMetrics *self, const gchar *id, guint64 duration_us)
+{
+	FuMetricsItem *item = fu_metrics_ensure_item_unlocked(self, id, TRUE);
+	guint idx = 0;
+
+	/* bucket N holds durations < 2^N us */
+	if (duration_us > 0)
+		idx = MIN(g_bit_storage(MIN(duration_us, G_MAXULONG)), FU_METRICS_BUCKETS - 1);
+	item->value++;
+	item->total_us += duration_us;
+	item->max_us = MAX(item->max_us, duration_us);
+	item->buckets[idx]++;
+}
+
+static guint64
+fu_metrics_duration_since(gint64 start_us)
+{
+	gint64 now = g_get_monotonic_time();
+	return now > start_us ? (guint64)(now - start_us) : 0;
+}
+
+/**
+ * fu_metrics_add_counter:
+ * @self: a #FuMetrics
+ * @id: a metric ID, e.g. `UsbControlTransferBytes`
+ * @value: the amount to add
+ *
+ * Increments a counter.
+ *
+ * Since: 2.0.9
+ **/
+void
+fu_metrics_add_counter(FuMetrics *self, const gchar *id, guint64 value)
+{
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_if_fail(FU_IS_METRICS(self));
+	g_return_if_fail(id != NULL);
+
+	locker = g_mutex_locker_new(&self->mutex);
+	fu_metrics_ensure_item_unlocked(self, id, FALSE)->value += value;
+}
+
+/**
+ * fu_metrics_add_duration:
+ * @self: a #FuMetrics
+ * @id: a metric ID, e.g. `UsbControlTransfer`
+ * @duration_us: duration in microseconds
+ *
+ * Records how long something took.
+ *
+ * Since: 2.0.9
+ **/
+void
+fu_metrics_add_duration(FuMetrics *self, const gchar *id, guint64 duration_us)
+{
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_if_fail(FU_IS_METRICS(self));
+	g_return_if_fail(id != NULL);
+
+	locker = g_mutex_locker_new(&self->mutex);
+	fu_metrics_add_duration_unlocked(self, id, duration_us);
+}
+
+/**
+ * fu_metrics_add_duration_since:
+ * @self: a #FuMetrics
+ * @id: a metric ID, e.g. `UsbControlTransfer`
+ * @start_us: a value from g_get_monotonic_time()
+ *
+ * Records how long something took, ending now.
+ *
+ * Since: 2.0.9
+ **/
+void
+fu_metrics_add_duration_since(FuMetrics *self, const gchar *id, gint64 start_us)
+{
+	fu_metrics_add_duration(self, id, fu_metrics_duration_since(start_us));
+}
+
+/**
+ * fu_metrics_add_duration_since_with_counter:
+ * @self: a #FuMetrics
+ * @id: a metric ID, e.g. `UsbBulkTransfer`
+ * @start_us: a value from g_get_monotonic_time()
+ * @counter_id: a metric ID, e.g. `UsbBulkTransferBytes`
+ * @value: the amount to add to @counter_id
+ *
+ * Records how long something took, ending now, and increments a counter at the same time.
+ *
+ * Since: 2.0.9
+ **/
+void
+fu_metrics_add_duration_since_with_counter(FuMetrics *self,
+					   const gchar *id,
+					   gint64 start_us,
+					   const gchar *counter_id,
+					   guint64 value)
+{
+	guint64 duration_us = fu_metrics_duration_since(start_us);
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_if_fail(FU_IS_METRICS(self));
+	g_return_if_fail(id != NULL);
+	g_return_if_fail(counter_id != NULL);
+
+	locker = g_mutex_locker_new(&self->mutex);
+	fu_metrics_add_duration_unlocked(self, id, duration_us);
+	fu_metrics_ensure_item_unlocked(self, counter_id, FALSE)->value += value;
+}
+
+/**
+ * fu_metrics_get_counter:
+ * @self: a #FuMetrics
+ * @id: a metric ID, e.g. `UsbControlTransferBytes`
+ *
+ * Gets the value of a counter.
+ *
+ * Returns: integer, or 0 if never incremented
+ *
+ * Since: 2.0.9
+ **/
+guint64
+fu_metrics_get_counter(FuMetrics *self, const gchar *id)
+{
+	FuMetricsItem *item;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_val_if_fail(FU_IS_METRICS(self), 0);
+	g_return_val_if_fail(id != NULL, 0);
+
+	locker = g_mutex_locker_new(&self->mutex);
+	item = g_hash_table_lookup(self->items, id);
+	if (item == NULL || item->is_duration)
+		return 0;
+	return item->value;
+}
+
+/**
+ * fu_metrics_get_duration_count:
+ * @self: a #FuMetrics
+ * @id: a metric ID, e.g. `UsbControlTransfer`
+ *
+ * Gets the number of durations recorded.
+ *
+ * Returns: integer
+ *
+ * Since: 2.0.9
+ **/
+guint64
+fu_metrics_get_duration_count(FuMetrics *self, const gchar *id)
+{
+	FuMetricsItem *item;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_val_if_fail(FU_IS_METRICS(self), 0);
+	g_return_val_if_fail(id != NULL, 0);
+
+	locker = g_mutex_locker_new(&self->mutex);
+	item = g_hash_table_lookup(self->items, id);
+	if (item == NULL || !item->is_duration)
+		return 0;
+	return item->value;
+}
+
+/* the upper bound of the bucket, so this is never an underestimate */
+static guint64
+fu_metrics_item_get_percentile(FuMetricsItem *item, guint percentile)
+{
+	guint64 cnt = 0;
+	guint64 threshold = (item->value * percentile + 99) / 100;
+
+	for (guint i = 0; i < FU_METRICS_BUCKETS - 1; i++) {
+		cnt += item->buckets[i];
+		if (cnt >= threshold && cnt > 0)
+			return MIN(((guint64)1 << i) - 1, item->max_us);
+	}
+	return item->max_us;
+}
+
+/**
+ * fu_metrics_get_duration_percentile:
+ * @self: a #FuMetrics
+ * @id: a metric ID, e.g. `UsbControlTransfer`
+ * @percentile: a percentile, e.g. 99
+ *
+ * Gets the approximate duration that the given percentage of recorded durations were shorter
+ * than or equal to.
+ *
+ * Returns: duration in microseconds, or 0 if none recorded
+ *
+ * Since: 2.0.9
+ **/
+guint64
+fu_metrics_get_duration_percentile(FuMetrics *self, const gchar *id, guint percentile)
+{
+	FuMetricsItem *item;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_val_if_fail(FU_IS_METRICS(self), 0);
+	g_return_val_if_fail(id != NULL, 0);
+	g_return_val_if_fail(percentile <= 100, 0);
+
+	locker = g_mutex_locker_new(&self->mutex);
+	item = g_hash_table_lookup(self->items, id);
+	if (item == NULL || !item->is_duration || item->value == 0)
+		return 0;
+	return fu_metrics_item_get_percentile(item, percentile);
+}
+
+static void
+fu_metrics_values_add(GHashTable *values, const gchar *id, const gchar *suffix, guint64 value)
+{
+	g_hash_table_insert(values,
+			    suffix != NULL ? g_strdup_printf("%s.%s", id, suffix) : g_strdup(id),
+			    g_memdup2(&value, sizeof(value)));
+}
+
+/**
+ * fu_metrics_get_values:
+ * @self: a #FuMetrics
+ *
+ * Gets a snapshot of all the metrics. Counters use the metric ID as the key, and each duration
+ * has the keys `ID.Count`, `ID.TotalUs`, `ID.MaxUs`, `ID.P50Us`, `ID.P90Us` and `ID.P99Us`.
+ *
+ * Returns: (transfer container) (element-type utf8 guint64): values
+ *
+ * Since: 2.0.9
+ **/
+GHashTable *
+fu_metrics_get_values(FuMetrics *self)
+{
+	FuMetricsItem *item;
+	GHashTableIter iter;
+	const gchar *id;
+	g_autoptr(GHashTable) values = NULL;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_val_if_fail(FU_IS_METRICS(self), NULL);
+
+	values = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	locker = g_mutex_locker_new(&self->mutex);
+	g_hash_table_iter_init(&iter, self->items);
+	while (g_hash_table_iter_next(&iter, (gpointer *)&id, (gpointer *)&item)) {
+		if (!item->is_duration) {
+			fu_metrics_values_add(values, id, NULL, item->value);
+			continue;
+		}
+		fu_metrics_values_add(values, id, "Count", item->value);
+		fu_metrics_values_add(values, id, "TotalUs", item->total_us);
+		fu_metrics_values_add(values, id, "MaxUs", item->max_us);
+		fu_metrics_values_add(values, id, "P50Us", fu_metrics_item_get_percentile(item, 50));
+		fu_metrics_values_add(values, id, "P90Us", fu_metrics_item_get_percentile(item, 90));
+		fu_metrics_values_add(values, id, "P99Us", fu_metrics_item_get_percentile(item, 99));
+	}
+	return g_steal_pointer(&values);
+}
+
+/**
+ * fu_metrics_reset:
+ * @self: a #FuMetrics
+ *
+ * Clears all the counters and durations.
+ *
+ * Since: 2.0.9
+ **/
+void
+fu_metrics_reset(FuMetrics *self)
+{
+	g_autoptr(GMutexLocker) locker = NULL;
+	g_return_if_fail(FU_IS_METRICS(self));
+	locker = g_mutex_locker_new(&self->mutex);
+	g_hash_table_remove_all(self->items);
+}
+
+static void
+fu_metrics_init(FuMetrics *self)
+{
+	g_mutex_init(&self->mutex);
+	self->items = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+}
+
+static void
+fu_metrics_finalize(GObject *obj)
+{
+	FuMetrics *self = FU_METRICS(obj);
+	g_hash_table_unref(self->items);
+	g_mutex_clear(&self->mutex);
+	G_OBJECT_CLASS(fu_metrics_parent_class)->finalize(obj);
+}
+
+static void
+fu_metrics_class_init(FuMetricsClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_metrics_finalize;
+}
+
+/**
+ * fu_metrics_new:
+ *
+ * Creates a new metrics registry.
+ *
+ * Returns: a #FuMetrics
+ *
+ * Since: 2.0.9
+ **/
+FuMetrics *
+fu_metrics_new(void)
+{
+	return g_object_new(FU_TYPE_METRICS, NULL);
+}
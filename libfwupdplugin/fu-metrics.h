@@ -0,0 +1,41 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupd.h>
+
+#define FU_TYPE_METRICS (fu_metrics_get_type())
+
+G_DECLARE_FINAL_TYPE(FuMetrics, fu_metrics, FU, METRICS, GObject)
+
+FuMetrics *
+fu_metrics_new(void);
+void
+fu_metrics_add_counter(FuMetrics *self, const gchar *id, guint64 value) G_GNUC_NON_NULL(1, 2);
+void
+fu_metrics_add_duration(FuMetrics *self, const gchar *id, guint64 duration_us)
+    G_GNUC_NON_NULL(1, 2);
+void
+fu_metrics_add_duration_since(FuMetrics *self, const gchar *id, gint64 start_us)
+    G_GNUC_NON_NULL(1, 2);
+void
+fu_metrics_add_duration_since_with_counter(FuMetrics *self,
+					   const gchar *id,
+					   gint64 start_us,
+					   const gchar *counter_id,
+					   guint64 value) G_GNUC_NON_NULL(1, 2, 4);
+guint64
+fu_metrics_get_counter(FuMetrics *self, const gchar *id) G_GNUC_NON_NULL(1, 2);
+guint64
+fu_metrics_get_duration_count(FuMetrics *self, const gchar *id) G_GNUC_NON_NULL(1, 2);
+guint64
+fu_metrics_get_duration_percentile(FuMetrics *self, const gchar *id, guint percentile)
+    G_GNUC_NON_NULL(1, 2);
+GHashTable *
+fu_metrics_get_values(FuMetrics *self) G_GNUC_NON_NULL(1);
+void
+fu_metrics_reset(FuMetrics *self) G_GNUC_NON_NULL(1);
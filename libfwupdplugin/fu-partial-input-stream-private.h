@@ -8,6 +8,8 @@
 
 #include "fu-partial-input-stream.h"
 
+GInputStream *
+fu_partial_input_stream_get_base_stream(FuPartialInputStream *self) G_GNUC_NON_NULL(1);
 gsize
 fu_partial_input_stream_get_offset(FuPartialInputStream *self) G_GNUC_NON_NULL(1);
 gsize
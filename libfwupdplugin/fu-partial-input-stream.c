@@ -203,6 +203,23 @@ fu_partial_input_stream_new(GInputStream *stream, gsize offset, gsize size, GErr
 	return G_INPUT_STREAM(g_steal_pointer(&self));
 }
 
+/**
+ * fu_partial_input_stream_get_base_stream:
+ * @self: a #FuPartialInputStream
+ *
+ * Gets the stream the data is read from.
+ *
+ * Returns: (transfer none): a #GInputStream
+ *
+ * Since: 2.0.9
+ **/
+GInputStream *
+fu_partial_input_stream_get_base_stream(FuPartialInputStream *self)
+{
+	g_return_val_if_fail(FU_IS_PARTIAL_INPUT_STREAM(self), NULL);
+	return self->base_stream;
+}
+
 /**
  * fu_partial_input_stream_get_offset:
  * @self: a #FuPartialInputStream
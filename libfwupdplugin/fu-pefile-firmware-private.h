@@ -0,0 +1,13 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-pefile-firmware.h"
+
+void
+fu_pefile_firmware_set_authenticode_hash(FuPefileFirmware *self, const gchar *authenticode_hash)
+    G_GNUC_NON_NULL(1);
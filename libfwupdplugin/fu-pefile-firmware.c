@@ -17,7 +17,7 @@
 #include "fu-input-stream.h"
 #include "fu-mem.h"
 #include "fu-partial-input-stream.h"
-#include "fu-pefile-firmware.h"
+#include "fu-pefile-firmware-private.h"
 #include "fu-pefile-struct.h"
 #include "fu-sbatlevel-section.h"
 #include "fu-string.h"
@@ -503,6 +503,18 @@ fu_pefile_firmware_get_checksum(FuFirmware *firmware, GChecksumType csum_kind, G
 	return g_strdup(priv->authenticode_hash);
 }
 
+/* used when the Authenticode checksum is already known, e.g. from a cache */
+void
+fu_pefile_firmware_set_authenticode_hash(FuPefileFirmware *self, const gchar *authenticode_hash)
+{
+	FuPefileFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FU_IS_PEFILE_FIRMWARE(self));
+	if (g_strcmp0(priv->authenticode_hash, authenticode_hash) == 0)
+		return;
+	g_free(priv->authenticode_hash);
+	priv->authenticode_hash = g_strdup(authenticode_hash);
+}
+
 static void
 fu_pefile_firmware_init(FuPefileFirmware *self)
 {
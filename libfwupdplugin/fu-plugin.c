@@ -19,7 +19,9 @@
 #include "fu-config-private.h"
 #include "fu-context-private.h"
 #include "fu-device-private.h"
+#include "fu-input-stream.h"
 #include "fu-kernel.h"
+#include "fu-mapped-input-stream.h"
 #include "fu-path.h"
 #include "fu-plugin-private.h"
 #include "fu-security-attr.h"
@@ -53,6 +55,8 @@ typedef struct {
 	GFileMonitor *config_monitor;
 	FuPluginData *data;
 	FuPluginVfuncs vfuncs;
+	GHashTable *metrics_ids; /* action:utf8 */
+	GMutex metrics_mutex;	 /* for metrics_ids */
 } FuPluginPrivate;
 
 enum { PROP_0, PROP_CONTEXT, PROP_LAST };
@@ -802,7 +806,9 @@ fu_plugin_device_read_firmware(FuPlugin *self,
 	g_autoptr(FuDeviceLocker) locker = NULL;
 	g_autoptr(FuFirmware) firmware = NULL;
 	g_autoptr(GBytes) fw = NULL;
-	GChecksumType checksum_types[] = {G_CHECKSUM_SHA1, G_CHECKSUM_SHA256, 0};
+	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(GPtrArray) checksums = NULL;
+	GChecksumType checksum_types[] = {G_CHECKSUM_SHA1, G_CHECKSUM_SHA256};
 	locker = fu_device_locker_new(proxy, error);
 	if (locker == NULL)
 		return FALSE;
@@ -824,11 +830,19 @@ fu_plugin_device_read_firmware(FuPlugin *self,
 		g_prefix_error(error, "failed to write firmware: ");
 		return FALSE;
 	}
-	for (guint i = 0; checksum_types[i] != 0; i++) {
-		g_autofree gchar *hash = NULL;
-		hash = g_compute_checksum_for_bytes(checksum_types[i], fw);
-		fu_device_add_checksum(device, hash);
+	stream = fu_mapped_input_stream_new(fw);
+	checksums = fu_input_stream_compute_checksums(stream,
+						      checksum_types,
+						      G_N_ELEMENTS(checksum_types),
+						      error);
+	if (checksums == NULL) {
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_device_attach_full(device, progress, &error_local))
+			g_debug("ignoring attach failure: %s", error_local->message);
+		return FALSE;
 	}
+	for (guint i = 0; i < checksums->len; i++)
+		fu_device_add_checksum(device, g_ptr_array_index(checksums, i));
 	return fu_device_attach_full(device, progress, error);
 }
 
@@ -965,6 +979,28 @@ fu_plugin_runner_init(FuPlugin *self)
 	}
 }
 
+static void
+fu_plugin_add_metrics(FuPlugin *self, const gchar *action, gint64 start_us)
+{
+	FuPluginPrivate *priv = GET_PRIVATE(self);
+	FuContext *ctx = fu_plugin_get_context(self);
+	const gchar *id;
+
+	if (ctx == NULL)
+		return;
+
+	/* @action is always a static string, so the ID is only built once */
+	g_mutex_lock(&priv->metrics_mutex);
+	id = g_hash_table_lookup(priv->metrics_ids, action);
+	if (id == NULL) {
+		gchar *id_tmp = g_strdup_printf("Plugin[%s].%s", fu_plugin_get_name(self), action);
+		g_hash_table_insert(priv->metrics_ids, (gpointer)action, id_tmp);
+		id = id_tmp;
+	}
+	g_mutex_unlock(&priv->metrics_mutex);
+	fu_metrics_add_duration_since(fu_context_get_metrics(ctx), id, start_us);
+}
+
 static gboolean
 fu_plugin_runner_device_generic(FuPlugin *self,
 				FuDevice *device,
@@ -972,6 +1008,8 @@ fu_plugin_runner_device_generic(FuPlugin *self,
 				FuPluginDeviceFunc device_func,
 				GError **error)
 {
+	gboolean ret;
+	gint64 start_us;
 	g_autoptr(GError) error_local = NULL;
 
 	/* not enabled */
@@ -982,7 +1020,10 @@ fu_plugin_runner_device_generic(FuPlugin *self,
 	if (device_func == NULL)
 		return TRUE;
 	g_debug("%s(%s)", symbol_name + 10, fu_plugin_get_name(self));
-	if (!device_func(self, device, &error_local)) {
+	start_us = g_get_monotonic_time();
+	ret = device_func(self, device, &error_local);
+	fu_plugin_add_metrics(self, symbol_name + 10, start_us);
+	if (!ret) {
 		if (error_local == NULL) {
 			g_critical("unset plugin error in %s(%s)",
 				   fu_plugin_get_name(self),
@@ -1010,6 +1051,8 @@ fu_plugin_runner_device_generic_progress(FuPlugin *self,
 					 FuPluginDeviceProgressFunc device_func,
 					 GError **error)
 {
+	gboolean ret;
+	gint64 start_us;
 	g_autoptr(GError) error_local = NULL;
 
 	/* not enabled */
@@ -1020,7 +1063,10 @@ fu_plugin_runner_device_generic_progress(FuPlugin *self,
 	if (device_func == NULL)
 		return TRUE;
 	g_debug("%s(%s)", symbol_name + 10, fu_plugin_get_name(self));
-	if (!device_func(self, device, progress, &error_local)) {
+	start_us = g_get_monotonic_time();
+	ret = device_func(self, device, progress, &error_local);
+	fu_plugin_add_metrics(self, symbol_name + 10, start_us);
+	if (!ret) {
 		if (error_local == NULL) {
 			g_critical("unset plugin error in %s(%s)",
 				   fu_plugin_get_name(self),
@@ -1049,6 +1095,8 @@ fu_plugin_runner_flagged_device_generic(FuPlugin *self,
 					FuPluginFlaggedDeviceFunc func,
 					GError **error)
 {
+	gboolean ret;
+	gint64 start_us;
 	g_autoptr(GError) error_local = NULL;
 
 	/* not enabled */
@@ -1059,7 +1107,10 @@ fu_plugin_runner_flagged_device_generic(FuPlugin *self,
 	if (func == NULL)
 		return TRUE;
 	g_debug("%s(%s)", symbol_name + 10, fu_plugin_get_name(self));
-	if (!func(self, device, progress, flags, &error_local)) {
+	start_us = g_get_monotonic_time();
+	ret = func(self, device, progress, flags, &error_local);
+	fu_plugin_add_metrics(self, symbol_name + 10, start_us);
+	if (!ret) {
 		if (error_local == NULL) {
 			g_critical("unset plugin error in %s(%s)",
 				   fu_plugin_get_name(self),
@@ -1086,6 +1137,8 @@ fu_plugin_runner_device_array_generic(FuPlugin *self,
 				      FuPluginDeviceArrayFunc func,
 				      GError **error)
 {
+	gboolean ret;
+	gint64 start_us;
 	g_autoptr(GError) error_local = NULL;
 
 	/* not enabled */
@@ -1096,7 +1149,10 @@ fu_plugin_runner_device_array_generic(FuPlugin *self,
 	if (func == NULL)
 		return TRUE;
 	g_debug("%s(%s)", symbol_name + 10, fu_plugin_get_name(self));
-	if (!func(self, devices, &error_local)) {
+	start_us = g_get_monotonic_time();
+	ret = func(self, devices, &error_local);
+	fu_plugin_add_metrics(self, symbol_name + 10, start_us);
+	if (!ret) {
 		if (error_local == NULL) {
 			g_critical("unset plugin error in for %s(%s)",
 				   fu_plugin_get_name(self),
@@ -1133,6 +1189,8 @@ fu_plugin_runner_coldplug(FuPlugin *self, FuProgress *progress, GError **error)
 {
 	FuPluginPrivate *priv = GET_PRIVATE(self);
 	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
+	gboolean ret;
+	gint64 start_us;
 	g_autoptr(GError) error_local = NULL;
 
 	g_return_val_if_fail(FU_IS_PLUGIN(self), FALSE);
@@ -1152,7 +1210,10 @@ fu_plugin_runner_coldplug(FuPlugin *self, FuProgress *progress, GError **error)
 	if (vfuncs->coldplug == NULL)
 		return TRUE;
 	g_debug("coldplug(%s)", fu_plugin_get_name(self));
-	if (!vfuncs->coldplug(self, progress, &error_local)) {
+	start_us = g_get_monotonic_time();
+	ret = vfuncs->coldplug(self, progress, &error_local);
+	fu_plugin_add_metrics(self, "coldplug", start_us);
+	if (!ret) {
 		if (error_local == NULL) {
 			g_critical("unset plugin error in coldplug(%s)", fu_plugin_get_name(self));
 			g_set_error_literal(&error_local,
@@ -3035,6 +3096,8 @@ fu_plugin_init(FuPlugin *self)
 {
 	FuPluginPrivate *priv = GET_PRIVATE(self);
 	priv->device_gtype_default = G_TYPE_INVALID;
+	priv->metrics_ids = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+	g_mutex_init(&priv->metrics_mutex);
 }
 
 static void
@@ -3069,6 +3132,8 @@ fu_plugin_finalize(GObject *object)
 	if (priv->config_monitor != NULL)
 		g_object_unref(priv->config_monitor);
 	g_free(priv->data);
+	g_hash_table_unref(priv->metrics_ids);
+	g_mutex_clear(&priv->metrics_mutex);
 
 	G_OBJECT_CLASS(fu_plugin_parent_class)->finalize(object);
 }
@@ -81,11 +81,21 @@ struct _FuQuirks {
 	XbQuery *query_kv;
 	XbQuery *query_vs;
 	gboolean verbose;
+	GMutex silo_mutex;	  /* for silo and the prepared queries, taken before mutex */
+	GMutex mutex;		  /* for lookup_cache and the prepared statements */
+	GHashTable *lookup_cache; /* (nullable): guid:GHashTable(key:value) */
+	guint64 lookup_cache_hits;
+	guint64 lookup_cache_misses;
 #ifdef HAVE_SQLITE
 	sqlite3 *db;
+	sqlite3_stmt *stmt_kv; /* guid, key */
+	sqlite3_stmt *stmt_vs; /* guid */
 #endif
 };
 
+/* used for negative results in the lookup cache, compared by address */
+static const gchar fu_quirks_lookup_cache_miss[] = "";
+
 G_DEFINE_TYPE(FuQuirks, fu_quirks, G_TYPE_OBJECT)
 
 #ifdef HAVE_SQLITE
@@ -100,6 +110,66 @@ fu_quirks_build_group_key(const gchar *group)
 	return fwupd_guid_hash_string(group);
 }
 
+/* values are interned or owned by the silo, or fu_quirks_lookup_cache_miss if not found */
+static const gchar *
+fu_quirks_lookup_cache_get(FuQuirks *self, const gchar *guid, const gchar *key)
+{
+	GHashTable *kvs;
+	const gchar *value;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->mutex);
+
+	if (self->lookup_cache == NULL)
+		return NULL;
+	kvs = g_hash_table_lookup(self->lookup_cache, guid);
+	if (kvs == NULL) {
+		self->lookup_cache_misses++;
+		return NULL;
+	}
+	value = g_hash_table_lookup(kvs, key);
+	if (value == NULL) {
+		self->lookup_cache_misses++;
+		return NULL;
+	}
+	self->lookup_cache_hits++;
+	return value;
+}
+
+static void
+fu_quirks_lookup_cache_set(FuQuirks *self, const gchar *guid, const gchar *key, const gchar *value)
+{
+	GHashTable *kvs;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->mutex);
+
+	if (self->lookup_cache == NULL)
+		return;
+	kvs = g_hash_table_lookup(self->lookup_cache, guid);
+	if (kvs == NULL) {
+		kvs = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+		g_hash_table_insert(self->lookup_cache, g_strdup(guid), kvs);
+	}
+	g_hash_table_insert(kvs,
+			    g_strdup(key),
+			    value != NULL ? (gpointer)value : (gpointer)fu_quirks_lookup_cache_miss);
+}
+
+static void
+fu_quirks_lookup_cache_invalidate(FuQuirks *self)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->mutex);
+	if (self->lookup_cache == NULL)
+		return;
+	if (self->lookup_cache_hits + self->lookup_cache_misses > 0) {
+		g_debug("quirk lookup cache: %u GUIDs, %" G_GUINT64_FORMAT
+			" hits, %" G_GUINT64_FORMAT " misses",
+			g_hash_table_size(self->lookup_cache),
+			self->lookup_cache_hits,
+			self->lookup_cache_misses);
+	}
+	g_hash_table_remove_all(self->lookup_cache);
+	self->lookup_cache_hits = 0;
+	self->lookup_cache_misses = 0;
+}
+
 static gboolean
 fu_quirks_validate_flags(const gchar *value, GError **error)
 {
@@ -353,8 +423,9 @@ fu_quirks_strcasecmp_cb(gconstpointer a, gconstpointer b)
 	return g_ascii_strcasecmp(entry1, entry2);
 }
 
+/* the caller must hold silo_mutex */
 static gboolean
-fu_quirks_check_silo(FuQuirks *self, GError **error)
+fu_quirks_check_silo_unlocked(FuQuirks *self, GError **error)
 {
 	XbBuilderCompileFlags compile_flags = XB_BUILDER_COMPILE_FLAG_WATCH_BLOB;
 	g_autofree gchar *datadir = NULL;
@@ -367,6 +438,9 @@ fu_quirks_check_silo(FuQuirks *self, GError **error)
 	if (self->silo != NULL && xb_silo_is_valid(self->silo))
 		return TRUE;
 
+	/* any cached values may now be stale */
+	fu_quirks_lookup_cache_invalidate(self);
+
 	/* system datadir */
 	builder = xb_builder_new();
 	datadir = fu_path_from_kind(FU_PATH_KIND_DATADIR_QUIRKS);
@@ -446,6 +520,60 @@ fu_quirks_check_silo(FuQuirks *self, GError **error)
 	return TRUE;
 }
 
+#ifdef HAVE_SQLITE
+/* this is generated from usb.ids and other static sources */
+static const gchar *
+fu_quirks_lookup_by_id_db(FuQuirks *self, const gchar *guid, const gchar *key)
+{
+	const gchar *value = NULL;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->mutex);
+
+	if (self->stmt_kv == NULL)
+		return NULL;
+	sqlite3_reset(self->stmt_kv);
+	sqlite3_clear_bindings(self->stmt_kv);
+	sqlite3_bind_text(self->stmt_kv, 1, guid, -1, SQLITE_STATIC);
+	sqlite3_bind_text(self->stmt_kv, 2, key, -1, SQLITE_STATIC);
+	if (sqlite3_step(self->stmt_kv) == SQLITE_ROW) {
+		const gchar *tmp = (const gchar *)sqlite3_column_text(self->stmt_kv, 1);
+		if (tmp != NULL)
+			value = g_intern_string(tmp);
+	}
+	sqlite3_reset(self->stmt_kv);
+	return value;
+}
+#endif
+
+/* the caller must hold silo_mutex */
+static const gchar *
+fu_quirks_lookup_by_id_silo(FuQuirks *self, const gchar *guid, const gchar *key)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbNode) n = NULL;
+	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+
+	/* no quirk data */
+	if (self->query_kv == NULL)
+		return NULL;
+
+	/* query */
+	xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
+	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
+	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 1, key, NULL);
+	n = xb_silo_query_first_with_context(self->silo, self->query_kv, &context, &error);
+	if (n == NULL) {
+		if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+			return NULL;
+		if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
+			return NULL;
+		g_warning("failed to query: %s", error->message);
+		return NULL;
+	}
+	if (self->verbose)
+		g_debug("%s:%s → %s", guid, key, xb_node_get_text(n));
+	return xb_node_get_text(n);
+}
+
 /**
  * fu_quirks_lookup_by_id:
  * @self: a #FuQuirks
@@ -461,63 +589,35 @@ fu_quirks_check_silo(FuQuirks *self, GError **error)
 const gchar *
 fu_quirks_lookup_by_id(FuQuirks *self, const gchar *guid, const gchar *key)
 {
+	const gchar *value = NULL;
 	g_autoptr(GError) error = NULL;
-	g_autoptr(XbNode) n = NULL;
-	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+	g_autoptr(GMutexLocker) locker = NULL;
 
 	g_return_val_if_fail(FU_IS_QUIRKS(self), NULL);
 	g_return_val_if_fail(guid != NULL, NULL);
 	g_return_val_if_fail(key != NULL, NULL);
 
-#ifdef HAVE_SQLITE
-	/* this is generated from usb.ids and other static sources */
-	if (self->db != NULL && (self->load_flags & FU_QUIRKS_LOAD_FLAG_NO_CACHE) == 0) {
-		g_autoptr(sqlite3_stmt) stmt = NULL;
-		if (sqlite3_prepare_v2(self->db,
-				       "SELECT key, value FROM quirks WHERE guid = ?1 "
-				       "AND key = ?2 LIMIT 1",
-				       -1,
-				       &stmt,
-				       NULL) != SQLITE_OK) {
-			g_warning("failed to prepare SQL: %s", sqlite3_errmsg(self->db));
-			return NULL;
-		}
-		sqlite3_bind_text(stmt, 1, guid, -1, SQLITE_STATIC);
-		sqlite3_bind_text(stmt, 2, key, -1, SQLITE_STATIC);
-		if (sqlite3_step(stmt) == SQLITE_ROW) {
-			const gchar *value = (const gchar *)sqlite3_column_text(stmt, 1);
-			if (value != NULL)
-				return g_intern_string(value);
-		}
-	}
-#endif
-
-	/* ensure up to date */
-	if (!fu_quirks_check_silo(self, &error)) {
+	/* ensure up to date, which also invalidates the lookup cache if required */
+	locker = g_mutex_locker_new(&self->silo_mutex);
+	if (!fu_quirks_check_silo_unlocked(self, &error)) {
 		g_warning("failed to build silo: %s", error->message);
 		return NULL;
 	}
 
-	/* no quirk data */
-	if (self->query_kv == NULL)
+	/* already looked up, perhaps with no result */
+	value = fu_quirks_lookup_cache_get(self, guid, key);
+	if (value == fu_quirks_lookup_cache_miss)
 		return NULL;
+	if (value != NULL)
+		return value;
 
-	/* query */
-	xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
-	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
-	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 1, key, NULL);
-	n = xb_silo_query_first_with_context(self->silo, self->query_kv, &context, &error);
-	if (n == NULL) {
-		if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
-			return NULL;
-		if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
-			return NULL;
-		g_warning("failed to query: %s", error->message);
-		return NULL;
-	}
-	if (self->verbose)
-		g_debug("%s:%s → %s", guid, key, xb_node_get_text(n));
-	return xb_node_get_text(n);
+#ifdef HAVE_SQLITE
+	value = fu_quirks_lookup_by_id_db(self, guid, key);
+#endif
+	if (value == NULL)
+		value = fu_quirks_lookup_by_id_silo(self, guid, key);
+	fu_quirks_lookup_cache_set(self, guid, key, value);
+	return value;
 }
 
 /**
@@ -542,6 +642,7 @@ fu_quirks_lookup_by_id_iter(FuQuirks *self,
 			    gpointer user_data)
 {
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GMutexLocker) locker = NULL;
 	g_autoptr(GPtrArray) results = NULL;
 	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
 
@@ -551,41 +652,38 @@ fu_quirks_lookup_by_id_iter(FuQuirks *self,
 
 #ifdef HAVE_SQLITE
 	/* this is generated from usb.ids and other static sources */
-	if (self->db != NULL && (self->load_flags & FU_QUIRKS_LOAD_FLAG_NO_CACHE) == 0) {
-		g_autoptr(sqlite3_stmt) stmt = NULL;
-		if (key == NULL) {
-			if (sqlite3_prepare_v2(self->db,
-					       "SELECT key, value FROM quirks WHERE guid = ?1",
-					       -1,
-					       &stmt,
-					       NULL) != SQLITE_OK) {
-				g_warning("failed to prepare SQL: %s", sqlite3_errmsg(self->db));
-				return FALSE;
-			}
-			sqlite3_bind_text(stmt, 1, guid, -1, SQLITE_STATIC);
-		} else {
-			if (sqlite3_prepare_v2(self->db,
-					       "SELECT key, value FROM quirks WHERE guid = ?1 "
-					       "AND key = ?2",
-					       -1,
-					       &stmt,
-					       NULL) != SQLITE_OK) {
-				g_warning("failed to prepare SQL: %s", sqlite3_errmsg(self->db));
-				return FALSE;
-			}
-			sqlite3_bind_text(stmt, 1, guid, -1, SQLITE_STATIC);
+	if (self->stmt_kv != NULL && self->stmt_vs != NULL) {
+		g_autoptr(GPtrArray) kvs = g_ptr_array_new_with_free_func(g_free);
+		sqlite3_stmt *stmt = key != NULL ? self->stmt_kv : self->stmt_vs;
+
+		/* the callback may do other lookups, so do not hold the lock when calling it */
+		g_mutex_lock(&self->mutex);
+		sqlite3_reset(stmt);
+		sqlite3_clear_bindings(stmt);
+		sqlite3_bind_text(stmt, 1, guid, -1, SQLITE_STATIC);
+		if (key != NULL)
 			sqlite3_bind_text(stmt, 2, key, -1, SQLITE_STATIC);
-		}
 		while (sqlite3_step(stmt) == SQLITE_ROW) {
 			const gchar *key_tmp = (const gchar *)sqlite3_column_text(stmt, 0);
 			const gchar *value = (const gchar *)sqlite3_column_text(stmt, 1);
-			iter_cb(self, key_tmp, value, FU_CONTEXT_QUIRK_SOURCE_DB, user_data);
+			g_ptr_array_add(kvs, g_strdup(key_tmp));
+			g_ptr_array_add(kvs, g_strdup(value));
+		}
+		sqlite3_reset(stmt);
+		g_mutex_unlock(&self->mutex);
+		for (guint i = 0; i + 1 < kvs->len; i += 2) {
+			iter_cb(self,
+				g_ptr_array_index(kvs, i),
+				g_ptr_array_index(kvs, i + 1),
+				FU_CONTEXT_QUIRK_SOURCE_DB,
+				user_data);
 		}
 	}
 #endif
 
 	/* ensure up to date */
-	if (!fu_quirks_check_silo(self, &error)) {
+	locker = g_mutex_locker_new(&self->silo_mutex);
+	if (!fu_quirks_check_silo_unlocked(self, &error)) {
 		g_warning("failed to build silo: %s", error->message);
 		return FALSE;
 	}
@@ -613,6 +711,9 @@ fu_quirks_lookup_by_id_iter(FuQuirks *self,
 		g_warning("failed to query: %s", error->message);
 		return FALSE;
 	}
+
+	/* the callback may do other lookups, and the nodes keep a reference to the silo */
+	g_clear_pointer(&locker, g_mutex_locker_free);
 	for (guint i = 0; i < results->len; i++) {
 		XbNode *n = g_ptr_array_index(results, i);
 		if (self->verbose)
@@ -977,6 +1078,39 @@ fu_quirks_db_load(FuQuirks *self, FuQuirksLoadFlags load_flags, GError **error)
 	/* success */
 	return TRUE;
 }
+
+/* kept for the lifetime of the object as lookups happen thousands of times during coldplug */
+static gboolean
+fu_quirks_db_prepare(FuQuirks *self, GError **error)
+{
+	if (sqlite3_prepare_v3(self->db,
+			       "SELECT key, value FROM quirks WHERE guid = ?1 AND key = ?2",
+			       -1,
+			       SQLITE_PREPARE_PERSISTENT,
+			       &self->stmt_kv,
+			       NULL) != SQLITE_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INTERNAL,
+			    "failed to prepare SQL: %s",
+			    sqlite3_errmsg(self->db));
+		return FALSE;
+	}
+	if (sqlite3_prepare_v3(self->db,
+			       "SELECT key, value FROM quirks WHERE guid = ?1",
+			       -1,
+			       SQLITE_PREPARE_PERSISTENT,
+			       &self->stmt_vs,
+			       NULL) != SQLITE_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INTERNAL,
+			    "failed to prepare SQL: %s",
+			    sqlite3_errmsg(self->db));
+		return FALSE;
+	}
+	return TRUE;
+}
 #endif
 
 /**
@@ -998,12 +1132,14 @@ fu_quirks_load(FuQuirks *self, FuQuirksLoadFlags load_flags, GError **error)
 	g_autofree gchar *cachedirpkg = fu_path_from_kind(FU_PATH_KIND_CACHEDIR_PKG);
 	g_autofree gchar *quirksdb = g_build_filename(cachedirpkg, "quirks.db", NULL);
 #endif
+	g_autoptr(GMutexLocker) locker = NULL;
 
 	g_return_val_if_fail(FU_IS_QUIRKS(self), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	self->load_flags = load_flags;
 	self->verbose = g_getenv("FWUPD_XMLB_VERBOSE") != NULL;
+	fu_quirks_lookup_cache_invalidate(self);
 
 #ifdef HAVE_SQLITE
 	if (self->db == NULL && (load_flags & FU_QUIRKS_LOAD_FLAG_NO_CACHE) == 0) {
@@ -1021,11 +1157,22 @@ fu_quirks_load(FuQuirks *self, FuQuirksLoadFlags load_flags, GError **error)
 		}
 		if (!fu_quirks_db_load(self, load_flags, error))
 			return FALSE;
+		if (!fu_quirks_db_prepare(self, error))
+			return FALSE;
 	}
 #endif
 
+	/* remember lookups, including ones with no result */
+	if (self->lookup_cache == NULL && (load_flags & FU_QUIRKS_LOAD_FLAG_NO_LOOKUP_CACHE) == 0) {
+		self->lookup_cache = g_hash_table_new_full(g_str_hash,
+							   g_str_equal,
+							   g_free,
+							   (GDestroyNotify)g_hash_table_unref);
+	}
+
 	/* now silo */
-	return fu_quirks_check_silo(self, error);
+	locker = g_mutex_locker_new(&self->silo_mutex);
+	return fu_quirks_check_silo_unlocked(self, error);
 }
 
 /**
@@ -1049,6 +1196,7 @@ fu_quirks_add_possible_key(FuQuirks *self, const gchar *possible_key)
 static void
 fu_quirks_housekeeping_cb(FuContext *ctx, FuQuirks *self)
 {
+	fu_quirks_lookup_cache_invalidate(self);
 #ifdef HAVE_SQLITE
 	sqlite3_release_memory(G_MAXINT32);
 	if (self->db != NULL)
@@ -1079,6 +1227,8 @@ fu_quirks_init(FuQuirks *self)
 {
 	self->possible_keys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 	self->invalid_keys = g_ptr_array_new_with_free_func(g_free);
+	g_mutex_init(&self->silo_mutex);
+	g_mutex_init(&self->mutex);
 
 	/* built in */
 	fu_quirks_add_possible_key(self, FU_QUIRKS_BRANCH);
@@ -1136,9 +1286,17 @@ fu_quirks_finalize(GObject *obj)
 	if (self->silo != NULL)
 		g_object_unref(self->silo);
 #ifdef HAVE_SQLITE
+	if (self->stmt_kv != NULL)
+		sqlite3_finalize(self->stmt_kv);
+	if (self->stmt_vs != NULL)
+		sqlite3_finalize(self->stmt_vs);
 	if (self->db != NULL)
 		sqlite3_close(self->db);
 #endif
+	if (self->lookup_cache != NULL)
+		g_hash_table_unref(self->lookup_cache);
+	g_mutex_clear(&self->silo_mutex);
+	g_mutex_clear(&self->mutex);
 	g_hash_table_unref(self->possible_keys);
 	g_ptr_array_unref(self->invalid_keys);
 	G_OBJECT_CLASS(fu_quirks_parent_class)->finalize(obj);
@@ -18,6 +18,7 @@ G_DECLARE_FINAL_TYPE(FuQuirks, fu_quirks, FU, QUIRKS, GObject)
  * @FU_QUIRKS_LOAD_FLAG_READONLY_FS:	Ignore readonly filesystem errors
  * @FU_QUIRKS_LOAD_FLAG_NO_CACHE:	Do not save to a persistent cache
  * @FU_QUIRKS_LOAD_FLAG_NO_VERIFY:	Do not check the key files for errors
+ * @FU_QUIRKS_LOAD_FLAG_NO_LOOKUP_CACHE:	Do not remember the results of lookups
  *
  * The flags to use when loading quirks.
  **/
@@ -26,6 +27,7 @@ typedef enum {
 	FU_QUIRKS_LOAD_FLAG_READONLY_FS = 1 << 0,
 	FU_QUIRKS_LOAD_FLAG_NO_CACHE = 1 << 1,
 	FU_QUIRKS_LOAD_FLAG_NO_VERIFY = 1 << 2,
+	FU_QUIRKS_LOAD_FLAG_NO_LOOKUP_CACHE = 1 << 3,
 	/*< private >*/
 	FU_QUIRKS_LOAD_FLAG_LAST
 } FuQuirksLoadFlags;
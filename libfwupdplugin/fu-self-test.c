@@ -12,6 +12,7 @@
 
 #include <glib/gstdio.h>
 #include <string.h>
+#include <utime.h>
 
 #include "fwupd-enums-private.h"
 #include "fwupd-security-attr-private.h"
@@ -23,6 +24,7 @@
 #include "fu-config-private.h"
 #include "fu-context-private.h"
 #include "fu-coswid-firmware.h"
+#include "fu-crc-private.h"
 #include "fu-device-event-private.h"
 #include "fu-device-private.h"
 #include "fu-device-progress.h"
@@ -431,6 +433,80 @@ fu_common_crc_func(void)
 	g_assert_cmpint(fu_crc32(FU_CRC_KIND_B32_Q, buf, sizeof(buf)), ==, 0xE955C875);
 }
 
+/* the lookup tables must match the bitwise reference for every kind, alignment and length */
+static void
+fu_common_crc_tables_func(void)
+{
+	guint8 buf[0x1000];
+
+	for (gsize i = 0; i < sizeof(buf); i++)
+		buf[i] = (guint8)g_random_int();
+	for (FuCrcKind kind = FU_CRC_KIND_B32_STANDARD; kind < FU_CRC_KIND_LAST; kind++) {
+		guint bitwidth = fu_crc_kind_get_bitwidth(kind);
+		for (gsize offset = 0; offset < 9; offset++) {
+			gsize bufsz = sizeof(buf) - offset - g_random_int_range(0, 9);
+			guint32 crc_bitwise = fu_crc_step_bitwise(kind, buf + offset, bufsz, 0x0);
+			guint32 crc = 0x0;
+
+			/* split to exercise both the slice-by-8 and the bytewise paths */
+			if (bitwidth == 32) {
+				crc = fu_crc32_step(kind, buf + offset, 3, crc);
+				crc = fu_crc32_step(kind, buf + offset + 3, bufsz - 3, crc);
+			} else if (bitwidth == 16) {
+				crc = fu_crc16_step(kind, buf + offset, 3, crc);
+				crc = fu_crc16_step(kind, buf + offset + 3, bufsz - 3, crc);
+			} else if (bitwidth == 8) {
+				crc = fu_crc8_step(kind, buf + offset, 3, crc);
+				crc = fu_crc8_step(kind, buf + offset + 3, bufsz - 3, crc);
+			}
+			g_assert_cmpint(crc, ==, crc_bitwise);
+		}
+	}
+}
+
+static void
+fu_common_crc_performance_func(void)
+{
+	const gsize bufsz = 0x100000;
+	g_autofree guint8 *buf = g_malloc(bufsz);
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	for (gsize i = 0; i < bufsz; i++)
+		buf[i] = (guint8)g_random_int();
+
+	for (FuCrcKind kind = FU_CRC_KIND_B32_STANDARD; kind < FU_CRC_KIND_LAST; kind++) {
+		guint bitwidth = fu_crc_kind_get_bitwidth(kind);
+		guint32 crc_bitwise;
+		guint32 crc = 0x0;
+		gdouble elapsed_bitwise;
+		gdouble elapsed;
+
+		g_timer_reset(timer);
+		crc_bitwise = fu_crc_step_bitwise(kind, buf, bufsz, 0x0);
+		elapsed_bitwise = g_timer_elapsed(timer, NULL);
+
+		/* split to exercise both the slice-by-8 and the bytewise paths */
+		g_timer_reset(timer);
+		if (bitwidth == 32) {
+			crc = fu_crc32_step(kind, buf, 3, crc);
+			crc = fu_crc32_step(kind, buf + 3, bufsz - 3, crc);
+		} else if (bitwidth == 16) {
+			crc = fu_crc16_step(kind, buf, 3, crc);
+			crc = fu_crc16_step(kind, buf + 3, bufsz - 3, crc);
+		} else if (bitwidth == 8) {
+			crc = fu_crc8_step(kind, buf, 3, crc);
+			crc = fu_crc8_step(kind, buf + 3, bufsz - 3, crc);
+		}
+		elapsed = g_timer_elapsed(timer, NULL);
+		if (crc != crc_bitwise)
+			g_warning("kind%u does not match bitwise reference", (guint)kind);
+		g_print("kind%u=%.0fMB/s(bitwise=%.0fMB/s) ",
+			(guint)kind,
+			1.f / elapsed,
+			1.f / elapsed_bitwise);
+	}
+}
+
 static void
 fu_common_guid_func(void)
 {
@@ -871,6 +947,57 @@ fu_context_udev_subsystems_func(void)
 	g_assert_cmpint(plugin_names2->len, ==, 1);
 }
 
+static void
+fu_metrics_func(void)
+{
+	guint64 *value;
+	g_autoptr(FuMetrics) metrics = fu_metrics_new();
+	g_autoptr(GHashTable) values = NULL;
+
+	/* counters */
+	fu_metrics_add_counter(metrics, "Foo", 5);
+	fu_metrics_add_counter(metrics, "Foo", 7);
+	g_assert_cmpint(fu_metrics_get_counter(metrics, "Foo"), ==, 12);
+	g_assert_cmpint(fu_metrics_get_counter(metrics, "Bar"), ==, 0);
+
+	/* durations */
+	for (guint i = 0; i < 9; i++)
+		fu_metrics_add_duration(metrics, "Bar", 10);
+	fu_metrics_add_duration(metrics, "Bar", 1000);
+	g_assert_cmpint(fu_metrics_get_duration_count(metrics, "Bar"), ==, 10);
+	g_assert_cmpint(fu_metrics_get_duration_count(metrics, "Foo"), ==, 0);
+	g_assert_cmpint(fu_metrics_get_duration_percentile(metrics, "Bar", 50), ==, 15);
+	g_assert_cmpint(fu_metrics_get_duration_percentile(metrics, "Bar", 90), ==, 15);
+	g_assert_cmpint(fu_metrics_get_duration_percentile(metrics, "Bar", 99), ==, 1000);
+
+	/* both at once */
+	fu_metrics_add_duration_since_with_counter(metrics,
+						   "Bar",
+						   g_get_monotonic_time() + 1000,
+						   "Foo",
+						   3);
+	g_assert_cmpint(fu_metrics_get_duration_count(metrics, "Bar"), ==, 11);
+	g_assert_cmpint(fu_metrics_get_counter(metrics, "Foo"), ==, 15);
+
+	/* snapshot */
+	values = fu_metrics_get_values(metrics);
+	g_assert_cmpint(g_hash_table_size(values), ==, 7);
+	value = g_hash_table_lookup(values, "Foo");
+	g_assert_nonnull(value);
+	g_assert_cmpint(*value, ==, 15);
+	value = g_hash_table_lookup(values, "Bar.TotalUs");
+	g_assert_nonnull(value);
+	g_assert_cmpint(*value, ==, 1090);
+	value = g_hash_table_lookup(values, "Bar.MaxUs");
+	g_assert_nonnull(value);
+	g_assert_cmpint(*value, ==, 1000);
+
+	/* clear */
+	fu_metrics_reset(metrics);
+	g_assert_cmpint(fu_metrics_get_counter(metrics, "Foo"), ==, 0);
+	g_assert_cmpint(fu_metrics_get_duration_count(metrics, "Bar"), ==, 0);
+}
+
 static void
 fu_context_state_func(void)
 {
@@ -1038,6 +1165,78 @@ fu_common_memmem_func(void)
 	g_assert_false(ret);
 }
 
+static void
+fu_mem_search_func(void)
+{
+	const guint8 haystack[] = {'H', 'A', 'Y', 'S', 'T', 'A', 'C', 'K'};
+	const guint8 needle1[] = {'T', 'A', 'C'};
+	const guint8 needle2[] = {'A', 'Y'};
+	const guint8 needle3[] = {'X'};
+	gboolean ret;
+	gsize offset = 0;
+	guint idx = G_MAXUINT;
+	g_autoptr(FuMemSearch) search = fu_mem_search_new();
+	g_autoptr(FuMemSearch) search_missing = fu_mem_search_new();
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	g_assert_cmpint(fu_mem_search_add_needle(search, needle1, sizeof(needle1)), ==, 0);
+	g_assert_cmpint(fu_mem_search_add_needle(search, needle2, sizeof(needle2)), ==, 1);
+	g_assert_cmpint(fu_mem_search_get_needle_count(search), ==, 2);
+
+	/* the earliest needle is returned */
+	ret = fu_mem_search_find(search, haystack, sizeof(haystack), 0x0, &offset, &idx, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, 0x1);
+	g_assert_cmpint(idx, ==, 1);
+
+	/* search from an offset */
+	ret = fu_mem_search_find(search, haystack, sizeof(haystack), 0x2, &offset, &idx, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, 0x4);
+	g_assert_cmpint(idx, ==, 0);
+
+	/* not found */
+	fu_mem_search_add_needle(search_missing, needle3, sizeof(needle3));
+	ret = fu_mem_search_find(search_missing,
+				 haystack,
+				 sizeof(haystack),
+				 0x0,
+				 &offset,
+				 &idx,
+				 &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* needle spanning the block boundary of a stream */
+	fu_byte_array_set_size(buf, 0x20000, 0x0);
+	ret = fu_memcpy_safe(buf->data,
+			     buf->len,
+			     0xFFFF, /* dst */
+			     needle1,
+			     sizeof(needle1),
+			     0x0, /* src */
+			     sizeof(needle1),
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	blob = g_bytes_new(buf->data, buf->len);
+	stream = g_memory_input_stream_new_from_bytes(blob);
+	ret = fu_mem_search_find_stream(search, stream, 0x0, &offset, &idx, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, 0xFFFF);
+	g_assert_cmpint(idx, ==, 0);
+	ret = fu_mem_search_find_stream(search, stream, 0x10000, &offset, &idx, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_false(ret);
+}
+
 static void
 fu_strpassmask_func(void)
 {
@@ -1596,16 +1795,17 @@ fu_plugin_quirks_func(void)
 }
 
 static void
-fu_plugin_quirks_performance_func(void)
+fu_plugin_quirks_performance_load_flags(FuQuirksLoadFlags load_flags)
 {
 	gboolean ret;
+	gdouble elapsed;
 	g_autoptr(FuContext) ctx = fu_context_new();
 	g_autoptr(FuQuirks) quirks = fu_quirks_new(ctx);
 	g_autoptr(GTimer) timer = g_timer_new();
 	g_autoptr(GError) error = NULL;
-	const gchar *keys[] = {"Name", "Children", "Flags", NULL};
+	const gchar *keys[] = {"Name", "Children", "Flags", "NotGoingToExist", NULL};
 
-	ret = fu_quirks_load(quirks, FU_QUIRKS_LOAD_FLAG_NO_CACHE, &error);
+	ret = fu_quirks_load(quirks, load_flags, &error);
 	g_assert_no_error(error);
 	g_assert_true(ret);
 
@@ -1615,10 +1815,25 @@ fu_plugin_quirks_performance_func(void)
 		const gchar *group = "bb9ec3e2-77b3-53bc-a1f1-b05916715627";
 		for (guint i = 0; keys[i] != NULL; i++) {
 			const gchar *tmp = fu_quirks_lookup_by_id(quirks, group, keys[i]);
-			g_assert_cmpstr(tmp, !=, NULL);
+			if (g_strcmp0(keys[i], "NotGoingToExist") == 0)
+				g_assert_cmpstr(tmp, ==, NULL);
+			else
+				g_assert_cmpstr(tmp, !=, NULL);
 		}
 	}
-	g_print("lookup=%.3fms ", g_timer_elapsed(timer, NULL) * 1000.f);
+	elapsed = g_timer_elapsed(timer, NULL);
+	g_print("%s lookup=%.3fms (%.0f/s) ",
+		load_flags & FU_QUIRKS_LOAD_FLAG_NO_LOOKUP_CACHE ? "uncached" : "cached",
+		elapsed * 1000.f,
+		(1000.f * (G_N_ELEMENTS(keys) - 1)) / elapsed);
+}
+
+static void
+fu_plugin_quirks_performance_func(void)
+{
+	fu_plugin_quirks_performance_load_flags(FU_QUIRKS_LOAD_FLAG_NO_CACHE |
+						FU_QUIRKS_LOAD_FLAG_NO_LOOKUP_CACHE);
+	fu_plugin_quirks_performance_load_flags(FU_QUIRKS_LOAD_FLAG_NO_CACHE);
 }
 
 typedef struct {
@@ -2202,6 +2417,68 @@ fu_device_event_donor_func(void)
 	g_assert_cmpint(events->len, ==, 3);
 }
 
+static void
+fu_device_event_replay_func(void)
+{
+	FuDeviceEvent *event;
+	g_autoptr(FuDevice) device = fu_device_new(NULL);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	/* lots of repeated IDs, like a DFU download */
+	fu_device_save_event(device, "Usb:Reset");
+	for (guint i = 0; i < 10000; i++) {
+		g_autofree gchar *id = g_strdup_printf("Usb:ControlTransfer=%u", i % 3);
+		event = fu_device_save_event(device, id);
+		fu_device_event_set_i64(event, "Idx", i);
+	}
+
+	/* in-order */
+	g_timer_reset(timer);
+	event = fu_device_load_event(device, "Usb:Reset", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(event);
+	for (guint i = 0; i < 10000; i++) {
+		g_autofree gchar *id = g_strdup_printf("Usb:ControlTransfer=%u", i % 3);
+		event = fu_device_load_event(device, id, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(event);
+		g_assert_cmpint(fu_device_event_get_i64(event, "Idx", NULL), ==, i);
+	}
+	g_print("replay=%.3fms ", g_timer_elapsed(timer, NULL) * 1000.f);
+
+	/* wraps around to the start, skipping the first event */
+	event = fu_device_load_event(device, "Usb:ControlTransfer=1", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(event);
+	g_assert_cmpint(fu_device_event_get_i64(event, "Idx", NULL), ==, 1);
+
+	/* out-of-order */
+	event = fu_device_load_event(device, "Usb:Reset", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_cmpstr(error->message, ==, "found out-of-order event Usb:Reset at position 0");
+	g_assert_null(event);
+	g_clear_error(&error);
+
+	/* added after the index was built */
+	fu_device_save_event(device, "Usb:Reset");
+	event = fu_device_load_event(device, "Usb:Reset", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(event);
+
+	/* unknown */
+	event = fu_device_load_event(device, "Usb:ControlTransfer=3", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(event);
+	g_clear_error(&error);
+
+	/* cleared */
+	fu_device_clear_events(device);
+	event = fu_device_load_event(device, "Usb:ControlTransfer=0", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(event);
+}
+
 static void
 fu_device_event_func(void)
 {
@@ -2264,6 +2541,88 @@ fu_device_event_func(void)
 	g_assert_false(ret);
 }
 
+static void
+fu_device_event_binary_func(void)
+{
+	gboolean ret;
+	const guint8 buf_bad[] = {
+	    0x00, 0x00, 0x00, 0x00,		/* no ID */
+	    FU_DEVICE_EVENT_VALUE_KIND_INT64,	/* kind */
+	    0x02, 0x00, 'R',  'c',		/* key */
+	    0x04, 0x00, 0x00, 0x00,		/* value size, which should be 8 */
+	    0xFF, 0xFF, 0xFF, 0xFF,
+	};
+	g_autofree gchar *json1 = NULL;
+	g_autofree gchar *json2 = NULL;
+	g_autoptr(FuDeviceEvent) event1 = fu_device_event_new("foo:bar:baz");
+	g_autoptr(FuDeviceEvent) event2 = fu_device_event_new(NULL);
+	g_autoptr(FuDeviceEvent) event3 = fu_device_event_new(NULL);
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GBytes) blob1 = g_bytes_new_static("hello", 6);
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GBytes) blob3 = NULL;
+	g_autoptr(GBytes) blob_bad = g_bytes_new_static(buf_bad, sizeof(buf_bad));
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GString) key_long = g_string_new(NULL);
+
+	for (guint i = 0; i < 300; i++)
+		g_string_append_c(key_long, 'a' + (i % 26));
+	fu_device_event_set_str(event1, "Name", "Richard");
+	fu_device_event_set_str(event1, "Empty", "");
+	fu_device_event_set_str(event1, "Base64", "aGVsbG8=");
+	fu_device_event_set_str(event1, key_long->str, "long");
+	fu_device_event_set_i64(event1, "Age", -123);
+	fu_device_event_set_bytes(event1, "Blob", blob1);
+	fu_device_event_set_data(event1, "Data", NULL, 0);
+	ret = fu_device_event_append_binary(event1, buf, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* the binary values are not base64 encoded, and strings are not decoded */
+	blob2 = g_bytes_new(buf->data, buf->len);
+	ret = fu_device_event_parse_binary(event2, blob2, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpstr(fu_device_event_get_id(event2), ==, "#f9f98a90");
+	g_assert_cmpstr(fu_device_event_get_str(event2, "Name", NULL), ==, "Richard");
+	g_assert_cmpstr(fu_device_event_get_str(event2, "Empty", NULL), ==, "");
+	g_assert_cmpstr(fu_device_event_get_str(event2, "Base64", NULL), ==, "aGVsbG8=");
+	g_assert_cmpstr(fu_device_event_get_str(event2, key_long->str, NULL), ==, "long");
+	g_assert_cmpint(fu_device_event_get_i64(event2, "Age", NULL), ==, -123);
+	blob3 = fu_device_event_get_bytes(event2, "Blob", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob3);
+	g_assert_cmpstr(g_bytes_get_data(blob3, NULL), ==, "hello");
+
+	/* the binary value is not converted to a string when read */
+	g_assert_null(fu_device_event_get_str(event2, "Blob", &error));
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_clear_error(&error);
+
+	/* the JSON is identical, including the uncompressed ID */
+	json1 = fwupd_codec_to_json_string(FWUPD_CODEC(event1), FWUPD_CODEC_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	json2 = fwupd_codec_to_json_string(FWUPD_CODEC(event2), FWUPD_CODEC_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(json1, ==, json2);
+	g_assert_nonnull(g_strstr_len(json2, -1, "foo:bar:baz"));
+
+	/* truncated */
+	g_bytes_unref(blob2);
+	blob2 = g_bytes_new(buf->data, buf->len - 1);
+	ret = fu_device_event_parse_binary(event3, blob2, &error);
+	g_assert_nonnull(error);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* integers have to be the right size */
+	g_clear_object(&event3);
+	event3 = fu_device_event_new(NULL);
+	ret = fu_device_event_parse_binary(event3, blob_bad, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+}
+
 static void
 fu_device_event_uncompressed_func(void)
 {
@@ -2352,9 +2711,11 @@ static void
 fu_device_instance_ids_func(void)
 {
 	gboolean ret;
+	g_autofree gchar *guid_upper = NULL;
 	g_autoptr(FuContext) ctx = fu_context_new();
 	g_autoptr(FuDevice) device = fu_device_new(ctx);
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) counterpart_guids = NULL;
 
 	/* do not save silo */
 	ret = fu_context_load_quirks(ctx, FU_QUIRKS_LOAD_FLAG_NO_CACHE, &error);
@@ -2376,6 +2737,20 @@ fu_device_instance_ids_func(void)
 	/* this gets added immediately */
 	fu_device_add_instance_id(device, "bazbarfoo");
 	g_assert_true(fu_device_has_guid(device, "77e49bb0-2cd6-5faf-bcee-5b7fbe6e944d"));
+
+	/* counterpart GUIDs are compared in binary form */
+	fu_device_add_instance_id_full(device, "bootloader", FU_DEVICE_INSTANCE_FLAG_COUNTERPART);
+	counterpart_guids = fu_device_get_counterpart_guids(device);
+	g_assert_cmpint(counterpart_guids->len, ==, 1);
+	g_assert_true(fu_device_has_instance_id(device,
+						g_ptr_array_index(counterpart_guids, 0),
+						FU_DEVICE_INSTANCE_FLAG_COUNTERPART));
+	guid_upper = g_ascii_strup(g_ptr_array_index(counterpart_guids, 0), -1);
+	g_assert_true(
+	    fu_device_has_instance_id(device, guid_upper, FU_DEVICE_INSTANCE_FLAG_COUNTERPART));
+	g_assert_false(
+	    fu_device_has_instance_id(device, guid_upper, FU_DEVICE_INSTANCE_FLAG_VISIBLE));
+	g_assert_false(fu_device_has_guid(device, guid_upper));
 }
 
 static void
@@ -3012,6 +3387,69 @@ fu_chunk_array_func(void)
 	g_assert_null(chk4);
 }
 
+static void
+fu_chunk_array_stream_func(void)
+{
+	gboolean ret;
+	guint cnt = 0;
+	guint idx = 0;
+	guint8 buf[0x100] = {0x0};
+	g_autoptr(FuChunk) chk = NULL;
+	g_autoptr(FuChunkArray) chunks = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	for (guint i = 0; i < sizeof(buf); i++)
+		buf[i] = i;
+	blob = g_bytes_new(buf, sizeof(buf));
+	stream = g_memory_input_stream_new_from_bytes(blob);
+	chunks = fu_chunk_array_new_from_stream(stream, 0x0, FU_CHUNK_PAGESZ_NONE, 7, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(chunks);
+	g_assert_cmpint(fu_chunk_array_length(chunks), ==, 37);
+
+	/* blocks of whole chunks */
+	fu_chunk_array_set_readahead(chunks, 0x20);
+	while (TRUE) {
+		g_autoptr(FuChunk) chk_tmp = NULL;
+		ret = fu_chunk_array_iterate(chunks, &idx, &chk_tmp, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		if (chk_tmp == NULL)
+			break;
+		g_assert_cmpint(fu_chunk_get_idx(chk_tmp), ==, cnt);
+		g_assert_cmpint(fu_chunk_get_address(chk_tmp), ==, cnt * 7);
+		g_assert_cmpint(fu_chunk_get_data_sz(chk_tmp), ==, cnt == 36 ? 4 : 7);
+		g_assert_cmpint(fu_chunk_get_data(chk_tmp)[0], ==, cnt * 7);
+		cnt++;
+	}
+	g_assert_cmpint(cnt, ==, 37);
+
+	/* random access still works */
+	chk = fu_chunk_array_index(chunks, 3, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(chk);
+	g_assert_cmpint(fu_chunk_get_data(chk)[0], ==, 21);
+	g_clear_object(&chk);
+
+	/* stopping early does not affect the next iteration */
+	idx = 0;
+	ret = fu_chunk_array_iterate(chunks, &idx, &chk, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_nonnull(chk);
+	g_assert_cmpint(fu_chunk_get_idx(chk), ==, 0);
+	g_clear_object(&chk);
+	idx = 0;
+	ret = fu_chunk_array_iterate(chunks, &idx, &chk, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_nonnull(chk);
+	g_assert_cmpint(fu_chunk_get_idx(chk), ==, 0);
+	g_assert_cmpint(idx, ==, 1);
+}
+
 static void
 fu_chunk_func(void)
 {
@@ -4431,6 +4869,103 @@ fu_firmware_common_func(void)
 	g_assert_false(ret);
 }
 
+static void
+fu_firmware_checksums_func(void)
+{
+	GChecksumType csum_kinds[] = {G_CHECKSUM_SHA1, G_CHECKSUM_SHA256};
+	g_autofree gchar *csum1 = NULL;
+	g_autofree gchar *csum2 = NULL;
+	g_autoptr(FuFirmware) firmware = fu_firmware_new();
+	g_autoptr(GBytes) blob1 = g_bytes_new_static("hello", 5);
+	g_autoptr(GBytes) blob2 = g_bytes_new_static("world", 5);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) csums = NULL;
+
+	fu_firmware_set_bytes(firmware, blob1);
+	csums = fu_firmware_get_checksums(firmware, csum_kinds, G_N_ELEMENTS(csum_kinds), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(csums);
+	g_assert_cmpint(csums->len, ==, 2);
+	g_assert_cmpstr(g_ptr_array_index(csums, 0),
+			==,
+			"aaf4c61ddcc5e8a2dabede0f3b482cd9aea9434d");
+	g_assert_cmpstr(g_ptr_array_index(csums, 1),
+			==,
+			"2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824");
+
+	/* remembered */
+	csum1 = fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA256, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(csum1, ==, g_ptr_array_index(csums, 1));
+
+	/* changing the contents invalidates */
+	fu_firmware_set_bytes(firmware, blob2);
+	csum2 = fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA256, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(csum2,
+			==,
+			"486ea46224d1bb4fb680f34f7c9ad96a8f24ec88be73ea8e5a6c65260e9cb8a7");
+}
+
+static void
+fu_firmware_checksum_image_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = fu_firmware_new();
+	g_autoptr(FuFirmware) img1 = fu_firmware_new();
+	g_autoptr(FuFirmware) img2 = fu_firmware_new();
+	g_autoptr(FuFirmware) img_empty = fu_firmware_new();
+	g_autoptr(FuFirmware) img_tmp1 = NULL;
+	g_autoptr(FuFirmware) img_tmp2 = NULL;
+	g_autoptr(FuFirmware) img_tmp3 = NULL;
+	g_autoptr(FuFirmware) img_tmp4 = NULL;
+	g_autoptr(GBytes) blob1 = g_bytes_new_static("hello", 5);
+	g_autoptr(GBytes) blob2 = g_bytes_new_static("world", 5);
+	g_autoptr(GError) error = NULL;
+
+	fu_firmware_set_bytes(img1, blob1);
+	fu_firmware_add_image(firmware, img1);
+	fu_firmware_set_bytes(img2, blob1);
+	fu_firmware_add_image(firmware, img2);
+
+	/* this has no payload, so cannot be checksummed, but does not break the others */
+	fu_firmware_add_image(firmware, img_empty);
+
+	/* the first image wins */
+	img_tmp1 = fu_firmware_get_image_by_checksum(
+	    firmware,
+	    "2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824",
+	    &error);
+	g_assert_no_error(error);
+	g_assert_true(img_tmp1 == img1);
+
+	/* changing the child contents invalidates the index */
+	fu_firmware_set_bytes(img2, blob2);
+	img_tmp2 = fu_firmware_get_image_by_checksum(
+	    firmware,
+	    "486ea46224d1bb4fb680f34f7c9ad96a8f24ec88be73ea8e5a6c65260e9cb8a7",
+	    &error);
+	g_assert_no_error(error);
+	g_assert_true(img_tmp2 == img2);
+
+	/* a different checksum kind */
+	img_tmp3 = fu_firmware_get_image_by_checksum(firmware,
+						     "aaf4c61ddcc5e8a2dabede0f3b482cd9aea9434d",
+						     &error);
+	g_assert_no_error(error);
+	g_assert_true(img_tmp3 == img1);
+
+	/* removing the image invalidates the index */
+	ret = fu_firmware_remove_image(firmware, img1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	img_tmp4 = fu_firmware_get_image_by_checksum(firmware,
+						     "aaf4c61ddcc5e8a2dabede0f3b482cd9aea9434d",
+						     &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(img_tmp4);
+}
+
 static void
 fu_firmware_dedupe_func(void)
 {
@@ -4597,6 +5132,9 @@ fu_efivar_boot_func(void)
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GPtrArray) entries = NULL;
 	g_autoptr(GPtrArray) esp_files = NULL;
+	g_autofree gchar *checksum = NULL;
+	FuContextEspFileFlags flags = FU_CONTEXT_ESP_FILE_FLAG_INCLUDE_FIRST_STAGE |
+				      FU_CONTEXT_ESP_FILE_FLAG_USE_CHECKSUM_CACHE;
 	FuEfivars *efivars = fu_context_get_efivars(ctx);
 
 	/* set and get BootCurrent */
@@ -4670,6 +5208,208 @@ fu_efivar_boot_func(void)
 	g_assert_cmpint(esp_files->len, ==, 2);
 	firmware_tmp = g_ptr_array_index(esp_files, 0);
 	g_assert_cmpstr(fu_firmware_get_filename(firmware_tmp), ==, pefile_fn);
+	checksum = fu_firmware_get_checksum(firmware_tmp, G_CHECKSUM_SHA256, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(checksum);
+
+	/* the second time the checksum comes from the cache */
+	for (guint i = 0; i < 2; i++) {
+		g_autofree gchar *checksum_tmp = NULL;
+		g_autoptr(GPtrArray) esp_files_tmp = NULL;
+
+		esp_files_tmp = fu_context_get_esp_files(ctx, flags, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(esp_files_tmp);
+		g_assert_cmpint(esp_files_tmp->len, ==, 2);
+		firmware_tmp = g_ptr_array_index(esp_files_tmp, 0);
+		g_assert_cmpstr(fu_firmware_get_filename(firmware_tmp), ==, pefile_fn);
+		g_assert_cmpint(fu_firmware_get_idx(firmware_tmp), ==, 0x0001);
+		checksum_tmp = fu_firmware_get_checksum(firmware_tmp, G_CHECKSUM_SHA256, &error);
+		g_assert_no_error(error);
+		g_assert_cmpstr(checksum_tmp, ==, checksum);
+	}
+}
+
+static void
+fu_efivar_esp_files_cache_func(void)
+{
+	const gchar *tmpdir = g_getenv("FWUPD_LOCALSTATEDIR");
+	gboolean ret;
+	guint16 idx = 0x2000;
+	GStatBuf statbuf = {0};
+	struct utimbuf utb = {0};
+	g_autofree gchar *cache_fn = NULL;
+	g_autofree gchar *cachedir = NULL;
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *checksum2 = NULL;
+	g_autofree gchar *checksum3 = NULL;
+	g_autofree gchar *esp_dir = g_build_filename(tmpdir, "esp-cache", NULL);
+	g_autofree gchar *fn = g_build_filename(esp_dir, "boot2000.efi", NULL);
+	g_autofree guint8 *buf = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuFirmware) img_text = fu_firmware_new();
+	g_autoptr(FuFirmware) pefile = fu_pefile_firmware_new();
+	g_autoptr(FuVolume) volume = fu_volume_new_from_mount_path(esp_dir);
+	g_autoptr(GArray) bootorder = g_array_new(FALSE, FALSE, sizeof(guint16));
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GFile) file = g_file_new_for_path(fn);
+	g_autoptr(GPtrArray) esp_files = NULL;
+	g_autoptr(GPtrArray) esp_files2 = NULL;
+	g_autoptr(GPtrArray) esp_files3 = NULL;
+	FuContextEspFileFlags flags = FU_CONTEXT_ESP_FILE_FLAG_INCLUDE_FIRST_STAGE |
+				      FU_CONTEXT_ESP_FILE_FLAG_USE_CHECKSUM_CACHE;
+	FuEfivars *efivars = fu_context_get_efivars(ctx);
+
+	/* a plausible ESP */
+	fu_volume_set_partition_kind(volume, FU_VOLUME_KIND_ESP);
+	fu_volume_set_partition_uuid(volume, "41f5e9b7-eb4f-5c65-b8a6-f94b0ad54815");
+	fu_context_add_esp_volume(ctx, volume);
+
+	/* start with nothing cached */
+	cachedir = fu_path_from_kind(FU_PATH_KIND_CACHEDIR_PKG);
+	cache_fn = g_build_filename(cachedir, "esp-checksums.ini", NULL);
+	g_unlink(cache_fn);
+
+	/* one boot entry with a 1MB PE file */
+	blob = g_bytes_new_take(g_malloc0(0x100000), 0x100000);
+	fu_firmware_set_id(img_text, ".text");
+	fu_firmware_set_bytes(img_text, blob);
+	fu_firmware_add_image(pefile, img_text);
+	ret = fu_firmware_write_file(pefile, file, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_efivars_create_boot_entry_for_volume(efivars,
+						      idx,
+						      volume,
+						      "Cache",
+						      "boot2000.efi",
+						      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_array_append_val(bootorder, idx);
+	ret = fu_efivars_set_boot_order(efivars, bootorder, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* parse and hash the file, which populates the cache */
+	esp_files = fu_context_get_esp_files(ctx, flags, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(esp_files);
+	g_assert_cmpint(esp_files->len, ==, 1);
+	checksum =
+	    fu_firmware_get_checksum(g_ptr_array_index(esp_files, 0), G_CHECKSUM_SHA256, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(checksum);
+	ret = g_file_test(cache_fn, G_FILE_TEST_EXISTS);
+	g_assert_true(ret);
+
+	/* the unchanged file uses the cached checksum */
+	esp_files2 = fu_context_get_esp_files(ctx, flags, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(esp_files2);
+	g_assert_cmpint(esp_files2->len, ==, 1);
+	g_assert_cmpstr(fu_firmware_get_filename(g_ptr_array_index(esp_files2, 0)), ==, fn);
+	g_assert_cmpint(fu_firmware_get_idx(g_ptr_array_index(esp_files2, 0)), ==, idx);
+	checksum2 =
+	    fu_firmware_get_checksum(g_ptr_array_index(esp_files2, 0), G_CHECKSUM_SHA256, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(checksum2, ==, checksum);
+
+	/* rewrite the file in place keeping the same size and mtime */
+	ret = g_stat(fn, &statbuf) == 0;
+	g_assert_true(ret);
+	buf = g_malloc(0x100000);
+	memset(buf, 0xff, 0x100000);
+	blob2 = g_bytes_new_take(g_steal_pointer(&buf), 0x100000);
+	fu_firmware_set_bytes(img_text, blob2);
+	ret = fu_firmware_write_file(pefile, file, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	utb.actime = statbuf.st_atime;
+	utb.modtime = statbuf.st_mtime;
+	ret = g_utime(fn, &utb) == 0;
+	g_assert_true(ret);
+
+	/* the stale checksum must not be returned */
+	esp_files3 = fu_context_get_esp_files(ctx, flags, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(esp_files3);
+	g_assert_cmpint(esp_files3->len, ==, 1);
+	checksum3 =
+	    fu_firmware_get_checksum(g_ptr_array_index(esp_files3, 0), G_CHECKSUM_SHA256, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(checksum3, !=, checksum);
+}
+
+static void
+fu_efivar_esp_files_perf_func(void)
+{
+	const gchar *tmpdir = g_getenv("FWUPD_LOCALSTATEDIR");
+	gboolean ret;
+	g_autofree gchar *cache_fn = NULL;
+	g_autofree gchar *cachedir = NULL;
+	g_autofree gchar *esp_dir = g_build_filename(tmpdir, "esp-perf", NULL);
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuFirmware) img_text = fu_firmware_new();
+	g_autoptr(FuFirmware) pefile = fu_pefile_firmware_new();
+	g_autoptr(FuVolume) volume = fu_volume_new_from_mount_path(esp_dir);
+	g_autoptr(GArray) bootorder = g_array_new(FALSE, FALSE, sizeof(guint16));
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+	FuContextEspFileFlags flags = FU_CONTEXT_ESP_FILE_FLAG_INCLUDE_FIRST_STAGE |
+				      FU_CONTEXT_ESP_FILE_FLAG_USE_CHECKSUM_CACHE;
+	FuEfivars *efivars = fu_context_get_efivars(ctx);
+
+	/* a plausible ESP */
+	fu_volume_set_partition_kind(volume, FU_VOLUME_KIND_ESP);
+	fu_volume_set_partition_uuid(volume, "41f5e9b7-eb4f-5c65-b8a6-f94b0ad54815");
+	fu_context_add_esp_volume(ctx, volume);
+
+	/* start with nothing cached */
+	cachedir = fu_path_from_kind(FU_PATH_KIND_CACHEDIR_PKG);
+	cache_fn = g_build_filename(cachedir, "esp-checksums.ini", NULL);
+	g_unlink(cache_fn);
+
+	/* lots of boot entries, each with a 1MB PE file */
+	blob = g_bytes_new_take(g_malloc0(0x100000), 0x100000);
+	fu_firmware_set_id(img_text, ".text");
+	fu_firmware_set_bytes(img_text, blob);
+	fu_firmware_add_image(pefile, img_text);
+	for (guint16 i = 0x1000; i < 0x1000 + 200; i++) {
+		g_autofree gchar *basename = g_strdup_printf("boot%04x.efi", i);
+		g_autoptr(GFile) file = g_file_new_build_filename(esp_dir, basename, NULL);
+		ret = fu_firmware_write_file(pefile, file, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		ret = fu_efivars_create_boot_entry_for_volume(efivars,
+							      i,
+							      volume,
+							      basename,
+							      basename,
+							      &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		g_array_append_val(bootorder, i);
+	}
+	ret = fu_efivars_set_boot_order(efivars, bootorder, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* parse and hash everything, then only the cached checksums */
+	for (guint i = 0; i < 2; i++) {
+		g_autoptr(GPtrArray) esp_files = NULL;
+		g_timer_reset(timer);
+		esp_files = fu_context_get_esp_files(ctx, flags, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(esp_files);
+		g_assert_cmpint(esp_files->len, ==, bootorder->len);
+		g_test_message("%s: %.2fms",
+			       i == 0 ? "uncached" : "cached",
+			       g_timer_elapsed(timer, NULL) * 1000.f);
+	}
 }
 
 typedef struct {
@@ -6019,6 +6759,153 @@ fu_partial_input_stream_func(void)
 	g_assert_null(stream_error);
 }
 
+static void
+fu_mapped_input_stream_func(void)
+{
+	gboolean ret;
+	guint8 value = 0;
+	g_autoptr(GBytes) blob = g_bytes_new_static("12345678", 8);
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = fu_mapped_input_stream_new(blob);
+	g_autoptr(GInputStream) partial_stream = NULL;
+
+	/* read */
+	ret = fu_input_stream_read_u8(stream, 0x7, &value, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(value, ==, '8');
+	g_assert_cmpint(g_seekable_tell(G_SEEKABLE(stream)), ==, 8);
+
+	/* we CANNOT seek past the end */
+	ret = g_seekable_seek(G_SEEKABLE(stream), 0x9, G_SEEK_SET, NULL, &error);
+	g_assert_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* a slice of a slice is not copied */
+	partial_stream = fu_partial_input_stream_new(stream, 2, 4, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(partial_stream);
+	blob2 = fu_input_stream_read_bytes(partial_stream, 0x1, G_MAXSIZE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob2);
+	g_assert_cmpint(g_bytes_get_size(blob2), ==, 3);
+	g_assert_true(g_bytes_get_data(blob2, NULL) ==
+		      (const guint8 *)g_bytes_get_data(blob, NULL) + 3);
+	g_assert_cmpint(g_seekable_tell(G_SEEKABLE(partial_stream)), ==, 4);
+
+	/* past the end of the partial stream */
+	ret = fu_input_stream_read_u8(partial_stream, 0x4, &value, &error);
+	g_assert_nonnull(error);
+	g_assert_false(ret);
+}
+
+static void
+fu_mapped_input_stream_path_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *cachedir = fu_path_from_kind(FU_PATH_KIND_CACHEDIR_PKG);
+	g_autofree gchar *fn_cache = g_build_filename(cachedir, "mapped.bin", NULL);
+	g_autofree gchar *fn_other = g_build_filename("/tmp/fwupd-self-test", "mapped.bin", NULL);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_cache = NULL;
+	g_autoptr(GInputStream) stream_other = NULL;
+
+	/* only files in our own directories are mapped */
+	ret = fu_path_mkdir_parent(fn_cache, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = g_file_set_contents_full(fn_cache,
+				       "hello",
+				       -1,
+				       G_FILE_SET_CONTENTS_NONE,
+				       0600,
+				       &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	stream_cache = fu_input_stream_from_path(fn_cache, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream_cache);
+	g_assert_true(FU_IS_MAPPED_INPUT_STREAM(stream_cache));
+
+	/* anything else is read normally */
+	ret = fu_path_mkdir_parent(fn_other, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = g_file_set_contents_full(fn_other,
+				       "hello",
+				       -1,
+				       G_FILE_SET_CONTENTS_NONE,
+				       0600,
+				       &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	stream_other = fu_input_stream_from_path(fn_other, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream_other);
+	g_assert_false(FU_IS_MAPPED_INPUT_STREAM(stream_other));
+}
+
+static void
+fu_mapped_input_stream_performance_func(void)
+{
+	gboolean ret;
+	gdouble elapsed_mapped = 0;
+	gdouble elapsed_memory = 0;
+	const guint loops = 100;
+	g_autoptr(FuFirmware) firmware = fu_efi_volume_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_payload = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+	g_autofree guint8 *buf = g_malloc0(0x400000);
+
+	/* create a large EFI volume */
+	blob_payload = g_bytes_new_take(g_steal_pointer(&buf), 0x400000);
+	fu_firmware_set_id(firmware, "fff12b8d-7696-4c8b-a985-2747075b4f50");
+	fu_firmware_set_alignment(firmware, 0x3);
+	fu_firmware_set_bytes(firmware, blob_payload);
+	blob = fu_firmware_write(firmware, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+
+	/* parse and get the payload, using a memory stream and then a mapped stream */
+	for (guint j = 0; j < 2; j++) {
+		g_timer_reset(timer);
+		for (guint i = 0; i < loops; i++) {
+			g_autoptr(FuFirmware) firmware_tmp = fu_efi_volume_new();
+			g_autoptr(GBytes) blob_tmp = NULL;
+			g_autoptr(GInputStream) stream = NULL;
+
+			if (j == 0) {
+				stream = g_memory_input_stream_new_from_bytes(blob);
+			} else {
+				stream = fu_mapped_input_stream_new(blob);
+			}
+			ret = fu_firmware_parse_stream(firmware_tmp,
+						       stream,
+						       0x0,
+						       FU_FIRMWARE_PARSE_FLAG_NONE,
+						       &error);
+			g_assert_no_error(error);
+			g_assert_true(ret);
+			blob_tmp = fu_firmware_get_bytes(firmware_tmp, &error);
+			g_assert_no_error(error);
+			g_assert_nonnull(blob_tmp);
+			g_assert_cmpint(g_bytes_get_size(blob_tmp), ==, 0x400000);
+		}
+		if (j == 0) {
+			elapsed_memory = g_timer_elapsed(timer, NULL);
+		} else {
+			elapsed_mapped = g_timer_elapsed(timer, NULL);
+		}
+	}
+	g_print("memory=%.2fms mapped=%.2fms ",
+		elapsed_memory * 1000.f / loops,
+		elapsed_mapped * 1000.f / loops);
+}
+
 static void
 fu_composite_input_stream_func(void)
 {
@@ -6477,6 +7364,95 @@ fu_cab_checksum_func(void)
 	}
 }
 
+static void
+fu_cab_firmware_lazy_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuCabFirmware) cab_firmware = fu_cab_firmware_new();
+	g_autoptr(FuCabFirmware) cab_firmware_eager = fu_cab_firmware_new();
+	g_autoptr(FuCabFirmware) cab_firmware_lazy = fu_cab_firmware_new();
+	g_autoptr(FuFirmware) img_lazy = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_lazy = NULL;
+	g_autoptr(GPtrArray) blobs = g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+
+	/* several images, each spanning multiple CFDATA blocks */
+	for (guint i = 0; i < 3; i++) {
+		g_autofree gchar *id = g_strdup_printf("firmware%u.bin", i);
+		g_autoptr(FuCabImage) img = fu_cab_image_new();
+		g_autoptr(GByteArray) buf = g_byte_array_new();
+		g_autoptr(GBytes) img_blob = NULL;
+
+		for (guint j = 0; j < 0x12345; j++)
+			fu_byte_array_append_uint8(buf, (guint8)((j * (i + 3)) ^ (j >> 9)));
+		img_blob = g_bytes_new(buf->data, buf->len);
+		fu_firmware_set_id(FU_FIRMWARE(img), id);
+		fu_firmware_set_bytes(FU_FIRMWARE(img), img_blob);
+		fu_firmware_add_image(FU_FIRMWARE(cab_firmware), FU_FIRMWARE(img));
+		g_ptr_array_add(blobs, g_steal_pointer(&img_blob));
+	}
+	fu_cab_firmware_set_compressed(cab_firmware, TRUE);
+	blob = fu_firmware_write(FU_FIRMWARE(cab_firmware), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+
+	/* inflate everything in parallel when parsing */
+	ret = fu_firmware_parse_bytes(FU_FIRMWARE(cab_firmware_eager),
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* inflate on demand, reading the images backwards */
+	fu_cab_firmware_set_lazy_decompress(cab_firmware_lazy, TRUE);
+	ret = fu_firmware_parse_bytes(FU_FIRMWARE(cab_firmware_lazy),
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	for (gint i = (gint)blobs->len - 1; i >= 0; i--) {
+		g_autofree gchar *id = g_strdup_printf("firmware%i.bin", i);
+		g_autoptr(GBytes) blob_eager = NULL;
+		g_autoptr(GBytes) blob_lazy = NULL;
+
+		blob_eager = fu_firmware_get_image_by_id_bytes(FU_FIRMWARE(cab_firmware_eager),
+							       id,
+							       &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(blob_eager);
+		ret = fu_bytes_compare(blob_eager, g_ptr_array_index(blobs, i), &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+
+		blob_lazy = fu_firmware_get_image_by_id_bytes(FU_FIRMWARE(cab_firmware_lazy),
+							      id,
+							      &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(blob_lazy);
+		ret = fu_bytes_compare(blob_lazy, g_ptr_array_index(blobs, i), &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+
+	/* cannot seek outside the folder */
+	img_lazy = fu_firmware_get_image_by_id(FU_FIRMWARE(cab_firmware_lazy),
+					       "firmware0.bin",
+					       &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(img_lazy);
+	stream_lazy = fu_firmware_get_stream(img_lazy, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream_lazy);
+	ret = g_seekable_seek(G_SEEKABLE(stream_lazy), 0x1000000, G_SEEK_SET, NULL, &error);
+	g_assert_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+	g_assert_false(ret);
+}
+
 static void
 fu_efi_lz77_decompressor_func(void)
 {
@@ -6546,7 +7522,9 @@ fu_input_stream_func(void)
 	gboolean ret;
 	gsize bufsz = 0;
 	gsize streamsz = 0;
+	GChecksumType csum_kinds[] = {G_CHECKSUM_MD5, G_CHECKSUM_SHA256};
 	g_autofree gchar *csum2 = NULL;
+	g_autofree gchar *csum3 = NULL;
 	g_autofree gchar *csum = NULL;
 	g_autofree gchar *fn = NULL;
 	g_autofree guint8 *buf2 = NULL;
@@ -6554,6 +7532,7 @@ fu_input_stream_func(void)
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GFile) file = NULL;
 	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(GPtrArray) csums = NULL;
 
 	fn = g_test_build_filename(G_TEST_DIST, "tests", "dfu.builder.xml", NULL);
 	g_assert_nonnull(fn);
@@ -6580,6 +7559,18 @@ fu_input_stream_func(void)
 	g_assert_nonnull(csum2);
 	g_assert_cmpstr(csum, ==, csum2);
 
+	/* verify multiple checksums in one pass */
+	csums = fu_input_stream_compute_checksums(stream,
+						  csum_kinds,
+						  G_N_ELEMENTS(csum_kinds),
+						  &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(csums);
+	g_assert_cmpint(csums->len, ==, 2);
+	g_assert_cmpstr(g_ptr_array_index(csums, 0), ==, csum);
+	csum3 = g_compute_checksum_for_data(G_CHECKSUM_SHA256, (const guchar *)buf, bufsz);
+	g_assert_cmpstr(g_ptr_array_index(csums, 1), ==, csum3);
+
 	/* read first byte */
 	buf2 = g_malloc0(bufsz);
 	ret = fu_input_stream_read_safe(stream, buf2, bufsz, 0x0, 0x0, 1, &error);
@@ -6760,6 +7751,8 @@ static void
 fu_plugin_struct_wrapped_func(void)
 {
 	gboolean ret;
+	FuStructSelfTestWrapped st_view = {0x0};
+	FuStructSelfTest st_base_view = {0x0};
 	g_autofree gchar *str1 = NULL;
 	g_autofree gchar *str2 = NULL;
 	g_autofree gchar *str4 = NULL;
@@ -6802,6 +7795,22 @@ fu_plugin_struct_wrapped_func(void)
 	st_base2 = fu_struct_self_test_wrapped_get_base(st);
 	g_assert_cmpint(fu_struct_self_test_get_revision(st_base2), ==, 0xFE);
 
+	/* parse without copying */
+	ret = fu_struct_self_test_wrapped_parse_view(&st_view, st->data, st->len, 0x0, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_true(st_view.data == st->data);
+	g_assert_cmpint(st_view.len, ==, FU_STRUCT_SELF_TEST_WRAPPED_SIZE);
+	g_assert_cmpint(fu_struct_self_test_wrapped_get_more(&st_view), ==, 0x12);
+	fu_struct_self_test_wrapped_get_base_view(&st_view, &st_base_view);
+	g_assert_true(st_base_view.data == st->data + FU_STRUCT_SELF_TEST_WRAPPED_OFFSET_BASE);
+	g_assert_cmpint(st_base_view.len, ==, FU_STRUCT_SELF_TEST_SIZE);
+	g_assert_cmpint(fu_struct_self_test_get_revision(&st_base_view), ==, 0xFE);
+	ret = fu_struct_self_test_wrapped_parse_view(&st_view, st->data, st->len, 0x1, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_READ);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
 	/* to string */
 	str2 = fu_struct_self_test_wrapped_to_string(st);
 	g_debug("%s", str2);
@@ -6827,6 +7836,10 @@ fu_plugin_struct_wrapped_func(void)
 	ret = fu_struct_self_test_wrapped_validate(st->data, st->len, 0x0, &error);
 	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
 	g_assert_false(ret);
+	g_clear_error(&error);
+	ret = fu_struct_self_test_wrapped_parse_view(&st_view, st->data, st->len, 0x0, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
 }
 
 static void
@@ -6942,6 +7955,7 @@ main(int argc, char **argv)
 	(void)g_setenv("CACHE_DIRECTORY", "/tmp/fwupd-self-test/cache", TRUE);
 
 	g_test_add_func("/fwupd/cab{checksum}", fu_cab_checksum_func);
+	g_test_add_func("/fwupd/cab{lazy}", fu_cab_firmware_lazy_func);
 	g_test_add_func("/fwupd/efi-lz77{decompressor}", fu_efi_lz77_decompressor_func);
 	g_test_add_func("/fwupd/input-stream", fu_input_stream_func);
 	g_test_add_func("/fwupd/input-stream{sum-overflow}", fu_input_stream_sum_overflow_func);
@@ -6954,6 +7968,10 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/partial-input-stream{composite}",
 			fu_partial_input_stream_composite_func);
 	g_test_add_func("/fwupd/composite-input-stream", fu_composite_input_stream_func);
+	g_test_add_func("/fwupd/mapped-input-stream", fu_mapped_input_stream_func);
+	g_test_add_func("/fwupd/mapped-input-stream{path}", fu_mapped_input_stream_path_func);
+	g_test_add_func("/fwupd/mapped-input-stream{performance}",
+			fu_mapped_input_stream_performance_func);
 	g_test_add_func("/fwupd/struct", fu_plugin_struct_func);
 	g_test_add_func("/fwupd/struct{bits}", fu_plugin_struct_bits_func);
 	g_test_add_func("/fwupd/struct{list}", fu_plugin_struct_list_func);
@@ -6966,6 +7984,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/common{strnsplit}", fu_strsplit_func);
 	g_test_add_func("/fwupd/common{olson-timezone-id}", fu_common_olson_timezone_id_func);
 	g_test_add_func("/fwupd/common{memmem}", fu_common_memmem_func);
+	g_test_add_func("/fwupd/mem-search", fu_mem_search_func);
 	if (g_test_slow())
 		g_test_add_func("/fwupd/progress", fu_progress_func);
 	g_test_add_func("/fwupd/progress{scaling}", fu_progress_scaling_func);
@@ -6997,11 +8016,15 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/backend{emulate}", fu_backend_emulate_func);
 	g_test_add_func("/fwupd/chunk", fu_chunk_func);
 	g_test_add_func("/fwupd/chunks", fu_chunk_array_func);
+	g_test_add_func("/fwupd/chunks{stream}", fu_chunk_array_stream_func);
 	g_test_add_func("/fwupd/common{align-up}", fu_common_align_up_func);
 	g_test_add_func("/fwupd/volume{gpt-type}", fu_volume_gpt_type_func);
 	g_test_add_func("/fwupd/common{bitwise}", fu_common_bitwise_func);
 	g_test_add_func("/fwupd/common{byte-array}", fu_common_byte_array_func);
 	g_test_add_func("/fwupd/common{crc}", fu_common_crc_func);
+	g_test_add_func("/fwupd/common{crc-tables}", fu_common_crc_tables_func);
+	if (g_test_perf())
+		g_test_add_func("/fwupd/common{crc-performance}", fu_common_crc_performance_func);
 	g_test_add_func("/fwupd/common{guid}", fu_common_guid_func);
 	g_test_add_func("/fwupd/common{string-append-kv}", fu_string_append_func);
 	g_test_add_func("/fwupd/common{version-guess-format}", fu_version_guess_format_func);
@@ -7030,6 +8053,9 @@ main(int argc, char **argv)
 			fu_plugin_efi_variable_authentication2_func);
 	g_test_add_func("/fwupd/efivar", fu_efivar_func);
 	g_test_add_func("/fwupd/efivar{bootxxxx}", fu_efivar_boot_func);
+	g_test_add_func("/fwupd/efivar{esp-files-cache}", fu_efivar_esp_files_cache_func);
+	if (g_test_perf())
+		g_test_add_func("/fwupd/efivar{esp-files-perf}", fu_efivar_esp_files_perf_func);
 	g_test_add_func("/fwupd/hwids", fu_hwids_func);
 	g_test_add_func("/fwupd/context{flags}", fu_context_flags_func);
 	g_test_add_func("/fwupd/context{backends}", fu_context_backends_func);
@@ -7037,6 +8063,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/context{hwids-fdt}", fu_context_hwids_fdt_func);
 	g_test_add_func("/fwupd/context{firmware-gtypes}", fu_context_firmware_gtypes_func);
 	g_test_add_func("/fwupd/context{state}", fu_context_state_func);
+	g_test_add_func("/fwupd/metrics", fu_metrics_func);
 	g_test_add_func("/fwupd/context{udev-subsystems}", fu_context_udev_subsystems_func);
 	g_test_add_func("/fwupd/string{utf16}", fu_string_utf16_func);
 	g_test_add_func("/fwupd/smbios", fu_smbios_func);
@@ -7052,6 +8079,8 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/firmware{archive}", fu_firmware_archive_func);
 	g_test_add_func("/fwupd/firmware{linear}", fu_firmware_linear_func);
 	g_test_add_func("/fwupd/firmware{dedupe}", fu_firmware_dedupe_func);
+	g_test_add_func("/fwupd/firmware{checksums}", fu_firmware_checksums_func);
+	g_test_add_func("/fwupd/firmware{checksum-image}", fu_firmware_checksum_image_func);
 	g_test_add_func("/fwupd/firmware{build}", fu_firmware_build_func);
 	g_test_add_func("/fwupd/firmware{raw-aligned}", fu_firmware_raw_aligned_func);
 	g_test_add_func("/fwupd/firmware{ihex}", fu_firmware_ihex_func);
@@ -7076,7 +8105,9 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/device{udev}", fu_device_udev_func);
 	g_test_add_func("/fwupd/device{event}", fu_device_event_func);
 	g_test_add_func("/fwupd/device{event-uncompressed}", fu_device_event_uncompressed_func);
+	g_test_add_func("/fwupd/device{event-binary}", fu_device_event_binary_func);
 	g_test_add_func("/fwupd/device{event-donor}", fu_device_event_donor_func);
+	g_test_add_func("/fwupd/device{event-replay}", fu_device_event_replay_func);
 	g_test_add_func("/fwupd/device{vfuncs}", fu_device_vfuncs_func);
 	g_test_add_func("/fwupd/device{instance-ids}", fu_device_instance_ids_func);
 	g_test_add_func("/fwupd/device{composite-id}", fu_device_composite_id_func);
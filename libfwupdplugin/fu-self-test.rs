@@ -21,7 +21,7 @@ struct FuStructSelfTest {
     asl_compiler_revision: u32le,
 }
 
-#[derive(New, Validate, Parse, ToString)]
+#[derive(New, Validate, Parse, ParseView, ToString)]
 #[repr(C, packed)]
 struct FuStructSelfTestWrapped {
     less: u8,
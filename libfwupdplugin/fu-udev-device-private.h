@@ -37,3 +37,5 @@ fu_udev_device_ioctl(FuUdevDevice *self,
 		     guint timeout,
 		     FuIoctlFlags flags,
 		     GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
+const gchar *
+fu_udev_device_get_ioctl_metrics_id(FuUdevDevice *self) G_GNUC_NON_NULL(1);
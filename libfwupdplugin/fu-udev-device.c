@@ -48,6 +48,8 @@ typedef struct {
 	FuIoChannelOpenFlag open_flags;
 	GHashTable *properties;
 	gboolean properties_valid;
+	gchar *metrics_plugin; /* (nullable) */
+	gchar *metrics_id;     /* (nullable) */
 } FuUdevDevicePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE(FuUdevDevice, fu_udev_device, FU_TYPE_DEVICE);
@@ -1182,6 +1184,24 @@ fu_udev_device_ioctl_new(FuUdevDevice *self)
 	return fu_ioctl_new(self);
 }
 
+/* private; the ID is only rebuilt if the plugin changes, so nothing is allocated for each ioctl */
+const gchar *
+fu_udev_device_get_ioctl_metrics_id(FuUdevDevice *self)
+{
+	FuUdevDevicePrivate *priv = GET_PRIVATE(self);
+	const gchar *plugin = fu_device_get_plugin(FU_DEVICE(self));
+
+	g_return_val_if_fail(FU_IS_UDEV_DEVICE(self), NULL);
+
+	if (priv->metrics_id != NULL && g_strcmp0(priv->metrics_plugin, plugin) == 0)
+		return priv->metrics_id;
+	g_free(priv->metrics_plugin);
+	g_free(priv->metrics_id);
+	priv->metrics_plugin = g_strdup(plugin);
+	priv->metrics_id = g_strdup_printf("Ioctl[%s]", plugin != NULL ? plugin : "unknown");
+	return priv->metrics_id;
+}
+
 /* private */
 gboolean
 fu_udev_device_ioctl(FuUdevDevice *self,
@@ -2415,6 +2435,8 @@ fu_udev_device_finalize(GObject *object)
 	g_free(priv->bind_id);
 	g_free(priv->driver);
 	g_free(priv->device_file);
+	g_free(priv->metrics_plugin);
+	g_free(priv->metrics_id);
 	if (priv->io_channel != NULL)
 		g_object_unref(priv->io_channel);
 
@@ -27,6 +27,13 @@
 #include "fu-usb-hid-descriptor-private.h"
 #include "fu-usb-interface-private.h"
 
+typedef enum {
+	FU_USB_DEVICE_METRIC_CONTROL,
+	FU_USB_DEVICE_METRIC_BULK,
+	FU_USB_DEVICE_METRIC_INTERRUPT,
+	FU_USB_DEVICE_METRIC_LAST
+} FuUsbDeviceMetric;
+
 /**
  * FuUsbDevice:
  *
@@ -50,6 +57,9 @@ typedef struct {
 	gint configuration;
 	GPtrArray *device_interfaces; /* (nullable) (element-type FuUsbDeviceInterface) */
 	guint claim_retry_count;
+	gchar *metrics_plugin;				 /* (nullable) */
+	gchar *metrics_ids[FU_USB_DEVICE_METRIC_LAST];	 /* (nullable) */
+	gchar *metrics_bytes[FU_USB_DEVICE_METRIC_LAST]; /* (nullable) */
 } FuUsbDevicePrivate;
 
 typedef struct {
@@ -191,6 +201,43 @@ fu_usb_device_not_open_error(FuUsbDevice *self, GError **error)
 	return FALSE;
 }
 
+/* the IDs are only rebuilt if the plugin changes, so nothing is allocated for each transfer */
+static void
+fu_usb_device_ensure_metrics_ids(FuUsbDevice *self, const gchar *plugin)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE(self);
+	const gchar *kinds[] = {"UsbControlTransfer", "UsbBulkTransfer", "UsbInterruptTransfer"};
+
+	if (priv->metrics_ids[0] != NULL && g_strcmp0(priv->metrics_plugin, plugin) == 0)
+		return;
+	g_free(priv->metrics_plugin);
+	priv->metrics_plugin = g_strdup(plugin);
+	for (guint i = 0; i < FU_USB_DEVICE_METRIC_LAST; i++) {
+		g_free(priv->metrics_ids[i]);
+		g_free(priv->metrics_bytes[i]);
+		priv->metrics_ids[i] =
+		    g_strdup_printf("%s[%s]", kinds[i], plugin != NULL ? plugin : "unknown");
+		priv->metrics_bytes[i] =
+		    g_strdup_printf("%sBytes[%s]", kinds[i], plugin != NULL ? plugin : "unknown");
+	}
+}
+
+static void
+fu_usb_device_add_metrics(FuUsbDevice *self, FuUsbDeviceMetric kind, gint64 start_us, gsize length)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE(self);
+	FuContext *ctx = fu_device_get_context(FU_DEVICE(self));
+
+	if (ctx == NULL)
+		return;
+	fu_usb_device_ensure_metrics_ids(self, fu_device_get_plugin(FU_DEVICE(self)));
+	fu_metrics_add_duration_since_with_counter(fu_context_get_metrics(ctx),
+						   priv->metrics_ids[kind],
+						   start_us,
+						   priv->metrics_bytes[kind],
+						   length);
+}
+
 static void
 fu_usb_device_invalidate(FuDevice *device)
 {
@@ -275,6 +322,11 @@ fu_usb_device_finalize(GObject *object)
 	g_ptr_array_unref(priv->bos_descriptors);
 	g_ptr_array_unref(priv->hid_descriptors);
 	g_ptr_array_unref(priv->cfg_descriptors);
+	g_free(priv->metrics_plugin);
+	for (guint i = 0; i < FU_USB_DEVICE_METRIC_LAST; i++) {
+		g_free(priv->metrics_ids[i]);
+		g_free(priv->metrics_bytes[i]);
+	}
 
 	G_OBJECT_CLASS(fu_usb_device_parent_class)->finalize(object);
 }
@@ -1451,6 +1503,7 @@ fu_usb_device_control_transfer(FuUsbDevice *self,
 {
 	FuUsbDevicePrivate *priv = GET_PRIVATE(self);
 	gint rc;
+	gint64 start_us;
 	guint8 request_type_raw = 0;
 	FuDeviceEvent *event = NULL;
 	g_autofree gchar *event_id = NULL;
@@ -1515,6 +1568,7 @@ fu_usb_device_control_transfer(FuUsbDevice *self,
 	request_type_raw |= recipient;
 
 	/* sync request */
+	start_us = g_get_monotonic_time();
 	rc = libusb_control_transfer(priv->handle,
 				     request_type_raw,
 				     request,
@@ -1523,6 +1577,7 @@ fu_usb_device_control_transfer(FuUsbDevice *self,
 				     data,
 				     length,
 				     timeout);
+	fu_usb_device_add_metrics(self, FU_USB_DEVICE_METRIC_CONTROL, start_us, MAX(rc, 0));
 	if (rc < 0) {
 		if (!fu_usb_device_libusb_error_to_gerror(rc, error)) {
 			if (event != NULL)
@@ -1575,6 +1630,7 @@ fu_usb_device_bulk_transfer(FuUsbDevice *self,
 {
 	FuUsbDevicePrivate *priv = GET_PRIVATE(self);
 	gint rc;
+	gint64 start_us;
 	gint transferred = 0;
 	FuDeviceEvent *event = NULL;
 	g_autofree gchar *event_id = NULL;
@@ -1623,7 +1679,9 @@ fu_usb_device_bulk_transfer(FuUsbDevice *self,
 	}
 
 	/* sync request */
+	start_us = g_get_monotonic_time();
 	rc = libusb_bulk_transfer(priv->handle, endpoint, data, length, &transferred, timeout);
+	fu_usb_device_add_metrics(self, FU_USB_DEVICE_METRIC_BULK, start_us, transferred);
 	if (!fu_usb_device_libusb_error_to_gerror(rc, error)) {
 		if (event != NULL)
 			fu_device_event_set_i64(event, "Error", rc);
@@ -1671,6 +1729,7 @@ fu_usb_device_interrupt_transfer(FuUsbDevice *self,
 {
 	FuUsbDevicePrivate *priv = GET_PRIVATE(self);
 	gint rc;
+	gint64 start_us;
 	gint transferred = 0;
 	FuDeviceEvent *event = NULL;
 	g_autofree gchar *event_id = NULL;
@@ -1719,7 +1778,9 @@ fu_usb_device_interrupt_transfer(FuUsbDevice *self,
 	}
 
 	/* sync request */
+	start_us = g_get_monotonic_time();
 	rc = libusb_interrupt_transfer(priv->handle, endpoint, data, length, &transferred, timeout);
+	fu_usb_device_add_metrics(self, FU_USB_DEVICE_METRIC_INTERRUPT, start_us, transferred);
 	if (!fu_usb_device_libusb_error_to_gerror(rc, error)) {
 		if (event != NULL)
 			fu_device_event_set_i64(event, "Error", rc);
@@ -1806,12 +1867,17 @@ fu_usb_device_parse_descriptor(FuUsbDevice *self, GInputStream *stream, GError *
 	offset += fu_usb_device_hdr_get_length(st);
 	while (offset < streamsz) {
 		FuUsbDescriptorKind descriptor_kind;
-		g_autoptr(FuUsbBaseHdr) st_base = NULL;
+		guint8 buf[FU_USB_BASE_HDR_SIZE] = {0x0};
+		FuUsbBaseHdr st_base = {0x0};
 		g_autoptr(GError) error_local = NULL;
 
 		/* this is common to all descriptor types */
-		st_base = fu_usb_base_hdr_parse_stream(stream, offset, &error_local);
-		if (st_base == NULL) {
+		if (!fu_usb_base_hdr_parse_stream_view(&st_base,
+						       stream,
+						       offset,
+						       buf,
+						       sizeof(buf),
+						       &error_local)) {
 			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE))
 				break;
 			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA))
@@ -1821,7 +1887,7 @@ fu_usb_device_parse_descriptor(FuUsbDevice *self, GInputStream *stream, GError *
 		}
 
 		/* config, interface or endpoint */
-		descriptor_kind = fu_usb_base_hdr_get_descriptor_type(st_base);
+		descriptor_kind = fu_usb_base_hdr_get_descriptor_type(&st_base);
 		if (descriptor_kind == FU_USB_DESCRIPTOR_KIND_CONFIG) {
 			g_autoptr(FuUsbConfigDescriptor) cfg_descriptor =
 			    fu_usb_config_descriptor_new();
@@ -1850,7 +1916,7 @@ fu_usb_device_parse_descriptor(FuUsbDevice *self, GInputStream *stream, GError *
 				if (!fu_firmware_parse_stream(
 					FU_FIRMWARE(img),
 					stream,
-					offset + fu_usb_base_hdr_get_length(st_base),
+					offset + fu_usb_base_hdr_get_length(&st_base),
 					FU_FIRMWARE_PARSE_FLAG_CACHE_BLOB,
 					error))
 					return FALSE;
@@ -1899,7 +1965,7 @@ fu_usb_device_parse_descriptor(FuUsbDevice *self, GInputStream *stream, GError *
 				descriptor_kind,
 				str != NULL ? str : "unknown");
 		}
-		offset += fu_usb_base_hdr_get_length(st_base);
+		offset += fu_usb_base_hdr_get_length(&st_base);
 	}
 
 	/* success */
@@ -2864,6 +2930,12 @@ fu_usb_device_from_json(FuDevice *device, JsonObject *json_object, GError **erro
 	return TRUE;
 }
 
+static const gchar *
+fu_usb_device_get_events_member(FuDevice *device)
+{
+	return "UsbEvents";
+}
+
 static void
 fu_usb_device_add_json(FuDevice *device, JsonBuilder *builder, FwupdCodecFlags flags)
 {
@@ -3088,6 +3160,7 @@ fu_usb_device_class_init(FuUsbDeviceClass *klass)
 	device_class->convert_version = fu_usb_device_convert_version;
 	device_class->from_json = fu_usb_device_from_json;
 	device_class->add_json = fu_usb_device_add_json;
+	device_class->get_events_member = fu_usb_device_get_events_member;
 
 	/**
 	 * FuUsbDevice:libusb-device:
@@ -71,7 +71,7 @@ enum FuUsbDescriptorKind {
     SsEndpointCompanion = 0x30,
 }
 
-#[derive(ParseStream, Parse)]
+#[derive(ParseStream, ParseStreamView, Parse)]
 #[repr(C, packed)]
 struct FuUsbBaseHdr {
     length: u8,
@@ -299,6 +299,10 @@ fu_uswid_firmware_init(FuUswidFirmware *self)
 	priv->compression = FU_USWID_PAYLOAD_COMPRESSION_NONE;
 	fu_firmware_add_flag(FU_FIRMWARE(self), FU_FIRMWARE_FLAG_HAS_STORED_SIZE);
 	fu_firmware_add_flag(FU_FIRMWARE(self), FU_FIRMWARE_FLAG_ALWAYS_SEARCH);
+	fu_firmware_add_magic(FU_FIRMWARE(self),
+			      (const guint8 *)FU_STRUCT_USWID_DEFAULT_MAGIC,
+			      sizeof(fwupd_guid_t),
+			      FU_STRUCT_USWID_OFFSET_MAGIC);
 	fu_firmware_set_images_max(FU_FIRMWARE(self), 2000);
 	g_type_ensure(FU_TYPE_COSWID_FIRMWARE);
 }
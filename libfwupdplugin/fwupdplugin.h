@@ -90,8 +90,11 @@
 #include <libfwupdplugin/fu-kernel-search-path.h>
 #include <libfwupdplugin/fu-kernel.h>
 #include <libfwupdplugin/fu-linear-firmware.h>
+#include <libfwupdplugin/fu-mapped-input-stream.h>
 #include <libfwupdplugin/fu-mei-device.h>
+#include <libfwupdplugin/fu-mem-search.h>
 #include <libfwupdplugin/fu-mem.h>
+#include <libfwupdplugin/fu-metrics.h>
 #include <libfwupdplugin/fu-msgpack-item.h>
 #include <libfwupdplugin/fu-msgpack.h>
 #include <libfwupdplugin/fu-oprom-device.h>
@@ -173,6 +173,8 @@ class StructObj:
             "Parse": Export.NONE,
             "ParseBytes": Export.NONE,
             "ParseStream": Export.NONE,
+            "ParseView": Export.NONE,
+            "ParseStreamView": Export.NONE,
             "ParseInternal": Export.NONE,
             "New": Export.NONE,
             "ToString": Export.NONE,
@@ -245,6 +247,8 @@ class StructObj:
             self.add_private_export("ParseInternal")
         elif derive == "ParseBytes":
             self.add_private_export("Parse")
+        elif derive in ["ParseView", "ParseStreamView"]:
+            self.add_private_export("ParseInternal")
         elif derive == "ParseInternal":
             self.add_private_export("ToString")
             self.add_private_export("ValidateInternal")
@@ -280,6 +284,12 @@ class StructObj:
             for item in self.items:
                 if item.struct_obj:
                     item.struct_obj.add_public_export("Getters")
+        if derive in ["ParseView", "ParseStreamView"]:
+            self.add_public_export("Getters")
+            for item in self.items:
+                if item.struct_obj and item.enabled:
+                    item.add_public_export("ViewGetters")
+                    item.struct_obj.add_public_export("Getters")
         if derive == "New":
             self.add_public_export("Setters")
 
@@ -309,6 +319,7 @@ class StructItem:
         self._exports: Dict[str, Export] = {
             "Getters": Export.NONE,
             "Setters": Export.NONE,
+            "ViewGetters": Export.NONE,
         }
 
     def add_private_export(self, derive: str) -> None:
@@ -382,6 +393,10 @@ class StructItem:
     def c_getter(self):
         return self.obj.c_method("get_" + self.element_id)
 
+    @property
+    def c_view_getter(self):
+        return self.obj.c_method("get_" + self.element_id + "_view")
+
     @property
     def c_setter(self):
         return self.obj.c_method("set_" + self.element_id)
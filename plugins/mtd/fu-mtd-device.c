@@ -339,6 +339,8 @@ fu_mtd_device_erase(FuMtdDevice *self, GInputStream *stream, FuProgress *progres
 static gboolean
 fu_mtd_device_write(FuMtdDevice *self, FuChunkArray *chunks, FuProgress *progress, GError **error)
 {
+	guint idx = 0;
+
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_set_steps(progress, fu_chunk_array_length(chunks));
@@ -350,13 +352,14 @@ fu_mtd_device_write(FuMtdDevice *self, FuChunkArray *chunks, FuProgress *progres
 	}
 
 	/* write each chunk */
-	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
+	while (TRUE) {
 		g_autoptr(FuChunk) chk = NULL;
 
 		/* prepare chunk */
-		chk = fu_chunk_array_index(chunks, i, error);
-		if (chk == NULL)
+		if (!fu_chunk_array_iterate(chunks, &idx, &chk, error))
 			return FALSE;
+		if (chk == NULL)
+			break;
 		if (!fu_udev_device_pwrite(FU_UDEV_DEVICE(self),
 					   fu_chunk_get_address(chk),
 					   fu_chunk_get_data(chk),
@@ -377,21 +380,24 @@ fu_mtd_device_write(FuMtdDevice *self, FuChunkArray *chunks, FuProgress *progres
 static gboolean
 fu_mtd_device_verify(FuMtdDevice *self, FuChunkArray *chunks, FuProgress *progress, GError **error)
 {
+	guint idx = 0;
+
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_set_steps(progress, fu_chunk_array_length(chunks));
 
 	/* verify each chunk */
-	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
+	while (TRUE) {
 		g_autofree guint8 *buf = NULL;
 		g_autoptr(FuChunk) chk = NULL;
 		g_autoptr(GBytes) blob1 = NULL;
 		g_autoptr(GBytes) blob2 = NULL;
 
 		/* prepare chunk */
-		chk = fu_chunk_array_index(chunks, i, error);
-		if (chk == NULL)
+		if (!fu_chunk_array_iterate(chunks, &idx, &chk, error))
 			return FALSE;
+		if (chk == NULL)
+			break;
 		buf = g_malloc0(fu_chunk_get_data_sz(chk));
 		if (!fu_udev_device_pread(FU_UDEV_DEVICE(self),
 					  fu_chunk_get_address(chk),
@@ -433,6 +439,7 @@ fu_mtd_device_write_verify(FuMtdDevice *self,
 						error);
 	if (chunks == NULL)
 		return FALSE;
+	fu_chunk_array_set_readahead(chunks, 0x10000);
 
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
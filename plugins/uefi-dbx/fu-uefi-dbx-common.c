@@ -40,29 +40,20 @@ fu_uefi_dbx_get_efi_arch(void)
 	return NULL;
 }
 
-static gchar *
-fu_uefi_dbx_get_authenticode_hash(const gchar *fn, GError **error)
-{
-	g_autoptr(FuFirmware) firmware = fu_pefile_firmware_new();
-	g_autoptr(GFile) file = g_file_new_for_path(fn);
-	if (!fu_firmware_parse_file(firmware, file, FU_FIRMWARE_PARSE_FLAG_NONE, error))
-		return NULL;
-	return fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA256, error);
-}
-
 static gboolean
-fu_uefi_dbx_signature_list_validate_filename(FuContext *ctx,
+fu_uefi_dbx_signature_list_validate_firmware(FuContext *ctx,
 					     FuEfiSignatureList *siglist,
-					     const gchar *fn,
+					     FuFirmware *firmware,
 					     FuFirmwareParseFlags flags,
 					     GError **error)
 {
+	const gchar *fn = fu_firmware_get_filename(firmware);
 	g_autofree gchar *checksum = NULL;
 	g_autoptr(FuFirmware) img = NULL;
 	g_autoptr(GError) error_local = NULL;
 
-	/* get checksum of file */
-	checksum = fu_uefi_dbx_get_authenticode_hash(fn, &error_local);
+	/* already computed when the file was loaded */
+	checksum = fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA256, &error_local);
 	if (checksum == NULL) {
 		g_debug("failed to get checksum for %s: %s", fn, error_local->message);
 		return TRUE;
@@ -107,12 +98,11 @@ fu_uefi_dbx_signature_list_validate(FuContext *ctx,
 	}
 	for (guint i = 0; i < files->len; i++) {
 		FuFirmware *firmware = g_ptr_array_index(files, i);
-		if (!fu_uefi_dbx_signature_list_validate_filename(
-			ctx,
-			siglist,
-			fu_firmware_get_filename(firmware),
-			flags,
-			error))
+		if (!fu_uefi_dbx_signature_list_validate_firmware(ctx,
+								  siglist,
+								  firmware,
+								  flags,
+								  error))
 			return FALSE;
 	}
 	return TRUE;
@@ -0,0 +1,261 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuCabinetCache"
+
+#include "config.h"
+
+#include "fu-cabinet-cache.h"
+
+/*
+ * An in-memory cache of parsed archives, keyed by the SHA256 of the archive. Clients often call
+ * GetDetails and then Install on the same file, or install the same file to many devices, and
+ * this avoids decompressing the archive, building the silo and verifying the signatures each time.
+ * The least recently used archives are dropped when the total size is over the limit.
+ */
+
+struct _FuCabinetCache {
+	GObject parent_instance;
+	GHashTable *items; /* checksum:FuCabinetCacheItem */
+	GQueue lru;	   /* element-type FuCabinetCacheItem, most recently used first */
+	guint64 size;
+	guint64 size_max;
+};
+
+G_DEFINE_TYPE(FuCabinetCache, fu_cabinet_cache, G_TYPE_OBJECT)
+
+typedef struct {
+	gchar *checksum;
+	FuCabinet *cabinet;
+	guint64 size;
+	GList link;
+} FuCabinetCacheItem;
+
+static void
+fu_cabinet_cache_item_free(FuCabinetCacheItem *item)
+{
+	g_free(item->checksum);
+	g_object_unref(item->cabinet);
+	g_free(item);
+}
+
+static void
+fu_cabinet_cache_remove_item(FuCabinetCache *self, FuCabinetCacheItem *item)
+{
+	g_debug("removing %s from cache", item->checksum);
+	g_queue_unlink(&self->lru, &item->link);
+	self->size -= item->size;
+	g_hash_table_remove(self->items, item->checksum);
+}
+
+static void
+fu_cabinet_cache_ensure_size(FuCabinetCache *self)
+{
+	while (self->size > self->size_max && self->lru.tail != NULL)
+		fu_cabinet_cache_remove_item(self, self->lru.tail->data);
+}
+
+/**
+ * fu_cabinet_cache_set_size_max:
+ * @self: a #FuCabinetCache
+ * @size_max: size in bytes, or 0 to disable the cache
+ *
+ * Sets the maximum total size of all the archives in the cache, dropping the least recently used
+ * archives if required. The cache is disabled by default.
+ **/
+void
+fu_cabinet_cache_set_size_max(FuCabinetCache *self, guint64 size_max)
+{
+	g_return_if_fail(FU_IS_CABINET_CACHE(self));
+	self->size_max = size_max;
+	fu_cabinet_cache_ensure_size(self);
+}
+
+/**
+ * fu_cabinet_cache_get_size:
+ * @self: a #FuCabinetCache
+ *
+ * Gets the approximate memory used by all the archives in the cache.
+ *
+ * Returns: size in bytes
+ **/
+guint64
+fu_cabinet_cache_get_size(FuCabinetCache *self)
+{
+	g_return_val_if_fail(FU_IS_CABINET_CACHE(self), G_MAXUINT64);
+	return self->size;
+}
+
+/**
+ * fu_cabinet_cache_lookup:
+ * @self: a #FuCabinetCache
+ * @checksum: the SHA256 of the archive
+ *
+ * Finds a parsed archive in the cache, marking it as recently used.
+ *
+ * Returns: (transfer full): a #FuCabinet, or %NULL if not found
+ **/
+FuCabinet *
+fu_cabinet_cache_lookup(FuCabinetCache *self, const gchar *checksum)
+{
+	FuCabinetCacheItem *item;
+
+	g_return_val_if_fail(FU_IS_CABINET_CACHE(self), NULL);
+	g_return_val_if_fail(checksum != NULL, NULL);
+
+	item = g_hash_table_lookup(self->items, checksum);
+	if (item == NULL)
+		return NULL;
+	g_queue_unlink(&self->lru, &item->link);
+	g_queue_push_head_link(&self->lru, &item->link);
+	return g_object_ref(item->cabinet);
+}
+
+/* the memory used once every image is loaded, without loading anything */
+static gboolean
+fu_cabinet_cache_get_cabinet_size(FuCabinet *cabinet, guint64 *size, GError **error)
+{
+	g_autoptr(GPtrArray) imgs = fu_firmware_get_images(FU_FIRMWARE(cabinet));
+	g_autoptr(XbSilo) silo = NULL;
+	g_autoptr(GBytes) silo_blob = NULL;
+
+	for (guint i = 0; i < imgs->len; i++) {
+		FuFirmware *img = g_ptr_array_index(imgs, i);
+		*size += fu_firmware_get_size(img);
+	}
+	silo = fu_cabinet_get_silo(cabinet, error);
+	if (silo == NULL)
+		return FALSE;
+	silo_blob = xb_silo_get_bytes(silo);
+	if (silo_blob != NULL)
+		*size += g_bytes_get_size(silo_blob);
+	return TRUE;
+}
+
+/* load each image into memory so that the cabinet no longer depends on the client stream */
+static gboolean
+fu_cabinet_cache_ensure_bytes(FuCabinet *cabinet, GError **error)
+{
+	g_autoptr(GPtrArray) imgs = fu_firmware_get_images(FU_FIRMWARE(cabinet));
+	for (guint i = 0; i < imgs->len; i++) {
+		FuFirmware *img = g_ptr_array_index(imgs, i);
+		g_autoptr(GBytes) blob = fu_firmware_get_bytes(img, error);
+		if (blob == NULL)
+			return FALSE;
+		fu_firmware_set_bytes(img, blob);
+	}
+	return TRUE;
+}
+
+/**
+ * fu_cabinet_cache_add:
+ * @self: a #FuCabinetCache
+ * @checksum: the SHA256 of the archive
+ * @cabinet: a parsed #FuCabinet
+ * @error: (nullable): optional return location for an error
+ *
+ * Adds a parsed archive to the cache, loading any images still backed by the archive stream into
+ * memory. Older archives are dropped if the cache is now too large, and archives that are larger
+ * than the maximum size are not added at all.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_cabinet_cache_add(FuCabinetCache *self,
+		     const gchar *checksum,
+		     FuCabinet *cabinet,
+		     GError **error)
+{
+	FuCabinetCacheItem *item;
+	guint64 size = 0;
+
+	g_return_val_if_fail(FU_IS_CABINET_CACHE(self), FALSE);
+	g_return_val_if_fail(checksum != NULL, FALSE);
+	g_return_val_if_fail(FU_IS_CABINET(cabinet), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* disabled */
+	if (self->size_max == 0)
+		return TRUE;
+
+	/* already added */
+	item = g_hash_table_lookup(self->items, checksum);
+	if (item != NULL && item->cabinet == cabinet)
+		return TRUE;
+
+	if (!fu_cabinet_cache_get_cabinet_size(cabinet, &size, error))
+		return FALSE;
+	if (size > self->size_max) {
+		g_debug("not adding %s to cache as too large", checksum);
+		return TRUE;
+	}
+	if (!fu_cabinet_cache_ensure_bytes(cabinet, error))
+		return FALSE;
+	if (item != NULL)
+		fu_cabinet_cache_remove_item(self, item);
+
+	item = g_new0(FuCabinetCacheItem, 1);
+	item->checksum = g_strdup(checksum);
+	item->cabinet = g_object_ref(cabinet);
+	item->size = size;
+	item->link.data = item;
+	g_hash_table_insert(self->items, item->checksum, item);
+	g_queue_push_head_link(&self->lru, &item->link);
+	self->size += size;
+	fu_cabinet_cache_ensure_size(self);
+	return TRUE;
+}
+
+/**
+ * fu_cabinet_cache_clear:
+ * @self: a #FuCabinetCache
+ *
+ * Removes all the archives from the cache, for instance when the archive size limit changes.
+ **/
+void
+fu_cabinet_cache_clear(FuCabinetCache *self)
+{
+	g_return_if_fail(FU_IS_CABINET_CACHE(self));
+	while (self->lru.head != NULL)
+		fu_cabinet_cache_remove_item(self, self->lru.head->data);
+}
+
+static void
+fu_cabinet_cache_init(FuCabinetCache *self)
+{
+	self->items = g_hash_table_new_full(g_str_hash,
+					    g_str_equal,
+					    NULL,
+					    (GDestroyNotify)fu_cabinet_cache_item_free);
+}
+
+static void
+fu_cabinet_cache_finalize(GObject *obj)
+{
+	FuCabinetCache *self = FU_CABINET_CACHE(obj);
+	g_hash_table_unref(self->items);
+	G_OBJECT_CLASS(fu_cabinet_cache_parent_class)->finalize(obj);
+}
+
+static void
+fu_cabinet_cache_class_init(FuCabinetCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_cabinet_cache_finalize;
+}
+
+/**
+ * fu_cabinet_cache_new:
+ *
+ * Creates a new in-memory cache of parsed archives.
+ *
+ * Returns: a #FuCabinetCache
+ **/
+FuCabinetCache *
+fu_cabinet_cache_new(void)
+{
+	return g_object_new(FU_TYPE_CABINET_CACHE, NULL);
+}
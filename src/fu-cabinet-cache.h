@@ -0,0 +1,28 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-cabinet.h"
+
+#define FU_TYPE_CABINET_CACHE (fu_cabinet_cache_get_type())
+G_DECLARE_FINAL_TYPE(FuCabinetCache, fu_cabinet_cache, FU, CABINET_CACHE, GObject)
+
+FuCabinetCache *
+fu_cabinet_cache_new(void);
+void
+fu_cabinet_cache_set_size_max(FuCabinetCache *self, guint64 size_max) G_GNUC_NON_NULL(1);
+guint64
+fu_cabinet_cache_get_size(FuCabinetCache *self) G_GNUC_NON_NULL(1);
+FuCabinet *
+fu_cabinet_cache_lookup(FuCabinetCache *self, const gchar *checksum) G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_cabinet_cache_add(FuCabinetCache *self,
+		     const gchar *checksum,
+		     FuCabinet *cabinet,
+		     GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2, 3);
+void
+fu_cabinet_cache_clear(FuCabinetCache *self) G_GNUC_NON_NULL(1);
@@ -50,6 +50,53 @@ fu_cabinet_set_jcat_context(FuCabinet *self, JcatContext *jcat_context)
 	g_set_object(&self->jcat_context, jcat_context);
 }
 
+/**
+ * fu_cabinet_get_container_checksum:
+ * @self: a #FuCabinet
+ * @csum_kind: a #GChecksumType, either %G_CHECKSUM_SHA1 or %G_CHECKSUM_SHA256
+ *
+ * Gets a checksum of the archive, as computed when it was parsed.
+ *
+ * Returns: a checksum, or %NULL if not parsed from a stream
+ *
+ * Since: 2.0.9
+ **/
+const gchar *
+fu_cabinet_get_container_checksum(FuCabinet *self, GChecksumType csum_kind)
+{
+	g_return_val_if_fail(FU_IS_CABINET(self), NULL);
+	g_return_val_if_fail(csum_kind == G_CHECKSUM_SHA1 || csum_kind == G_CHECKSUM_SHA256, NULL);
+	if (csum_kind == G_CHECKSUM_SHA1)
+		return self->container_checksum;
+	return self->container_checksum_alt;
+}
+
+/**
+ * fu_cabinet_set_container_checksum:
+ * @self: a #FuCabinet
+ * @csum_kind: a #GChecksumType, either %G_CHECKSUM_SHA1 or %G_CHECKSUM_SHA256
+ * @checksum: (nullable): the checksum of the archive stream
+ *
+ * Sets a checksum of the archive that the caller has already computed, so that the archive does
+ * not need to be hashed again when parsed.
+ *
+ * Since: 2.0.9
+ **/
+void
+fu_cabinet_set_container_checksum(FuCabinet *self, GChecksumType csum_kind, const gchar *checksum)
+{
+	g_return_if_fail(FU_IS_CABINET(self));
+	g_return_if_fail(csum_kind == G_CHECKSUM_SHA1 || csum_kind == G_CHECKSUM_SHA256);
+
+	if (csum_kind == G_CHECKSUM_SHA1) {
+		g_free(self->container_checksum);
+		self->container_checksum = g_strdup(checksum);
+		return;
+	}
+	g_free(self->container_checksum_alt);
+	self->container_checksum_alt = g_strdup(checksum);
+}
+
 /**
  * fu_cabinet_get_silo: (skip):
  * @self: a #FuCabinet
@@ -104,6 +151,8 @@ fu_cabinet_parse_release(FuCabinet *self, XbNode *release, GError **error)
 {
 	const gchar *csum_filename = NULL;
 	gsize streamsz = 0;
+	guint csum_kinds_len = 0;
+	GChecksumType csum_kinds[3] = {0};
 	g_autofree gchar *basename = NULL;
 	g_autoptr(FuFirmware) img_blob = NULL;
 	g_autoptr(GInputStream) stream = NULL;
@@ -115,6 +164,7 @@ fu_cabinet_parse_release(FuCabinet *self, XbNode *release, GError **error)
 	g_autoptr(JcatItem) item = NULL;
 	g_autoptr(GBytes) release_flags_blob = NULL;
 	g_autoptr(GBytes) filename_blob = NULL;
+	g_autoptr(GPtrArray) checksums = NULL;
 	FwupdReleaseFlags release_flags = FWUPD_RELEASE_FLAG_NONE;
 
 	/* we set this with XbBuilderSource before the silo was created */
@@ -186,15 +236,26 @@ fu_cabinet_parse_release(FuCabinet *self, XbNode *release, GError **error)
 		xb_node_set_data(release, "fwupd::ReleaseSize", blob_sz);
 	}
 
-	/* set if unspecified, but error out if specified and incorrect */
+	/* calculate all the payload checksums we need in one pass */
+	item = jcat_file_get_item_by_id(self->jcat_file, basename, NULL);
 	if (csum_tmp != NULL && xb_node_get_text(csum_tmp) != NULL) {
 		const gchar *checksum_old = xb_node_get_text(csum_tmp);
-		GChecksumType checksum_type = fwupd_checksum_guess_kind(checksum_old);
-		g_autofree gchar *checksum = NULL;
-		checksum = fu_input_stream_compute_checksum(stream, checksum_type, error);
-		if (checksum == NULL)
+		csum_kinds[csum_kinds_len++] = fwupd_checksum_guess_kind(checksum_old);
+	}
+	if (item != NULL && jcat_item_has_target(item)) {
+		csum_kinds[csum_kinds_len++] = G_CHECKSUM_SHA256;
+		csum_kinds[csum_kinds_len++] = G_CHECKSUM_SHA512;
+	}
+	if (csum_kinds_len > 0) {
+		checksums = fu_firmware_get_checksums(img_blob, csum_kinds, csum_kinds_len, error);
+		if (checksums == NULL)
 			return FALSE;
-		if (g_strcmp0(checksum, checksum_old) != 0) {
+	}
+
+	/* set if unspecified, but error out if specified and incorrect */
+	if (csum_tmp != NULL && xb_node_get_text(csum_tmp) != NULL) {
+		const gchar *checksum = g_ptr_array_index(checksums, 0);
+		if (g_strcmp0(checksum, xb_node_get_text(csum_tmp)) != 0) {
 			g_set_error(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_INVALID_FILE,
@@ -206,10 +267,9 @@ fu_cabinet_parse_release(FuCabinet *self, XbNode *release, GError **error)
 	}
 
 	/* the jcat file signed the *checksum of the payload*, not the payload itself */
-	item = jcat_file_get_item_by_id(self->jcat_file, basename, NULL);
 	if (item != NULL && jcat_item_has_target(item)) {
-		g_autofree gchar *checksum_sha256 = NULL;
-		g_autofree gchar *checksum_sha512 = NULL;
+		const gchar *checksum_sha256 = g_ptr_array_index(checksums, csum_kinds_len - 2);
+		const gchar *checksum_sha512 = g_ptr_array_index(checksums, csum_kinds_len - 1);
 		g_autoptr(GError) error_local = NULL;
 		g_autoptr(GPtrArray) results = NULL;
 		g_autoptr(JcatBlob) blob_target_sha256 = NULL;
@@ -217,18 +277,10 @@ fu_cabinet_parse_release(FuCabinet *self, XbNode *release, GError **error)
 		g_autoptr(JcatItem) item_target = jcat_item_new(basename);
 
 		/* add SHA-256 */
-		checksum_sha256 =
-		    fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA256, error);
-		if (checksum_sha256 == NULL)
-			return FALSE;
 		blob_target_sha256 = jcat_blob_new_utf8(JCAT_BLOB_KIND_SHA256, checksum_sha256);
 		jcat_item_add_blob(item_target, blob_target_sha256);
 
 		/* add SHA-512 */
-		checksum_sha512 =
-		    fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA512, error);
-		if (checksum_sha512 == NULL)
-			return FALSE;
 		blob_target_sha512 = jcat_blob_new_utf8(JCAT_BLOB_KIND_SHA512, checksum_sha512);
 		jcat_item_add_blob(item_target, blob_target_sha512);
 
@@ -898,22 +950,31 @@ fu_cabinet_parse(FuFirmware *firmware,
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 	g_return_val_if_fail(self->silo == NULL, FALSE);
 
-	/* decompress and calculate container hashes */
+	/* decompress and calculate container hashes, unless already set by the caller */
 	if (stream != NULL) {
+		GChecksumType csum_kinds[] = {G_CHECKSUM_SHA1, G_CHECKSUM_SHA256};
+		g_autoptr(GPtrArray) checksums = NULL;
+
 		if (!FU_FIRMWARE_CLASS(fu_cabinet_parent_class)
 			 ->parse(firmware,
 				 stream,
 				 flags | FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM,
 				 error))
 			return FALSE;
-		self->container_checksum =
-		    fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA1, error);
-		if (self->container_checksum == NULL)
-			return FALSE;
-		self->container_checksum_alt =
-		    fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA256, error);
-		if (self->container_checksum_alt == NULL)
-			return FALSE;
+		if (self->container_checksum == NULL || self->container_checksum_alt == NULL) {
+			checksums = fu_firmware_get_checksums(firmware,
+							      csum_kinds,
+							      G_N_ELEMENTS(csum_kinds),
+							      error);
+			if (checksums == NULL)
+				return FALSE;
+			fu_cabinet_set_container_checksum(self,
+							  G_CHECKSUM_SHA1,
+							  g_ptr_array_index(checksums, 0));
+			fu_cabinet_set_container_checksum(self,
+							  G_CHECKSUM_SHA256,
+							  g_ptr_array_index(checksums, 1));
+		}
 	}
 
 	/* build xmlb silo */
@@ -31,6 +31,11 @@ FuCabinet *
 fu_cabinet_new(void);
 void
 fu_cabinet_set_jcat_context(FuCabinet *self, JcatContext *jcat_context) G_GNUC_NON_NULL(1);
+const gchar *
+fu_cabinet_get_container_checksum(FuCabinet *self, GChecksumType csum_kind) G_GNUC_NON_NULL(1);
+void
+fu_cabinet_set_container_checksum(FuCabinet *self, GChecksumType csum_kind, const gchar *checksum)
+    G_GNUC_NON_NULL(1);
 gboolean
 fu_cabinet_sign(FuCabinet *self,
 		GBytes *cert,
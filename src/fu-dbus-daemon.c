@@ -26,6 +26,7 @@
 #include "fu-client-list.h"
 #include "fu-dbus-daemon.h"
 #include "fu-device-private.h"
+#include "fu-device-variant-cache.h"
 #include "fu-engine-helper.h"
 #include "fu-engine-requirements.h"
 #include "fu-polkit-authority.h"
@@ -48,6 +49,7 @@ struct _FuDbusDaemon {
 	guint percentage;   /* last emitted */
 	guint owner_id;
 	GPtrArray *system_inhibits;
+	FuDeviceVariantCache *device_variants;
 };
 
 G_DEFINE_TYPE(FuDbusDaemon, fu_dbus_daemon, FU_TYPE_DAEMON)
@@ -55,6 +57,9 @@ G_DEFINE_TYPE(FuDbusDaemon, fu_dbus_daemon, FU_TYPE_DAEMON)
 static void
 fu_dbus_daemon_engine_changed_cb(FuEngine *engine, FuDbusDaemon *self)
 {
+	/* releases and problems may have changed on any device */
+	fu_device_variant_cache_invalidate_all(self->device_variants);
+
 	/* not yet connected */
 	if (self->connection == NULL)
 		return;
@@ -71,12 +76,15 @@ fu_dbus_daemon_engine_changed_cb(FuEngine *engine, FuDbusDaemon *self)
 static void
 fu_dbus_daemon_engine_device_added_cb(FuEngine *engine, FuDevice *device, FuDbusDaemon *self)
 {
-	GVariant *val;
+	g_autoptr(GVariant) val = NULL;
+
+	/* not all changes emit GObject::notify */
+	fu_device_variant_cache_invalidate(self->device_variants, device);
 
 	/* not yet connected */
 	if (self->connection == NULL)
 		return;
-	val = fwupd_codec_to_variant(FWUPD_CODEC(device), FWUPD_CODEC_FLAG_NONE);
+	val = fu_device_variant_cache_get(self->device_variants, device, FWUPD_CODEC_FLAG_NONE);
 	g_dbus_connection_emit_signal(self->connection,
 				      NULL,
 				      FWUPD_DBUS_PATH,
@@ -92,6 +100,9 @@ fu_dbus_daemon_engine_device_removed_cb(FuEngine *engine, FuDevice *device, FuDb
 {
 	GVariant *val;
 
+	/* so that GetDevicesSince can report it */
+	fu_device_variant_cache_remove(self->device_variants, device);
+
 	/* not yet connected */
 	if (self->connection == NULL)
 		return;
@@ -109,12 +120,15 @@ fu_dbus_daemon_engine_device_removed_cb(FuEngine *engine, FuDevice *device, FuDb
 static void
 fu_dbus_daemon_engine_device_changed_cb(FuEngine *engine, FuDevice *device, FuDbusDaemon *self)
 {
-	GVariant *val;
+	g_autoptr(GVariant) val = NULL;
+
+	/* not all changes emit GObject::notify */
+	fu_device_variant_cache_invalidate(self->device_variants, device);
 
 	/* not yet connected */
 	if (self->connection == NULL)
 		return;
-	val = fwupd_codec_to_variant(FWUPD_CODEC(device), FWUPD_CODEC_FLAG_NONE);
+	val = fu_device_variant_cache_get(self->device_variants, device, FWUPD_CODEC_FLAG_NONE);
 	g_dbus_connection_emit_signal(self->connection,
 				      NULL,
 				      FWUPD_DBUS_PATH,
@@ -248,17 +262,26 @@ fu_dbus_daemon_create_request(FuDbusDaemon *self, const gchar *sender, GError **
 	return g_object_ref(request);
 }
 
+static FwupdCodecFlags
+fu_dbus_daemon_device_codec_flags(FuDbusDaemon *self, FuEngineRequest *request)
+{
+	FuEngine *engine = fu_daemon_get_engine(FU_DAEMON(self));
+	FwupdCodecFlags flags = fu_engine_request_get_converter_flags(request);
+	if (fu_engine_config_get_show_device_private(fu_engine_get_config(engine)))
+		flags |= FWUPD_CODEC_FLAG_TRUSTED;
+	return flags;
+}
+
 static GVariant *
 fu_dbus_daemon_device_array_to_variant(FuDbusDaemon *self,
 				       FuEngineRequest *request,
 				       GPtrArray *devices,
 				       GError **error)
 {
-	FuEngine *engine = fu_daemon_get_engine(FU_DAEMON(self));
-	FwupdCodecFlags flags = fu_engine_request_get_converter_flags(request);
-	if (fu_engine_config_get_show_device_private(fu_engine_get_config(engine)))
-		flags |= FWUPD_CODEC_FLAG_TRUSTED;
-	return fwupd_codec_array_to_variant(devices, flags);
+	return fu_device_variant_cache_array_to_variant(
+	    self->device_variants,
+	    devices,
+	    fu_dbus_daemon_device_codec_flags(self, request));
 }
 
 typedef struct {
@@ -1184,6 +1207,37 @@ fu_dbus_daemon_method_get_devices(FuDbusDaemon *self,
 	g_dbus_method_invocation_return_value(invocation, val);
 }
 
+static void
+fu_dbus_daemon_method_get_devices_since(FuDbusDaemon *self,
+					GVariant *parameters,
+					FuEngineRequest *request,
+					GDBusMethodInvocation *invocation)
+{
+	FuEngine *engine = fu_daemon_get_engine(FU_DAEMON(self));
+	GVariant *val;
+	guint64 generation = 0;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+
+	g_variant_get(parameters, "(t)", &generation);
+	devices = fu_engine_get_devices(engine, &error);
+	if (devices == NULL) {
+		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
+		return;
+	}
+	val = fu_device_variant_cache_array_to_variant_since(
+	    self->device_variants,
+	    devices,
+	    generation,
+	    fu_dbus_daemon_device_codec_flags(self, request),
+	    &error);
+	if (val == NULL) {
+		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
+		return;
+	}
+	g_dbus_method_invocation_return_value(invocation, val);
+}
+
 static void
 fu_dbus_daemon_method_get_plugins(FuDbusDaemon *self,
 				  GVariant *parameters,
@@ -1292,6 +1346,30 @@ fu_dbus_daemon_method_get_report_metadata(FuDbusDaemon *self,
 	g_dbus_method_invocation_return_value(invocation, g_variant_new_tuple(&val, 1));
 }
 
+static void
+fu_dbus_daemon_method_get_metrics(FuDbusDaemon *self,
+				  GVariant *parameters,
+				  FuEngineRequest *request,
+				  GDBusMethodInvocation *invocation)
+{
+	FuEngine *engine = fu_daemon_get_engine(FU_DAEMON(self));
+	FuMetrics *metrics = fu_context_get_metrics(fu_engine_get_context(engine));
+	const gchar *key;
+	guint64 *value;
+	GHashTableIter iter;
+	GVariantBuilder builder;
+	GVariant *val;
+	g_autoptr(GHashTable) values = fu_metrics_get_values(metrics);
+
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("a{st}"));
+	g_hash_table_iter_init(&iter, values);
+	while (g_hash_table_iter_next(&iter, (gpointer *)&key, (gpointer *)&value)) {
+		g_variant_builder_add_value(&builder, g_variant_new("{st}", key, *value));
+	}
+	val = g_variant_builder_end(&builder);
+	g_dbus_method_invocation_return_value(invocation, g_variant_new_tuple(&val, 1));
+}
+
 static void
 fu_dbus_daemon_method_set_approved_firmware(FuDbusDaemon *self,
 					    GVariant *parameters,
@@ -2473,11 +2551,13 @@ fu_dbus_daemon_method_call(GDBusConnection *connection,
 		FuDbusDaemonMethodFunc func;
 	} method_funcs[] = {
 	    {"GetDevices", fu_dbus_daemon_method_get_devices},
+	    {"GetDevicesSince", fu_dbus_daemon_method_get_devices_since},
 	    {"GetPlugins", fu_dbus_daemon_method_get_plugins},
 	    {"GetReleases", fu_dbus_daemon_method_get_releases},
 	    {"GetApprovedFirmware", fu_dbus_daemon_method_get_approved_firmware},
 	    {"GetBlockedFirmware", fu_dbus_daemon_method_get_blocked_firmware},
 	    {"GetReportMetadata", fu_dbus_daemon_method_get_report_metadata},
+	    {"GetMetrics", fu_dbus_daemon_method_get_metrics},
 	    {"SetApprovedFirmware", fu_dbus_daemon_method_set_approved_firmware},
 	    {"SetBlockedFirmware", fu_dbus_daemon_method_set_blocked_firmware},
 	    {"Quit", fu_dbus_daemon_method_quit},
@@ -2906,6 +2986,7 @@ static void
 fu_dbus_daemon_init(FuDbusDaemon *self)
 {
 	self->status = FWUPD_STATUS_IDLE;
+	self->device_variants = fu_device_variant_cache_new();
 	self->system_inhibits =
 	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_dbus_daemon_system_inhibit_free);
 }
@@ -2916,6 +2997,7 @@ fu_dbus_daemon_finalize(GObject *obj)
 	FuDbusDaemon *self = FU_DBUS_DAEMON(obj);
 
 	g_ptr_array_unref(self->system_inhibits);
+	g_object_unref(self->device_variants);
 	if (self->client_list != NULL)
 		g_object_unref(self->client_list);
 	if (self->owner_id > 0)
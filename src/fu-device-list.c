@@ -34,6 +34,11 @@ struct _FuDeviceList {
 	GObject parent_instance;
 	GPtrArray *devices; /* of FuDeviceItem */
 	GRWLock devices_mutex;
+	GPtrArray *index_ids;	       /* of FuDeviceIndexEntry, sorted by key */
+	GHashTable *index_guids;       /* of guid:GPtrArray of FuDeviceIndexEntry */
+	GHashTable *index_connections; /* of physical+logical:GPtrArray of FuDeviceIndexEntry */
+	gint index_dirty;	       /* atomic, set when any item has index_dirty set */
+	guint64 item_seq;
 };
 
 enum { SIGNAL_ADDED, SIGNAL_REMOVED, SIGNAL_CHANGED, SIGNAL_LAST };
@@ -45,8 +50,24 @@ typedef struct {
 	FuDevice *device_old;
 	FuDeviceList *self; /* no ref */
 	guint remove_id;
+	guint64 seq;	    /* the order the item was added */
+	GPtrArray *entries; /* of FuDeviceIndexEntry */
+	gint index_dirty;   /* atomic, set when an indexed ID or GUID changed */
 } FuDeviceItem;
 
+typedef enum {
+	FU_DEVICE_INDEX_KIND_ID,
+	FU_DEVICE_INDEX_KIND_GUID,
+	FU_DEVICE_INDEX_KIND_CONNECTION,
+} FuDeviceIndexKind;
+
+typedef struct {
+	FuDeviceIndexKind kind;
+	gchar *key;
+	FuDeviceItem *item; /* no ref */
+	gboolean is_old;
+} FuDeviceIndexEntry;
+
 static void
 fu_device_list_codec_iface_init(FwupdCodecInterface *iface);
 
@@ -111,6 +132,222 @@ fu_device_list_add_string(FwupdCodec *codec, guint idt, GString *str)
 	g_rw_lock_reader_unlock(&self->devices_mutex);
 }
 
+static void
+fu_device_index_entry_free(FuDeviceIndexEntry *entry)
+{
+	g_free(entry->key);
+	g_free(entry);
+}
+
+static gchar *
+fu_device_list_connection_key(const gchar *physical_id, const gchar *logical_id)
+{
+	if (logical_id == NULL)
+		return g_strdup(physical_id);
+	return g_strdup_printf("%s\t%s", physical_id, logical_id);
+}
+
+/* returns the index of the first ID that is not less than @key */
+static guint
+fu_device_list_index_ids_lower_bound(FuDeviceList *self, const gchar *key)
+{
+	guint lo = 0;
+	guint hi = self->index_ids->len;
+	while (lo < hi) {
+		guint mid = lo + (hi - lo) / 2;
+		FuDeviceIndexEntry *entry = g_ptr_array_index(self->index_ids, mid);
+		if (g_strcmp0(entry->key, key) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+static GHashTable *
+fu_device_list_index_for_kind(FuDeviceList *self, FuDeviceIndexKind kind)
+{
+	if (kind == FU_DEVICE_INDEX_KIND_GUID)
+		return self->index_guids;
+	return self->index_connections;
+}
+
+/* the caller must hold the writer lock */
+static void
+fu_device_list_index_add_unlocked(FuDeviceList *self,
+				  FuDeviceItem *item,
+				  FuDeviceIndexKind kind,
+				  const gchar *key,
+				  gboolean is_old)
+{
+	FuDeviceIndexEntry *entry = g_new0(FuDeviceIndexEntry, 1);
+
+	entry->kind = kind;
+	entry->key = g_strdup(key);
+	entry->item = item;
+	entry->is_old = is_old;
+	g_ptr_array_add(item->entries, entry);
+
+	if (kind == FU_DEVICE_INDEX_KIND_ID) {
+		g_ptr_array_insert(self->index_ids,
+				   fu_device_list_index_ids_lower_bound(self, key),
+				   entry);
+	} else {
+		GHashTable *index = fu_device_list_index_for_kind(self, kind);
+		GPtrArray *entries = g_hash_table_lookup(index, key);
+		if (entries == NULL) {
+			entries = g_ptr_array_new();
+			g_hash_table_insert(index, g_strdup(key), entries);
+		}
+		g_ptr_array_add(entries, entry);
+	}
+}
+
+/* the caller must hold the writer lock */
+static void
+fu_device_list_index_remove_unlocked(FuDeviceList *self, FuDeviceIndexEntry *entry)
+{
+	if (entry->kind == FU_DEVICE_INDEX_KIND_ID) {
+		for (guint i = fu_device_list_index_ids_lower_bound(self, entry->key);
+		     i < self->index_ids->len;
+		     i++) {
+			if (g_ptr_array_index(self->index_ids, i) == entry) {
+				g_ptr_array_remove_index(self->index_ids, i);
+				break;
+			}
+		}
+	} else {
+		GHashTable *index = fu_device_list_index_for_kind(self, entry->kind);
+		GPtrArray *entries = g_hash_table_lookup(index, entry->key);
+		if (entries != NULL) {
+			g_ptr_array_remove(entries, entry);
+			if (entries->len == 0)
+				g_hash_table_remove(index, entry->key);
+		}
+	}
+}
+
+/* the caller must hold the writer lock */
+static void
+fu_device_list_index_device_unlocked(FuDeviceList *self,
+				     FuDeviceItem *item,
+				     FuDevice *device,
+				     gboolean is_old)
+{
+	GPtrArray *guids = fu_device_get_guids(device);
+	const gchar *ids[] = {fu_device_get_id(device), fu_device_get_equivalent_id(device)};
+
+	for (guint i = 0; i < G_N_ELEMENTS(ids); i++) {
+		if (ids[i] == NULL)
+			continue;
+		fu_device_list_index_add_unlocked(self,
+						  item,
+						  FU_DEVICE_INDEX_KIND_ID,
+						  ids[i],
+						  is_old);
+	}
+	for (guint i = 0; i < guids->len; i++) {
+		const gchar *guid = g_ptr_array_index(guids, i);
+		fu_device_list_index_add_unlocked(self,
+						  item,
+						  FU_DEVICE_INDEX_KIND_GUID,
+						  guid,
+						  is_old);
+	}
+	if (fu_device_get_physical_id(device) != NULL) {
+		g_autofree gchar *key =
+		    fu_device_list_connection_key(fu_device_get_physical_id(device),
+						  fu_device_get_logical_id(device));
+		fu_device_list_index_add_unlocked(self,
+						  item,
+						  FU_DEVICE_INDEX_KIND_CONNECTION,
+						  key,
+						  is_old);
+	}
+}
+
+/* the caller must hold the writer lock */
+static void
+fu_device_list_item_unindex_unlocked(FuDeviceList *self, FuDeviceItem *item)
+{
+	for (guint i = 0; i < item->entries->len; i++) {
+		FuDeviceIndexEntry *entry = g_ptr_array_index(item->entries, i);
+		fu_device_list_index_remove_unlocked(self, entry);
+	}
+	g_ptr_array_set_size(item->entries, 0);
+}
+
+/* the caller must hold the writer lock */
+static void
+fu_device_list_item_reindex_unlocked(FuDeviceList *self, FuDeviceItem *item)
+{
+	g_atomic_int_set(&item->index_dirty, 0);
+	fu_device_list_item_unindex_unlocked(self, item);
+	if (item->device != NULL)
+		fu_device_list_index_device_unlocked(self, item, item->device, FALSE);
+	if (item->device_old != NULL)
+		fu_device_list_index_device_unlocked(self, item, item->device_old, TRUE);
+}
+
+static void
+fu_device_list_item_reindex(FuDeviceList *self, FuDeviceItem *item)
+{
+	g_rw_lock_writer_lock(&self->devices_mutex);
+	fu_device_list_item_reindex_unlocked(self, item);
+	g_rw_lock_writer_unlock(&self->devices_mutex);
+}
+
+/* reindex the items where an ID or GUID changed since they were last indexed; this must be
+ * called before taking the reader lock */
+static void
+fu_device_list_ensure_index(FuDeviceList *self)
+{
+	if (g_atomic_int_get(&self->index_dirty) == 0)
+		return;
+	g_rw_lock_writer_lock(&self->devices_mutex);
+	if (g_atomic_int_compare_and_exchange(&self->index_dirty, 1, 0)) {
+		for (guint i = 0; i < self->devices->len; i++) {
+			FuDeviceItem *item = g_ptr_array_index(self->devices, i);
+			if (g_atomic_int_get(&item->index_dirty) == 0)
+				continue;
+			fu_device_list_item_reindex_unlocked(self, item);
+		}
+	}
+	g_rw_lock_writer_unlock(&self->devices_mutex);
+}
+
+/* the notify may be emitted while the list lock is already held, so just mark the item as
+ * stale rather than taking the writer lock here */
+static void
+fu_device_list_item_notify_id_cb(FuDevice *device, GParamSpec *pspec, gpointer user_data)
+{
+	FuDeviceItem *item = (FuDeviceItem *)user_data;
+	g_atomic_int_set(&item->index_dirty, 1);
+	g_atomic_int_set(&item->self->index_dirty, 1);
+}
+
+/* find the earliest added item, preferring active devices over old devices */
+static FuDeviceItem *
+fu_device_list_index_entries_best_item(GPtrArray *entries)
+{
+	FuDeviceItem *item_old = NULL;
+	FuDeviceItem *item_new = NULL;
+
+	if (entries == NULL)
+		return NULL;
+	for (guint i = 0; i < entries->len; i++) {
+		FuDeviceIndexEntry *entry = g_ptr_array_index(entries, i);
+		if (entry->is_old) {
+			if (item_old == NULL || entry->item->seq < item_old->seq)
+				item_old = entry->item;
+		} else {
+			if (item_new == NULL || entry->item->seq < item_new->seq)
+				item_new = entry->item;
+		}
+	}
+	return item_new != NULL ? item_new : item_old;
+}
+
 /* we cannot use fu_device_get_children() as this will not find "parent-only"
  * logical relationships added using fu_device_add_parent_guid() */
 static GPtrArray *
@@ -254,21 +491,21 @@ fu_device_list_find_by_device(FuDeviceList *self, FuDevice *device)
 static FuDeviceItem *
 fu_device_list_find_by_guid(FuDeviceList *self, const gchar *guid)
 {
-	g_autoptr(GRWLockReaderLocker) locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
+	fwupd_guid_t guid_bin = {0x0};
+	g_autofree gchar *guid_tmp = NULL;
+	g_autoptr(GRWLockReaderLocker) locker = NULL;
+
+	/* the index uses the lowercase form, and instance IDs are converted to GUIDs */
+	if (fwupd_guid_from_string(guid, &guid_bin, FWUPD_GUID_FLAG_NONE, NULL))
+		guid_tmp = fwupd_guid_to_string(&guid_bin, FWUPD_GUID_FLAG_NONE);
+	else
+		guid_tmp = fwupd_guid_hash_string(guid);
+
+	fu_device_list_ensure_index(self);
+	locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
 	g_return_val_if_fail(locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (fu_device_has_guid(item->device, guid))
-			return item;
-	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (item->device_old == NULL)
-			continue;
-		if (fu_device_has_guid(item->device_old, guid))
-			return item;
-	}
-	return NULL;
+	return fu_device_list_index_entries_best_item(
+	    g_hash_table_lookup(self->index_guids, guid_tmp));
 }
 
 static FuDeviceItem *
@@ -276,28 +513,16 @@ fu_device_list_find_by_connection(FuDeviceList *self,
 				  const gchar *physical_id,
 				  const gchar *logical_id)
 {
+	g_autofree gchar *key = NULL;
 	g_autoptr(GRWLockReaderLocker) locker = NULL;
 	if (physical_id == NULL)
 		return NULL;
+	key = fu_device_list_connection_key(physical_id, logical_id);
+	fu_device_list_ensure_index(self);
 	locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
 	g_return_val_if_fail(locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
-		FuDevice *device = item_tmp->device;
-		if (device != NULL &&
-		    g_strcmp0(fu_device_get_physical_id(device), physical_id) == 0 &&
-		    g_strcmp0(fu_device_get_logical_id(device), logical_id) == 0)
-			return item_tmp;
-	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
-		FuDevice *device = item_tmp->device_old;
-		if (device != NULL &&
-		    g_strcmp0(fu_device_get_physical_id(device), physical_id) == 0 &&
-		    g_strcmp0(fu_device_get_logical_id(device), logical_id) == 0)
-			return item_tmp;
-	}
-	return NULL;
+	return fu_device_list_index_entries_best_item(
+	    g_hash_table_lookup(self->index_connections, key));
 }
 
 static gint
@@ -309,6 +534,10 @@ fu_device_list_item_sort_by_priority_cb(gconstpointer a, gconstpointer b)
 		return 1;
 	if (fu_device_get_priority(item1->device) > fu_device_get_priority(item2->device))
 		return -1;
+	if (item1->seq > item2->seq)
+		return 1;
+	if (item1->seq < item2->seq)
+		return -1;
 	return 0;
 }
 
@@ -317,23 +546,23 @@ fu_device_list_filter_by_id(FuDeviceList *self, const gchar *device_id, GError *
 {
 	gsize device_id_len;
 	g_autoptr(GPtrArray) items = g_ptr_array_new();
+	g_autoptr(GPtrArray) items_old = g_ptr_array_new();
 
 	g_return_val_if_fail(device_id != NULL, NULL);
 
-	/* support abbreviated hashes */
+	/* support abbreviated hashes, which are all sorted after the prefix */
 	device_id_len = strlen(device_id);
+	fu_device_list_ensure_index(self);
 	g_rw_lock_reader_lock(&self->devices_mutex);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
-		const gchar *ids[] = {fu_device_get_id(item_tmp->device),
-				      fu_device_get_equivalent_id(item_tmp->device),
-				      NULL};
-		for (guint j = 0; ids[j] != NULL; j++) {
-			if (strncmp(ids[j], device_id, device_id_len) == 0) {
-				g_ptr_array_add(items, item_tmp);
-				break;
-			}
-		}
+	for (guint i = fu_device_list_index_ids_lower_bound(self, device_id);
+	     i < self->index_ids->len;
+	     i++) {
+		FuDeviceIndexEntry *entry = g_ptr_array_index(self->index_ids, i);
+		GPtrArray *items_tmp = entry->is_old ? items_old : items;
+		if (strncmp(entry->key, device_id, device_id_len) != 0)
+			break;
+		if (!g_ptr_array_find(items_tmp, entry->item, NULL))
+			g_ptr_array_add(items_tmp, entry->item);
 	}
 	g_rw_lock_reader_unlock(&self->devices_mutex);
 	if (items->len > 0) {
@@ -342,25 +571,9 @@ fu_device_list_filter_by_id(FuDeviceList *self, const gchar *device_id, GError *
 	}
 
 	/* only search old devices if we didn't find the active device */
-	g_rw_lock_reader_lock(&self->devices_mutex);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
-		const gchar *ids[3] = {NULL};
-		if (item_tmp->device_old == NULL)
-			continue;
-		ids[0] = fu_device_get_id(item_tmp->device_old);
-		ids[1] = fu_device_get_equivalent_id(item_tmp->device_old);
-		for (guint j = 0; ids[j] != NULL; j++) {
-			if (strncmp(ids[j], device_id, device_id_len) == 0) {
-				g_ptr_array_add(items, item_tmp);
-				break;
-			}
-		}
-	}
-	g_rw_lock_reader_unlock(&self->devices_mutex);
-	if (items->len > 0) {
-		g_ptr_array_sort(items, fu_device_list_item_sort_by_priority_cb);
-		return g_steal_pointer(&items);
+	if (items_old->len > 0) {
+		g_ptr_array_sort(items_old, fu_device_list_item_sort_by_priority_cb);
+		return g_steal_pointer(&items_old);
 	}
 
 	/* failed */
@@ -650,11 +863,33 @@ fu_device_list_item_finalized_cb(gpointer data, GObject *where_the_object_was)
 	g_rw_lock_writer_unlock(&self->devices_mutex);
 }
 
+/* reindex the item if any of the indexed IDs or GUIDs change */
+static void
+fu_device_list_item_watch(FuDeviceItem *item, FuDevice *device)
+{
+	const gchar *signal_names[] = {"notify::id",
+				       "notify::equivalent-id",
+				       "notify::physical-id",
+				       "notify::logical-id",
+				       "notify::guids"};
+	g_signal_handlers_disconnect_by_data(device, item);
+	for (guint i = 0; i < G_N_ELEMENTS(signal_names); i++) {
+		g_signal_connect(device,
+				 signal_names[i],
+				 G_CALLBACK(fu_device_list_item_notify_id_cb),
+				 item);
+	}
+}
+
 static void
 fu_device_list_item_set_device_old(FuDeviceItem *item, FuDevice *device)
 {
 	fu_device_set_parent(device, NULL);
 	fu_device_remove_children(device);
+	if (item->device_old != NULL && item->device_old != item->device)
+		g_signal_handlers_disconnect_by_data(item->device_old, item);
+	if (device != NULL)
+		fu_device_list_item_watch(item, device);
 	g_set_object(&item->device_old, device);
 }
 
@@ -664,9 +899,12 @@ fu_device_list_item_set_device(FuDeviceItem *item, FuDevice *device)
 {
 	if (item->device != NULL) {
 		g_object_weak_unref(G_OBJECT(item->device), fu_device_list_item_finalized_cb, item);
+		if (item->device != item->device_old)
+			g_signal_handlers_disconnect_by_data(item->device, item);
 	}
 	if (device != NULL) {
 		g_object_weak_ref(G_OBJECT(device), fu_device_list_item_finalized_cb, item);
+		fu_device_list_item_watch(item, device);
 	}
 	g_set_object(&item->device, device);
 }
@@ -784,6 +1022,7 @@ fu_device_list_replace(FuDeviceList *self, FuDeviceItem *item, FuDevice *device)
 	/* assign the new device */
 	fu_device_list_item_set_device_old(item, item->device);
 	fu_device_list_item_set_device(item, device);
+	fu_device_list_item_reindex(self, item);
 	fu_device_list_emit_device_changed(self, device);
 
 	/* debug */
@@ -850,6 +1089,7 @@ fu_device_list_add(FuDeviceList *self, FuDevice *device)
 						  FU_DEVICE_INCORPORATE_FLAG_UPDATE_ERROR);
 			g_set_object(&item->device_old, item->device);
 			fu_device_list_item_set_device(item, device);
+			fu_device_list_item_reindex(self, item);
 			fu_device_list_clear_wait_for_replug(self, item);
 			fu_device_list_emit_device_changed(self, device);
 			return;
@@ -918,9 +1158,12 @@ fu_device_list_add(FuDeviceList *self, FuDevice *device)
 	/* add helper */
 	item = g_new0(FuDeviceItem, 1);
 	item->self = self; /* no ref */
+	item->entries = g_ptr_array_new_with_free_func((GDestroyNotify)fu_device_index_entry_free);
 	fu_device_list_item_set_device(item, device);
 	g_rw_lock_writer_lock(&self->devices_mutex);
+	item->seq = self->item_seq++;
 	g_ptr_array_add(self->devices, item);
+	fu_device_list_item_reindex_unlocked(self, item);
 	g_rw_lock_writer_unlock(&self->devices_mutex);
 	fu_device_list_emit_device_added(self, device);
 }
@@ -1084,14 +1327,20 @@ fu_device_list_get_by_id(FuDeviceList *self, const gchar *device_id, GError **er
 	return g_object_ref(item->device);
 }
 
+/* the caller must hold the writer lock */
 static void
 fu_device_list_item_free(FuDeviceItem *item)
 {
 	if (item->remove_id != 0)
 		g_source_remove(item->remove_id);
-	if (item->device_old != NULL)
-		g_object_unref(item->device_old);
+	fu_device_list_item_unindex_unlocked(item->self, item);
+	if (item->device_old != NULL) {
+		if (item->device_old != item->device)
+			g_signal_handlers_disconnect_by_data(item->device_old, item);
+		g_clear_object(&item->device_old);
+	}
 	fu_device_list_item_set_device(item, NULL);
+	g_ptr_array_unref(item->entries);
 	g_free(item);
 }
 
@@ -1176,6 +1425,11 @@ static void
 fu_device_list_init(FuDeviceList *self)
 {
 	self->devices = g_ptr_array_new_with_free_func((GDestroyNotify)fu_device_list_item_free);
+	self->index_ids = g_ptr_array_new();
+	self->index_guids =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_ptr_array_unref);
+	self->index_connections =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_ptr_array_unref);
 	g_rw_lock_init(&self->devices_mutex);
 }
 
@@ -1186,6 +1440,9 @@ fu_device_list_finalize(GObject *obj)
 
 	g_rw_lock_clear(&self->devices_mutex);
 	g_ptr_array_unref(self->devices);
+	g_ptr_array_unref(self->index_ids);
+	g_hash_table_unref(self->index_guids);
+	g_hash_table_unref(self->index_connections);
 
 	G_OBJECT_CLASS(fu_device_list_parent_class)->finalize(obj);
 }
@@ -0,0 +1,432 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuDeviceVariantCache"
+
+#include "config.h"
+
+#include "fu-device-variant-cache.h"
+
+/*
+ * Caches the serialized GVariant of each device so that GetDevices does not have to build every
+ * property of every device on each call. Each device also has the generation it last changed
+ * at, so that clients can ask for just the devices that changed since they last asked.
+ */
+
+struct _FuDeviceVariantCache {
+	GObject parent_instance;
+	GMutex mutex;
+	GHashTable *entries; /* (element-type FuDevice FuDeviceVariantCacheEntry) */
+	GPtrArray *removed;  /* (element-type FuDeviceVariantCacheRemoved) */
+	guint64 generation;
+	guint64 generation_removed_min; /* older removals have been forgotten */
+};
+
+G_DEFINE_TYPE(FuDeviceVariantCache, fu_device_variant_cache, G_TYPE_OBJECT)
+
+#define FU_DEVICE_VARIANT_CACHE_REMOVED_MAX 1024
+
+typedef struct {
+	FuDeviceVariantCache *self; /* (not owned) */
+	FuDevice *device;	    /* (not owned) */
+	gulong notify_id;
+	guint64 generation;
+	GVariant *variant;	   /* (nullable) */
+	GVariant *variant_trusted; /* (nullable) */
+} FuDeviceVariantCacheEntry;
+
+typedef struct {
+	gchar *device_id;
+	guint64 generation;
+} FuDeviceVariantCacheRemoved;
+
+static void
+fu_device_variant_cache_entry_clear(FuDeviceVariantCacheEntry *entry)
+{
+	g_clear_pointer(&entry->variant, g_variant_unref);
+	g_clear_pointer(&entry->variant_trusted, g_variant_unref);
+}
+
+static void
+fu_device_variant_cache_device_finalized_cb(gpointer user_data, GObject *where_the_object_was)
+{
+	FuDeviceVariantCacheEntry *entry = (FuDeviceVariantCacheEntry *)user_data;
+	FuDeviceVariantCache *self = entry->self;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->mutex);
+
+	/* the signal handler and weak ref are already gone */
+	entry->device = NULL;
+	g_hash_table_remove(self->entries, where_the_object_was);
+}
+
+static void
+fu_device_variant_cache_entry_free(FuDeviceVariantCacheEntry *entry)
+{
+	if (entry->device != NULL) {
+		g_signal_handler_disconnect(entry->device, entry->notify_id);
+		g_object_weak_unref(G_OBJECT(entry->device),
+				    fu_device_variant_cache_device_finalized_cb,
+				    entry);
+	}
+	fu_device_variant_cache_entry_clear(entry);
+	g_free(entry);
+}
+
+static void
+fu_device_variant_cache_removed_free(FuDeviceVariantCacheRemoved *removed)
+{
+	g_free(removed->device_id);
+	g_free(removed);
+}
+
+static void
+fu_device_variant_cache_device_notify_cb(FuDevice *device, GParamSpec *pspec, gpointer user_data)
+{
+	FuDeviceVariantCache *self = FU_DEVICE_VARIANT_CACHE(user_data);
+	fu_device_variant_cache_invalidate(self, device);
+}
+
+/* the caller must hold the mutex */
+static void
+fu_device_variant_cache_forget_removed_unlocked(FuDeviceVariantCache *self, const gchar *device_id)
+{
+	if (device_id == NULL)
+		return;
+	for (guint i = 0; i < self->removed->len; i++) {
+		FuDeviceVariantCacheRemoved *removed = g_ptr_array_index(self->removed, i);
+		if (g_strcmp0(removed->device_id, device_id) == 0) {
+			g_ptr_array_remove_index(self->removed, i);
+			return;
+		}
+	}
+}
+
+/* the caller must hold the mutex */
+static FuDeviceVariantCacheEntry *
+fu_device_variant_cache_ensure_entry_unlocked(FuDeviceVariantCache *self, FuDevice *device)
+{
+	FuDeviceVariantCacheEntry *entry = g_hash_table_lookup(self->entries, device);
+	if (entry != NULL)
+		return entry;
+
+	/* a device that was removed and then added again is only reported as changed */
+	fu_device_variant_cache_forget_removed_unlocked(self, fu_device_get_id(device));
+
+	/* a device we have not seen before counts as a change */
+	entry = g_new0(FuDeviceVariantCacheEntry, 1);
+	entry->self = self;
+	entry->device = device;
+	entry->generation = ++self->generation;
+	entry->notify_id = g_signal_connect(device,
+					    "notify",
+					    G_CALLBACK(fu_device_variant_cache_device_notify_cb),
+					    self);
+	g_object_weak_ref(G_OBJECT(device), fu_device_variant_cache_device_finalized_cb, entry);
+	g_hash_table_insert(self->entries, device, entry);
+	return entry;
+}
+
+/**
+ * fu_device_variant_cache_get_generation:
+ * @self: a #FuDeviceVariantCache
+ *
+ * Gets the generation of the most recent change to any device.
+ *
+ * Returns: integer, or 0 if no devices have been seen
+ **/
+guint64
+fu_device_variant_cache_get_generation(FuDeviceVariantCache *self)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->mutex);
+	g_return_val_if_fail(FU_IS_DEVICE_VARIANT_CACHE(self), 0);
+	return self->generation;
+}
+
+/**
+ * fu_device_variant_cache_invalidate:
+ * @self: a #FuDeviceVariantCache
+ * @device: a #FuDevice
+ *
+ * Marks the device as changed, so that it is serialized again when next required.
+ *
+ * This is also called automatically for any GObject property change on the device.
+ **/
+void
+fu_device_variant_cache_invalidate(FuDeviceVariantCache *self, FuDevice *device)
+{
+	FuDeviceVariantCacheEntry *entry;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->mutex);
+
+	g_return_if_fail(FU_IS_DEVICE_VARIANT_CACHE(self));
+	g_return_if_fail(FU_IS_DEVICE(device));
+
+	entry = g_hash_table_lookup(self->entries, device);
+	if (entry == NULL) {
+		fu_device_variant_cache_ensure_entry_unlocked(self, device);
+		return;
+	}
+	fu_device_variant_cache_entry_clear(entry);
+	entry->generation = ++self->generation;
+}
+
+/**
+ * fu_device_variant_cache_invalidate_all:
+ * @self: a #FuDeviceVariantCache
+ *
+ * Marks all the devices as changed, for instance after the engine has reloaded metadata.
+ **/
+void
+fu_device_variant_cache_invalidate_all(FuDeviceVariantCache *self)
+{
+	FuDeviceVariantCacheEntry *entry;
+	GHashTableIter iter;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->mutex);
+
+	g_return_if_fail(FU_IS_DEVICE_VARIANT_CACHE(self));
+
+	self->generation++;
+	g_hash_table_iter_init(&iter, self->entries);
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&entry)) {
+		fu_device_variant_cache_entry_clear(entry);
+		entry->generation = self->generation;
+	}
+}
+
+/**
+ * fu_device_variant_cache_remove:
+ * @self: a #FuDeviceVariantCache
+ * @device: a #FuDevice
+ *
+ * Forgets about the device, and remembers the device ID so that clients can be told about the
+ * removal.
+ **/
+void
+fu_device_variant_cache_remove(FuDeviceVariantCache *self, FuDevice *device)
+{
+	FuDeviceVariantCacheRemoved *removed;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->mutex);
+
+	g_return_if_fail(FU_IS_DEVICE_VARIANT_CACHE(self));
+	g_return_if_fail(FU_IS_DEVICE(device));
+
+	g_hash_table_remove(self->entries, device);
+	if (fu_device_get_id(device) == NULL)
+		return;
+
+	/* only report each device ID once */
+	fu_device_variant_cache_forget_removed_unlocked(self, fu_device_get_id(device));
+
+	/* only keep the most recent */
+	if (self->removed->len >= FU_DEVICE_VARIANT_CACHE_REMOVED_MAX) {
+		FuDeviceVariantCacheRemoved *removed_old = g_ptr_array_index(self->removed, 0);
+		self->generation_removed_min = removed_old->generation;
+		g_ptr_array_remove_index(self->removed, 0);
+	}
+	removed = g_new0(FuDeviceVariantCacheRemoved, 1);
+	removed->device_id = g_strdup(fu_device_get_id(device));
+	removed->generation = ++self->generation;
+	g_ptr_array_add(self->removed, removed);
+}
+
+static GVariant **
+fu_device_variant_cache_entry_get_slot(FuDeviceVariantCacheEntry *entry, FwupdCodecFlags flags)
+{
+	return flags == FWUPD_CODEC_FLAG_TRUSTED ? &entry->variant_trusted : &entry->variant;
+}
+
+/**
+ * fu_device_variant_cache_get:
+ * @self: a #FuDeviceVariantCache
+ * @device: a #FuDevice
+ * @flags: a #FwupdCodecFlags, e.g. %FWUPD_CODEC_FLAG_TRUSTED
+ *
+ * Gets the serialized device, only building it if the device has changed.
+ *
+ * The device is serialized without holding the lock, so that property getters and any notify
+ * handlers can use the cache.
+ *
+ * Returns: (transfer full): a #GVariant of type `a{sv}`
+ **/
+GVariant *
+fu_device_variant_cache_get(FuDeviceVariantCache *self, FuDevice *device, FwupdCodecFlags flags)
+{
+	FuDeviceVariantCacheEntry *entry;
+	GVariant **variant;
+	guint64 generation;
+	g_autoptr(GVariant) val = NULL;
+
+	g_return_val_if_fail(FU_IS_DEVICE_VARIANT_CACHE(self), NULL);
+	g_return_val_if_fail(FU_IS_DEVICE(device), NULL);
+
+	/* not worth caching */
+	if (flags != FWUPD_CODEC_FLAG_NONE && flags != FWUPD_CODEC_FLAG_TRUSTED)
+		return g_variant_ref_sink(fwupd_codec_to_variant(FWUPD_CODEC(device), flags));
+
+	/* already built */
+	g_mutex_lock(&self->mutex);
+	entry = fu_device_variant_cache_ensure_entry_unlocked(self, device);
+	variant = fu_device_variant_cache_entry_get_slot(entry, flags);
+	if (*variant != NULL) {
+		val = g_variant_ref(*variant);
+		g_mutex_unlock(&self->mutex);
+		return g_steal_pointer(&val);
+	}
+	generation = entry->generation;
+	g_mutex_unlock(&self->mutex);
+
+	/* only store it if the device did not change or get removed while being serialized */
+	val = g_variant_ref_sink(fwupd_codec_to_variant(FWUPD_CODEC(device), flags));
+	g_mutex_lock(&self->mutex);
+	entry = g_hash_table_lookup(self->entries, device);
+	if (entry != NULL && entry->generation == generation) {
+		variant = fu_device_variant_cache_entry_get_slot(entry, flags);
+		if (*variant == NULL)
+			*variant = g_variant_ref(val);
+	}
+	g_mutex_unlock(&self->mutex);
+	return g_steal_pointer(&val);
+}
+
+/**
+ * fu_device_variant_cache_array_to_variant:
+ * @self: a #FuDeviceVariantCache
+ * @devices: (element-type FuDevice): devices
+ * @flags: a #FwupdCodecFlags, e.g. %FWUPD_CODEC_FLAG_TRUSTED
+ *
+ * Serializes devices in the same format as fwupd_codec_array_to_variant().
+ *
+ * Returns: (transfer floating): a #GVariant of type `(aa{sv})`
+ **/
+GVariant *
+fu_device_variant_cache_array_to_variant(FuDeviceVariantCache *self,
+					 GPtrArray *devices,
+					 FwupdCodecFlags flags)
+{
+	GVariantBuilder builder;
+
+	g_return_val_if_fail(FU_IS_DEVICE_VARIANT_CACHE(self), NULL);
+	g_return_val_if_fail(devices != NULL, NULL);
+
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("aa{sv}"));
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index(devices, i);
+		g_autoptr(GVariant) val = fu_device_variant_cache_get(self, device, flags);
+		g_variant_builder_add_value(&builder, val);
+	}
+	return g_variant_new("(aa{sv})", &builder);
+}
+
+/**
+ * fu_device_variant_cache_array_to_variant_since:
+ * @self: a #FuDeviceVariantCache
+ * @devices: (element-type FuDevice): devices
+ * @generation: the generation returned from a previous call, or 0 for all devices
+ * @flags: a #FwupdCodecFlags, e.g. %FWUPD_CODEC_FLAG_TRUSTED
+ * @error: (nullable): optional return location for an error
+ *
+ * Serializes only the devices that have changed after @generation, along with the IDs of the
+ * devices that have been removed and the current generation.
+ *
+ * Returns: (transfer floating): a #GVariant of type `(aa{sv}ast)`, or %NULL if @generation is
+ * no longer known
+ **/
+GVariant *
+fu_device_variant_cache_array_to_variant_since(FuDeviceVariantCache *self,
+					       GPtrArray *devices,
+					       guint64 generation,
+					       FwupdCodecFlags flags,
+					       GError **error)
+{
+	GVariantBuilder builder;
+	GVariantBuilder builder_removed;
+	guint64 generation_now;
+	g_autoptr(GPtrArray) devices_changed = g_ptr_array_new();
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_val_if_fail(FU_IS_DEVICE_VARIANT_CACHE(self), NULL);
+	g_return_val_if_fail(devices != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* from a previous daemon instance, or too many removals ago */
+	locker = g_mutex_locker_new(&self->mutex);
+	if (generation > self->generation || generation < self->generation_removed_min) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "generation %" G_GUINT64_FORMAT " is not known, use GetDevices",
+			    generation);
+		return NULL;
+	}
+
+	/* new devices are added first so that any removal of the same device ID is forgotten */
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index(devices, i);
+		FuDeviceVariantCacheEntry *entry =
+		    fu_device_variant_cache_ensure_entry_unlocked(self, device);
+		if (entry->generation > generation)
+			g_ptr_array_add(devices_changed, device);
+	}
+	g_variant_builder_init(&builder_removed, G_VARIANT_TYPE("as"));
+	for (guint i = 0; i < self->removed->len; i++) {
+		FuDeviceVariantCacheRemoved *removed = g_ptr_array_index(self->removed, i);
+		if (removed->generation <= generation)
+			continue;
+		g_variant_builder_add(&builder_removed, "s", removed->device_id);
+	}
+
+	/* anything that changes while serializing is returned again next time */
+	generation_now = self->generation;
+	g_clear_pointer(&locker, g_mutex_locker_free);
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("aa{sv}"));
+	for (guint i = 0; i < devices_changed->len; i++) {
+		FuDevice *device = g_ptr_array_index(devices_changed, i);
+		g_autoptr(GVariant) val = fu_device_variant_cache_get(self, device, flags);
+		g_variant_builder_add_value(&builder, val);
+	}
+	return g_variant_new("(aa{sv}ast)", &builder, &builder_removed, generation_now);
+}
+
+static void
+fu_device_variant_cache_init(FuDeviceVariantCache *self)
+{
+	g_mutex_init(&self->mutex);
+	self->entries = g_hash_table_new_full(g_direct_hash,
+					      g_direct_equal,
+					      NULL,
+					      (GDestroyNotify)fu_device_variant_cache_entry_free);
+	self->removed =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_device_variant_cache_removed_free);
+}
+
+static void
+fu_device_variant_cache_finalize(GObject *obj)
+{
+	FuDeviceVariantCache *self = FU_DEVICE_VARIANT_CACHE(obj);
+	g_hash_table_unref(self->entries);
+	g_ptr_array_unref(self->removed);
+	g_mutex_clear(&self->mutex);
+	G_OBJECT_CLASS(fu_device_variant_cache_parent_class)->finalize(obj);
+}
+
+static void
+fu_device_variant_cache_class_init(FuDeviceVariantCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_device_variant_cache_finalize;
+}
+
+/**
+ * fu_device_variant_cache_new:
+ *
+ * Creates a new cache of serialized devices.
+ *
+ * Returns: a #FuDeviceVariantCache
+ **/
+FuDeviceVariantCache *
+fu_device_variant_cache_new(void)
+{
+	return g_object_new(FU_TYPE_DEVICE_VARIANT_CACHE, NULL);
+}
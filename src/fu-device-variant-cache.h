@@ -0,0 +1,42 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupdplugin.h>
+
+#define FU_TYPE_DEVICE_VARIANT_CACHE (fu_device_variant_cache_get_type())
+G_DECLARE_FINAL_TYPE(FuDeviceVariantCache,
+		     fu_device_variant_cache,
+		     FU,
+		     DEVICE_VARIANT_CACHE,
+		     GObject)
+
+FuDeviceVariantCache *
+fu_device_variant_cache_new(void);
+guint64
+fu_device_variant_cache_get_generation(FuDeviceVariantCache *self) G_GNUC_NON_NULL(1);
+void
+fu_device_variant_cache_invalidate(FuDeviceVariantCache *self, FuDevice *device)
+    G_GNUC_NON_NULL(1, 2);
+void
+fu_device_variant_cache_invalidate_all(FuDeviceVariantCache *self) G_GNUC_NON_NULL(1);
+void
+fu_device_variant_cache_remove(FuDeviceVariantCache *self, FuDevice *device)
+    G_GNUC_NON_NULL(1, 2);
+GVariant *
+fu_device_variant_cache_get(FuDeviceVariantCache *self, FuDevice *device, FwupdCodecFlags flags)
+    G_GNUC_NON_NULL(1, 2);
+GVariant *
+fu_device_variant_cache_array_to_variant(FuDeviceVariantCache *self,
+					 GPtrArray *devices,
+					 FwupdCodecFlags flags) G_GNUC_NON_NULL(1, 2);
+GVariant *
+fu_device_variant_cache_array_to_variant_since(FuDeviceVariantCache *self,
+					       GPtrArray *devices,
+					       guint64 generation,
+					       FwupdCodecFlags flags,
+					       GError **error) G_GNUC_NON_NULL(1, 2);
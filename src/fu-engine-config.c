@@ -279,6 +279,18 @@ fu_engine_config_get_archive_size_max(FuEngineConfig *self)
 	return fu_config_get_value_u64(FU_CONFIG(self), "fwupd", "ArchiveSizeMax");
 }
 
+guint64
+fu_engine_config_get_cabinet_cache_size_max(FuEngineConfig *self)
+{
+	return fu_config_get_value_u64(FU_CONFIG(self), "fwupd", "CabinetCacheSizeMax");
+}
+
+guint64
+fu_engine_config_get_firmware_cache_size_max(FuEngineConfig *self)
+{
+	return fu_config_get_value_u64(FU_CONFIG(self), "fwupd", "FirmwareCacheSizeMax");
+}
+
 GPtrArray *
 fu_engine_config_get_disabled_plugins(FuEngineConfig *self)
 {
@@ -359,6 +371,12 @@ fu_engine_config_get_enumerate_all_devices(FuEngineConfig *self)
 	return fu_config_get_value_bool(FU_CONFIG(self), "fwupd", "EnumerateAllDevices");
 }
 
+gboolean
+fu_engine_config_get_parallel_coldplug(FuEngineConfig *self)
+{
+	return fu_config_get_value_bool(FU_CONFIG(self), "fwupd", "ParallelColdplug");
+}
+
 const gchar *
 fu_engine_config_get_host_bkc(FuEngineConfig *self)
 {
@@ -406,10 +424,12 @@ fu_engine_config_init(FuEngineConfig *self)
 	fu_engine_config_set_default(self, "ApprovedFirmware", NULL);
 	fu_engine_config_set_default(self, "ArchiveSizeMax", archive_size_max_default);
 	fu_engine_config_set_default(self, "BlockedFirmware", NULL);
+	fu_engine_config_set_default(self, "CabinetCacheSizeMax", "0");
 	fu_engine_config_set_default(self, "DisabledDevices", NULL);
 	fu_engine_config_set_default(self, "DisabledPlugins", "");
 	fu_engine_config_set_default(self, "EnumerateAllDevices", "false");
 	fu_engine_config_set_default(self, "EspLocation", NULL);
+	fu_engine_config_set_default(self, "FirmwareCacheSizeMax", "0");
 	fu_engine_config_set_default(self, "HostBkc", NULL);
 	fu_engine_config_set_default(self, "IdleTimeout", "300");		  /* s */
 	fu_engine_config_set_default(self, "IdleInhibitStartupThreshold", "500"); /* ms */
@@ -417,6 +437,7 @@ fu_engine_config_init(FuEngineConfig *self)
 	fu_engine_config_set_default(self, "IgnoreRequirements", "false");
 	fu_engine_config_set_default(self, "OnlyTrusted", "true");
 	fu_engine_config_set_default(self, "P2pPolicy", FU_DEFAULT_P2P_POLICY);
+	fu_engine_config_set_default(self, "ParallelColdplug", "false");
 	fu_engine_config_set_default(self, "ReleaseDedupe", "true");
 	fu_engine_config_set_default(self, "ReleasePriority", "local");
 	fu_engine_config_set_default(self, "ShowDevicePrivate", "true");
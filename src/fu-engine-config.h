@@ -17,6 +17,10 @@ FuEngineConfig *
 fu_engine_config_new(void);
 guint64
 fu_engine_config_get_archive_size_max(FuEngineConfig *self) G_GNUC_NON_NULL(1);
+guint64
+fu_engine_config_get_cabinet_cache_size_max(FuEngineConfig *self) G_GNUC_NON_NULL(1);
+guint64
+fu_engine_config_get_firmware_cache_size_max(FuEngineConfig *self) G_GNUC_NON_NULL(1);
 guint
 fu_engine_config_get_idle_timeout(FuEngineConfig *self) G_GNUC_NON_NULL(1);
 GPtrArray *
@@ -39,6 +43,8 @@ fu_engine_config_get_update_motd(FuEngineConfig *self) G_GNUC_NON_NULL(1);
 gboolean
 fu_engine_config_get_enumerate_all_devices(FuEngineConfig *self) G_GNUC_NON_NULL(1);
 gboolean
+fu_engine_config_get_parallel_coldplug(FuEngineConfig *self) G_GNUC_NON_NULL(1);
+gboolean
 fu_engine_config_get_ignore_power(FuEngineConfig *self) G_GNUC_NON_NULL(1);
 gboolean
 fu_engine_config_get_only_trusted(FuEngineConfig *self) G_GNUC_NON_NULL(1);
@@ -9,16 +9,32 @@
 #include "config.h"
 
 #include "fu-archive.h"
+#include "fu-backend-private.h"
+#include "fu-byte-array.h"
+#include "fu-bytes.h"
 #include "fu-context-private.h"
+#include "fu-device-event-private.h"
 #include "fu-device-private.h"
 #include "fu-engine-emulator.h"
+#include "fu-input-stream.h"
+#include "fu-lzma-common.h"
 
 struct _FuEngineEmulator {
 	GObject parent_instance;
 	FuEngine *engine;
-	GHashTable *phase_blobs; /* (element-type utf-8 GBytes) */
+	GHashTable *phase_blobs;   /* (element-type utf-8 GBytes) */
+	GHashTable *phase_records; /* (element-type utf-8 GBytes), in the binary format */
 };
 
+/* the events split out of each device JSON object in the binary format */
+typedef struct {
+	GBytes *json;	    /* (nullable) */
+	GHashTable *events; /* backend-id : member name, e.g. `UsbEvents` : GPtrArray */
+} FuEngineEmulatorRecords;
+
+/* the maximum size of a decompressed binary emulation */
+#define FU_ENGINE_EMULATOR_BINARY_SIZE_MAX (128 * 1024 * 1024u)
+
 G_DEFINE_TYPE(FuEngineEmulator, fu_engine_emulator, G_TYPE_OBJECT)
 
 enum { PROP_0, PROP_ENGINE, PROP_LAST };
@@ -31,27 +47,591 @@ fu_engine_emulator_phase_to_filename(FuEngineEmulatorPhase phase, guint write_cn
 	return g_strdup_printf("%s-%u.json", fu_engine_emulator_phase_to_string(phase), write_cnt);
 }
 
-gboolean
-fu_engine_emulator_save(FuEngineEmulator *self, GOutputStream *stream, GError **error)
+static void
+fu_engine_emulator_records_free(FuEngineEmulatorRecords *records)
+{
+	if (records->json != NULL)
+		g_bytes_unref(records->json);
+	g_hash_table_unref(records->events);
+	g_free(records);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuEngineEmulatorRecords, fu_engine_emulator_records_free)
+
+static FuEngineEmulatorRecords *
+fu_engine_emulator_records_new(void)
+{
+	FuEngineEmulatorRecords *records = g_new0(FuEngineEmulatorRecords, 1);
+	records->events = g_hash_table_new_full(g_str_hash,
+						g_str_equal,
+						g_free,
+						(GDestroyNotify)g_hash_table_unref);
+	return records;
+}
+
+static void
+fu_engine_emulator_append_record(GByteArray *buf,
+				 FuEngineEmulatorRecordKind kind,
+				 const guint8 *data,
+				 gsize datasz)
+{
+	g_autoptr(FuStructEngineEmulatorRecord) st = fu_struct_engine_emulator_record_new();
+	fu_struct_engine_emulator_record_set_kind(st, kind);
+	fu_struct_engine_emulator_record_set_size(st, datasz);
+	g_byte_array_append(buf, st->data, st->len);
+	if (datasz > 0)
+		g_byte_array_append(buf, data, datasz);
+}
+
+static gboolean
+fu_engine_emulator_append_record_device(GByteArray *buf,
+					const gchar *member_name,
+					const gchar *backend_id,
+					GError **error)
+{
+	gsize member_namesz = strlen(member_name);
+	gsize backend_idsz = strlen(backend_id);
+	g_autoptr(GByteArray) st = g_byte_array_new();
+
+	if (member_namesz == 0 || member_namesz > G_MAXUINT16 || backend_idsz == 0 ||
+	    backend_idsz > G_MAXUINT16) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "invalid device record for %s",
+			    backend_id);
+		return FALSE;
+	}
+	fu_byte_array_append_uint16(st, member_namesz, G_LITTLE_ENDIAN);
+	g_byte_array_append(st, (const guint8 *)member_name, member_namesz);
+	fu_byte_array_append_uint16(st, backend_idsz, G_LITTLE_ENDIAN);
+	g_byte_array_append(st, (const guint8 *)backend_id, backend_idsz);
+	fu_engine_emulator_append_record(buf, FU_ENGINE_EMULATOR_RECORD_KIND_DEVICE, st->data, st->len);
+	return TRUE;
+}
+
+/* move the device events out of the JSON so the binary data does not have to be base64 encoded */
+static gboolean
+fu_engine_emulator_append_records_for_json(GByteArray *buf, GBytes *json_blob, GError **error)
+{
+	JsonNode *root;
+	const gchar *member_names[] = {"Events", "UsbEvents"};
+	g_autofree gchar *json = NULL;
+	g_autoptr(JsonGenerator) json_generator = json_generator_new();
+	g_autoptr(JsonParser) parser = json_parser_new();
+
+	if (!json_parser_load_from_data(parser,
+					g_bytes_get_data(json_blob, NULL),
+					g_bytes_get_size(json_blob),
+					error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	root = json_parser_get_root(parser);
+	if (JSON_NODE_HOLDS_OBJECT(root) &&
+	    json_object_has_member(json_node_get_object(root), "UsbDevices")) {
+		JsonArray *json_array =
+		    json_object_get_array_member(json_node_get_object(root), "UsbDevices");
+		for (guint i = 0; i < json_array_get_length(json_array); i++) {
+			JsonNode *node_tmp = json_array_get_element(json_array, i);
+			JsonObject *object_tmp;
+			const gchar *backend_id;
+
+			if (!JSON_NODE_HOLDS_OBJECT(node_tmp))
+				continue;
+			object_tmp = json_node_get_object(node_tmp);
+			backend_id =
+			    json_object_get_string_member_with_default(object_tmp, "BackendId", NULL);
+			if (backend_id == NULL)
+				continue;
+			for (guint j = 0; j < G_N_ELEMENTS(member_names); j++) {
+				JsonArray *events;
+
+				if (!json_object_has_member(object_tmp, member_names[j]))
+					continue;
+				if (!fu_engine_emulator_append_record_device(buf,
+									     member_names[j],
+									     backend_id,
+									     error))
+					return FALSE;
+				events = json_object_get_array_member(object_tmp, member_names[j]);
+				for (guint k = 0; k < json_array_get_length(events); k++) {
+					JsonNode *node_event = json_array_get_element(events, k);
+					g_autoptr(FuDeviceEvent) event = fu_device_event_new(NULL);
+					g_autoptr(GByteArray) st = g_byte_array_new();
+					if (!fwupd_codec_from_json(FWUPD_CODEC(event), node_event, error))
+						return FALSE;
+					if (!fu_device_event_append_binary(event, st, error))
+						return FALSE;
+					fu_engine_emulator_append_record(
+					    buf,
+					    FU_ENGINE_EMULATOR_RECORD_KIND_EVENT,
+					    st->data,
+					    st->len);
+				}
+
+				/* keep a placeholder so the member order is preserved */
+				json_object_set_array_member(object_tmp,
+							     member_names[j],
+							     json_array_new());
+			}
+		}
+	}
+
+	/* whatever is left */
+	json_generator_set_root(json_generator, root);
+	json = json_generator_to_data(json_generator, NULL);
+	fu_engine_emulator_append_record(buf,
+					 FU_ENGINE_EMULATOR_RECORD_KIND_JSON,
+					 (const guint8 *)json,
+					 strlen(json));
+	return TRUE;
+}
+
+static gboolean
+fu_engine_emulator_parse_record_device(GBytes *blob,
+				       gchar **member_name,
+				       gchar **backend_id,
+				       GError **error)
+{
+	gsize bufsz = 0;
+	guint16 member_namesz = 0;
+	guint16 backend_idsz = 0;
+	const guint8 *buf = g_bytes_get_data(blob, &bufsz);
+
+	if (!fu_memread_uint16_safe(buf, bufsz, 0x0, &member_namesz, G_LITTLE_ENDIAN, error))
+		return FALSE;
+	if (!fu_memread_uint16_safe(buf,
+				    bufsz,
+				    sizeof(guint16) + member_namesz,
+				    &backend_idsz,
+				    G_LITTLE_ENDIAN,
+				    error))
+		return FALSE;
+	if (member_namesz == 0 || backend_idsz == 0 ||
+	    (2 * sizeof(guint16)) + member_namesz + backend_idsz != bufsz) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "invalid device record");
+		return FALSE;
+	}
+	*member_name = g_strndup((const gchar *)buf + sizeof(guint16), member_namesz);
+	*backend_id = g_strndup((const gchar *)buf + (2 * sizeof(guint16)) + member_namesz,
+				backend_idsz);
+	if (strlen(*member_name) != member_namesz || strlen(*backend_id) != backend_idsz) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "invalid device record string");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* the events reference @blob, so if mapped the binary data is only paged in when required */
+static FuEngineEmulatorRecords *
+fu_engine_emulator_parse_records(GBytes *blob, GError **error)
+{
+	GPtrArray *events = NULL;
+	gsize offset = 0;
+	g_autoptr(FuEngineEmulatorRecords) records = fu_engine_emulator_records_new();
+
+	while (offset < g_bytes_get_size(blob)) {
+		FuEngineEmulatorRecordKind kind;
+		g_autoptr(FuStructEngineEmulatorRecord) st = NULL;
+		g_autoptr(GBytes) data = NULL;
+
+		st = fu_struct_engine_emulator_record_parse_bytes(blob, offset, error);
+		if (st == NULL)
+			return NULL;
+		offset += st->len;
+		data = fu_bytes_new_offset(blob,
+					   offset,
+					   fu_struct_engine_emulator_record_get_size(st),
+					   error);
+		if (data == NULL)
+			return NULL;
+		offset += g_bytes_get_size(data);
+
+		kind = fu_struct_engine_emulator_record_get_kind(st);
+		if (kind == FU_ENGINE_EMULATOR_RECORD_KIND_JSON) {
+			if (records->json != NULL) {
+				g_set_error_literal(error,
+						    FWUPD_ERROR,
+						    FWUPD_ERROR_INVALID_DATA,
+						    "duplicate JSON record");
+				return NULL;
+			}
+			records->json = g_bytes_ref(data);
+		} else if (kind == FU_ENGINE_EMULATOR_RECORD_KIND_DEVICE) {
+			GHashTable *members;
+			g_autofree gchar *member_name = NULL;
+			g_autofree gchar *backend_id = NULL;
+			if (!fu_engine_emulator_parse_record_device(data,
+								    &member_name,
+								    &backend_id,
+								    error))
+				return NULL;
+			members = g_hash_table_lookup(records->events, backend_id);
+			if (members == NULL) {
+				members = g_hash_table_new_full(g_str_hash,
+								g_str_equal,
+								g_free,
+								(GDestroyNotify)g_ptr_array_unref);
+				g_hash_table_insert(records->events,
+						    g_steal_pointer(&backend_id),
+						    members);
+			}
+			events = g_hash_table_lookup(members, member_name);
+			if (events == NULL) {
+				events = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+				g_hash_table_insert(members, g_steal_pointer(&member_name), events);
+			}
+		} else if (kind == FU_ENGINE_EMULATOR_RECORD_KIND_EVENT) {
+			g_autoptr(FuDeviceEvent) event = fu_device_event_new(NULL);
+			if (events == NULL) {
+				g_set_error_literal(error,
+						    FWUPD_ERROR,
+						    FWUPD_ERROR_INVALID_DATA,
+						    "event record without device record");
+				return NULL;
+			}
+			if (!fu_device_event_parse_binary(event, data, error))
+				return NULL;
+			g_ptr_array_add(events, g_steal_pointer(&event));
+		} else {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "unknown record kind 0x%x",
+				    kind);
+			return NULL;
+		}
+	}
+	if (records->json == NULL) {
+		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA, "no JSON record");
+		return NULL;
+	}
+	return g_steal_pointer(&records);
+}
+
+/* put the device events back into the JSON */
+static GBytes *
+fu_engine_emulator_records_to_json(GBytes *blob, GError **error)
+{
+	JsonNode *root;
+	gsize jsonsz = 0;
+	g_autofree gchar *json = NULL;
+	g_autoptr(FuEngineEmulatorRecords) records = NULL;
+	g_autoptr(JsonGenerator) json_generator = json_generator_new();
+	g_autoptr(JsonParser) parser = json_parser_new();
+
+	records = fu_engine_emulator_parse_records(blob, error);
+	if (records == NULL)
+		return NULL;
+	if (!json_parser_load_from_data(parser,
+					g_bytes_get_data(records->json, NULL),
+					g_bytes_get_size(records->json),
+					error)) {
+		fwupd_error_convert(error);
+		return NULL;
+	}
+	root = json_parser_get_root(parser);
+	if (JSON_NODE_HOLDS_OBJECT(root) &&
+	    json_object_has_member(json_node_get_object(root), "UsbDevices")) {
+		JsonArray *json_array =
+		    json_object_get_array_member(json_node_get_object(root), "UsbDevices");
+		for (guint i = 0; i < json_array_get_length(json_array); i++) {
+			JsonNode *node_tmp = json_array_get_element(json_array, i);
+			JsonObject *object_tmp;
+			GHashTable *members;
+			GHashTableIter iter;
+			gpointer key;
+			gpointer value;
+			const gchar *backend_id;
+
+			if (!JSON_NODE_HOLDS_OBJECT(node_tmp))
+				continue;
+			object_tmp = json_node_get_object(node_tmp);
+			backend_id =
+			    json_object_get_string_member_with_default(object_tmp, "BackendId", NULL);
+			if (backend_id == NULL)
+				continue;
+			members = g_hash_table_lookup(records->events, backend_id);
+			if (members == NULL)
+				continue;
+
+			/* this replaces the placeholder, so the member order is preserved */
+			g_hash_table_iter_init(&iter, members);
+			while (g_hash_table_iter_next(&iter, &key, &value)) {
+				GPtrArray *events = (GPtrArray *)value;
+				JsonArray *json_events = json_array_new();
+				for (guint j = 0; j < events->len; j++) {
+					FuDeviceEvent *event = g_ptr_array_index(events, j);
+					g_autoptr(JsonBuilder) json_builder = json_builder_new();
+					json_builder_begin_object(json_builder);
+					fwupd_codec_to_json(FWUPD_CODEC(event),
+							    json_builder,
+							    FWUPD_CODEC_FLAG_NONE);
+					json_builder_end_object(json_builder);
+					json_array_add_element(json_events,
+							       json_builder_get_root(json_builder));
+				}
+				json_object_set_array_member(object_tmp,
+							     (const gchar *)key,
+							     json_events);
+			}
+		}
+	}
+
+	/* export */
+	json_generator_set_pretty(json_generator, TRUE);
+	json_generator_set_root(json_generator, root);
+	json = json_generator_to_data(json_generator, &jsonsz);
+	return g_bytes_new_take(g_steal_pointer(&json), jsonsz);
+}
+
+/* each phase filename followed by the records for that phase */
+static GBytes *
+fu_engine_emulator_write_binary(GHashTable *phase_blobs,
+				FuEngineEmulatorCompression compression,
+				GError **error)
+{
+	g_autoptr(FuStructEngineEmulatorHdr) st = fu_struct_engine_emulator_hdr_new();
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GBytes) payload = NULL;
+	g_autoptr(GList) fns = NULL;
+
+	/* sort so the output is reproducible */
+	fns = g_hash_table_get_keys(phase_blobs);
+	fns = g_list_sort(fns, (GCompareFunc)g_strcmp0);
+	for (GList *l = fns; l != NULL; l = l->next) {
+		const gchar *fn = (const gchar *)l->data;
+		fu_engine_emulator_append_record(buf,
+						 FU_ENGINE_EMULATOR_RECORD_KIND_PHASE,
+						 (const guint8 *)fn,
+						 strlen(fn));
+		if (!fu_engine_emulator_append_records_for_json(buf,
+								g_hash_table_lookup(phase_blobs, fn),
+								error)) {
+			g_prefix_error(error, "failed to convert %s: ", fn);
+			return NULL;
+		}
+	}
+	if (buf->len > FU_ENGINE_EMULATOR_BINARY_SIZE_MAX) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "emulation data too large");
+		return NULL;
+	}
+	fu_struct_engine_emulator_hdr_set_payloadsz(st, buf->len);
+	fu_struct_engine_emulator_hdr_set_compression(st, compression);
+	payload = g_byte_array_free_to_bytes(g_steal_pointer(&buf));
+	if (compression == FU_ENGINE_EMULATOR_COMPRESSION_LZMA) {
+		g_autoptr(GBytes) payload_tmp = fu_lzma_compress_bytes(payload, error);
+		if (payload_tmp == NULL)
+			return NULL;
+		g_bytes_unref(payload);
+		payload = g_steal_pointer(&payload_tmp);
+	}
+	fu_byte_array_append_bytes(st, payload);
+	return g_byte_array_free_to_bytes(g_steal_pointer(&st));
+}
+
+static gboolean
+fu_engine_emulator_add_phase_records(GHashTable *phase_records,
+				     GBytes *payload,
+				     GBytes *fn_blob,
+				     gsize offset,
+				     gsize length,
+				     GError **error)
+{
+	g_autoptr(GBytes) blob = NULL;
+	g_autofree gchar *fn = NULL;
+
+	fn = g_strndup(g_bytes_get_data(fn_blob, NULL), g_bytes_get_size(fn_blob));
+	if (!g_str_has_suffix(fn, ".json") || strchr(fn, '/') != NULL) {
+		g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA, "invalid phase %s", fn);
+		return FALSE;
+	}
+	blob = fu_bytes_new_offset(payload, offset, length, error);
+	if (blob == NULL)
+		return FALSE;
+	g_hash_table_insert(phase_records, g_steal_pointer(&fn), g_steal_pointer(&blob));
+	return TRUE;
+}
+
+/* phase filename : the phase records, which are sliced from @blob where possible */
+static GHashTable *
+fu_engine_emulator_parse_binary(GBytes *blob, GError **error)
+{
+	gsize offset = 0;
+	gsize offset_phase = 0;
+	g_autoptr(FuStructEngineEmulatorHdr) st = NULL;
+	g_autoptr(GBytes) fn_blob = NULL;
+	g_autoptr(GBytes) payload = NULL;
+	g_autoptr(GHashTable) phase_records =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_bytes_unref);
+
+	st = fu_struct_engine_emulator_hdr_parse_bytes(blob, 0x0, error);
+	if (st == NULL)
+		return NULL;
+	if (fu_struct_engine_emulator_hdr_get_payloadsz(st) > FU_ENGINE_EMULATOR_BINARY_SIZE_MAX) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "payload size 0x%x is too large",
+			    (guint)fu_struct_engine_emulator_hdr_get_payloadsz(st));
+		return NULL;
+	}
+	if (fu_struct_engine_emulator_hdr_get_compression(st) ==
+	    FU_ENGINE_EMULATOR_COMPRESSION_LZMA) {
+		g_autoptr(GBytes) payload_tmp =
+		    fu_bytes_new_offset(blob, st->len, g_bytes_get_size(blob) - st->len, error);
+		if (payload_tmp == NULL)
+			return NULL;
+		payload = fu_lzma_decompress_bytes(payload_tmp,
+						   FU_ENGINE_EMULATOR_BINARY_SIZE_MAX,
+						   error);
+		if (payload == NULL)
+			return NULL;
+		if (g_bytes_get_size(payload) != fu_struct_engine_emulator_hdr_get_payloadsz(st)) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "decompressed size 0x%x, expected 0x%x",
+				    (guint)g_bytes_get_size(payload),
+				    (guint)fu_struct_engine_emulator_hdr_get_payloadsz(st));
+			return NULL;
+		}
+	} else if (fu_struct_engine_emulator_hdr_get_compression(st) ==
+		   FU_ENGINE_EMULATOR_COMPRESSION_NONE) {
+		if (st->len + fu_struct_engine_emulator_hdr_get_payloadsz(st) !=
+		    g_bytes_get_size(blob)) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "payload size 0x%x does not match file size 0x%x",
+				    (guint)fu_struct_engine_emulator_hdr_get_payloadsz(st),
+				    (guint)g_bytes_get_size(blob));
+			return NULL;
+		}
+		payload = fu_bytes_new_offset(blob,
+					      st->len,
+					      fu_struct_engine_emulator_hdr_get_payloadsz(st),
+					      error);
+		if (payload == NULL)
+			return NULL;
+	} else {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "compression 0x%x is not supported",
+			    fu_struct_engine_emulator_hdr_get_compression(st));
+		return NULL;
+	}
+
+	/* only the phase records need parsing here */
+	while (offset < g_bytes_get_size(payload)) {
+		g_autoptr(FuStructEngineEmulatorRecord) st_rec = NULL;
+		g_autoptr(GBytes) data = NULL;
+
+		st_rec = fu_struct_engine_emulator_record_parse_bytes(payload, offset, error);
+		if (st_rec == NULL)
+			return NULL;
+		data = fu_bytes_new_offset(payload,
+					   offset + st_rec->len,
+					   fu_struct_engine_emulator_record_get_size(st_rec),
+					   error);
+		if (data == NULL)
+			return NULL;
+		if (fu_struct_engine_emulator_record_get_kind(st_rec) ==
+		    FU_ENGINE_EMULATOR_RECORD_KIND_PHASE) {
+			if (fn_blob != NULL) {
+				if (!fu_engine_emulator_add_phase_records(phase_records,
+									  payload,
+									  fn_blob,
+									  offset_phase,
+									  offset - offset_phase,
+									  error))
+					return NULL;
+				g_bytes_unref(fn_blob);
+			}
+			fn_blob = g_bytes_ref(data);
+			offset_phase = offset + st_rec->len + g_bytes_get_size(data);
+		} else if (fn_blob == NULL) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_DATA,
+					    "record without phase record");
+			return NULL;
+		}
+		offset += st_rec->len + g_bytes_get_size(data);
+	}
+	if (fn_blob != NULL) {
+		if (!fu_engine_emulator_add_phase_records(phase_records,
+							  payload,
+							  fn_blob,
+							  offset_phase,
+							  offset - offset_phase,
+							  error))
+			return NULL;
+	}
+	return g_steal_pointer(&phase_records);
+}
+
+static GBytes *
+fu_engine_emulator_write_archive(GHashTable *phase_blobs, GError **error)
 {
 	GHashTableIter iter;
-	gboolean got_json = FALSE;
 	gpointer key;
 	gpointer value;
 	g_autoptr(GByteArray) buf = NULL;
 	g_autoptr(FuArchive) archive = fu_archive_new(NULL, FU_ARCHIVE_FLAG_NONE, NULL);
 
+	g_hash_table_iter_init(&iter, phase_blobs);
+	while (g_hash_table_iter_next(&iter, &key, &value))
+		fu_archive_add_entry(archive, (const gchar *)key, (GBytes *)value);
+	buf = fu_archive_write(archive, FU_ARCHIVE_FORMAT_ZIP, FU_ARCHIVE_COMPRESSION_GZIP, error);
+	if (buf == NULL)
+		return NULL;
+	return g_byte_array_free_to_bytes(g_steal_pointer(&buf));
+}
+
+gboolean
+fu_engine_emulator_save(FuEngineEmulator *self, GOutputStream *stream, GError **error)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GHashTable) phase_blobs = NULL;
+
 	g_return_val_if_fail(FU_IS_ENGINE_EMULATOR(self), FALSE);
 	g_return_val_if_fail(G_IS_OUTPUT_STREAM(stream), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	/* sanity check */
+	phase_blobs = g_hash_table_new_full(g_str_hash,
+					    g_str_equal,
+					    g_free,
+					    (GDestroyNotify)g_bytes_unref);
+	g_hash_table_iter_init(&iter, self->phase_records);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		GBytes *json_blob = fu_engine_emulator_records_to_json((GBytes *)value, error);
+		if (json_blob == NULL)
+			return FALSE;
+		g_hash_table_insert(phase_blobs, g_strdup((const gchar *)key), json_blob);
+	}
 	g_hash_table_iter_init(&iter, self->phase_blobs);
 	while (g_hash_table_iter_next(&iter, &key, &value)) {
-		fu_archive_add_entry(archive, (const gchar *)key, (GBytes *)value);
-		got_json = TRUE;
+		g_hash_table_insert(phase_blobs,
+				    g_strdup((const gchar *)key),
+				    g_bytes_ref((GBytes *)value));
 	}
-	if (!got_json) {
+	if (g_hash_table_size(phase_blobs) == 0) {
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_NOT_SUPPORTED,
@@ -60,10 +640,15 @@ fu_engine_emulator_save(FuEngineEmulator *self, GOutputStream *stream, GError **
 	}
 
 	/* write  */
-	buf = fu_archive_write(archive, FU_ARCHIVE_FORMAT_ZIP, FU_ARCHIVE_COMPRESSION_GZIP, error);
-	if (buf == NULL)
+	blob = fu_engine_emulator_write_archive(phase_blobs, error);
+	if (blob == NULL)
 		return FALSE;
-	if (!g_output_stream_write_all(stream, buf->data, buf->len, NULL, NULL, error)) {
+	if (!g_output_stream_write_all(stream,
+				       g_bytes_get_data(blob, NULL),
+				       g_bytes_get_size(blob),
+				       NULL,
+				       NULL,
+				       error)) {
 		fu_error_convert(error);
 		return FALSE;
 	}
@@ -74,11 +659,15 @@ fu_engine_emulator_save(FuEngineEmulator *self, GOutputStream *stream, GError **
 
 	/* success */
 	g_hash_table_remove_all(self->phase_blobs);
+	g_hash_table_remove_all(self->phase_records);
 	return TRUE;
 }
 
 static gboolean
-fu_engine_emulator_load_json_blob(FuEngineEmulator *self, GBytes *json_blob, GError **error)
+fu_engine_emulator_load_json_blob_with_events(FuEngineEmulator *self,
+					      GBytes *json_blob,
+					      GHashTable *events,
+					      GError **error)
 {
 	GPtrArray *backends = fu_context_get_backends(fu_engine_get_context(self->engine));
 	JsonNode *root;
@@ -95,7 +684,11 @@ fu_engine_emulator_load_json_blob(FuEngineEmulator *self, GBytes *json_blob, GEr
 	root = json_parser_get_root(parser);
 	for (guint i = 0; i < backends->len; i++) {
 		FuBackend *backend = g_ptr_array_index(backends, i);
-		if (!fwupd_codec_from_json(FWUPD_CODEC(backend), root, error))
+		gboolean ret;
+		fu_backend_set_emulation_events(backend, events);
+		ret = fwupd_codec_from_json(FWUPD_CODEC(backend), root, error);
+		fu_backend_set_emulation_events(backend, NULL);
+		if (!ret)
 			return FALSE;
 	}
 
@@ -103,19 +696,40 @@ fu_engine_emulator_load_json_blob(FuEngineEmulator *self, GBytes *json_blob, GEr
 	return TRUE;
 }
 
+static gboolean
+fu_engine_emulator_load_json_blob(FuEngineEmulator *self, GBytes *json_blob, GError **error)
+{
+	return fu_engine_emulator_load_json_blob_with_events(self, json_blob, NULL, error);
+}
+
+static gboolean
+fu_engine_emulator_load_records(FuEngineEmulator *self, GBytes *blob, GError **error)
+{
+	g_autoptr(FuEngineEmulatorRecords) records = fu_engine_emulator_parse_records(blob, error);
+	if (records == NULL)
+		return FALSE;
+	return fu_engine_emulator_load_json_blob_with_events(self,
+							     records->json,
+							     records->events,
+							     error);
+}
+
 gboolean
 fu_engine_emulator_load_phase(FuEngineEmulator *self,
 			      FuEngineEmulatorPhase phase,
 			      guint write_cnt,
 			      GError **error)
 {
-	GBytes *json_blob;
+	GBytes *blob;
 	g_autofree gchar *fn = fu_engine_emulator_phase_to_filename(phase, write_cnt);
 
-	json_blob = g_hash_table_lookup(self->phase_blobs, fn);
-	if (json_blob == NULL)
+	blob = g_hash_table_lookup(self->phase_records, fn);
+	if (blob != NULL)
+		return fu_engine_emulator_load_records(self, blob, error);
+	blob = g_hash_table_lookup(self->phase_blobs, fn);
+	if (blob == NULL)
 		return TRUE;
-	return fu_engine_emulator_load_json_blob(self, json_blob, error);
+	return fu_engine_emulator_load_json_blob(self, blob, error);
 }
 
 static void
@@ -242,6 +856,53 @@ fu_engine_emulator_load_phases(FuEngineEmulator *self,
 	return TRUE;
 }
 
+static gboolean
+fu_engine_emulator_load_binary(FuEngineEmulator *self, GBytes *blob, GError **error)
+{
+	const gchar *json_empty = "{\"UsbDevices\":[]}";
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	g_autofree gchar *fn_setup = NULL;
+	g_autoptr(GBytes) json_blob = g_bytes_new_static(json_empty, strlen(json_empty));
+	g_autoptr(GHashTable) phase_records = NULL;
+
+	/* unload any existing devices */
+	if (!fu_engine_emulator_load_json_blob(self, json_blob, error))
+		return FALSE;
+	g_hash_table_remove_all(self->phase_blobs);
+	g_hash_table_remove_all(self->phase_records);
+
+	/* the setup phase is loaded now, and the others when required */
+	phase_records = fu_engine_emulator_parse_binary(blob, error);
+	if (phase_records == NULL)
+		return FALSE;
+	if (g_hash_table_size(phase_records) == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "no emulation data found");
+		return FALSE;
+	}
+	fn_setup = fu_engine_emulator_phase_to_filename(FU_ENGINE_EMULATOR_PHASE_SETUP,
+							FU_ENGINE_EMULATOR_WRITE_COUNT_DEFAULT);
+	g_hash_table_iter_init(&iter, phase_records);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		g_info("emulation for %s", (const gchar *)key);
+		if (g_strcmp0(key, fn_setup) == 0) {
+			if (!fu_engine_emulator_load_records(self, (GBytes *)value, error))
+				return FALSE;
+			continue;
+		}
+		g_hash_table_insert(self->phase_records,
+				    g_strdup((const gchar *)key),
+				    g_bytes_ref((GBytes *)value));
+	}
+
+	/* success */
+	return TRUE;
+}
+
 gboolean
 fu_engine_emulator_load(FuEngineEmulator *self, GInputStream *stream, GError **error)
 {
@@ -249,16 +910,29 @@ fu_engine_emulator_load(FuEngineEmulator *self, GInputStream *stream, GError **e
 	const gchar *json_empty = "{\"UsbDevices\":[]}";
 	g_autoptr(FuArchive) archive = NULL;
 	g_autoptr(GBytes) json_blob = g_bytes_new_static(json_empty, strlen(json_empty));
+	g_autoptr(GBytes) blob_hdr = NULL;
 	g_autoptr(GError) error_archive = NULL;
 
 	g_return_val_if_fail(FU_IS_ENGINE_EMULATOR(self), FALSE);
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
+	/* the binary format is loaded in one piece */
+	blob_hdr =
+	    fu_input_stream_read_bytes(stream, 0x0, FU_STRUCT_ENGINE_EMULATOR_HDR_SIZE, NULL, NULL);
+	if (blob_hdr != NULL && fu_struct_engine_emulator_hdr_validate_bytes(blob_hdr, 0x0, NULL)) {
+		g_autoptr(GBytes) blob = NULL;
+		blob = fu_input_stream_read_bytes(stream, 0x0, G_MAXSIZE, NULL, error);
+		if (blob == NULL)
+			return FALSE;
+		return fu_engine_emulator_load_binary(self, blob, error);
+	}
+
 	/* unload any existing devices */
 	if (!fu_engine_emulator_load_json_blob(self, json_blob, error))
 		return FALSE;
 	g_hash_table_remove_all(self->phase_blobs);
+	g_hash_table_remove_all(self->phase_records);
 
 	/* load archive */
 	archive = fu_archive_new_stream(stream, FU_ARCHIVE_FLAG_NONE, &error_archive);
@@ -288,6 +962,134 @@ fu_engine_emulator_load(FuEngineEmulator *self, GInputStream *stream, GError **e
 	return TRUE;
 }
 
+/**
+ * fu_engine_emulator_load_bytes:
+ * @self: a #FuEngineEmulator
+ * @blob: a #GBytes, typically a mapped file
+ * @error: (nullable): optional return location for an error
+ *
+ * Loads emulation data, which may be a JSON file, a ZIP archive of JSON files or the binary
+ * format written by fu_engine_emulator_convert().
+ *
+ * Device events in the binary format reference @blob directly rather than being copied.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_engine_emulator_load_bytes(FuEngineEmulator *self, GBytes *blob, GError **error)
+{
+	g_autoptr(GInputStream) stream = NULL;
+
+	g_return_val_if_fail(FU_IS_ENGINE_EMULATOR(self), FALSE);
+	g_return_val_if_fail(blob != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (fu_struct_engine_emulator_hdr_validate_bytes(blob, 0x0, NULL))
+		return fu_engine_emulator_load_binary(self, blob, error);
+	stream = g_memory_input_stream_new_from_bytes(blob);
+	return fu_engine_emulator_load(self, stream, error);
+}
+
+static gboolean
+fu_engine_emulator_convert_archive_cb(FuArchive *archive,
+				      const gchar *filename,
+				      GBytes *bytes,
+				      gpointer user_data,
+				      GError **error)
+{
+	GHashTable *phase_blobs = (GHashTable *)user_data;
+	if (!g_str_has_suffix(filename, ".json"))
+		return TRUE;
+	g_hash_table_insert(phase_blobs, g_strdup(filename), g_bytes_ref(bytes));
+	return TRUE;
+}
+
+/**
+ * fu_engine_emulator_convert:
+ * @blob: a #GBytes of emulation data in any supported format
+ * @format: the format to write, e.g. %FU_ENGINE_EMULATOR_FORMAT_BINARY
+ * @compression: the compression to use for %FU_ENGINE_EMULATOR_FORMAT_BINARY
+ * @error: (nullable): optional return location for an error
+ *
+ * Converts emulation data between the ZIP archive of JSON files and the binary format.
+ *
+ * Returns: (transfer full): a #GBytes, or %NULL on error
+ **/
+GBytes *
+fu_engine_emulator_convert(GBytes *blob,
+			   FuEngineEmulatorFormat format,
+			   FuEngineEmulatorCompression compression,
+			   GError **error)
+{
+	g_autoptr(GHashTable) phase_blobs = NULL;
+
+	g_return_val_if_fail(blob != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* phase filename : JSON */
+	if (fu_struct_engine_emulator_hdr_validate_bytes(blob, 0x0, NULL)) {
+		GHashTableIter iter;
+		gpointer key;
+		gpointer value;
+		g_autoptr(GHashTable) phase_records = fu_engine_emulator_parse_binary(blob, error);
+		if (phase_records == NULL)
+			return NULL;
+		phase_blobs = g_hash_table_new_full(g_str_hash,
+						    g_str_equal,
+						    g_free,
+						    (GDestroyNotify)g_bytes_unref);
+		g_hash_table_iter_init(&iter, phase_records);
+		while (g_hash_table_iter_next(&iter, &key, &value)) {
+			GBytes *json_blob =
+			    fu_engine_emulator_records_to_json((GBytes *)value, error);
+			if (json_blob == NULL)
+				return NULL;
+			g_hash_table_insert(phase_blobs, g_strdup((const gchar *)key), json_blob);
+		}
+	} else {
+		g_autoptr(FuArchive) archive = NULL;
+		g_autoptr(GError) error_archive = NULL;
+
+		phase_blobs = g_hash_table_new_full(g_str_hash,
+						    g_str_equal,
+						    g_free,
+						    (GDestroyNotify)g_bytes_unref);
+		archive = fu_archive_new(blob, FU_ARCHIVE_FLAG_NONE, &error_archive);
+		if (archive == NULL) {
+			g_autofree gchar *fn =
+			    fu_engine_emulator_phase_to_filename(FU_ENGINE_EMULATOR_PHASE_SETUP,
+								 FU_ENGINE_EMULATOR_WRITE_COUNT_DEFAULT);
+			g_debug("no archive found, using JSON as phase setup: %s",
+				error_archive->message);
+			g_hash_table_insert(phase_blobs, g_steal_pointer(&fn), g_bytes_ref(blob));
+		} else if (!fu_archive_iterate(archive,
+					       fu_engine_emulator_convert_archive_cb,
+					       phase_blobs,
+					       error)) {
+			return NULL;
+		}
+	}
+	if (g_hash_table_size(phase_blobs) == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "no emulation data found");
+		return NULL;
+	}
+
+	/* write */
+	if (format == FU_ENGINE_EMULATOR_FORMAT_JSON)
+		return fu_engine_emulator_write_archive(phase_blobs, error);
+	if (format == FU_ENGINE_EMULATOR_FORMAT_BINARY)
+		return fu_engine_emulator_write_binary(phase_blobs, compression, error);
+	g_set_error(error,
+		    FWUPD_ERROR,
+		    FWUPD_ERROR_NOT_SUPPORTED,
+		    "emulation format %s is not supported",
+		    fu_engine_emulator_format_to_string(format));
+	return NULL;
+}
+
 static void
 fu_engine_emulator_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
 {
@@ -324,6 +1126,8 @@ fu_engine_emulator_init(FuEngineEmulator *self)
 {
 	self->phase_blobs =
 	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_bytes_unref);
+	self->phase_records =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_bytes_unref);
 }
 
 static void
@@ -331,6 +1135,7 @@ fu_engine_emulator_finalize(GObject *obj)
 {
 	FuEngineEmulator *self = FU_ENGINE_EMULATOR(obj);
 	g_hash_table_unref(self->phase_blobs);
+	g_hash_table_unref(self->phase_records);
 	G_OBJECT_CLASS(fu_engine_emulator_parent_class)->finalize(obj);
 }
 
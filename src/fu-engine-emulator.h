@@ -27,6 +27,14 @@ gboolean
 fu_engine_emulator_load(FuEngineEmulator *self, GInputStream *stream, GError **error)
     G_GNUC_NON_NULL(1, 2);
 gboolean
+fu_engine_emulator_load_bytes(FuEngineEmulator *self, GBytes *blob, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+GBytes *
+fu_engine_emulator_convert(GBytes *blob,
+			   FuEngineEmulatorFormat format,
+			   FuEngineEmulatorCompression compression,
+			   GError **error) G_GNUC_NON_NULL(1);
+gboolean
 fu_engine_emulator_load_phase(FuEngineEmulator *self,
 			      FuEngineEmulatorPhase phase,
 			      guint write_cnt,
@@ -44,6 +44,7 @@
 #include "fu-backend-private.h"
 #include "fu-bios-setting.h"
 #include "fu-bios-settings-private.h"
+#include "fu-cabinet-cache.h"
 #include "fu-config-private.h"
 #include "fu-context-private.h"
 #include "fu-coswid-firmware.h"
@@ -56,8 +57,10 @@
 #include "fu-engine-request.h"
 #include "fu-engine-requirements.h"
 #include "fu-engine.h"
+#include "fu-firmware-cache.h"
 #include "fu-history.h"
 #include "fu-idle.h"
+#include "fu-partial-input-stream-private.h"
 #include "fu-plugin-builtin.h"
 #include "fu-plugin-list.h"
 #include "fu-plugin-private.h"
@@ -94,6 +97,9 @@
 
 #define FU_ENGINE_UPDATE_MOTD_DELAY 5 /* s */
 
+#define FU_ENGINE_INSTALL_PARALLEL_POLL_MS 100
+#define FU_ENGINE_INSTALL_PARALLEL_MAX	   8 /* lanes, mostly waiting on device I/O */
+
 #define FU_ENGINE_MAX_METADATA_SIZE  0x2000000 /* 32MB */
 #define FU_ENGINE_MAX_SIGNATURE_SIZE 0x100000  /* 1MB */
 
@@ -106,6 +112,17 @@ fu_engine_ensure_security_attrs(FuEngine *self);
 static void
 fu_engine_md_refresh_device(FuEngine *self, FuDevice *device);
 
+/* each remote is compiled into its own silo, so refreshing one does not rebuild all of them */
+typedef struct {
+	gchar *id;
+	gchar *basename;  /* (nullable) */
+	gchar *cache_key; /* (nullable) */
+	XbSilo *silo;
+	XbQuery *query_tag_by_guid_version;
+	GHashTable *components_by_guid;	 /* (element-type utf8 GPtrArray<XbNode>) */
+	GHashTable *release_by_checksum; /* (nullable) (element-type utf8 XbNode) */
+} FuEngineSilo;
+
 struct _FuEngine {
 	GObject parent_instance;
 	FuEngineConfig *config;
@@ -117,11 +134,9 @@ struct _FuEngine {
 	guint percentage;
 	FuHistory *history;
 	FuIdle *idle;
-	XbSilo *silo;
-	XbQuery *query_component_by_guid;
-	XbQuery *query_container_checksum1; /* container checksum -> release */
-	XbQuery *query_container_checksum2; /* artifact checksum -> release */
-	XbQuery *query_tag_by_guid_version;
+	FuFirmwareCache *firmware_cache;
+	FuCabinetCache *cabinet_cache;
+	GPtrArray *silos; /* (element-type FuEngineSilo) */
 	guint coldplug_id;
 	FuPluginList *plugin_list;
 	GPtrArray *plugin_filter;
@@ -141,6 +156,10 @@ struct _FuEngine {
 	guint update_motd_id;
 	FuEngineEmulatorPhase emulator_phase;
 	guint emulator_write_cnt;
+	GAsyncQueue *install_queue; /* (nullable) (element-type FuEngineInstallCall) */
+	GThread *install_thread;    /* (nullable) */
+	GPtrArray *install_writing; /* (element-type FuDevice) */
+	GPtrArray *install_events;  /* (element-type FuEngineBackendEvent) */
 #ifdef HAVE_PASSIM
 	PassimClient *passim_client;
 #endif
@@ -323,8 +342,15 @@ static void
 fu_engine_history_notify_cb(FuDevice *device, GParamSpec *pspec, FuEngine *self)
 {
 	if (self->write_history) {
+		gboolean ret;
+		gint64 start_us = g_get_monotonic_time();
 		g_autoptr(GError) error_local = NULL;
-		if (!fu_history_modify_device(self->history, device, &error_local)) {
+
+		ret = fu_history_modify_device(self->history, device, &error_local);
+		fu_metrics_add_duration_since(fu_context_get_metrics(self->ctx),
+					      "HistoryWrite",
+					      start_us);
+		if (!ret) {
 			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND)) {
 				g_debug("ignoring: %s", error_local->message);
 			} else {
@@ -337,11 +363,152 @@ fu_engine_history_notify_cb(FuDevice *device, GParamSpec *pspec, FuEngine *self)
 	fu_engine_emit_device_changed(self, fu_device_get_id(device));
 }
 
+/* the firmware write of a parallel install lane runs in a worker thread, but the history
+ * database, the plugin vfuncs and the engine signals are only ever used from the main thread */
+typedef gboolean (*FuEngineInstallFunc)(gpointer user_data, GError **error);
+
+typedef struct {
+	FuEngineInstallFunc func; /* (nullable) for when the lane has finished */
+	gpointer user_data;
+	gboolean ret;
+	gboolean done;
+	GError *error;
+	GMutex mutex;
+	GCond cond;
+} FuEngineInstallCall;
+
+/* runs in the main thread */
+static void
+fu_engine_install_call_run(FuEngineInstallCall *call)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&call->mutex);
+	call->ret = call->func(call->user_data, &call->error);
+	call->done = TRUE;
+	g_cond_signal(&call->cond);
+}
+
+static gboolean
+fu_engine_install_invoke(FuEngine *self,
+			 FuEngineInstallFunc func,
+			 gpointer user_data,
+			 GError **error)
+{
+	FuEngineInstallCall call = {.func = func, .user_data = user_data};
+
+	/* not installing in parallel, or already in the main thread */
+	if (self->install_queue == NULL || g_thread_self() == self->install_thread)
+		return func(user_data, error);
+
+	/* wait for the main thread to run this */
+	g_mutex_init(&call.mutex);
+	g_cond_init(&call.cond);
+	g_async_queue_push(self->install_queue, &call);
+	g_mutex_lock(&call.mutex);
+	while (!call.done)
+		g_cond_wait(&call.cond, &call.mutex);
+	g_mutex_unlock(&call.mutex);
+	g_mutex_clear(&call.mutex);
+	g_cond_clear(&call.cond);
+	if (!call.ret) {
+		g_propagate_error(error, call.error);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+typedef void (*FuEngineBackendEventFunc)(FuBackend *backend, FuDevice *device, FuEngine *self);
+
+typedef struct {
+	FuEngineBackendEventFunc func;
+	FuBackend *backend;
+	FuDevice *device;
+} FuEngineBackendEvent;
+
+static void
+fu_engine_backend_event_free(FuEngineBackendEvent *event)
+{
+	g_object_unref(event->backend);
+	g_object_unref(event->device);
+	g_free(event);
+}
+
+/* a backend ID of a child is the sysfs path of the parent with more components */
+static gboolean
+fu_engine_backend_id_is_within(const gchar *backend_id, const gchar *backend_id_parent)
+{
+	gsize backend_id_parentsz;
+
+	if (backend_id == NULL || backend_id_parent == NULL)
+		return FALSE;
+	if (!g_str_has_prefix(backend_id, backend_id_parent))
+		return FALSE;
+	backend_id_parentsz = strlen(backend_id_parent);
+	return backend_id[backend_id_parentsz] == '\0' || backend_id[backend_id_parentsz] == '/';
+}
+
+/* the hotplug and changed events for a device being written by a parallel install lane are
+ * deferred, as the main context is iterated when another lane is waiting for a replug */
+static gboolean
+fu_engine_install_defer_backend_event(FuEngine *self,
+				      FuEngineBackendEventFunc func,
+				      FuBackend *backend,
+				      FuDevice *device)
+{
+	const gchar *backend_id = fu_device_get_backend_id(device);
+	FuEngineBackendEvent *event;
+
+	for (guint i = 0; i < self->install_writing->len; i++) {
+		FuDevice *device_tmp = g_ptr_array_index(self->install_writing, i);
+		if (!fu_engine_backend_id_is_within(backend_id,
+						    fu_device_get_backend_id(device_tmp)))
+			continue;
+		g_debug("deferring backend event for %s as being written", backend_id);
+		event = g_new0(FuEngineBackendEvent, 1);
+		event->func = func;
+		event->backend = g_object_ref(backend);
+		event->device = g_object_ref(device);
+		g_ptr_array_add(self->install_events, event);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/* runs in the main thread, in the order the events were received */
+static void
+fu_engine_install_replay_backend_events(FuEngine *self)
+{
+	g_autoptr(GPtrArray) events = g_steal_pointer(&self->install_events);
+
+	self->install_events =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_engine_backend_event_free);
+	for (guint i = 0; i < events->len; i++) {
+		FuEngineBackendEvent *event = g_ptr_array_index(events, i);
+		event->func(event->backend, event->device, self);
+	}
+}
+
+typedef struct {
+	FuEngine *self;
+	FwupdRequest *request;
+} FuEngineDeviceRequestHelper;
+
+static gboolean
+fu_engine_device_request_emit_cb(gpointer user_data, GError **error)
+{
+	FuEngineDeviceRequestHelper *helper = (FuEngineDeviceRequestHelper *)user_data;
+	g_info("Emitting DeviceRequest('Message'='%s')",
+	       fwupd_request_get_message(helper->request));
+	g_signal_emit(helper->self, signals[SIGNAL_DEVICE_REQUEST], 0, helper->request);
+	return TRUE;
+}
+
 static void
 fu_engine_device_request_cb(FuDevice *device, FwupdRequest *request, FuEngine *self)
 {
-	g_info("Emitting DeviceRequest('Message'='%s')", fwupd_request_get_message(request));
-	g_signal_emit(self, signals[SIGNAL_DEVICE_REQUEST], 0, request);
+	FuEngineDeviceRequestHelper helper = {.self = self, .request = request};
+
+	/* a parallel install lane waits for this to be emitted from the main thread */
+	fu_engine_install_invoke(self, fu_engine_device_request_emit_cb, &helper, NULL);
 }
 
 static void
@@ -552,39 +719,52 @@ fu_engine_add_local_release_metadata(FuEngine *self, FuRelease *release, GError
 	if (dev == NULL)
 		return TRUE;
 
-	/* not set up */
-	if (self->query_tag_by_guid_version == NULL)
-		return TRUE;
-
 	/* use prepared query for each GUID */
 	guids = fu_device_get_guids(dev);
-	for (guint i = 0; i < guids->len; i++) {
-		const gchar *guid = g_ptr_array_index(guids, i);
-		g_autoptr(GError) error_local = NULL;
-		g_autoptr(GPtrArray) tags = NULL;
-		g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+	for (guint k = 0; k < self->silos->len; k++) {
+		FuEngineSilo *engine_silo = g_ptr_array_index(self->silos, k);
 
-		/* bind GUID and then query */
-		xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
-		xb_value_bindings_bind_str(xb_query_context_get_bindings(&context),
-					   1,
-					   fu_release_get_version(release),
-					   NULL);
-		tags = xb_silo_query_with_context(self->silo,
-						  self->query_tag_by_guid_version,
-						  &context,
-						  &error_local);
-		if (tags == NULL) {
-			if (g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
-			    g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
-				continue;
-			g_propagate_error(error, g_steal_pointer(&error_local));
-			fwupd_error_convert(error);
-			return FALSE;
-		}
-		for (guint j = 0; j < tags->len; j++) {
-			XbNode *tag = g_ptr_array_index(tags, j);
-			fu_release_add_tag(release, xb_node_get_text(tag));
+		/* not set up */
+		if (engine_silo->query_tag_by_guid_version == NULL)
+			continue;
+		for (guint i = 0; i < guids->len; i++) {
+			const gchar *guid = g_ptr_array_index(guids, i);
+			g_autoptr(GError) error_local = NULL;
+			g_autoptr(GPtrArray) tags = NULL;
+			g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+			gint64 start_us;
+
+			/* bind GUID and then query */
+			xb_value_bindings_bind_str(xb_query_context_get_bindings(&context),
+						   0,
+						   guid,
+						   NULL);
+			xb_value_bindings_bind_str(xb_query_context_get_bindings(&context),
+						   1,
+						   fu_release_get_version(release),
+						   NULL);
+			start_us = g_get_monotonic_time();
+			tags = xb_silo_query_with_context(engine_silo->silo,
+							  engine_silo->query_tag_by_guid_version,
+							  &context,
+							  &error_local);
+			fu_metrics_add_duration_since(fu_context_get_metrics(self->ctx),
+						      "XmlbQuery",
+						      start_us);
+			if (tags == NULL) {
+				if (g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
+				    g_error_matches(error_local,
+						    G_IO_ERROR,
+						    G_IO_ERROR_INVALID_ARGUMENT))
+					continue;
+				g_propagate_error(error, g_steal_pointer(&error_local));
+				fwupd_error_convert(error);
+				return FALSE;
+			}
+			for (guint j = 0; j < tags->len; j++) {
+				XbNode *tag = g_ptr_array_index(tags, j);
+				fu_release_add_tag(release, xb_node_get_text(tag));
+			}
 		}
 	}
 
@@ -740,33 +920,80 @@ fu_engine_load_release(FuEngine *self,
 	return TRUE;
 }
 
+/* the first release in document order wins, as with xb_silo_query_first() */
+static void
+fu_engine_silo_add_release_by_checksum(FuEngineSilo *engine_silo, const gchar *xpath, guint depth)
+{
+	g_autoptr(GPtrArray) csums = xb_silo_query(engine_silo->silo, xpath, 0, NULL);
+	if (csums == NULL)
+		return;
+	for (guint i = 0; i < csums->len; i++) {
+		XbNode *csum = g_ptr_array_index(csums, i);
+		const gchar *text = xb_node_get_text(csum);
+		g_autoptr(XbNode) release = g_object_ref(csum);
+
+		if (text == NULL)
+			continue;
+		if (g_hash_table_contains(engine_silo->release_by_checksum, text))
+			continue;
+		for (guint j = 0; j < depth && release != NULL; j++) {
+			XbNode *parent = xb_node_get_parent(release);
+			g_object_unref(release);
+			release = parent;
+		}
+		if (release == NULL)
+			continue;
+		g_hash_table_insert(engine_silo->release_by_checksum,
+				    g_strdup(text),
+				    g_steal_pointer(&release));
+	}
+}
+
+/* only needed when installing or getting details, so built on first use */
+static GHashTable *
+fu_engine_silo_get_release_by_checksum(FuEngineSilo *engine_silo)
+{
+	if (engine_silo->release_by_checksum != NULL)
+		return engine_silo->release_by_checksum;
+	engine_silo->release_by_checksum =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_object_unref);
+
+	/* old-style <checksum target="container"> and new-style <artifact> */
+	fu_engine_silo_add_release_by_checksum(
+	    engine_silo,
+	    "components/component[@type='firmware']/releases/release/"
+	    "checksum[@target='container']",
+	    1);
+	fu_engine_silo_add_release_by_checksum(
+	    engine_silo,
+	    "components/component[@type='firmware']/releases/release/"
+	    "artifacts/artifact[@type='binary']/checksum",
+	    3);
+	g_debug("silo %s indexed %u checksums",
+		engine_silo->id,
+		g_hash_table_size(engine_silo->release_by_checksum));
+	return engine_silo->release_by_checksum;
+}
+
 /* finds the release for the first firmware in the silo that matches this
  * container or artifact checksum */
 static XbNode *
 fu_engine_get_release_for_checksum(FuEngine *self, const gchar *csum)
 {
-	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
-	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, csum, NULL);
-	if (self->query_container_checksum1 != NULL) {
-		g_autoptr(XbNode) rel =
-		    xb_silo_query_first_with_context(self->silo,
-						     self->query_container_checksum1,
-						     &context,
-						     NULL);
-		if (rel != NULL)
-			return g_steal_pointer(&rel);
-	}
-	if (self->query_container_checksum2 != NULL) {
-		g_autoptr(XbNode) rel =
-		    xb_silo_query_first_with_context(self->silo,
-						     self->query_container_checksum2,
-						     &context,
-						     NULL);
-		if (rel != NULL)
-			return g_steal_pointer(&rel);
+	FuMetrics *metrics = fu_context_get_metrics(self->ctx);
+	for (guint i = 0; i < self->silos->len; i++) {
+		FuEngineSilo *engine_silo = g_ptr_array_index(self->silos, i);
+		GHashTable *release_by_checksum =
+		    fu_engine_silo_get_release_by_checksum(engine_silo);
+		XbNode *rel = g_hash_table_lookup(release_by_checksum, csum);
+		if (rel != NULL) {
+			fu_metrics_add_counter(metrics, "SiloIndexHit", 1);
+			return g_object_ref(rel);
+		}
 	}
 
 	/* failed */
+	fu_metrics_add_counter(metrics, "SiloIndexMiss", 1);
 	return NULL;
 }
 
@@ -774,17 +1001,21 @@ fu_engine_get_release_for_checksum(FuEngine *self, const gchar *csum)
 gchar *
 fu_engine_get_remote_id_for_stream(FuEngine *self, GInputStream *stream)
 {
-	GChecksumType checksum_types[] = {G_CHECKSUM_SHA256, G_CHECKSUM_SHA1, 0};
+	GChecksumType checksum_types[] = {G_CHECKSUM_SHA256, G_CHECKSUM_SHA1};
+	g_autoptr(GPtrArray) checksums = NULL;
 
 	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
 
-	for (guint i = 0; checksum_types[i] != 0; i++) {
-		g_autofree gchar *csum = NULL;
-		g_autoptr(XbNode) rel = NULL;
-		csum = fu_input_stream_compute_checksum(stream, checksum_types[i], NULL);
-		if (csum != NULL)
-			rel = fu_engine_get_release_for_checksum(self, csum);
+	checksums = fu_input_stream_compute_checksums(stream,
+						      checksum_types,
+						      G_N_ELEMENTS(checksum_types),
+						      NULL);
+	if (checksums == NULL)
+		return NULL;
+	for (guint i = 0; i < checksums->len; i++) {
+		const gchar *csum = g_ptr_array_index(checksums, i);
+		g_autoptr(XbNode) rel = fu_engine_get_release_for_checksum(self, csum);
 		if (rel != NULL) {
 			const gchar *remote_id =
 			    xb_node_query_text(rel,
@@ -866,9 +1097,10 @@ fu_engine_modify_config(FuEngine *self,
 		    "ArchiveSizeMax",	 "ApprovedFirmware",
 		    "BlockedFirmware",	 "DisabledDevices",
 		    "DisabledPlugins",	 "EnumerateAllDevices",
-		    "EspLocation",	 "HostBkc",
-		    "IdleTimeout",	 "IgnorePower",
-		    "OnlyTrusted",	 "P2pPolicy",
+		    "EspLocation",	 "FirmwareCacheSizeMax",
+		    "HostBkc",		 "IdleTimeout",
+		    "IgnorePower",	 "OnlyTrusted",
+		    "P2pPolicy",	 "ParallelColdplug",
 		    "ReleaseDedupe",	 "ReleasePriority",
 		    "ShowDevicePrivate", "TestDevices",
 		    "TrustedReports",	 "TrustedUids",
@@ -1374,27 +1606,51 @@ fu_engine_verify_update(FuEngine *self,
 static XbNode *
 fu_engine_get_component_by_guid(FuEngine *self, const gchar *guid)
 {
-	g_autoptr(GError) error_local = NULL;
-	g_autoptr(XbNode) component = NULL;
-	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+	for (guint i = 0; i < self->silos->len; i++) {
+		FuEngineSilo *engine_silo = g_ptr_array_index(self->silos, i);
+		GPtrArray *components = g_hash_table_lookup(engine_silo->components_by_guid, guid);
+		if (components != NULL && components->len > 0) {
+			fu_metrics_add_counter(fu_context_get_metrics(self->ctx),
+					       "SiloIndexHit",
+					       1);
+			return g_object_ref(g_ptr_array_index(components, 0));
+		}
+	}
+	fu_metrics_add_counter(fu_context_get_metrics(self->ctx), "SiloIndexMiss", 1);
+	return NULL;
+}
 
-	/* no components in silo */
-	if (self->query_component_by_guid == NULL)
-		return NULL;
+/* all the components in every silo */
+static GPtrArray *
+fu_engine_get_components_by_guid(FuEngine *self, const gchar *guid)
+{
+	GPtrArray *components = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	for (guint i = 0; i < self->silos->len; i++) {
+		FuEngineSilo *engine_silo = g_ptr_array_index(self->silos, i);
+		GPtrArray *components_tmp =
+		    g_hash_table_lookup(engine_silo->components_by_guid, guid);
+		if (components_tmp == NULL)
+			continue;
+		for (guint j = 0; j < components_tmp->len; j++) {
+			XbNode *component = g_ptr_array_index(components_tmp, j);
+			g_ptr_array_add(components, g_object_ref(component));
+		}
+	}
+	fu_metrics_add_counter(fu_context_get_metrics(self->ctx),
+			       components->len > 0 ? "SiloIndexHit" : "SiloIndexMiss",
+			       1);
+	return components;
+}
 
-	xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
-	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
-	component = xb_silo_query_first_with_context(self->silo,
-						     self->query_component_by_guid,
-						     &context,
-						     &error_local);
-	if (component == NULL) {
-		if (!g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) &&
-		    !g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
-			g_warning("ignoring: %s", error_local->message);
-		return NULL;
+static gboolean
+fu_engine_has_components(FuEngine *self)
+{
+	for (guint i = 0; i < self->silos->len; i++) {
+		FuEngineSilo *engine_silo = g_ptr_array_index(self->silos, i);
+		if (g_hash_table_size(engine_silo->components_by_guid) > 0)
+			return TRUE;
 	}
-	return g_object_ref(component);
+	return FALSE;
 }
 
 XbNode *
@@ -1457,14 +1713,17 @@ fu_engine_verify_from_local_metadata(FuEngine *self, FuDevice *device, GError **
 }
 
 static XbNode *
-fu_engine_verify_from_system_metadata(FuEngine *self, FuDevice *device, GError **error)
+fu_engine_verify_from_system_metadata_silo(FuEngine *self,
+					   FuDevice *device,
+					   XbSilo *silo,
+					   GError **error)
 {
 	FwupdVersionFormat fmt = fu_device_get_version_format(device);
 	GPtrArray *guids = fu_device_get_guids(device);
 	g_autoptr(XbQuery) query = NULL;
 
 	/* prepare query with bound GUID parameter */
-	query = xb_query_new_full(self->silo,
+	query = xb_query_new_full(silo,
 				  "components/component[@type='firmware']/"
 				  "provides/firmware[@type='flashed'][text()=?]/"
 				  "../../releases/release",
@@ -1478,13 +1737,18 @@ fu_engine_verify_from_system_metadata(FuEngine *self, FuDevice *device, GError *
 	/* use prepared query for each GUID */
 	for (guint i = 0; i < guids->len; i++) {
 		const gchar *guid = g_ptr_array_index(guids, i);
+		gint64 start_us;
 		g_autoptr(GError) error_local = NULL;
 		g_autoptr(GPtrArray) releases = NULL;
 		g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
 
 		/* bind GUID and then query */
 		xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
-		releases = xb_silo_query_with_context(self->silo, query, &context, &error_local);
+		start_us = g_get_monotonic_time();
+		releases = xb_silo_query_with_context(silo, query, &context, &error_local);
+		fu_metrics_add_duration_since(fu_context_get_metrics(self->ctx),
+					      "XmlbQuery",
+					      start_us);
 		if (releases == NULL) {
 			if (g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
 			    g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
@@ -1509,6 +1773,34 @@ fu_engine_verify_from_system_metadata(FuEngine *self, FuDevice *device, GError *
 	return NULL;
 }
 
+static XbNode *
+fu_engine_verify_from_system_metadata(FuEngine *self, FuDevice *device, GError **error)
+{
+	for (guint i = 0; i < self->silos->len; i++) {
+		FuEngineSilo *engine_silo = g_ptr_array_index(self->silos, i);
+		g_autoptr(GError) error_local = NULL;
+		g_autoptr(XbNode) rel = NULL;
+
+		/* no components in silo */
+		if (g_hash_table_size(engine_silo->components_by_guid) == 0)
+			continue;
+		rel = fu_engine_verify_from_system_metadata_silo(self,
+								 device,
+								 engine_silo->silo,
+								 &error_local);
+		if (rel != NULL)
+			return g_steal_pointer(&rel);
+		if (!g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND)) {
+			g_propagate_error(error, g_steal_pointer(&error_local));
+			return NULL;
+		}
+	}
+
+	/* not found */
+	g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "failed to find release");
+	return NULL;
+}
+
 /**
  * fu_engine_verify:
  * @self: a #FuEngine
@@ -2195,6 +2487,74 @@ fu_engine_publish_release(FuEngine *self, FuRelease *release, GError **error)
 	return TRUE;
 }
 
+/* the cache is opt-in, and the config may have been changed since the daemon started */
+static FuFirmwareCache *
+fu_engine_get_firmware_cache(FuEngine *self, GError **error)
+{
+	guint64 size_max = fu_engine_config_get_firmware_cache_size_max(self->config);
+	if (size_max == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "firmware cache is disabled");
+		return NULL;
+	}
+	fu_firmware_cache_set_size_max(self->firmware_cache, size_max);
+	return self->firmware_cache;
+}
+
+/* returns the filename of the archive for @release if it has already been installed */
+gchar *
+fu_engine_lookup_firmware_cache(FuEngine *self, FwupdRelease *release, GError **error)
+{
+	FuFirmwareCache *firmware_cache;
+	const gchar *checksum;
+
+	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
+	g_return_val_if_fail(FWUPD_IS_RELEASE(release), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	firmware_cache = fu_engine_get_firmware_cache(self, error);
+	if (firmware_cache == NULL)
+		return NULL;
+	checksum = fwupd_checksum_get_by_kind(fwupd_release_get_checksums(release),
+					      G_CHECKSUM_SHA256);
+	if (checksum == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_FOUND,
+				    "release has no SHA256 checksum");
+		return NULL;
+	}
+	return fu_firmware_cache_lookup(firmware_cache, checksum, error);
+}
+
+static void
+fu_engine_save_into_firmware_cache(FuEngine *self, FuCabinet *cabinet)
+{
+	FuFirmwareCache *firmware_cache;
+	g_autofree gchar *checksum = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	/* disabled */
+	firmware_cache = fu_engine_get_firmware_cache(self, NULL);
+	if (firmware_cache == NULL)
+		return;
+
+	stream = fu_firmware_get_stream(FU_FIRMWARE(cabinet), &error_local);
+	if (stream == NULL) {
+		g_debug("not adding archive to cache: %s", error_local->message);
+		return;
+	}
+	checksum = fu_firmware_cache_add_stream(firmware_cache, stream, &error_local);
+	if (checksum == NULL) {
+		g_warning("failed to add archive to cache: %s", error_local->message);
+		return;
+	}
+	g_debug("archive %s is in cache", checksum);
+}
+
 static gboolean
 fu_engine_install_release_version_check(FuEngine *self,
 					FuRelease *release,
@@ -2224,78 +2584,360 @@ fu_engine_install_release_version_check(FuEngine *self,
 	return TRUE;
 }
 
-/**
- * fu_engine_install_releases:
- * @self: a #FuEngine
- * @request: a #FuEngineRequest
- * @releases: (element-type FuRelease): a device
- * @cabinet: a #FuCabinet
- * @flags: install flags, e.g. %FWUPD_DEVICE_FLAG_UPDATABLE
- * @error: (nullable): optional return location for an error
- *
- * Installs a specific firmware file on one or more install tasks.
- *
- * By this point all the requirements and tests should have been done in
- * fu_engine_requirements_check() so this should not fail before running
- * the plugin loader.
- *
- * Returns: %TRUE for success
- **/
-gboolean
-fu_engine_install_releases(FuEngine *self,
-			   FuEngineRequest *request,
-			   GPtrArray *releases,
-			   FuCabinet *cabinet,
-			   FuProgress *progress,
-			   FwupdInstallFlags flags,
-			   GError **error)
+typedef struct {
+	FuEngine *self;	     /* no ref */
+	GPtrArray *releases; /* of FuRelease, in install order */
+	GHashTable *keys;    /* of root, proxy root and composite device ID */
+	FwupdInstallFlags flags;
+	gint percentage; /* atomic */
+	FuEngineInstallCall call_finished;
+	GError *error;
+} FuEngineInstallLane;
+
+static void
+fu_engine_install_lane_free(FuEngineInstallLane *lane)
 {
-	g_autoptr(FuIdleLocker) locker = NULL;
-	g_autoptr(GPtrArray) devices = NULL;
-	g_autoptr(GPtrArray) devices_new = NULL;
+	g_ptr_array_unref(lane->releases);
+	g_hash_table_unref(lane->keys);
+	if (lane->error != NULL)
+		g_error_free(lane->error);
+	g_free(lane);
+}
 
-	/* do not allow auto-shutdown during this time */
-	locker = fu_idle_locker_new(self->idle,
-				    FU_IDLE_INHIBIT_TIMEOUT | FU_IDLE_INHIBIT_SIGNALS,
-				    "update");
-	g_return_val_if_fail(locker != NULL, FALSE);
+/* releases for devices sharing an ancestor, a proxy or a composite device must not be
+ * installed concurrently */
+static GPtrArray *
+fu_engine_install_release_get_lane_keys(FuRelease *release)
+{
+	FuDevice *device = fu_release_get_device(release);
+	FuDevice *proxy = fu_device_get_proxy(device);
+	const gchar *composite_id = fu_device_get_composite_id(device);
+	GPtrArray *keys = g_ptr_array_new_with_free_func(g_free);
+	g_autoptr(FuDevice) root = fu_device_get_root(device);
 
-	/* use an allow-list for device-changed signals -- only allow any of the composite update
-	 * devices to emit signals for the duration of the install */
-	for (guint i = 0; i < releases->len; i++) {
-		FuRelease *release = g_ptr_array_index(releases, i);
-		FuDevice *device = fu_release_get_device(release);
-		g_hash_table_insert(self->device_changed_allowlist,
-				    g_strdup(fu_device_get_id(device)),
-				    GUINT_TO_POINTER(1));
+	g_ptr_array_add(keys, g_strdup(fu_device_get_id(root)));
+	if (proxy != NULL) {
+		g_autoptr(FuDevice) root_proxy = fu_device_get_root(proxy);
+		g_ptr_array_add(keys, g_strdup(fu_device_get_id(root_proxy)));
 	}
+	if (composite_id != NULL)
+		g_ptr_array_add(keys, g_strdup(composite_id));
+	return keys;
+}
 
-	/* install these in the right order */
-	g_ptr_array_sort(releases, fu_engine_sort_release_device_order_release_version_cb);
+static gboolean
+fu_engine_install_lane_has_any_key(FuEngineInstallLane *lane, GPtrArray *keys)
+{
+	for (guint i = 0; i < keys->len; i++) {
+		const gchar *key = g_ptr_array_index(keys, i);
+		if (g_hash_table_contains(lane->keys, key))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/* split the sorted releases into lanes that can be installed at the same time */
+static GPtrArray *
+fu_engine_install_releases_build_lanes(FuEngine *self, GPtrArray *releases, FwupdInstallFlags flags)
+{
+	GPtrArray *lanes =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_engine_install_lane_free);
 
-	/* notify the plugins about the composite action */
-	devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	for (guint i = 0; i < releases->len; i++) {
 		FuRelease *release = g_ptr_array_index(releases, i);
-		FuDevice *device = fu_release_get_device(release);
-		const gchar *logical_id = fu_device_get_logical_id(device);
-		g_info("composite update %u: %s %s->%s (%s, order:%i: priority:%u)",
-		       i + 1,
-		       fu_device_get_id(device),
-		       fu_device_get_version(device),
-		       fu_release_get_version(release),
-		       logical_id != NULL ? logical_id : "n/a",
-		       fu_device_get_order(device),
-		       (guint)fu_release_get_priority(release));
-		g_ptr_array_add(devices, g_object_ref(device));
+		FuEngineInstallLane *lane = NULL;
+		g_autoptr(GPtrArray) keys = fu_engine_install_release_get_lane_keys(release);
+
+		for (guint j = 0; j < lanes->len; j++) {
+			FuEngineInstallLane *lane_tmp = g_ptr_array_index(lanes, j);
+			GHashTableIter iter;
+			gpointer key = NULL;
+
+			if (!fu_engine_install_lane_has_any_key(lane_tmp, keys))
+				continue;
+			if (lane == NULL) {
+				lane = lane_tmp;
+				continue;
+			}
+
+			/* this release depends on both lanes, so merge them */
+			g_ptr_array_extend(lane->releases,
+					   lane_tmp->releases,
+					   (GCopyFunc)g_object_ref,
+					   NULL);
+			g_ptr_array_sort(lane->releases,
+					 fu_engine_sort_release_device_order_release_version_cb);
+			g_hash_table_iter_init(&iter, lane_tmp->keys);
+			while (g_hash_table_iter_next(&iter, &key, NULL))
+				g_hash_table_add(lane->keys, g_strdup(key));
+			g_ptr_array_remove_index(lanes, j--);
+		}
+		if (lane == NULL) {
+			lane = g_new0(FuEngineInstallLane, 1);
+			lane->self = self;
+			lane->flags = flags;
+			lane->releases =
+			    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+			lane->keys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+			g_ptr_array_add(lanes, lane);
+		}
+		g_ptr_array_add(lane->releases, g_object_ref(release));
+		for (guint j = 0; j < keys->len; j++)
+			g_hash_table_add(lane->keys, g_strdup(g_ptr_array_index(keys, j)));
+	}
+	return lanes;
+}
+
+/* the order set from the parent->child depth only applies within one device tree, which is
+ * already installed in one lane -- but an explicit device order or a different release priority
+ * has to be honored across lanes, so those start a new wave that waits for the previous one */
+static gboolean
+fu_engine_install_releases_is_same_wave(FuRelease *release1, FuRelease *release2)
+{
+	FuDevice *device1 = fu_release_get_device(release1);
+	FuDevice *device2 = fu_release_get_device(release2);
+
+	if (fu_release_get_priority(release1) != fu_release_get_priority(release2))
+		return FALSE;
+	if (fu_device_get_order(device1) == fu_device_get_order(device2))
+		return TRUE;
+	return !fu_device_has_private_flag(device1, FU_DEVICE_PRIVATE_FLAG_EXPLICIT_ORDER) &&
+	       !fu_device_has_private_flag(device2, FU_DEVICE_PRIVATE_FLAG_EXPLICIT_ORDER);
+}
+
+static GPtrArray *
+fu_engine_install_releases_build_waves(FuEngine *self, GPtrArray *releases, FwupdInstallFlags flags)
+{
+	GPtrArray *waves = g_ptr_array_new_with_free_func((GDestroyNotify)g_ptr_array_unref);
+	g_autoptr(GPtrArray) releases_wave = NULL;
+
+	for (guint i = 0; i < releases->len; i++) {
+		FuRelease *release = g_ptr_array_index(releases, i);
+		if (releases_wave != NULL &&
+		    !fu_engine_install_releases_is_same_wave(
+			g_ptr_array_index(releases_wave, releases_wave->len - 1),
+			release)) {
+			g_ptr_array_add(waves,
+					fu_engine_install_releases_build_lanes(self,
+									       releases_wave,
+									       flags));
+			g_clear_pointer(&releases_wave, g_ptr_array_unref);
+		}
+		if (releases_wave == NULL)
+			releases_wave = g_ptr_array_new();
+		g_ptr_array_add(releases_wave, release);
 	}
-	fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_COMPOSITE_PREPARE);
-	if (!fu_engine_composite_prepare(self, devices, error)) {
-		g_prefix_error(error, "failed to prepare composite action: ");
+	if (releases_wave != NULL) {
+		g_ptr_array_add(waves,
+				fu_engine_install_releases_build_lanes(self, releases_wave, flags));
+	}
+	return waves;
+}
+
+static gboolean
+fu_engine_install_waves_has_parallel(GPtrArray *waves)
+{
+	for (guint i = 0; i < waves->len; i++) {
+		GPtrArray *lanes = g_ptr_array_index(waves, i);
+		if (lanes->len > 1)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static guint
+fu_engine_install_lanes_get_releases_cnt(GPtrArray *lanes)
+{
+	guint releases_cnt = 0;
+	for (guint i = 0; i < lanes->len; i++) {
+		FuEngineInstallLane *lane = g_ptr_array_index(lanes, i);
+		releases_cnt += lane->releases->len;
+	}
+	return releases_cnt;
+}
+
+static void
+fu_engine_install_lane_percentage_changed_cb(FuProgress *progress,
+					     guint percentage,
+					     FuEngineInstallLane *lane)
+{
+	g_atomic_int_set(&lane->percentage, (gint)percentage);
+}
+
+static gboolean
+fu_engine_install_lane_release(FuEngine *self,
+			       FuRelease *release,
+			       FuProgress *progress,
+			       FwupdInstallFlags flags,
+			       GError **error);
+
+/* runs in a worker thread, with all the releases of the lane installed in order */
+static void
+fu_engine_install_lane_cb(gpointer data, gpointer user_data)
+{
+	FuEngineInstallLane *lane = (FuEngineInstallLane *)data;
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+
+	g_signal_connect(FU_PROGRESS(progress),
+			 "percentage-changed",
+			 G_CALLBACK(fu_engine_install_lane_percentage_changed_cb),
+			 lane);
+	fu_progress_set_steps(progress, lane->releases->len);
+	for (guint i = 0; i < lane->releases->len; i++) {
+		FuRelease *release = g_ptr_array_index(lane->releases, i);
+		if (!fu_engine_install_lane_release(lane->self,
+						    release,
+						    fu_progress_get_child(progress),
+						    lane->flags,
+						    &lane->error))
+			break;
+		fu_progress_step_done(progress);
+	}
+
+	/* the main thread is waiting for this */
+	g_async_queue_push(lane->self->install_queue, &lane->call_finished);
+}
+
+/* the partial streams of one cabinet all share the seek position of the base stream, so the
+ * releases can only be read from the lane worker threads when backed by mapped data */
+static gboolean
+fu_engine_install_release_stream_is_mapped(FuRelease *release)
+{
+	GInputStream *stream = fu_release_get_stream(release);
+	while (stream != NULL && FU_IS_PARTIAL_INPUT_STREAM(stream))
+		stream = fu_partial_input_stream_get_base_stream(FU_PARTIAL_INPUT_STREAM(stream));
+	return stream != NULL && FU_IS_MAPPED_INPUT_STREAM(stream);
+}
+
+/* parallel installs are not possible when recording the emulation phases, when the plugin
+ * waits for the system to acquiesce using the main loop, or from a nested install */
+static gboolean
+fu_engine_install_releases_parallel_supported(FuEngine *self, GPtrArray *releases)
+{
+	if (fu_context_has_flag(self->ctx, FU_CONTEXT_FLAG_SAVE_EVENTS))
+		return FALSE;
+	if (self->install_queue != NULL)
+		return FALSE;
+	for (guint i = 0; i < releases->len; i++) {
+		FuRelease *release = g_ptr_array_index(releases, i);
+		FuDevice *device = fu_release_get_device(release);
+		if (fu_device_has_flag(device, FWUPD_DEVICE_FLAG_EMULATED))
+			return FALSE;
+		if (fu_device_get_acquiesce_delay(device) > 0)
+			return FALSE;
+		if (!fu_engine_install_release_stream_is_mapped(release)) {
+			g_info("firmware for %s is not mapped, installing in sequence",
+			       fu_device_get_id(device));
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/* give each release a stream with its own seek position, which references the mapped data
+ * rather than being a copy */
+static gboolean
+fu_engine_install_release_ensure_stream_view(FuRelease *release, GError **error)
+{
+	GInputStream *stream = fu_release_get_stream(release);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GInputStream) stream_view = NULL;
+
+	blob = fu_input_stream_read_bytes(stream, 0x0, G_MAXSIZE, NULL, error);
+	if (blob == NULL)
+		return FALSE;
+	stream_view = fu_mapped_input_stream_new(blob);
+	fu_release_set_stream(release, stream_view);
+	return TRUE;
+}
+
+static gboolean
+fu_engine_install_releases_parallel(FuEngine *self,
+				    GPtrArray *lanes,
+				    FuProgress *progress,
+				    GError **error)
+{
+	GThreadPool *pool;
+	guint lanes_done = 0;
+	guint lanes_pushed = 0;
+	guint releases_cnt = fu_engine_install_lanes_get_releases_cnt(lanes);
+	g_autoptr(GAsyncQueue) queue = g_async_queue_new();
+	g_autoptr(GError) error_push = NULL;
+
+	fu_progress_set_id(progress, G_STRLOC);
+	for (guint i = 0; i < lanes->len; i++) {
+		FuEngineInstallLane *lane = g_ptr_array_index(lanes, i);
+		for (guint j = 0; j < lane->releases->len; j++) {
+			FuRelease *release = g_ptr_array_index(lane->releases, j);
+			if (!fu_engine_install_release_ensure_stream_view(release, error))
+				return FALSE;
+		}
+	}
+
+	/* install each lane in a worker thread */
+	pool = g_thread_pool_new(fu_engine_install_lane_cb,
+				 NULL,
+				 (gint)MIN(lanes->len, FU_ENGINE_INSTALL_PARALLEL_MAX),
+				 FALSE,
+				 error);
+	if (pool == NULL)
 		return FALSE;
+	self->install_queue = queue;
+	self->install_thread = g_thread_self();
+	for (guint i = 0; i < lanes->len; i++) {
+		FuEngineInstallLane *lane = g_ptr_array_index(lanes, i);
+		if (!g_thread_pool_push(pool, lane, &error_push))
+			break;
+		lanes_pushed++;
 	}
 
-	/* all authenticated, so install all the things */
+	/* run the steps the workers hand back until all the lanes have finished -- the default
+	 * main context is only iterated when waiting for a replug, just like a serial install */
+	while (lanes_done < lanes_pushed) {
+		FuEngineInstallCall *call =
+		    g_async_queue_timeout_pop(queue, FU_ENGINE_INSTALL_PARALLEL_POLL_MS * 1000);
+		guint64 percentage = 0;
+
+		if (call != NULL) {
+			if (call->func == NULL)
+				lanes_done++;
+			else
+				fu_engine_install_call_run(call);
+		}
+		for (guint i = 0; i < lanes->len; i++) {
+			FuEngineInstallLane *lane = g_ptr_array_index(lanes, i);
+			percentage +=
+			    (guint64)g_atomic_int_get(&lane->percentage) * lane->releases->len;
+		}
+		fu_progress_set_percentage(progress, percentage / releases_cnt);
+	}
+	g_thread_pool_free(pool, FALSE, TRUE);
+	self->install_queue = NULL;
+	self->install_thread = NULL;
+	if (error_push != NULL) {
+		g_propagate_error(error, g_steal_pointer(&error_push));
+		return FALSE;
+	}
+
+	/* all the lanes have finished, so report the first failure */
+	for (guint i = 0; i < lanes->len; i++) {
+		FuEngineInstallLane *lane = g_ptr_array_index(lanes, i);
+		if (lane->error != NULL) {
+			g_propagate_error(error, g_steal_pointer(&lane->error));
+			return FALSE;
+		}
+	}
+	fu_progress_set_percentage(progress, 100);
+	return TRUE;
+}
+
+static gboolean
+fu_engine_install_releases_serial(FuEngine *self,
+				  GPtrArray *releases,
+				  FuProgress *progress,
+				  FwupdInstallFlags flags,
+				  GError **error)
+{
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_set_steps(progress, releases->len);
 	for (guint i = 0; i < releases->len; i++) {
@@ -2313,16 +2955,150 @@ fu_engine_install_releases(FuEngine *self,
 					       stream,
 					       fu_progress_get_child(progress),
 					       flags,
-					       error)) {
-			g_autoptr(GError) error_local = NULL;
-			if (!fu_engine_composite_cleanup(self, devices, &error_local)) {
-				g_warning("failed to cleanup failed composite action: %s",
-					  error_local->message);
-			}
+					       error))
 			return FALSE;
+		fu_progress_step_done(progress);
+	}
+	return TRUE;
+}
+
+/* each wave waits for the previous one, and the lanes of one wave are installed in parallel */
+static gboolean
+fu_engine_install_releases_waves(FuEngine *self,
+				 GPtrArray *waves,
+				 FuProgress *progress,
+				 FwupdInstallFlags flags,
+				 GError **error)
+{
+	fu_progress_set_id(progress, G_STRLOC);
+	for (guint i = 0; i < waves->len; i++) {
+		GPtrArray *lanes = g_ptr_array_index(waves, i);
+		fu_progress_add_step(progress,
+				     FWUPD_STATUS_DEVICE_WRITE,
+				     fu_engine_install_lanes_get_releases_cnt(lanes),
+				     NULL);
+	}
+	for (guint i = 0; i < waves->len; i++) {
+		GPtrArray *lanes = g_ptr_array_index(waves, i);
+		if (lanes->len == 1) {
+			FuEngineInstallLane *lane = g_ptr_array_index(lanes, 0);
+			if (!fu_engine_install_releases_serial(self,
+							       lane->releases,
+							       fu_progress_get_child(progress),
+							       flags,
+							       error))
+				return FALSE;
+		} else {
+			g_info("installing %u releases in %u parallel lanes",
+			       fu_engine_install_lanes_get_releases_cnt(lanes),
+			       lanes->len);
+			if (!fu_engine_install_releases_parallel(self,
+								 lanes,
+								 fu_progress_get_child(progress),
+								 error))
+				return FALSE;
 		}
 		fu_progress_step_done(progress);
 	}
+	return TRUE;
+}
+
+/**
+ * fu_engine_install_releases:
+ * @self: a #FuEngine
+ * @request: a #FuEngineRequest
+ * @releases: (element-type FuRelease): a device
+ * @cabinet: a #FuCabinet
+ * @flags: install flags, e.g. %FWUPD_DEVICE_FLAG_UPDATABLE
+ * @error: (nullable): optional return location for an error
+ *
+ * Installs a specific firmware file on one or more install tasks.
+ *
+ * By this point all the requirements and tests should have been done in
+ * fu_engine_requirements_check() so this should not fail before running
+ * the plugin loader.
+ *
+ * If %FWUPD_INSTALL_FLAG_PARALLEL is set then releases for devices that share no ancestor,
+ * proxy or composite device are installed at the same time, unless an explicit device order or
+ * the release priority requires them to be installed in sequence.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_engine_install_releases(FuEngine *self,
+			   FuEngineRequest *request,
+			   GPtrArray *releases,
+			   FuCabinet *cabinet,
+			   FuProgress *progress,
+			   FwupdInstallFlags flags,
+			   GError **error)
+{
+	gboolean ret;
+	g_autoptr(FuIdleLocker) locker = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) devices_new = NULL;
+	g_autoptr(GPtrArray) waves = NULL;
+
+	/* do not allow auto-shutdown during this time */
+	locker = fu_idle_locker_new(self->idle,
+				    FU_IDLE_INHIBIT_TIMEOUT | FU_IDLE_INHIBIT_SIGNALS,
+				    "update");
+	g_return_val_if_fail(locker != NULL, FALSE);
+
+	/* use an allow-list for device-changed signals -- only allow any of the composite update
+	 * devices to emit signals for the duration of the install */
+	for (guint i = 0; i < releases->len; i++) {
+		FuRelease *release = g_ptr_array_index(releases, i);
+		FuDevice *device = fu_release_get_device(release);
+		g_hash_table_insert(self->device_changed_allowlist,
+				    g_strdup(fu_device_get_id(device)),
+				    GUINT_TO_POINTER(1));
+	}
+
+	/* install these in the right order */
+	g_ptr_array_sort(releases, fu_engine_sort_release_device_order_release_version_cb);
+
+	/* notify the plugins about the composite action */
+	devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	for (guint i = 0; i < releases->len; i++) {
+		FuRelease *release = g_ptr_array_index(releases, i);
+		FuDevice *device = fu_release_get_device(release);
+		const gchar *logical_id = fu_device_get_logical_id(device);
+		g_info("composite update %u: %s %s->%s (%s, order:%i: priority:%u)",
+		       i + 1,
+		       fu_device_get_id(device),
+		       fu_device_get_version(device),
+		       fu_release_get_version(release),
+		       logical_id != NULL ? logical_id : "n/a",
+		       fu_device_get_order(device),
+		       (guint)fu_release_get_priority(release));
+		g_ptr_array_add(devices, g_object_ref(device));
+	}
+	fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_COMPOSITE_PREPARE);
+	if (!fu_engine_composite_prepare(self, devices, error)) {
+		g_prefix_error(error, "failed to prepare composite action: ");
+		return FALSE;
+	}
+
+	/* optionally install the releases for independent devices at the same time */
+	if ((flags & FWUPD_INSTALL_FLAG_PARALLEL) > 0 &&
+	    fu_engine_install_releases_parallel_supported(self, releases))
+		waves = fu_engine_install_releases_build_waves(self, releases, flags);
+
+	/* all authenticated, so install all the things */
+	if (waves != NULL && fu_engine_install_waves_has_parallel(waves)) {
+		ret = fu_engine_install_releases_waves(self, waves, progress, flags, error);
+	} else {
+		ret = fu_engine_install_releases_serial(self, releases, progress, flags, error);
+	}
+	if (!ret) {
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_engine_composite_cleanup(self, devices, &error_local)) {
+			g_warning("failed to cleanup failed composite action: %s",
+				  error_local->message);
+		}
+		return FALSE;
+	}
 
 	/* set all the device statuses back to unknown */
 	for (guint i = 0; i < releases->len; i++) {
@@ -2380,6 +3156,9 @@ fu_engine_install_releases(FuEngine *self,
 			return FALSE;
 	}
 
+	/* so that fwupdtool can install this release again without downloading the archive */
+	fu_engine_save_into_firmware_cache(self, cabinet);
+
 	/* allow capturing setup again */
 	fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_SETUP);
 
@@ -2545,14 +3324,20 @@ fu_engine_install_release(FuEngine *self,
 	if (request != NULL)
 		feature_flags = fu_engine_request_get_feature_flags(request);
 
-	/* add the checksum of the container blob if not already set */
+	/* add the checksum of the blob if not already set, which is only required when the release
+	 * was not loaded from a cabinet as fu_release_load() uses the container checksums */
 	if (fwupd_release_get_checksums(FWUPD_RELEASE(release))->len == 0) {
-		GChecksumType checksum_types[] = {G_CHECKSUM_SHA256, G_CHECKSUM_SHA1, 0};
-		for (guint i = 0; checksum_types[i] != 0; i++) {
-			g_autofree gchar *checksum =
-			    fu_input_stream_compute_checksum(stream, checksum_types[i], error);
-			if (checksum == NULL)
-				return FALSE;
+		GChecksumType checksum_types[] = {G_CHECKSUM_SHA256, G_CHECKSUM_SHA1};
+		g_autoptr(GPtrArray) checksums = NULL;
+
+		checksums = fu_input_stream_compute_checksums(stream,
+							      checksum_types,
+							      G_N_ELEMENTS(checksum_types),
+							      error);
+		if (checksums == NULL)
+			return FALSE;
+		for (guint i = 0; i < checksums->len; i++) {
+			const gchar *checksum = g_ptr_array_index(checksums, i);
 			fwupd_release_add_checksum(FWUPD_RELEASE(release), checksum);
 		}
 	}
@@ -2600,11 +3385,19 @@ fu_engine_install_release(FuEngine *self,
 
 	/* add device to database */
 	if ((flags & FWUPD_INSTALL_FLAG_NO_HISTORY) == 0) {
+		gboolean ret;
+		gint64 start_us;
+
 		if (!fu_engine_add_release_metadata(self, release, error))
 			return FALSE;
 		if (!fu_engine_add_release_plugin_metadata(self, release, plugin, error))
 			return FALSE;
-		if (!fu_history_add_device(self->history, device, release, error))
+		start_us = g_get_monotonic_time();
+		ret = fu_history_add_device(self->history, device, release, error);
+		fu_metrics_add_duration_since(fu_context_get_metrics(self->ctx),
+					      "HistoryWrite",
+					      start_us);
+		if (!ret)
 			return FALSE;
 	}
 
@@ -2702,6 +3495,15 @@ fu_engine_emulation_load(FuEngine *self, GInputStream *stream, GError **error)
 	return fu_engine_emulator_load(self->emulation, stream, error);
 }
 
+gboolean
+fu_engine_emulation_load_bytes(FuEngine *self, GBytes *blob, GError **error)
+{
+	g_return_val_if_fail(FU_IS_ENGINE(self), FALSE);
+	g_return_val_if_fail(blob != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+	return fu_engine_emulator_load_bytes(self->emulation, blob, error);
+}
+
 gboolean
 fu_engine_emulation_save(FuEngine *self, GOutputStream *stream, GError **error)
 {
@@ -3609,30 +4411,786 @@ fu_engine_install_blob(FuEngine *self,
 	return TRUE;
 }
 
-static FuDevice *
-fu_engine_get_item_by_id_fallback_history(FuEngine *self, const gchar *id, GError **error)
+
+/* the state of installing one release in a parallel install lane, shared between the steps run
+ * in the main thread and the firmware write, which runs in the lane worker thread */
+typedef struct {
+	FuEngine *self;	    /* no ref */
+	FuRelease *release; /* no ref */
+	FuDevice *device;
+	gchar *device_id;
+	GInputStream *stream_fw;
+	FuProgress *progress; /* no ref */
+	FwupdInstallFlags flags;
+	FwupdFeatureFlags feature_flags;
+	GTimer *timer;			   /* (nullable) */
+	FuDeviceProgress *device_progress; /* (nullable) */
+	guint write_cnt;
+	gboolean write_complete;
+	gboolean write_ret;
+	FuDevice *device_loop;			 /* (nullable) */
+	FuProgress *progress_loop;		 /* (nullable) no ref */
+	FuFirmware *firmware;			 /* (nullable) */
+	FuDevice *device_write;			 /* (nullable) */
+	FuProgress *progress_write;		 /* (nullable) no ref */
+	FuDeviceProgress *device_progress_write; /* (nullable) */
+	FuDeviceLocker *poll_locker;		 /* (nullable) */
+	FuPlugin *plugin;			 /* (nullable) no ref */
+	GPtrArray *devices_frozen;		 /* of FuDevice */
+	GError *error_write;			 /* (nullable) */
+	GError *error_install;			 /* (nullable) no ref */
+} FuEngineInstallLaneHelper;
+
+static FuEngineInstallLaneHelper *
+fu_engine_install_lane_helper_new(FuEngine *self,
+				  FuRelease *release,
+				  GInputStream *stream_fw,
+				  FuProgress *progress,
+				  FwupdInstallFlags flags,
+				  FwupdFeatureFlags feature_flags)
+{
+	FuEngineInstallLaneHelper *helper = g_new0(FuEngineInstallLaneHelper, 1);
+	helper->self = self;
+	helper->release = release;
+	helper->device = g_object_ref(fu_release_get_device(release));
+	helper->device_id = g_strdup(fu_device_get_id(helper->device));
+	helper->stream_fw = g_object_ref(stream_fw);
+	helper->progress = progress;
+	helper->flags = flags;
+	helper->feature_flags = feature_flags;
+	helper->devices_frozen = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	return helper;
+}
+
+/* the objects that emit signals have already been released in the main thread */
+static void
+fu_engine_install_lane_helper_free(FuEngineInstallLaneHelper *helper)
 {
-	g_autoptr(GPtrArray) devices = NULL;
+	g_object_unref(helper->device);
+	g_object_unref(helper->stream_fw);
+	if (helper->timer != NULL)
+		g_timer_destroy(helper->timer);
+	g_ptr_array_unref(helper->devices_frozen);
+	g_free(helper->device_id);
+	g_free(helper);
+}
 
-	/* not a wildcard */
-	if (g_strcmp0(id, FWUPD_DEVICE_ID_ANY) != 0) {
-		g_autoptr(FuDevice) dev = NULL;
-		g_autoptr(GError) error_local = NULL;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuEngineInstallLaneHelper, fu_engine_install_lane_helper_free)
 
-		/* get this one device */
-		dev = fu_history_get_device_by_id(self->history, id, &error_local);
-		if (dev == NULL) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOTHING_TO_DO,
-				    "Failed to find %s in history database: %s",
-				    id,
-				    error_local->message);
-			return NULL;
+/* the caller must be in the main thread */
+static gboolean
+fu_engine_install_lane_release_prepare_cb(gpointer user_data, GError **error)
+{
+	FuEngineInstallLaneHelper *helper = (FuEngineInstallLaneHelper *)user_data;
+	FuEngine *self = helper->self;
+	FuRelease *release = helper->release;
+	FuDevice *device = helper->device;
+	FuPlugin *plugin;
+	const gchar *tmp;
+
+	/* add the checksum of the blob if not already set, which is only required when the release
+	 * was not loaded from a cabinet as fu_release_load() uses the container checksums */
+	if (fwupd_release_get_checksums(FWUPD_RELEASE(release))->len == 0) {
+		GChecksumType checksum_types[] = {G_CHECKSUM_SHA256, G_CHECKSUM_SHA1};
+		g_autoptr(GPtrArray) checksums = NULL;
+
+		checksums = fu_input_stream_compute_checksums(helper->stream_fw,
+							      checksum_types,
+							      G_N_ELEMENTS(checksum_types),
+							      error);
+		if (checksums == NULL)
+			return FALSE;
+		for (guint i = 0; i < checksums->len; i++) {
+			const gchar *checksum = g_ptr_array_index(checksums, i);
+			fwupd_release_add_checksum(FWUPD_RELEASE(release), checksum);
 		}
+	}
 
-		/* only useful */
-		if (fu_device_get_update_state(dev) == FWUPD_UPDATE_STATE_SUCCESS ||
+	/* not in bootloader mode */
+	if (!fu_device_has_flag(device, FWUPD_DEVICE_FLAG_IS_BOOTLOADER)) {
+		/* both optional; the plugin can specify a fallback */
+		tmp = fwupd_release_get_detach_caption(FWUPD_RELEASE(release));
+		if (tmp != NULL)
+			fu_device_set_update_message(device, tmp);
+		tmp = fwupd_release_get_detach_image(FWUPD_RELEASE(release));
+		if (tmp != NULL)
+			fu_device_set_update_image(device, tmp);
+	}
+
+	/* save to persistent storage so that the device can recover without a network */
+	if (fu_device_has_private_flag(device, FU_DEVICE_PRIVATE_FLAG_SAVE_INTO_BACKUP_REMOTE)) {
+		g_autoptr(GBytes) blob_cab =
+		    fu_input_stream_read_bytes(helper->stream_fw, 0, G_MAXSIZE, NULL, error);
+		if (blob_cab == NULL)
+			return FALSE;
+		if (!fu_engine_save_into_backup_remote(self, blob_cab, error))
+			return FALSE;
+	}
+
+	/* set this for the callback */
+	self->write_history = (helper->flags & FWUPD_INSTALL_FLAG_NO_HISTORY) == 0;
+
+	/* get the plugin */
+	plugin =
+	    fu_plugin_list_find_by_name(self->plugin_list, fu_device_get_plugin(device), error);
+	if (plugin == NULL)
+		return FALSE;
+
+	/* add device to database */
+	if ((helper->flags & FWUPD_INSTALL_FLAG_NO_HISTORY) == 0) {
+		gboolean ret;
+		gint64 start_us;
+
+		if (!fu_engine_add_release_metadata(self, release, error))
+			return FALSE;
+		if (!fu_engine_add_release_plugin_metadata(self, release, plugin, error))
+			return FALSE;
+		start_us = g_get_monotonic_time();
+		ret = fu_history_add_device(self->history, device, release, error);
+		fu_metrics_add_duration_since(fu_context_get_metrics(self->ctx),
+					      "HistoryWrite",
+					      start_us);
+		if (!ret)
+			return FALSE;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+/* the caller must be in the main thread */
+static gboolean
+fu_engine_install_lane_release_failed_cb(gpointer user_data, GError **error)
+{
+	FuEngineInstallLaneHelper *helper = (FuEngineInstallLaneHelper *)user_data;
+	FuDevice *device_orig = fu_release_get_device(helper->release);
+	FwupdUpdateState state = fu_device_get_update_state(helper->device);
+
+	if (state != FWUPD_UPDATE_STATE_FAILED && state != FWUPD_UPDATE_STATE_FAILED_TRANSIENT)
+		fu_device_set_update_state(device_orig, FWUPD_UPDATE_STATE_FAILED);
+	else
+		fu_device_set_update_state(device_orig, state);
+	fu_device_set_update_error(device_orig, helper->error_install->message);
+	return TRUE;
+}
+
+/* the caller must be in the main thread */
+static gboolean
+fu_engine_install_lane_release_finish_cb(gpointer user_data, GError **error)
+{
+	FuEngineInstallLaneHelper *helper = (FuEngineInstallLaneHelper *)user_data;
+	FuEngine *self = helper->self;
+	FuDevice *device_orig = fu_release_get_device(helper->release);
+	g_autoptr(FuDevice) device = NULL;
+
+	/* the device may have changed */
+	device = fu_device_list_get_by_id(self->device_list, helper->device_id, error);
+	if (device == NULL) {
+		g_prefix_error(error, "failed to get device after install: ");
+		return FALSE;
+	}
+
+	/* update state (which updates the database if required) */
+	if (fu_device_has_flag(device, FWUPD_DEVICE_FLAG_NEEDS_REBOOT) ||
+	    fu_device_has_flag(device, FWUPD_DEVICE_FLAG_NEEDS_SHUTDOWN)) {
+		fu_device_set_update_state(device_orig, FWUPD_UPDATE_STATE_NEEDS_REBOOT);
+		return TRUE;
+	}
+
+	/* mark success unless needs a reboot */
+	if (fu_device_get_update_state(device) != FWUPD_UPDATE_STATE_NEEDS_REBOOT)
+		fu_device_set_update_state(device, FWUPD_UPDATE_STATE_SUCCESS);
+
+	/* success */
+	return TRUE;
+}
+
+/* property notifications from a lane worker thread are deferred until thawed in the main thread,
+ * as the handlers write to the history database and emit the engine signals -- and the backend
+ * events for the device are deferred too, as another lane may be iterating the main context */
+static void
+fu_engine_install_lane_helper_freeze(FuEngineInstallLaneHelper *helper, FuDevice *device)
+{
+	if (g_ptr_array_find(helper->devices_frozen, device, NULL))
+		return;
+	g_object_freeze_notify(G_OBJECT(device));
+	g_ptr_array_add(helper->devices_frozen, g_object_ref(device));
+	g_ptr_array_add(helper->self->install_writing, g_object_ref(device));
+}
+
+static void
+fu_engine_install_lane_helper_thaw(FuEngineInstallLaneHelper *helper)
+{
+	if (helper->devices_frozen->len == 0)
+		return;
+	for (guint i = 0; i < helper->devices_frozen->len; i++) {
+		FuDevice *device = g_ptr_array_index(helper->devices_frozen, i);
+		g_ptr_array_remove(helper->self->install_writing, device);
+		g_object_thaw_notify(G_OBJECT(device));
+	}
+	g_ptr_array_set_size(helper->devices_frozen, 0);
+	fu_engine_install_replay_backend_events(helper->self);
+}
+
+/* the caller must be in the main thread */
+static void
+fu_engine_install_lane_helper_write_clear(FuEngineInstallLaneHelper *helper)
+{
+	fu_engine_install_lane_helper_thaw(helper);
+	g_clear_error(&helper->error_write);
+	g_clear_object(&helper->device_progress_write);
+	g_clear_object(&helper->poll_locker);
+	g_clear_object(&helper->device_write);
+	helper->progress_write = NULL;
+	helper->plugin = NULL;
+}
+
+/* the caller must be in the main thread */
+static void
+fu_engine_install_lane_helper_loop_clear(FuEngineInstallLaneHelper *helper)
+{
+	fu_engine_install_lane_helper_write_clear(helper);
+	g_clear_object(&helper->firmware);
+	g_clear_object(&helper->device_loop);
+	helper->progress_loop = NULL;
+}
+
+/* runs in the main thread, as the device progress sets the device status when finalized */
+static gboolean
+fu_engine_install_lane_helper_clear_cb(gpointer user_data, GError **error)
+{
+	FuEngineInstallLaneHelper *helper = (FuEngineInstallLaneHelper *)user_data;
+	fu_engine_install_lane_helper_loop_clear(helper);
+	g_clear_object(&helper->device_progress);
+	return TRUE;
+}
+
+/* the caller must be in the main thread */
+static gboolean
+fu_engine_install_lane_write_prepare(FuEngineInstallLaneHelper *helper,
+				     FuProgress *progress,
+				     GError **error)
+{
+	FuEngine *self = helper->self;
+	FuDevice *proxy;
+	GPtrArray *children;
+	g_autofree gchar *str = NULL;
+	g_autoptr(FuDevice) root = NULL;
+
+	/* the device and plugin both may have changed */
+	helper->device_write = fu_engine_get_device(self, helper->device_id, error);
+	if (helper->device_write == NULL) {
+		g_prefix_error(error, "failed to get device before update: ");
+		return FALSE;
+	}
+	helper->progress_write = progress;
+	helper->device_progress_write = fu_device_progress_new(helper->device_write, progress);
+	g_return_val_if_fail(helper->device_progress_write != NULL, FALSE);
+
+	/* pause the polling */
+	helper->poll_locker = fu_device_poll_locker_new(helper->device_write, error);
+	if (helper->poll_locker == NULL)
+		return FALSE;
+
+	str = fu_device_to_string(helper->device_write);
+	g_info("update -> %s", str);
+	helper->plugin = fu_plugin_list_find_by_name(self->plugin_list,
+						     fu_device_get_plugin(helper->device_write),
+						     error);
+	if (helper->plugin == NULL)
+		return FALSE;
+
+	/* the write is going to be run in the lane worker thread */
+	children = fu_device_get_children(helper->device_write);
+	root = fu_device_get_root(helper->device_write);
+	fu_engine_install_lane_helper_freeze(helper, helper->device);
+	fu_engine_install_lane_helper_freeze(helper, helper->device_write);
+	proxy = fu_device_get_proxy_with_fallback(helper->device_write);
+	fu_engine_install_lane_helper_freeze(helper, proxy);
+	fu_engine_install_lane_helper_freeze(helper, root);
+	for (guint i = 0; i < children->len; i++)
+		fu_engine_install_lane_helper_freeze(helper, g_ptr_array_index(children, i));
+
+	/* success */
+	return TRUE;
+}
+
+/* the caller must be in the main thread */
+static gboolean
+fu_engine_install_lane_write_finish(FuEngineInstallLaneHelper *helper, GError **error)
+{
+	FuEngine *self = helper->self;
+	FuDevice *device = helper->device_write;
+
+	/* emit the notifications from the write */
+	fu_engine_install_lane_helper_thaw(helper);
+
+	if (!helper->write_ret) {
+		FuProgress *progress = helper->progress_write;
+		g_autofree gchar *str_write = NULL;
+		g_autoptr(GError) error_attach = NULL;
+		g_autoptr(GError) error_cleanup = NULL;
+		g_autoptr(GError) error_write = g_steal_pointer(&helper->error_write);
+
+		if (g_error_matches(error_write, FWUPD_ERROR, FWUPD_ERROR_AC_POWER_REQUIRED) ||
+		    g_error_matches(error_write, FWUPD_ERROR, FWUPD_ERROR_BATTERY_LEVEL_TOO_LOW) ||
+		    g_error_matches(error_write, FWUPD_ERROR, FWUPD_ERROR_NEEDS_USER_ACTION) ||
+		    g_error_matches(error_write, FWUPD_ERROR, FWUPD_ERROR_BROKEN_SYSTEM)) {
+			fu_device_set_update_state(device, FWUPD_UPDATE_STATE_FAILED_TRANSIENT);
+		} else {
+			fu_device_set_update_state(device, FWUPD_UPDATE_STATE_FAILED);
+		}
+
+		/* this is really helpful for debugging, as we want to dump the device *before*
+		 * we run cleanup */
+		str_write = fu_device_to_string(device);
+		g_debug("failed write-firmware '%s': %s", error_write->message, str_write);
+
+		/* attach back into runtime then cleanup */
+		if (!fu_device_has_flag(device, FWUPD_DEVICE_FLAG_EMULATED)) {
+			fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_ATTACH);
+			fu_progress_reset(progress);
+			if (!fu_plugin_runner_attach(helper->plugin,
+						     device,
+						     progress,
+						     &error_attach)) {
+				g_warning("failed to attach device after failed update: %s",
+					  error_attach->message);
+			}
+			fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_CLEANUP);
+			fu_progress_reset(progress);
+			if (!fu_engine_cleanup(self,
+					       helper->device_id,
+					       progress,
+					       helper->flags,
+					       &error_cleanup)) {
+				g_warning("failed to update-cleanup after failed update: %s",
+					  error_cleanup->message);
+			}
+		}
+
+		/* return error to client */
+		g_propagate_error(error, g_steal_pointer(&error_write));
+		return FALSE;
+	}
+
+	/* abort loop before waiting for replug */
+	if (fu_device_has_private_flag(device, FU_DEVICE_PRIVATE_FLAG_INSTALL_LOOP_RESTART))
+		return TRUE;
+
+	/* wait for any device to disconnect and reconnect */
+	if (!fu_device_list_wait_for_replug(self->device_list, error)) {
+		g_prefix_error(error, "failed to wait for write-firmware replug: ");
+		return FALSE;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+/* the caller must be in the main thread */
+static gboolean
+fu_engine_install_lane_loop_prepare_cb(gpointer user_data, GError **error)
+{
+	FuEngineInstallLaneHelper *helper = (FuEngineInstallLaneHelper *)user_data;
+	FuEngine *self = helper->self;
+	FuProgress *progress = fu_progress_get_child(helper->progress);
+	const gchar *device_id = helper->device_id;
+
+	helper->progress_loop = progress;
+
+	/* not ideal; but best we can do as we don't know how many writes are required */
+	fu_progress_reset(progress);
+
+	/* progress */
+	if (!fu_engine_set_progress(self, device_id, progress, error))
+		return FALSE;
+	if (fu_progress_get_steps(progress) == 0) {
+		fu_progress_set_id(progress, G_STRLOC);
+		fu_progress_add_flag(progress, FU_PROGRESS_FLAG_GUESSED);
+		fu_progress_add_step(progress, FWUPD_STATUS_DECOMPRESSING, 1, NULL);
+		fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_RESTART, 2, NULL);
+		fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_WRITE, 94, NULL);
+		fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_RESTART, 2, NULL);
+		fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_BUSY, 2, NULL);
+	} else if (fu_progress_get_steps(progress) != 5) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INTERNAL,
+				    "FuDevice->set_progress did not set "
+				    "prepare-firmware,detach,write,attach,reload steps");
+		return FALSE;
+	}
+
+	/* some emulations are storing events on the bootloader device */
+	helper->device_loop = fu_engine_get_device(self, device_id, error);
+	if (helper->device_loop == NULL) {
+		g_prefix_error(error, "failed to get device for flags: ");
+		return FALSE;
+	}
+
+	/* do not rely on the plugin clearing these */
+	if (fu_device_has_private_flag(helper->device_loop,
+				       FU_DEVICE_PRIVATE_FLAG_INSTALL_LOOP_RESTART)) {
+		g_debug("clearing install-loop-restart");
+		fu_device_remove_private_flag(helper->device_loop,
+					      FU_DEVICE_PRIVATE_FLAG_INSTALL_LOOP_RESTART);
+	}
+	if (fu_device_has_flag(helper->device_loop, FWUPD_DEVICE_FLAG_ANOTHER_WRITE_REQUIRED)) {
+		g_debug("clearing another-write-required");
+		fu_device_remove_flag(helper->device_loop,
+				      FWUPD_DEVICE_FLAG_ANOTHER_WRITE_REQUIRED);
+	}
+
+	/* detach->parse->install or parse->detach->install */
+	if (fu_device_has_private_flag(helper->device_loop,
+				       FU_DEVICE_PRIVATE_FLAG_DETACH_PREPARE_FIRMWARE)) {
+		/* detach to bootloader mode */
+		fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_DETACH);
+		if (!fu_engine_detach(self,
+				      device_id,
+				      fu_progress_get_child(progress),
+				      helper->feature_flags,
+				      error)) {
+			g_prefix_error(error, "failed to detach: ");
+			return FALSE;
+		}
+		fu_progress_step_done(progress);
+
+		/* parse firmware */
+		fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_INSTALL);
+		helper->firmware = fu_engine_prepare_firmware(self,
+							      device_id,
+							      helper->stream_fw,
+							      fu_progress_get_child(progress),
+							      FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM,
+							      error);
+		if (helper->firmware == NULL)
+			return FALSE;
+		fu_progress_step_done(progress);
+	} else {
+		/* parse firmware */
+		helper->firmware = fu_engine_prepare_firmware(self,
+							      device_id,
+							      helper->stream_fw,
+							      fu_progress_get_child(progress),
+							      FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM,
+							      error);
+		if (helper->firmware == NULL)
+			return FALSE;
+		fu_progress_step_done(progress);
+
+		/* detach to bootloader mode */
+		fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_DETACH);
+		if (!fu_engine_detach(self,
+				      device_id,
+				      fu_progress_get_child(progress),
+				      helper->feature_flags,
+				      error)) {
+			g_prefix_error(error, "failed to detach: ");
+			return FALSE;
+		}
+		fu_progress_step_done(progress);
+		fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_INSTALL);
+	}
+
+	/* get ready to install */
+	if (!fu_engine_install_lane_write_prepare(helper, fu_progress_get_child(progress), error)) {
+		g_prefix_error(error, "failed to write-firmware: ");
+		return FALSE;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+/* the caller must be in the main thread */
+static gboolean
+fu_engine_install_lane_loop_finish(FuEngineInstallLaneHelper *helper, GError **error)
+{
+	FuEngine *self = helper->self;
+	FuProgress *progress = helper->progress_loop;
+	const gchar *device_id = helper->device_id;
+	gboolean ret;
+	g_autoptr(FuDevice) device_tmp = NULL;
+
+	/* install */
+	ret = fu_engine_install_lane_write_finish(helper, error);
+	fu_engine_install_lane_helper_write_clear(helper);
+	if (!ret) {
+		g_prefix_error(error, "failed to write-firmware: ");
+		return FALSE;
+	}
+	fu_progress_step_done(progress);
+
+	/* abort loop */
+	if (fu_device_has_private_flag(helper->device_loop,
+				       FU_DEVICE_PRIVATE_FLAG_INSTALL_LOOP_RESTART)) {
+		g_debug("restarting install loop, aborting with success");
+		return TRUE;
+	}
+
+	/* attach into runtime mode */
+	fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_ATTACH);
+	if (!fu_engine_attach(self, device_id, fu_progress_get_child(progress), error)) {
+		g_prefix_error(error, "failed to attach: ");
+		return FALSE;
+	}
+	fu_progress_step_done(progress);
+
+	/* abort loop */
+	if (fu_device_has_private_flag(helper->device_loop,
+				       FU_DEVICE_PRIVATE_FLAG_INSTALL_LOOP_RESTART)) {
+		g_debug("restarting install loop, aborting with success");
+		return TRUE;
+	}
+
+	/* get the new version number */
+	fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_RELOAD);
+	if (!fu_engine_reload(self, device_id, error)) {
+		g_prefix_error(error, "failed to reload: ");
+		return FALSE;
+	}
+	fu_progress_step_done(progress);
+
+	/* abort loop */
+	device_tmp = fu_engine_get_device(self, device_id, error);
+	if (device_tmp == NULL) {
+		g_prefix_error(error, "failed to get device after reload: ");
+		return FALSE;
+	}
+	if (fu_device_has_flag(device_tmp, FWUPD_DEVICE_FLAG_ANOTHER_WRITE_REQUIRED)) {
+		g_debug("another write required, aborting with success");
+		return TRUE;
+	}
+
+	/* success */
+	helper->write_complete = TRUE;
+	return TRUE;
+}
+
+static gboolean
+fu_engine_install_lane_loop_finish_cb(gpointer user_data, GError **error)
+{
+	FuEngineInstallLaneHelper *helper = (FuEngineInstallLaneHelper *)user_data;
+	gboolean ret = fu_engine_install_lane_loop_finish(helper, error);
+	fu_engine_install_lane_helper_loop_clear(helper);
+	return ret;
+}
+
+static gboolean
+fu_engine_install_lane_loop(FuEngineInstallLaneHelper *helper, GError **error)
+{
+	FuEngine *self = helper->self;
+
+	/* detach and parse the firmware */
+	if (!fu_engine_install_invoke(self, fu_engine_install_lane_loop_prepare_cb, helper, error))
+		return FALSE;
+
+	/* only the device and the plugin ->write_firmware() vfunc are used from a lane worker
+	 * thread, and a failure is handled in the main thread */
+	helper->write_ret = fu_plugin_runner_write_firmware(helper->plugin,
+							    helper->device_write,
+							    helper->firmware,
+							    helper->progress_write,
+							    helper->flags,
+							    &helper->error_write);
+
+	/* attach and reload */
+	return fu_engine_install_invoke(self, fu_engine_install_lane_loop_finish_cb, helper, error);
+}
+
+/* the caller must be in the main thread */
+static gboolean
+fu_engine_install_lane_blob_prepare_cb(gpointer user_data, GError **error)
+{
+	FuEngineInstallLaneHelper *helper = (FuEngineInstallLaneHelper *)user_data;
+	FuEngine *self = helper->self;
+	FuProgress *progress = helper->progress;
+	gsize streamsz = 0;
+
+	helper->timer = g_timer_new();
+	helper->device_progress = fu_device_progress_new(helper->device, progress);
+	g_return_val_if_fail(helper->device_progress != NULL, FALSE);
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_add_flag(progress, FU_PROGRESS_FLAG_NO_PROFILE);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_BUSY, 1, "prepare");
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_WRITE, 98, NULL);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_BUSY, 1, "cleanup");
+
+	/* test the firmware is not an empty blob */
+	if (!fu_input_stream_size(helper->stream_fw, &streamsz, error))
+		return FALSE;
+	if (streamsz == 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_FILE,
+			    "Firmware is invalid as has zero size");
+		return FALSE;
+	}
+
+	/* mark this as modified even if we actually fail to do the update */
+	fu_device_set_modified_usec(helper->device, g_get_real_time());
+
+	/* signal to all the plugins the update is about to happen */
+	fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_PREPARE);
+	if (!fu_engine_prepare(self,
+			       helper->device_id,
+			       fu_progress_get_child(progress),
+			       helper->flags,
+			       error))
+		return FALSE;
+	fu_progress_step_done(progress);
+	return TRUE;
+}
+
+/* the caller must be in the main thread */
+static gboolean
+fu_engine_install_lane_blob_finish_cb(gpointer user_data, GError **error)
+{
+	FuEngineInstallLaneHelper *helper = (FuEngineInstallLaneHelper *)user_data;
+	FuEngine *self = helper->self;
+	FuProgress *progress = helper->progress;
+
+	fu_progress_step_done(progress);
+
+	/* update history database */
+	fu_device_set_update_state(helper->device, FWUPD_UPDATE_STATE_SUCCESS);
+	fu_device_set_install_duration(helper->device, g_timer_elapsed(helper->timer, NULL));
+	if ((helper->flags & FWUPD_INSTALL_FLAG_NO_HISTORY) == 0) {
+		if (!fu_history_modify_device(self->history, helper->device, error)) {
+			g_prefix_error(error, "failed to set success: ");
+			return FALSE;
+		}
+	}
+
+	/* signal to all the plugins the update has happened */
+	fu_engine_set_emulator_phase(self, FU_ENGINE_EMULATOR_PHASE_CLEANUP);
+	if (!fu_engine_cleanup(self,
+			       helper->device_id,
+			       fu_progress_get_child(progress),
+			       helper->flags,
+			       error))
+		return FALSE;
+	fu_progress_step_done(progress);
+
+	/* make the UI update */
+	fu_engine_emit_device_changed(self, helper->device_id);
+	g_info("Updating %s took %f seconds",
+	       fu_device_get_name(helper->device),
+	       g_timer_elapsed(helper->timer, NULL));
+	return TRUE;
+}
+
+static gboolean
+fu_engine_install_lane_blob(FuEngineInstallLaneHelper *helper, GError **error)
+{
+	FuEngine *self = helper->self;
+
+	/* signal to all the plugins the update is about to happen */
+	if (!fu_engine_install_invoke(self, fu_engine_install_lane_blob_prepare_cb, helper, error))
+		return FALSE;
+
+	/* plugins can set FWUPD_DEVICE_FLAG_ANOTHER_WRITE_REQUIRED to run again, but they
+	 * must return TRUE rather than an error -- use a per-install counter as the releases for
+	 * other devices may be installed at the same time */
+	for (helper->write_cnt = 0;
+	     helper->write_cnt < FU_ENGINE_EMULATOR_WRITE_COUNT_MAX && !helper->write_complete;
+	     helper->write_cnt++) {
+		if (!fu_engine_install_lane_loop(helper, error))
+			return FALSE;
+	}
+	if (!helper->write_complete) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INTERNAL,
+			    "aborting device write loop, limit %u",
+			    (guint)FU_ENGINE_EMULATOR_WRITE_COUNT_MAX);
+		return FALSE;
+	}
+
+	/* update the history database and signal to all the plugins the update has happened */
+	return fu_engine_install_invoke(self, fu_engine_install_lane_blob_finish_cb, helper, error);
+}
+
+/* the steps that use the history database, the plugins or emit signals are run in the main
+ * thread, and only the firmware write is run in the lane worker thread */
+static gboolean
+fu_engine_install_lane_release(FuEngine *self,
+			       FuRelease *release,
+			       FuProgress *progress,
+			       FwupdInstallFlags flags,
+			       GError **error)
+{
+	FuEngineRequest *request = fu_release_get_request(release);
+	FwupdFeatureFlags feature_flags = FWUPD_FEATURE_FLAG_NONE;
+	gboolean ret;
+	g_autoptr(FuEngineInstallLaneHelper) helper = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	/* optional for tests */
+	if (request != NULL)
+		feature_flags = fu_engine_request_get_feature_flags(request);
+	helper = fu_engine_install_lane_helper_new(self,
+						   release,
+						   fu_release_get_stream(release),
+						   progress,
+						   flags,
+						   feature_flags);
+
+	/* add device to database */
+	if (!fu_engine_install_invoke(self,
+				      fu_engine_install_lane_release_prepare_cb,
+				      helper,
+				      error))
+		return FALSE;
+
+	/* install firmware blob */
+	ret = fu_engine_install_lane_blob(helper, &error_local);
+	fu_engine_install_invoke(self, fu_engine_install_lane_helper_clear_cb, helper, NULL);
+	if (!ret) {
+		helper->error_install = error_local;
+		fu_engine_install_invoke(self,
+					 fu_engine_install_lane_release_failed_cb,
+					 helper,
+					 NULL);
+		g_propagate_error(error, g_steal_pointer(&error_local));
+		return FALSE;
+	}
+
+	/* update state */
+	return fu_engine_install_invoke(self,
+					fu_engine_install_lane_release_finish_cb,
+					helper,
+					error);
+}
+
+static FuDevice *
+fu_engine_get_item_by_id_fallback_history(FuEngine *self, const gchar *id, GError **error)
+{
+	g_autoptr(GPtrArray) devices = NULL;
+
+	/* not a wildcard */
+	if (g_strcmp0(id, FWUPD_DEVICE_ID_ANY) != 0) {
+		g_autoptr(FuDevice) dev = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		/* get this one device */
+		dev = fu_history_get_device_by_id(self->history, id, &error_local);
+		if (dev == NULL) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOTHING_TO_DO,
+				    "Failed to find %s in history database: %s",
+				    id,
+				    error_local->message);
+			return NULL;
+		}
+
+		/* only useful */
+		if (fu_device_get_update_state(dev) == FWUPD_UPDATE_STATE_SUCCESS ||
 		    fu_device_get_update_state(dev) == FWUPD_UPDATE_STATE_FAILED_TRANSIENT ||
 		    fu_device_get_update_state(dev) == FWUPD_UPDATE_STATE_FAILED) {
 			return g_steal_pointer(&dev);
@@ -3665,46 +5223,119 @@ fu_engine_get_item_by_id_fallback_history(FuEngine *self, const gchar *id, GErro
 	return NULL;
 }
 
+static void
+fu_engine_silo_free(FuEngineSilo *engine_silo)
+{
+	g_free(engine_silo->id);
+	g_free(engine_silo->basename);
+	g_free(engine_silo->cache_key);
+	if (engine_silo->silo != NULL)
+		g_object_unref(engine_silo->silo);
+	if (engine_silo->query_tag_by_guid_version != NULL)
+		g_object_unref(engine_silo->query_tag_by_guid_version);
+	g_hash_table_unref(engine_silo->components_by_guid);
+	if (engine_silo->release_by_checksum != NULL)
+		g_hash_table_unref(engine_silo->release_by_checksum);
+	g_free(engine_silo);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuEngineSilo, fu_engine_silo_free)
+
+static FuEngineSilo *
+fu_engine_silo_new(const gchar *id, const gchar *basename, const gchar *cache_key, XbSilo *silo)
+{
+	FuEngineSilo *engine_silo = g_new0(FuEngineSilo, 1);
+	engine_silo->id = g_strdup(id);
+	engine_silo->basename = g_strdup(basename);
+	engine_silo->cache_key = g_strdup(cache_key);
+	engine_silo->silo = g_object_ref(silo);
+	engine_silo->components_by_guid =
+	    g_hash_table_new_full(g_str_hash,
+				  g_str_equal,
+				  g_free,
+				  (GDestroyNotify)g_ptr_array_unref);
+	return engine_silo;
+}
+
+/* the flashed GUIDs of every component, without running XPath for each GUID */
+static void
+fu_engine_create_silo_index_guids(FuEngineSilo *engine_silo)
+{
+	g_autoptr(GPtrArray) components =
+	    xb_silo_query(engine_silo->silo, "components/component", 0, NULL);
+	if (components == NULL)
+		return;
+	for (guint i = 0; i < components->len; i++) {
+		XbNode *component = g_ptr_array_index(components, i);
+		g_autoptr(GPtrArray) firmwares = NULL;
+		g_autoptr(GHashTable) guids_seen = g_hash_table_new(g_str_hash, g_str_equal);
+
+		firmwares = xb_node_query(component, "provides/firmware[@type='flashed']", 0, NULL);
+		if (firmwares == NULL)
+			continue;
+		for (guint j = 0; j < firmwares->len; j++) {
+			XbNode *firmware = g_ptr_array_index(firmwares, j);
+			const gchar *guid = xb_node_get_text(firmware);
+			GPtrArray *components_tmp;
+
+			/* a component can provide the same GUID more than once */
+			if (guid == NULL || g_hash_table_contains(guids_seen, guid))
+				continue;
+			g_hash_table_add(guids_seen, (gpointer)guid);
+			components_tmp = g_hash_table_lookup(engine_silo->components_by_guid, guid);
+			if (components_tmp == NULL) {
+				components_tmp =
+				    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+				g_hash_table_insert(engine_silo->components_by_guid,
+						    g_strdup(guid),
+						    components_tmp);
+			}
+			g_ptr_array_add(components_tmp, g_object_ref(component));
+		}
+	}
+}
+
 static gboolean
-fu_engine_create_silo_index(FuEngine *self, GError **error)
+fu_engine_create_silo_index(FuEngine *self, FuEngineSilo *engine_silo, GError **error)
 {
+	XbSilo *silo = engine_silo->silo;
 	g_autoptr(GPtrArray) components = NULL;
-	g_autoptr(GError) error_container_checksum1 = NULL;
-	g_autoptr(GError) error_container_checksum2 = NULL;
 	g_autoptr(GError) error_tag_by_guid_version = NULL;
 
+	/* prepare tag query with bound GUID parameter, typically only for the local silo */
+	engine_silo->query_tag_by_guid_version =
+	    xb_query_new_full(silo,
+			      "local/components/component[@merge='append']/provides/"
+			      "firmware[text()=?]/../../releases/release[@version=?]/../../"
+			      "tags/tag",
+			      XB_QUERY_FLAG_OPTIMIZE,
+			      &error_tag_by_guid_version);
+	if (engine_silo->query_tag_by_guid_version == NULL)
+		g_debug("ignoring prepared query: %s", error_tag_by_guid_version->message);
+
 	/* print what we've got */
-	components = xb_silo_query(self->silo, "components/component[@type='firmware']", 0, NULL);
+	components = xb_silo_query(silo, "components/component[@type='firmware']", 0, NULL);
 	if (components == NULL)
 		return TRUE;
-	g_info("%u components now in silo", components->len);
-
-	/* clear old prepared queries */
-	g_clear_object(&self->query_component_by_guid);
-	g_clear_object(&self->query_container_checksum1);
-	g_clear_object(&self->query_container_checksum2);
-	g_clear_object(&self->query_tag_by_guid_version);
+	g_info("%u components now in silo %s", components->len, engine_silo->id);
 
 	/* build the index */
-	if (!xb_silo_query_build_index(self->silo, "components/component", "type", error)) {
+	if (!xb_silo_query_build_index(silo, "components/component", "type", error)) {
 		fwupd_error_convert(error);
 		return FALSE;
 	}
-	if (!xb_silo_query_build_index(self->silo,
+	if (!xb_silo_query_build_index(silo,
 				       "components/component[@type='firmware']/provides/firmware",
 				       "type",
 				       error)) {
 		fwupd_error_convert(error);
 		return FALSE;
 	}
-	if (!xb_silo_query_build_index(self->silo,
-				       "components/component/provides/firmware",
-				       NULL,
-				       error)) {
+	if (!xb_silo_query_build_index(silo, "components/component/provides/firmware", NULL, error)) {
 		fwupd_error_convert(error);
 		return FALSE;
 	}
-	if (!xb_silo_query_build_index(self->silo,
+	if (!xb_silo_query_build_index(silo,
 				       "components/component[@type='firmware']/tags/tag",
 				       "namespace",
 				       error)) {
@@ -3712,47 +5343,11 @@ fu_engine_create_silo_index(FuEngine *self, GError **error)
 		return FALSE;
 	}
 
-	/* create prepared queries to save time later */
-	self->query_component_by_guid =
-	    xb_query_new_full(self->silo,
-			      "components/component/provides/firmware[@type=$'flashed'][text()=?]/"
-			      "../..",
-			      XB_QUERY_FLAG_OPTIMIZE,
-			      error);
-	if (self->query_component_by_guid == NULL) {
-		g_prefix_error(error, "failed to prepare query: ");
-		return FALSE;
-	}
-
-	/* old-style <checksum target="container"> and new-style <artifact> */
-	self->query_container_checksum1 =
-	    xb_query_new_full(self->silo,
-			      "components/component[@type='firmware']/releases/release/"
-			      "checksum[@target='container'][text()=?]/..",
-			      XB_QUERY_FLAG_OPTIMIZE,
-			      &error_container_checksum1);
-	if (self->query_container_checksum1 == NULL)
-		g_debug("ignoring prepared query: %s", error_container_checksum1->message);
-	self->query_container_checksum2 =
-	    xb_query_new_full(self->silo,
-			      "components/component[@type='firmware']/releases/release/"
-			      "artifacts/artifact[@type='binary']/checksum[text()=?]/"
-			      "../../..",
-			      XB_QUERY_FLAG_OPTIMIZE,
-			      &error_container_checksum2);
-	if (self->query_container_checksum2 == NULL)
-		g_debug("ignoring prepared query: %s", error_container_checksum2->message);
-
-	/* prepare tag query with bound GUID parameter */
-	self->query_tag_by_guid_version =
-	    xb_query_new_full(self->silo,
-			      "local/components/component[@merge='append']/provides/"
-			      "firmware[text()=?]/../../releases/release[@version=?]/../../"
-			      "tags/tag",
-			      XB_QUERY_FLAG_OPTIMIZE,
-			      &error_tag_by_guid_version);
-	if (self->query_tag_by_guid_version == NULL)
-		g_debug("ignoring prepared query: %s", error_tag_by_guid_version->message);
+	/* build the in-memory index for the hot lookups */
+	fu_engine_create_silo_index_guids(engine_silo);
+	g_info("silo %s indexed %u GUIDs",
+	       engine_silo->id,
+	       g_hash_table_size(engine_silo->components_by_guid));
 
 	/* success */
 	return TRUE;
@@ -3762,12 +5357,15 @@ fu_engine_create_silo_index(FuEngine *self, GError **error)
 void
 fu_engine_set_silo(FuEngine *self, XbSilo *silo)
 {
+	g_autoptr(FuEngineSilo) engine_silo = NULL;
 	g_autoptr(GError) error_local = NULL;
 	g_return_if_fail(FU_IS_ENGINE(self));
 	g_return_if_fail(XB_IS_SILO(silo));
-	g_set_object(&self->silo, silo);
-	if (!fu_engine_create_silo_index(self, &error_local))
+	engine_silo = fu_engine_silo_new("self-test", NULL, NULL, silo);
+	if (!fu_engine_create_silo_index(self, engine_silo, &error_local))
 		g_warning("failed to create indexes: %s", error_local->message);
+	g_ptr_array_set_size(self->silos, 0);
+	g_ptr_array_add(self->silos, g_steal_pointer(&engine_silo));
 }
 
 static gboolean
@@ -4010,134 +5608,329 @@ fu_engine_load_metadata_store_local(FuEngine *self,
 		xb_builder_import_source(builder, source);
 	}
 
-	/* success */
-	return TRUE;
+	/* success */
+	return TRUE;
+}
+
+static XbBuilder *
+fu_engine_metadata_builder_new(void)
+{
+	XbBuilder *builder = xb_builder_new();
+
+#ifdef SOURCE_VERSION
+	/* invalidate the cache if the fwupd version changes */
+	xb_builder_append_guid(builder, SOURCE_VERSION);
+#endif
+
+	/* verbose profiling */
+	if (g_getenv("FWUPD_XMLB_VERBOSE") != NULL) {
+		xb_builder_set_profile_flags(builder,
+					     XB_SILO_PROFILE_FLAG_XPATH |
+						 XB_SILO_PROFILE_FLAG_DEBUG);
+	}
+	return builder;
+}
+
+static FuEngineSilo *
+fu_engine_load_metadata_store_silo(FuEngine *self,
+				   XbBuilder *builder,
+				   const gchar *id,
+				   const gchar *basename,
+				   const gchar *cache_key,
+				   FuEngineLoadFlags flags,
+				   GError **error)
+{
+	XbBuilderCompileFlags compile_flags = XB_BUILDER_COMPILE_FLAG_IGNORE_INVALID;
+	g_autoptr(FuEngineSilo) engine_silo = NULL;
+	g_autoptr(GFile) xmlb = NULL;
+	g_autoptr(XbSilo) silo = NULL;
+
+	/* on a read-only filesystem don't care about the cache GUID */
+	if (flags & FU_ENGINE_LOAD_FLAG_READONLY)
+		compile_flags |= XB_BUILDER_COMPILE_FLAG_IGNORE_GUID;
+
+	/* ensure silo is up to date */
+	if (flags & FU_ENGINE_LOAD_FLAG_NO_CACHE) {
+		g_autoptr(GFileIOStream) iostr = NULL;
+		xmlb = g_file_new_tmp(NULL, &iostr, error);
+		if (xmlb == NULL)
+			return NULL;
+	} else {
+		g_autofree gchar *cachedirpkg = fu_path_from_kind(FU_PATH_KIND_CACHEDIR_PKG);
+		g_autofree gchar *xmlbfn =
+		    g_build_filename(cachedirpkg, "metadata", basename, NULL);
+		if (!fu_path_mkdir_parent(xmlbfn, error))
+			return NULL;
+		xmlb = g_file_new_for_path(xmlbfn);
+	}
+	silo = xb_builder_ensure(builder, xmlb, compile_flags, NULL, error);
+	if (silo == NULL) {
+		g_prefix_error(error, "cannot create %s: ", basename);
+		return NULL;
+	}
+	engine_silo = fu_engine_silo_new(id, basename, cache_key, silo);
+	if (!fu_engine_create_silo_index(self, engine_silo, error))
+		return NULL;
+	return g_steal_pointer(&engine_silo);
+}
+
+/* reuse the silo from the last load if the metadata has not changed */
+static FuEngineSilo *
+fu_engine_silos_find_by_cache_key(GPtrArray *silos, const gchar *id, const gchar *cache_key)
+{
+	for (guint i = 0; i < silos->len; i++) {
+		FuEngineSilo *engine_silo = g_ptr_array_index(silos, i);
+		if (engine_silo->cache_key == NULL)
+			continue;
+		if (g_strcmp0(engine_silo->id, id) == 0 &&
+		    g_strcmp0(engine_silo->cache_key, cache_key) == 0)
+			return engine_silo;
+	}
+	return NULL;
+}
+
+/* a reused silo is in both arrays, so remove it from one without freeing it */
+static void
+fu_engine_silos_steal_shared(GPtrArray *silos, GPtrArray *silos_other)
+{
+	for (guint i = 0; i < silos_other->len; i++) {
+		guint idx = 0;
+		if (g_ptr_array_find(silos, g_ptr_array_index(silos_other, i), &idx))
+			g_ptr_array_steal_index(silos, idx);
+	}
+}
+
+/* the metadata file is replaced or rewritten on refresh, so hashing it is not required */
+static gchar *
+fu_engine_load_metadata_store_cache_key(GFile *file, GError **error)
+{
+	g_autoptr(GFileInfo) info = NULL;
+
+	info = g_file_query_info(file,
+				 G_FILE_ATTRIBUTE_STANDARD_SIZE
+				 "," G_FILE_ATTRIBUTE_TIME_MODIFIED
+				 "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC
+				 "," G_FILE_ATTRIBUTE_UNIX_INODE,
+				 G_FILE_QUERY_INFO_NONE,
+				 NULL,
+				 error);
+	if (info == NULL) {
+		fwupd_error_convert(error);
+		return NULL;
+	}
+	return g_strdup_printf(
+	    "%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT ".%06u:%" G_GUINT64_FORMAT,
+	    (guint64)g_file_info_get_size(info),
+	    g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED),
+	    g_file_info_get_attribute_uint32(info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC),
+	    g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_UNIX_INODE));
+}
+
+/* returns a silo still owned by self->silos if the metadata is unchanged */
+static FuEngineSilo *
+fu_engine_load_metadata_store_remote(FuEngine *self,
+				     FwupdRemote *remote,
+				     FuEngineLoadFlags flags,
+				     GError **error)
+{
+	const gchar *path = fwupd_remote_get_filename_cache(remote);
+	g_autofree gchar *basename = g_strdup_printf("remote-%s.xmlb", fwupd_remote_get_id(remote));
+	g_autofree gchar *cache_key = NULL;
+	g_autoptr(GFile) file = g_file_new_for_path(path);
+	g_autoptr(XbBuilder) builder = fu_engine_metadata_builder_new();
+	g_autoptr(XbBuilderFixup) fixup = NULL;
+	g_autoptr(XbBuilderNode) custom = NULL;
+	g_autoptr(XbBuilderSource) source = xb_builder_source_new();
+	FuEngineSilo *engine_silo;
+
+	/* generate all metadata on demand */
+	if (fwupd_remote_get_kind(remote) == FWUPD_REMOTE_KIND_DIRECTORY) {
+		g_info("loading metadata for remote '%s'", fwupd_remote_get_id(remote));
+		if (!fu_engine_create_metadata(self, builder, remote, error))
+			return NULL;
+		return fu_engine_load_metadata_store_silo(self,
+							  builder,
+							  fwupd_remote_get_id(remote),
+							  basename,
+							  NULL,
+							  flags,
+							  error);
+	}
+
+	/* unchanged since the last load */
+	cache_key = fu_engine_load_metadata_store_cache_key(file, error);
+	if (cache_key == NULL)
+		return NULL;
+	engine_silo =
+	    fu_engine_silos_find_by_cache_key(self->silos, fwupd_remote_get_id(remote), cache_key);
+	if (engine_silo != NULL) {
+		g_debug("metadata for remote '%s' unchanged", fwupd_remote_get_id(remote));
+		fu_metrics_add_counter(fu_context_get_metrics(self->ctx), "MetadataSiloHit", 1);
+		return engine_silo;
+	}
+	fu_metrics_add_counter(fu_context_get_metrics(self->ctx), "MetadataSiloMiss", 1);
+	xb_builder_append_guid(builder, cache_key);
+
+	/* save the remote-id in the custom metadata space */
+	if (!xb_builder_source_load_file(source, file, XB_BUILDER_SOURCE_FLAG_NONE, NULL, error)) {
+		fwupd_error_convert(error);
+		return NULL;
+	}
+
+	/* fix up any legacy installed files */
+	fixup = xb_builder_fixup_new("AppStreamUpgrade", fu_engine_appstream_upgrade_cb, self, NULL);
+	xb_builder_fixup_set_max_depth(fixup, 3);
+	xb_builder_source_add_fixup(source, fixup);
+
+	/* add metadata */
+	custom = xb_builder_node_new("custom");
+	xb_builder_node_insert_text(custom, "value", path, "key", "fwupd::FilenameCache", NULL);
+	xb_builder_node_insert_text(custom,
+				    "value",
+				    fwupd_remote_get_id(remote),
+				    "key",
+				    "fwupd::RemoteId",
+				    NULL);
+	xb_builder_source_set_info(source, custom);
+	xb_builder_import_source(builder, source);
+	return fu_engine_load_metadata_store_silo(self,
+						  builder,
+						  fwupd_remote_get_id(remote),
+						  basename,
+						  cache_key,
+						  flags,
+						  error);
+}
+
+/* remove the silos of remotes that have been disabled or deleted */
+static void
+fu_engine_load_metadata_store_prune(FuEngine *self)
+{
+	g_autofree gchar *cachedirpkg = fu_path_from_kind(FU_PATH_KIND_CACHEDIR_PKG);
+	g_autofree gchar *metadata_path = g_build_filename(cachedirpkg, "metadata", NULL);
+	g_autofree gchar *legacy_fn = g_build_filename(cachedirpkg, "metadata.xmlb", NULL);
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) xmlb_fns = NULL;
+
+	/* the monolithic silo used before each remote had its own */
+	if (g_file_test(legacy_fn, G_FILE_TEST_EXISTS)) {
+		g_autoptr(GError) error_delete = NULL;
+		g_autoptr(GFile) file = g_file_new_for_path(legacy_fn);
+		g_info("removing legacy %s", legacy_fn);
+		if (!g_file_delete(file, NULL, &error_delete))
+			g_warning("failed to delete %s: %s", legacy_fn, error_delete->message);
+	}
+
+	xmlb_fns = fu_path_glob(metadata_path, "*.xmlb", &error_local);
+	if (xmlb_fns == NULL) {
+		g_debug("ignoring: %s", error_local->message);
+		return;
+	}
+	for (guint i = 0; i < xmlb_fns->len; i++) {
+		const gchar *fn = g_ptr_array_index(xmlb_fns, i);
+		gboolean in_use = FALSE;
+		g_autofree gchar *basename = g_path_get_basename(fn);
+		g_autoptr(GError) error_delete = NULL;
+		g_autoptr(GFile) file = NULL;
+
+		for (guint j = 0; j < self->silos->len; j++) {
+			FuEngineSilo *engine_silo = g_ptr_array_index(self->silos, j);
+			if (g_strcmp0(engine_silo->basename, basename) == 0) {
+				in_use = TRUE;
+				break;
+			}
+		}
+		if (in_use)
+			continue;
+		g_info("removing orphaned %s", fn);
+		file = g_file_new_for_path(fn);
+		if (!g_file_delete(file, NULL, &error_delete))
+			g_warning("failed to delete %s: %s", fn, error_delete->message);
+	}
 }
 
 static gboolean
 fu_engine_load_metadata_store(FuEngine *self, FuEngineLoadFlags flags, GError **error)
 {
 	GPtrArray *remotes;
-	XbBuilderCompileFlags compile_flags = XB_BUILDER_COMPILE_FLAG_IGNORE_INVALID;
-	g_autoptr(GFile) xmlb = NULL;
-	g_autoptr(XbBuilder) builder = xb_builder_new();
-
-	/* clear existing silo */
-	g_clear_object(&self->silo);
-
-#ifdef SOURCE_VERSION
-	/* invalidate the cache if the fwupd version changes */
-	xb_builder_append_guid(builder, SOURCE_VERSION);
-#endif
-
-	/* verbose profiling */
-	if (g_getenv("FWUPD_XMLB_VERBOSE") != NULL) {
-		xb_builder_set_profile_flags(builder,
-					     XB_SILO_PROFILE_FLAG_XPATH |
-						 XB_SILO_PROFILE_FLAG_DEBUG);
-	}
+	g_autoptr(FuEngineSilo) engine_silo_local = NULL;
+	g_autoptr(GPtrArray) silos =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_engine_silo_free);
+	g_autoptr(XbBuilder) builder = fu_engine_metadata_builder_new();
 
 	/* load each enabled metadata file */
 	remotes = fu_remote_list_get_all(self->remote_list);
 	for (guint i = 0; i < remotes->len; i++) {
-		const gchar *path = NULL;
+		FwupdRemote *remote = g_ptr_array_index(remotes, i);
+		FuEngineSilo *engine_silo;
 		g_autoptr(GError) error_local = NULL;
-		g_autoptr(GFile) file = NULL;
-		g_autoptr(XbBuilderFixup) fixup = NULL;
-		g_autoptr(XbBuilderNode) custom = NULL;
-		g_autoptr(XbBuilderSource) source = xb_builder_source_new();
 
-		FwupdRemote *remote = g_ptr_array_index(remotes, i);
 		if (!fwupd_remote_has_flag(remote, FWUPD_REMOTE_FLAG_ENABLED))
 			continue;
-		path = fwupd_remote_get_filename_cache(remote);
-		if (!g_file_test(path, G_FILE_TEST_EXISTS))
-			continue;
-
-		/* generate all metadata on demand */
-		if (fwupd_remote_get_kind(remote) == FWUPD_REMOTE_KIND_DIRECTORY) {
-			g_info("loading metadata for remote '%s'", fwupd_remote_get_id(remote));
-			if (!fu_engine_create_metadata(self, builder, remote, &error_local)) {
-				g_warning("failed to generate remote %s: %s",
-					  fwupd_remote_get_id(remote),
-					  error_local->message);
-			}
+		if (!g_file_test(fwupd_remote_get_filename_cache(remote), G_FILE_TEST_EXISTS))
 			continue;
-		}
-
-		/* save the remote-id in the custom metadata space */
-		file = g_file_new_for_path(path);
-		if (!xb_builder_source_load_file(source,
-						 file,
-						 XB_BUILDER_SOURCE_FLAG_NONE,
-						 NULL,
-						 &error_local)) {
+		engine_silo =
+		    fu_engine_load_metadata_store_remote(self, remote, flags, &error_local);
+		if (engine_silo == NULL) {
 			g_warning("failed to load remote %s: %s",
 				  fwupd_remote_get_id(remote),
 				  error_local->message);
 			continue;
 		}
-
-		/* fix up any legacy installed files */
-		fixup = xb_builder_fixup_new("AppStreamUpgrade",
-					     fu_engine_appstream_upgrade_cb,
-					     self,
-					     NULL);
-		xb_builder_fixup_set_max_depth(fixup, 3);
-		xb_builder_source_add_fixup(source, fixup);
-
-		/* add metadata */
-		custom = xb_builder_node_new("custom");
-		xb_builder_node_insert_text(custom,
-					    "value",
-					    path,
-					    "key",
-					    "fwupd::FilenameCache",
-					    NULL);
-		xb_builder_node_insert_text(custom,
-					    "value",
-					    fwupd_remote_get_id(remote),
-					    "key",
-					    "fwupd::RemoteId",
-					    NULL);
-		xb_builder_source_set_info(source, custom);
-
-		/* we need to watch for changes? */
-		xb_builder_import_source(builder, source);
+		g_ptr_array_add(silos, engine_silo);
 	}
 
 	/* add any client-side data, e.g. BKC tags */
 	if (!fu_engine_load_metadata_store_local(self,
 						 builder,
 						 FU_PATH_KIND_LOCALSTATEDIR_PKG,
-						 error))
+						 error) ||
+	    !fu_engine_load_metadata_store_local(self, builder, FU_PATH_KIND_DATADIR_PKG, error)) {
+		fu_engine_silos_steal_shared(silos, self->silos);
 		return FALSE;
-	if (!fu_engine_load_metadata_store_local(self, builder, FU_PATH_KIND_DATADIR_PKG, error))
-		return FALSE;
-
-	/* on a read-only filesystem don't care about the cache GUID */
-	if (flags & FU_ENGINE_LOAD_FLAG_READONLY)
-		compile_flags |= XB_BUILDER_COMPILE_FLAG_IGNORE_GUID;
-
-	/* ensure silo is up to date */
-	if (flags & FU_ENGINE_LOAD_FLAG_NO_CACHE) {
-		g_autoptr(GFileIOStream) iostr = NULL;
-		xmlb = g_file_new_tmp(NULL, &iostr, error);
-		if (xmlb == NULL)
-			return FALSE;
-	} else {
-		g_autofree gchar *cachedirpkg = fu_path_from_kind(FU_PATH_KIND_CACHEDIR_PKG);
-		g_autofree gchar *xmlbfn = g_build_filename(cachedirpkg, "metadata.xmlb", NULL);
-		xmlb = g_file_new_for_path(xmlbfn);
 	}
-	self->silo = xb_builder_ensure(builder, xmlb, compile_flags, NULL, error);
-	if (self->silo == NULL) {
-		g_prefix_error(error, "cannot create metadata.xmlb: ");
+	engine_silo_local = fu_engine_load_metadata_store_silo(self,
+							       builder,
+							       "local",
+							       "local.xmlb",
+							       NULL,
+							       flags,
+							       error);
+	if (engine_silo_local == NULL) {
+		fu_engine_silos_steal_shared(silos, self->silos);
 		return FALSE;
 	}
+	g_ptr_array_add(silos, g_steal_pointer(&engine_silo_local));
+
+	/* only swap in the new silos when they all loaded */
+	fu_engine_silos_steal_shared(self->silos, silos);
+	g_ptr_array_unref(self->silos);
+	self->silos = g_steal_pointer(&silos);
+
+	/* only the silos just loaded are valid */
+	if ((flags & (FU_ENGINE_LOAD_FLAG_NO_CACHE | FU_ENGINE_LOAD_FLAG_READONLY)) == 0)
+		fu_engine_load_metadata_store_prune(self);
 
 	/* success */
-	return fu_engine_create_silo_index(self, error);
+	return TRUE;
+}
+
+/**
+ * fu_engine_reload_metadata:
+ * @self: a #FuEngine
+ * @error: (nullable): optional return location for an error
+ *
+ * Reloads the metadata of all the enabled remotes, only recompiling the remotes where the
+ * metadata file has changed since the last load.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_engine_reload_metadata(FuEngine *self, GError **error)
+{
+	g_return_val_if_fail(FU_IS_ENGINE(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+	return fu_engine_load_metadata_store(self, FU_ENGINE_LOAD_FLAG_NONE, error);
 }
 
 static void
@@ -4163,6 +5956,9 @@ fu_engine_config_changed_cb(FuEngineConfig *config, FuEngine *self)
 
 	fu_idle_set_timeout(self->idle, fu_engine_config_get_idle_timeout(config));
 
+	/* the archive size limit may have changed */
+	fu_cabinet_cache_clear(self->cabinet_cache);
+
 	/* allow changing the hardcoded ESP location */
 	if (fu_engine_config_get_esp_location(config) != NULL)
 		fu_context_set_esp_location(self->ctx, fu_engine_config_get_esp_location(config));
@@ -4320,6 +6116,26 @@ fu_engine_validate_result_timestamp(JcatResult *jcat_result,
 	return TRUE;
 }
 
+/* the metadata is still current, so reset the age to avoid refreshing again */
+static gboolean
+fu_engine_update_metadata_touch(FwupdRemote *remote, GError **error)
+{
+	guint64 now = (guint64)g_get_real_time() / G_USEC_PER_SEC;
+	g_autoptr(GFile) file = g_file_new_for_path(fwupd_remote_get_filename_cache(remote));
+
+	if (!g_file_set_attribute_uint64(file,
+					 G_FILE_ATTRIBUTE_TIME_MODIFIED,
+					 now,
+					 G_FILE_QUERY_INFO_NONE,
+					 NULL,
+					 error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	fwupd_remote_set_mtime(remote, now);
+	return TRUE;
+}
+
 /**
  * fu_engine_update_metadata_bytes:
  * @self: a #FuEngine
@@ -4340,6 +6156,7 @@ fu_engine_update_metadata_bytes(FuEngine *self,
 				GError **error)
 {
 	FwupdRemote *remote;
+	g_autofree gchar *checksum_sig = NULL;
 	g_autoptr(GError) error_local = NULL;
 	g_autoptr(GInputStream) istream = NULL;
 	g_autoptr(GPtrArray) results = NULL;
@@ -4373,6 +6190,24 @@ fu_engine_update_metadata_bytes(FuEngine *self,
 		return FALSE;
 	}
 
+	/* the signature is the same as the one already verified, so nothing has changed */
+	checksum_sig = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, bytes_sig);
+	if (g_strcmp0(checksum_sig, fwupd_remote_get_checksum(remote)) == 0 &&
+	    g_file_test(fwupd_remote_get_filename_cache(remote), G_FILE_TEST_EXISTS)) {
+		g_info("metadata signature of %s is unchanged, skipping", remote_id);
+		return fu_engine_update_metadata_touch(remote, error);
+	}
+
+	/* only a client that got HTTP 304 Not Modified can send no metadata */
+	if (g_bytes_get_size(bytes_raw) == 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_FILE,
+			    "no metadata for %s and the signature has changed",
+			    remote_id);
+		return FALSE;
+	}
+
 	/* verify JCatFile, or create a dummy one from legacy data */
 	istream = g_memory_input_stream_new_from_bytes(bytes_sig);
 	if (!jcat_file_import_stream(jcat_file, istream, JCAT_IMPORT_FLAG_NONE, NULL, error))
@@ -4446,6 +6281,8 @@ fu_engine_update_metadata_bytes(FuEngine *self,
 	/* save signature to remotes.d */
 	if (!fu_bytes_set_contents(fwupd_remote_get_filename_cache_sig(remote), bytes_sig, error))
 		return FALSE;
+	fwupd_remote_set_checksum_sig(remote, checksum_sig);
+	fwupd_remote_set_mtime(remote, (guint64)g_get_real_time() / G_USEC_PER_SEC);
 	if (!fu_engine_load_metadata_store(self, FU_ENGINE_LOAD_FLAG_NONE, error))
 		return FALSE;
 
@@ -4482,6 +6319,7 @@ fu_engine_update_metadata(FuEngine *self,
 			  GError **error)
 {
 #ifdef HAVE_GIO_UNIX
+	gsize streamsz = 0;
 	g_autoptr(GBytes) bytes_raw = NULL;
 	g_autoptr(GBytes) bytes_sig = NULL;
 	g_autoptr(GInputStream) stream_fd = NULL;
@@ -4497,11 +6335,20 @@ fu_engine_update_metadata(FuEngine *self,
 	stream_fd = fu_unix_seekable_input_stream_new(fd, TRUE);
 	stream_sig = fu_unix_seekable_input_stream_new(fd_sig, TRUE);
 
-	/* read the entire file into memory */
-	bytes_raw =
-	    fu_input_stream_read_bytes(stream_fd, 0, FU_ENGINE_MAX_METADATA_SIZE, NULL, error);
-	if (bytes_raw == NULL)
+	/* read the entire file into memory, which is empty if the metadata was not modified */
+	if (!fu_input_stream_size(stream_fd, &streamsz, error))
 		return FALSE;
+	if (streamsz == 0) {
+		bytes_raw = g_bytes_new(NULL, 0);
+	} else {
+		bytes_raw = fu_input_stream_read_bytes(stream_fd,
+						       0,
+						       FU_ENGINE_MAX_METADATA_SIZE,
+						       NULL,
+						       error);
+		if (bytes_raw == NULL)
+			return FALSE;
+	}
 
 	/* read signature */
 	bytes_sig =
@@ -4533,13 +6380,62 @@ fu_engine_update_metadata(FuEngine *self,
 FuCabinet *
 fu_engine_build_cabinet_from_stream(FuEngine *self, GInputStream *stream, GError **error)
 {
-	g_autoptr(FuCabinet) cabinet = fu_cabinet_new();
+	FuMetrics *metrics = fu_context_get_metrics(self->ctx);
+	guint64 cache_size_max = fu_engine_config_get_cabinet_cache_size_max(self->config);
+	const gchar *checksum = NULL;
+	gsize streamsz = 0;
+	g_autoptr(FuCabinet) cabinet = NULL;
+	g_autoptr(GError) error_cache = NULL;
+	g_autoptr(GInputStream) stream_mapped = NULL;
+	g_autoptr(GPtrArray) checksums = NULL;
 
 	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
+	/* the client could change the file between reads, so the archive is read into memory once
+	 * and the same bytes are hashed and then parsed; both container checksums are computed in
+	 * one pass so that the archive does not need to be hashed again when parsed */
+	fu_cabinet_cache_set_size_max(self->cabinet_cache, cache_size_max);
+	if (cache_size_max > 0) {
+		if (!fu_input_stream_size(stream, &streamsz, error))
+			return NULL;
+	}
+	if (cache_size_max > 0 && streamsz <= cache_size_max) {
+		GChecksumType csum_kinds[] = {G_CHECKSUM_SHA1, G_CHECKSUM_SHA256};
+		g_autoptr(GBytes) blob = NULL;
+
+		blob = fu_input_stream_read_bytes(stream, 0x0, streamsz, NULL, error);
+		if (blob == NULL)
+			return NULL;
+		stream_mapped = fu_mapped_input_stream_new(blob);
+		stream = stream_mapped;
+		checksums = fu_input_stream_compute_checksums(stream,
+							      csum_kinds,
+							      G_N_ELEMENTS(csum_kinds),
+							      error);
+		if (checksums == NULL)
+			return NULL;
+		checksum = g_ptr_array_index(checksums, 1);
+		cabinet = fu_cabinet_cache_lookup(self->cabinet_cache, checksum);
+		if (cabinet != NULL) {
+			g_debug("using parsed archive %s from cache", checksum);
+			fu_metrics_add_counter(metrics, "CabinetCacheHit", 1);
+			return g_steal_pointer(&cabinet);
+		}
+		fu_metrics_add_counter(metrics, "CabinetCacheMiss", 1);
+	}
+
 	/* load file */
+	cabinet = fu_cabinet_new();
+	if (checksums != NULL) {
+		fu_cabinet_set_container_checksum(cabinet,
+						  G_CHECKSUM_SHA1,
+						  g_ptr_array_index(checksums, 0));
+		fu_cabinet_set_container_checksum(cabinet,
+						  G_CHECKSUM_SHA256,
+						  g_ptr_array_index(checksums, 1));
+	}
 	fu_engine_set_status(self, FWUPD_STATUS_DECOMPRESSING);
 	fu_firmware_set_size_max(FU_FIRMWARE(cabinet),
 				 fu_engine_config_get_archive_size_max(self->config));
@@ -4550,6 +6446,11 @@ fu_engine_build_cabinet_from_stream(FuEngine *self, GInputStream *stream, GError
 				      FU_FIRMWARE_PARSE_FLAG_NONE,
 				      error))
 		return NULL;
+
+	/* save for next time */
+	if (checksum != NULL &&
+	    !fu_cabinet_cache_add(self->cabinet_cache, checksum, cabinet, &error_cache))
+		g_debug("not adding parsed archive to cache: %s", error_cache->message);
 	return g_steal_pointer(&cabinet);
 }
 
@@ -4690,10 +6591,9 @@ fu_engine_get_details(FuEngine *self,
 		      GInputStream *stream,
 		      GError **error)
 {
-	GChecksumType checksum_types[] = {G_CHECKSUM_SHA256, G_CHECKSUM_SHA1, 0};
+	GChecksumType checksum_types[] = {G_CHECKSUM_SHA256, G_CHECKSUM_SHA1};
 	g_autoptr(GPtrArray) components = NULL;
 	g_autoptr(GPtrArray) details = NULL;
-	g_autoptr(GPtrArray) checksums = g_ptr_array_new_with_free_func(g_free);
 	g_autoptr(FuCabinet) cabinet = NULL;
 	g_autoptr(XbNode) rel_by_csum = NULL;
 
@@ -4710,18 +6610,11 @@ fu_engine_get_details(FuEngine *self,
 	if (components == NULL)
 		return NULL;
 
-	/* calculate the checksums of the blob */
-	for (guint i = 0; checksum_types[i] != 0; i++) {
-		g_autofree gchar *checksum =
-		    fu_input_stream_compute_checksum(stream, checksum_types[i], error);
-		if (checksum == NULL)
-			return NULL;
-		g_ptr_array_add(checksums, g_steal_pointer(&checksum));
-	}
-
-	/* does this exist in any enabled remote */
-	for (guint i = 0; i < checksums->len; i++) {
-		const gchar *csum = g_ptr_array_index(checksums, i);
+	/* does this exist in any enabled remote, using the checksums from when it was parsed */
+	for (guint i = 0; i < G_N_ELEMENTS(checksum_types); i++) {
+		const gchar *csum = fu_cabinet_get_container_checksum(cabinet, checksum_types[i]);
+		if (csum == NULL)
+			continue;
 		rel_by_csum = fu_engine_get_release_for_checksum(self, csum);
 		if (rel_by_csum != NULL)
 			break;
@@ -4750,9 +6643,11 @@ fu_engine_get_details(FuEngine *self,
 		}
 
 		/* add the checksum of the container blob */
-		for (guint j = 0; j < checksums->len; j++) {
-			const gchar *csum = g_ptr_array_index(checksums, j);
-			fu_release_add_checksum(rel, csum);
+		for (guint j = 0; j < G_N_ELEMENTS(checksum_types); j++) {
+			const gchar *csum =
+			    fu_cabinet_get_container_checksum(cabinet, checksum_types[j]);
+			if (csum != NULL)
+				fu_release_add_checksum(rel, csum);
 		}
 		g_ptr_array_add(details, dev);
 	}
@@ -5285,7 +7180,7 @@ fu_engine_get_releases_for_device(FuEngine *self,
 	g_autoptr(GPtrArray) releases = NULL;
 
 	/* no components in silo */
-	if (self->query_component_by_guid == NULL) {
+	if (!fu_engine_has_components(self)) {
 		g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "no components in silo");
 		return NULL;
 	}
@@ -5328,18 +7223,10 @@ fu_engine_get_releases_for_device(FuEngine *self,
 	releases = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	for (guint j = 0; j < device_guids->len; j++) {
 		const gchar *guid = g_ptr_array_index(device_guids, j);
-		g_autoptr(GError) error_local = NULL;
-		g_autoptr(GPtrArray) components = NULL;
-		g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+		g_autoptr(GPtrArray) components = fu_engine_get_components_by_guid(self, guid);
 
-		xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
-		xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
-		components = xb_silo_query_with_context(self->silo,
-							self->query_component_by_guid,
-							&context,
-							&error_local);
-		if (components == NULL) {
-			g_debug("%s was not found: %s", guid, error_local->message);
+		if (components->len == 0) {
+			g_debug("%s was not found", guid);
 			continue;
 		}
 
@@ -6547,17 +8434,18 @@ fu_engine_add_plugin_filter(FuEngine *self, const gchar *plugin_glob)
 static gboolean
 fu_engine_plugin_check_supported_cb(FuPlugin *plugin, const gchar *guid, FuEngine *self)
 {
-	g_autoptr(XbNode) n = NULL;
-	g_autofree gchar *xpath = NULL;
+	g_autoptr(GPtrArray) components = NULL;
 
 	if (fu_engine_config_get_enumerate_all_devices(self->config))
 		return TRUE;
 
-	xpath = g_strdup_printf("components/component[@type='firmware']/"
-				"provides/firmware[@type='flashed'][text()='%s']",
-				guid);
-	n = xb_silo_query_first(self->silo, xpath, NULL);
-	return n != NULL;
+	components = fu_engine_get_components_by_guid(self, guid);
+	for (guint i = 0; i < components->len; i++) {
+		XbNode *component = g_ptr_array_index(components, i);
+		if (g_strcmp0(xb_node_get_attr(component, "type"), "firmware") == 0)
+			return TRUE;
+	}
+	return FALSE;
 }
 
 FuEngineConfig *
@@ -7476,6 +9364,13 @@ fu_engine_backend_device_removed_cb(FuBackend *backend, FuDevice *device, FuEngi
 {
 	g_autoptr(GPtrArray) devices = NULL;
 
+	/* being written by a parallel install lane */
+	if (fu_engine_install_defer_backend_event(self,
+						  fu_engine_backend_device_removed_cb,
+						  backend,
+						  device))
+		return;
+
 	/* if this is for firmware attributes, reload that part of the daemon */
 	fu_engine_check_firmware_attributes(self, device, FALSE);
 
@@ -7576,6 +9471,21 @@ fu_engine_backend_device_added_run_plugins(FuEngine *self, FuDevice *device, FuP
 	}
 }
 
+static void
+fu_engine_backend_device_probe_failed(FuDevice *device, const GError *error)
+{
+	if (!g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) &&
+	    !g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_TIMED_OUT)) {
+		g_warning("failed to probe device %s: %s",
+			  fu_device_get_backend_id(device),
+			  error->message);
+	} else {
+		g_debug("failed to probe device %s : %s",
+			fu_device_get_backend_id(device),
+			error->message);
+	}
+}
+
 static void
 fu_engine_backend_device_added(FuEngine *self, FuDevice *device, FuProgress *progress)
 {
@@ -7597,16 +9507,7 @@ fu_engine_backend_device_added(FuEngine *self, FuDevice *device, FuProgress *pro
 	/* add any extra quirks */
 	fu_device_set_context(device, self->ctx);
 	if (!fu_device_probe(device, &error_local)) {
-		if (!g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) &&
-		    !g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_TIMED_OUT)) {
-			g_warning("failed to probe device %s: %s",
-				  fu_device_get_backend_id(device),
-				  error_local->message);
-		} else {
-			g_debug("failed to probe device %s : %s",
-				fu_device_get_backend_id(device),
-				error_local->message);
-		}
+		fu_engine_backend_device_probe_failed(device, error_local);
 		fu_progress_finished(progress);
 		return;
 	}
@@ -7635,6 +9536,13 @@ fu_engine_backend_device_added_cb(FuBackend *backend, FuDevice *device, FuEngine
 	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
 	g_autoptr(GPtrArray) possible_plugins = NULL;
 
+	/* being written by a parallel install lane */
+	if (fu_engine_install_defer_backend_event(self,
+						  fu_engine_backend_device_added_cb,
+						  backend,
+						  device))
+		return;
+
 	fu_engine_backend_device_added(self, device, progress);
 
 	/* free data cached during ->probe */
@@ -7655,6 +9563,13 @@ fu_engine_backend_device_changed_cb(FuBackend *backend, FuDevice *device, FuEngi
 	GPtrArray *plugins = fu_plugin_list_get_all(self->plugin_list);
 	g_autoptr(GPtrArray) devices = NULL;
 
+	/* being written by a parallel install lane */
+	if (fu_engine_install_defer_backend_event(self,
+						  fu_engine_backend_device_changed_cb,
+						  backend,
+						  device))
+		return;
+
 	/* debug */
 	g_debug("%s changed %s", fu_backend_get_name(backend), fu_device_get_physical_id(device));
 
@@ -8025,34 +9940,254 @@ fu_engine_win32_registry_get_string(HKEY hkey,
 }
 #endif
 
+static void
+fu_engine_backends_coldplug_backend_device_done(FuEngine *self,
+						FuBackend *backend,
+						FuDevice *device)
+{
+	g_autoptr(GPtrArray) possible_plugins = NULL;
+
+	/* free data cached during ->probe */
+	fu_device_probe_complete(device);
+
+	/* there's no point keeping this in the cache */
+	possible_plugins = fu_device_get_possible_plugins(device);
+	if (possible_plugins->len == 0) {
+		g_debug("removing %s from backend cache as no possible plugin",
+			fu_device_get_backend_id(device));
+		fu_backend_device_removed(backend, device);
+	}
+}
+
+typedef struct {
+	FuDevice *device;
+	GError *error;
+	gdouble duration_probe; /* ms */
+} FuEngineColdplugItem;
+
+static void
+fu_engine_coldplug_item_free(FuEngineColdplugItem *item)
+{
+	g_object_unref(item->device);
+	if (item->error != NULL)
+		g_error_free(item->error);
+	g_free(item);
+}
+
+/* runs in a worker thread, with all the devices of the group probed in order -- quirk lookups
+ * are protected by the FuQuirks mutexes, and property notifications are frozen until the
+ * device is processed in the main thread */
+static void
+fu_engine_backends_coldplug_probe_cb(gpointer data, gpointer user_data)
+{
+	GPtrArray *items = (GPtrArray *)data;
+	for (guint i = 0; i < items->len; i++) {
+		FuEngineColdplugItem *item = g_ptr_array_index(items, i);
+		g_autoptr(GTimer) timer = g_timer_new();
+		if (!fu_device_probe(item->device, &item->error))
+			g_debug("failed to probe %s", fu_device_get_backend_id(item->device));
+		item->duration_probe = g_timer_elapsed(timer, NULL) * 1000.f;
+	}
+}
+
+/* parents are always probed before their children, and never concurrently */
+static gint
+fu_engine_backends_coldplug_item_sort_cb(gconstpointer a, gconstpointer b)
+{
+	FuEngineColdplugItem *item1 = *((FuEngineColdplugItem **)a);
+	FuEngineColdplugItem *item2 = *((FuEngineColdplugItem **)b);
+	const gchar *backend_id1 = fu_device_get_backend_id(item1->device);
+	const gchar *backend_id2 = fu_device_get_backend_id(item2->device);
+	gsize backend_idsz1 = backend_id1 != NULL ? strlen(backend_id1) : 0;
+	gsize backend_idsz2 = backend_id2 != NULL ? strlen(backend_id2) : 0;
+	if (backend_idsz1 < backend_idsz2)
+		return -1;
+	if (backend_idsz1 > backend_idsz2)
+		return 1;
+	return 0;
+}
+
+/* the root of the parent and proxy hierarchy, where for sysfs paths any ancestor that is also
+ * being coldplugged counts as a parent, e.g. the USB hub of a USB device */
+static gchar *
+fu_engine_backends_coldplug_group_id(FuDevice *device, GHashTable *backend_ids)
+{
+	FuDevice *root = device;
+	const gchar *backend_id;
+	g_autofree gchar *group_id = NULL;
+	g_autofree gchar *path = NULL;
+
+	while (TRUE) {
+		FuDevice *tmp = fu_device_get_parent(root);
+		if (tmp == NULL)
+			tmp = fu_device_get_proxy(root);
+		if (tmp == NULL)
+			break;
+		root = tmp;
+	}
+	backend_id = fu_device_get_backend_id(root);
+	if (backend_id == NULL)
+		return g_strdup_printf("%p", root);
+	group_id = g_strdup(backend_id);
+	if (!g_path_is_absolute(backend_id))
+		return g_steal_pointer(&group_id);
+	path = g_path_get_dirname(backend_id);
+	while (TRUE) {
+		g_autofree gchar *path_parent = NULL;
+		if (g_hash_table_contains(backend_ids, path)) {
+			g_free(group_id);
+			group_id = g_strdup(path);
+		}
+		path_parent = g_path_get_dirname(path);
+		if (g_strcmp0(path_parent, path) == 0)
+			break;
+		g_free(path);
+		path = g_steal_pointer(&path_parent);
+	}
+	return g_steal_pointer(&group_id);
+}
+
+static void
+fu_engine_backends_coldplug_thaw_items(GPtrArray *items)
+{
+	for (guint i = 0; i < items->len; i++) {
+		FuEngineColdplugItem *item = g_ptr_array_index(items, i);
+		g_object_thaw_notify(G_OBJECT(item->device));
+	}
+}
+
+static gboolean
+fu_engine_backends_coldplug_backend_add_devices_parallel(FuEngine *self,
+							 FuBackend *backend,
+							 FuProgress *progress,
+							 GError **error)
+{
+	gdouble duration_probe = 0.f;
+	GThreadPool *pool;
+	GHashTableIter iter;
+	gpointer value = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+	g_autoptr(GPtrArray) devices = fu_backend_get_devices(backend);
+	g_autoptr(GPtrArray) items =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_engine_coldplug_item_free);
+	g_autoptr(GHashTable) backend_ids = g_hash_table_new(g_str_hash, g_str_equal);
+	g_autoptr(GHashTable) groups =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_ptr_array_unref);
+
+	/* group devices by the root of the hierarchy */
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index(devices, i);
+		const gchar *backend_id = fu_device_get_backend_id(device);
+		if (backend_id != NULL)
+			g_hash_table_add(backend_ids, (gpointer)backend_id);
+	}
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index(devices, i);
+		FuEngineColdplugItem *item = g_new0(FuEngineColdplugItem, 1);
+		GPtrArray *group;
+		g_autofree gchar *group_id =
+		    fu_engine_backends_coldplug_group_id(device, backend_ids);
+
+		/* any notify::* signals get emitted when thawed in the main thread */
+		fu_device_set_context(device, self->ctx);
+		g_object_freeze_notify(G_OBJECT(device));
+		item->device = g_object_ref(device);
+		g_ptr_array_add(items, item);
+		group = g_hash_table_lookup(groups, group_id);
+		if (group == NULL) {
+			group = g_ptr_array_new();
+			g_hash_table_insert(groups, g_steal_pointer(&group_id), group);
+		}
+		g_ptr_array_add(group, item);
+	}
+
+	/* probe each group in a worker thread */
+	pool = g_thread_pool_new(fu_engine_backends_coldplug_probe_cb,
+				 NULL,
+				 (gint)g_get_num_processors(),
+				 FALSE,
+				 error);
+	if (pool == NULL) {
+		fu_engine_backends_coldplug_thaw_items(items);
+		return FALSE;
+	}
+	g_hash_table_iter_init(&iter, groups);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		GPtrArray *group = (GPtrArray *)value;
+		g_ptr_array_sort(group, fu_engine_backends_coldplug_item_sort_cb);
+		if (!g_thread_pool_push(pool, group, error)) {
+			g_thread_pool_free(pool, FALSE, TRUE);
+			fu_engine_backends_coldplug_thaw_items(items);
+			return FALSE;
+		}
+	}
+	g_thread_pool_free(pool, FALSE, TRUE);
+	fu_engine_backends_coldplug_thaw_items(items);
+
+	/* the plugins are not threadsafe, so run ->probe() and ->setup() in the main thread */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_set_steps(progress, items->len);
+	for (guint i = 0; i < items->len; i++) {
+		FuEngineColdplugItem *item = g_ptr_array_index(items, i);
+		g_autoptr(GTimer) timer_setup = g_timer_new();
+
+		duration_probe += item->duration_probe;
+		if (item->error != NULL) {
+			fu_engine_backend_device_probe_failed(item->device, item->error);
+			fu_progress_finished(fu_progress_get_child(progress));
+		} else {
+			fu_engine_backend_device_added(self,
+						       item->device,
+						       fu_progress_get_child(progress));
+		}
+		fu_progress_step_done(progress);
+		g_debug("%s probe took %.1fms, plugins took %.1fms",
+			fu_device_get_backend_id(item->device),
+			item->duration_probe,
+			g_timer_elapsed(timer_setup, NULL) * 1000.f);
+		fu_engine_backends_coldplug_backend_device_done(self, backend, item->device);
+	}
+	g_info("%s coldplug of %u devices in %u groups took %.0fms, serial probe would be %.0fms",
+	       fu_backend_get_name(backend),
+	       items->len,
+	       g_hash_table_size(groups),
+	       g_timer_elapsed(timer, NULL) * 1000.f,
+	       duration_probe);
+
+	/* success */
+	return TRUE;
+}
+
 static gboolean
 fu_engine_backends_coldplug_backend_add_devices(FuEngine *self,
 						FuBackend *backend,
 						FuProgress *progress,
 						GError **error)
 {
-	g_autoptr(GPtrArray) devices = fu_backend_get_devices(backend);
+	g_autoptr(GPtrArray) devices = NULL;
+
+	/* opt-in */
+	if (fu_engine_config_get_parallel_coldplug(self->config)) {
+		g_autoptr(GError) error_local = NULL;
+		if (fu_engine_backends_coldplug_backend_add_devices_parallel(self,
+									     backend,
+									     progress,
+									     &error_local))
+			return TRUE;
+		g_warning("failed to coldplug %s in parallel, falling back: %s",
+			  fu_backend_get_name(backend),
+			  error_local->message);
+	}
 
 	/* progress */
+	devices = fu_backend_get_devices(backend);
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_set_steps(progress, devices->len);
 	for (guint i = 0; i < devices->len; i++) {
 		FuDevice *device = g_ptr_array_index(devices, i);
-		g_autoptr(GPtrArray) possible_plugins = NULL;
-
 		fu_engine_backend_device_added(self, device, fu_progress_get_child(progress));
 		fu_progress_step_done(progress);
-
-		/* free data cached during ->probe */
-		fu_device_probe_complete(device);
-
-		/* there's no point keeping this in the cache */
-		possible_plugins = fu_device_get_possible_plugins(device);
-		if (possible_plugins->len == 0) {
-			g_debug("removing %s from backend cache as no possible plugin",
-				fu_device_get_backend_id(device));
-			fu_backend_device_removed(backend, device);
-		}
+		fu_engine_backends_coldplug_backend_device_done(self, backend, device);
 	}
 
 	/* success */
@@ -8926,15 +11061,24 @@ fu_engine_constructed(GObject *obj)
 static void
 fu_engine_init(FuEngine *self)
 {
+	g_autofree gchar *cachedirpkg = fu_path_from_kind(FU_PATH_KIND_CACHEDIR_PKG);
+	g_autofree gchar *firmware_cache_dir = g_build_filename(cachedirpkg, "firmware", NULL);
+
 	self->percentage = 0;
 	self->config = fu_engine_config_new();
 	self->remote_list = fu_remote_list_new();
 	self->device_list = fu_device_list_new();
 	self->idle = fu_idle_new();
+	self->firmware_cache = fu_firmware_cache_new(firmware_cache_dir);
+	self->cabinet_cache = fu_cabinet_cache_new();
 	self->plugin_list = fu_plugin_list_new();
 	self->plugin_filter = g_ptr_array_new_with_free_func(g_free);
+	self->silos = g_ptr_array_new_with_free_func((GDestroyNotify)fu_engine_silo_free);
 	self->host_security_attrs = fu_security_attrs_new();
 	self->local_monitors = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	self->install_writing = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	self->install_events =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_engine_backend_event_free);
 	self->acquiesce_loop = g_main_loop_new(NULL, FALSE);
 	self->device_changed_allowlist =
 	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
@@ -8956,16 +11100,7 @@ fu_engine_finalize(GObject *obj)
 		g_file_monitor_cancel(monitor);
 	}
 
-	if (self->silo != NULL)
-		g_object_unref(self->silo);
-	if (self->query_component_by_guid != NULL)
-		g_object_unref(self->query_component_by_guid);
-	if (self->query_container_checksum1 != NULL)
-		g_object_unref(self->query_container_checksum1);
-	if (self->query_container_checksum2 != NULL)
-		g_object_unref(self->query_container_checksum2);
-	if (self->query_tag_by_guid_version != NULL)
-		g_object_unref(self->query_tag_by_guid_version);
+	g_ptr_array_unref(self->silos);
 	if (self->coldplug_id != 0)
 		g_source_remove(self->coldplug_id);
 	if (self->approved_firmware != NULL)
@@ -8988,12 +11123,16 @@ fu_engine_finalize(GObject *obj)
 	g_object_unref(self->host_security_attrs);
 	g_object_unref(self->idle);
 	g_object_unref(self->config);
+	g_object_unref(self->firmware_cache);
+	g_object_unref(self->cabinet_cache);
 	g_object_unref(self->remote_list);
 	g_object_unref(self->history);
 	g_object_unref(self->device_list);
 	g_object_unref(self->jcat_context);
 	g_ptr_array_unref(self->plugin_filter);
 	g_ptr_array_unref(self->local_monitors);
+	g_ptr_array_unref(self->install_writing);
+	g_ptr_array_unref(self->install_events);
 	g_hash_table_unref(self->device_changed_allowlist);
 	g_object_unref(self->plugin_list);
 
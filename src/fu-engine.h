@@ -260,6 +260,8 @@ gboolean
 fu_engine_check_trust(FuEngine *self, FuRelease *release, GError **error) G_GNUC_NON_NULL(1, 2);
 void
 fu_engine_set_silo(FuEngine *self, XbSilo *silo) G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_engine_reload_metadata(FuEngine *self, GError **error) G_GNUC_NON_NULL(1);
 XbNode *
 fu_engine_get_component_by_guids(FuEngine *self, FuDevice *device) G_GNUC_NON_NULL(1, 2);
 gboolean
@@ -272,6 +274,9 @@ fu_engine_load_release(FuEngine *self,
 		       GError **error) G_GNUC_NON_NULL(1, 2, 4);
 gchar *
 fu_engine_get_remote_id_for_stream(FuEngine *self, GInputStream *stream) G_GNUC_NON_NULL(1, 2);
+gchar *
+fu_engine_lookup_firmware_cache(FuEngine *self, FwupdRelease *release, GError **error)
+    G_GNUC_NON_NULL(1, 2);
 gboolean
 fu_engine_modify_bios_settings(FuEngine *self,
 			       GHashTable *settings,
@@ -281,6 +286,9 @@ gboolean
 fu_engine_emulation_load(FuEngine *self, GInputStream *stream, GError **error)
     G_GNUC_NON_NULL(1, 2);
 gboolean
+fu_engine_emulation_load_bytes(FuEngine *self, GBytes *blob, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+gboolean
 fu_engine_emulation_save(FuEngine *self, GOutputStream *stream, GError **error)
     G_GNUC_NON_NULL(1, 2);
 gboolean
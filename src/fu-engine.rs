@@ -28,6 +28,46 @@ enum FuEngineEmulatorPhase {
     CompositeCleanup,
 }
 
+#[derive(ToString, FromString)]
+enum FuEngineEmulatorFormat {
+    Unknown,
+    Json,
+    Binary,
+}
+
+#[derive(ToString)]
+#[repr(u8)]
+enum FuEngineEmulatorCompression {
+    None,
+    Lzma,
+}
+
+// all the records are stored after this header, optionally compressed
+#[derive(New, ValidateBytes, ParseBytes, Default)]
+#[repr(C, packed)]
+struct FuStructEngineEmulatorHdr {
+    magic: [char; 8] == "FWUPDEMU",
+    version: u8 == 0x01,
+    compression: FuEngineEmulatorCompression,
+    reserved: [u8; 2],
+    payloadsz: u32le, // uncompressed
+}
+
+#[repr(u8)]
+enum FuEngineEmulatorRecordKind {
+    Phase = 0x01,  // filename, e.g. `install-1.json`
+    Json = 0x02,   // the phase JSON without the device events
+    Device = 0x03, // u16le member name size, member name, u16le backend ID size, backend ID
+    Event = 0x04,  // see fu_device_event_append_binary()
+}
+
+#[derive(New, ParseBytes)]
+#[repr(C, packed)]
+struct FuStructEngineEmulatorRecord {
+    kind: FuEngineEmulatorRecordKind,
+    size: u32le,
+}
+
 #[derive(ToBitString)]
 enum FuEngineRequestFlag {
     None = 0,
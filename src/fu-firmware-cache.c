@@ -0,0 +1,401 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuFirmwareCache"
+
+#include "config.h"
+
+#include <errno.h>
+#include <glib/gstdio.h>
+
+#include "fu-firmware-cache.h"
+
+/* a partial archive from a daemon that was killed while saving it */
+#define FU_FIRMWARE_CACHE_INCOMING_AGE_MAX 3600 /* s */
+
+/*
+ * A content-addressed store of firmware archives, where each file is named by the SHA256 of the
+ * contents. Archives may not be public, so the files are only readable by the daemon user, and
+ * the least recently used files are deleted when the total size is over the limit.
+ */
+
+struct _FuFirmwareCache {
+	GObject parent_instance;
+	gchar *path;
+	guint64 size_max;
+};
+
+G_DEFINE_TYPE(FuFirmwareCache, fu_firmware_cache, G_TYPE_OBJECT)
+
+typedef struct {
+	gchar *filename;
+	guint64 size;
+	gint64 mtime;
+} FuFirmwareCacheItem;
+
+static void
+fu_firmware_cache_item_free(FuFirmwareCacheItem *item)
+{
+	g_free(item->filename);
+	g_free(item);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuFirmwareCacheItem, fu_firmware_cache_item_free)
+
+/**
+ * fu_firmware_cache_get_path:
+ * @self: a #FuFirmwareCache
+ *
+ * Gets the directory used to store the archives.
+ *
+ * Returns: a path
+ **/
+const gchar *
+fu_firmware_cache_get_path(FuFirmwareCache *self)
+{
+	g_return_val_if_fail(FU_IS_FIRMWARE_CACHE(self), NULL);
+	return self->path;
+}
+
+/**
+ * fu_firmware_cache_set_size_max:
+ * @self: a #FuFirmwareCache
+ * @size_max: size in bytes, or 0 to disable the cache
+ *
+ * Sets the maximum total size of all the archives in the cache, which is disabled by default.
+ **/
+void
+fu_firmware_cache_set_size_max(FuFirmwareCache *self, guint64 size_max)
+{
+	g_return_if_fail(FU_IS_FIRMWARE_CACHE(self));
+	self->size_max = size_max;
+}
+
+static gboolean
+fu_firmware_cache_checksum_valid(const gchar *checksum, GError **error)
+{
+	if (strlen(checksum) != (gsize)g_checksum_type_get_length(G_CHECKSUM_SHA256) * 2) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "invalid SHA256 checksum %s",
+			    checksum);
+		return FALSE;
+	}
+	for (guint i = 0; checksum[i] != '\0'; i++) {
+		if (!g_ascii_isxdigit(checksum[i])) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "invalid SHA256 checksum %s",
+				    checksum);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static gchar *
+fu_firmware_cache_build_filename(FuFirmwareCache *self, const gchar *checksum)
+{
+	g_autofree gchar *checksum_safe = g_ascii_strdown(checksum, -1);
+	g_autofree gchar *basename = g_strdup_printf("%s.cab", checksum_safe);
+	return g_build_filename(self->path, basename, NULL);
+}
+
+static gboolean
+fu_firmware_cache_touch(const gchar *filename, GError **error)
+{
+	guint64 now = (guint64)g_get_real_time() / G_USEC_PER_SEC;
+	g_autoptr(GFile) file = g_file_new_for_path(filename);
+
+	if (!g_file_set_attribute_uint64(file,
+					 G_FILE_ATTRIBUTE_TIME_MODIFIED,
+					 now,
+					 G_FILE_QUERY_INFO_NONE,
+					 NULL,
+					 error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * fu_firmware_cache_lookup:
+ * @self: a #FuFirmwareCache
+ * @checksum: the SHA256 of the archive
+ * @error: (nullable): optional return location for an error
+ *
+ * Finds an archive in the cache, marking it as recently used.
+ *
+ * Returns: (transfer full): a filename, or %NULL if not found
+ **/
+gchar *
+fu_firmware_cache_lookup(FuFirmwareCache *self, const gchar *checksum, GError **error)
+{
+	g_autofree gchar *filename = NULL;
+
+	g_return_val_if_fail(FU_IS_FIRMWARE_CACHE(self), NULL);
+	g_return_val_if_fail(checksum != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* disabled */
+	if (self->size_max == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "firmware cache is disabled");
+		return NULL;
+	}
+	if (!fu_firmware_cache_checksum_valid(checksum, error))
+		return NULL;
+	filename = fu_firmware_cache_build_filename(self, checksum);
+	if (!g_file_test(filename, G_FILE_TEST_EXISTS)) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "%s not found in cache",
+			    checksum);
+		return NULL;
+	}
+	if (!fu_firmware_cache_touch(filename, error))
+		return NULL;
+	return g_steal_pointer(&filename);
+}
+
+typedef struct {
+	GOutputStream *ostr;
+	GChecksum *csum;
+} FuFirmwareCacheWriteHelper;
+
+static gboolean
+fu_firmware_cache_write_cb(const guint8 *buf, gsize bufsz, gpointer user_data, GError **error)
+{
+	FuFirmwareCacheWriteHelper *helper = (FuFirmwareCacheWriteHelper *)user_data;
+	g_checksum_update(helper->csum, buf, bufsz);
+	if (!g_output_stream_write_all(helper->ostr, buf, bufsz, NULL, NULL, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * fu_firmware_cache_add_stream:
+ * @self: a #FuFirmwareCache
+ * @stream: a #GInputStream of the archive
+ * @error: (nullable): optional return location for an error
+ *
+ * Adds an archive to the cache, which is only read once to both save and checksum the data.
+ * If the archive already exists it is marked as recently used, and older archives are deleted if
+ * the cache is now too large.
+ *
+ * Returns: (transfer full): the SHA256 of the archive, or %NULL for error
+ **/
+gchar *
+fu_firmware_cache_add_stream(FuFirmwareCache *self, GInputStream *stream, GError **error)
+{
+	g_autofree gchar *basename_tmp = NULL;
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *filename = NULL;
+	g_autofree gchar *filename_tmp = NULL;
+	g_autoptr(GChecksum) csum = g_checksum_new(G_CHECKSUM_SHA256);
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GFile) file_tmp = NULL;
+	g_autoptr(GOutputStream) ostr = NULL;
+	FuFirmwareCacheWriteHelper helper = {.csum = csum};
+
+	g_return_val_if_fail(FU_IS_FIRMWARE_CACHE(self), NULL);
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* disabled */
+	if (self->size_max == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "firmware cache is disabled");
+		return NULL;
+	}
+
+	/* save and checksum in one pass, using a new private file as the daemon may be adding
+	 * more than one archive at the same time */
+	if (!fu_path_mkdir(self->path, error))
+		return NULL;
+	basename_tmp = g_strdup_printf("incoming-%08x.tmp", g_random_int());
+	filename_tmp = g_build_filename(self->path, basename_tmp, NULL);
+	file_tmp = g_file_new_for_path(filename_tmp);
+	ostr = G_OUTPUT_STREAM(g_file_create(file_tmp, G_FILE_CREATE_PRIVATE, NULL, error));
+	if (ostr == NULL) {
+		fwupd_error_convert(error);
+		return NULL;
+	}
+	helper.ostr = ostr;
+	if (!fu_input_stream_chunkify(stream, fu_firmware_cache_write_cb, &helper, error)) {
+		g_prefix_error(error, "failed to save archive: ");
+		(void)g_output_stream_close(ostr, NULL, NULL);
+		(void)g_file_delete(file_tmp, NULL, NULL);
+		return NULL;
+	}
+	if (!g_output_stream_close(ostr, NULL, error)) {
+		fwupd_error_convert(error);
+		(void)g_file_delete(file_tmp, NULL, NULL);
+		return NULL;
+	}
+	checksum = g_strdup(g_checksum_get_string(csum));
+
+	/* already exists, so just mark as used */
+	filename = fu_firmware_cache_build_filename(self, checksum);
+	if (g_file_test(filename, G_FILE_TEST_EXISTS)) {
+		g_debug("%s already in cache", checksum);
+		(void)g_file_delete(file_tmp, NULL, NULL);
+		if (!fu_firmware_cache_touch(filename, error))
+			return NULL;
+		return g_steal_pointer(&checksum);
+	}
+
+	/* atomically rename so clients never see a partial file */
+	file = g_file_new_for_path(filename);
+	if (!g_file_move(file_tmp, file, G_FILE_COPY_OVERWRITE, NULL, NULL, NULL, error)) {
+		fwupd_error_convert(error);
+		(void)g_file_delete(file_tmp, NULL, NULL);
+		return NULL;
+	}
+	g_info("added %s to cache", filename);
+	if (!fu_firmware_cache_evict(self, error))
+		return NULL;
+	return g_steal_pointer(&checksum);
+}
+
+static gint
+fu_firmware_cache_item_sort_cb(gconstpointer a, gconstpointer b)
+{
+	FuFirmwareCacheItem *item1 = *((FuFirmwareCacheItem **)a);
+	FuFirmwareCacheItem *item2 = *((FuFirmwareCacheItem **)b);
+	if (item1->mtime < item2->mtime)
+		return -1;
+	if (item1->mtime > item2->mtime)
+		return 1;
+	return 0;
+}
+
+/**
+ * fu_firmware_cache_evict:
+ * @self: a #FuFirmwareCache
+ * @error: (nullable): optional return location for an error
+ *
+ * Deletes the least recently used archives until the cache is no larger than the maximum size,
+ * and any partial archive that was never completed.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_firmware_cache_evict(FuFirmwareCache *self, GError **error)
+{
+	const gchar *fn;
+	gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+	guint64 size_total = 0;
+	g_autoptr(GDir) dir = NULL;
+	g_autoptr(GPtrArray) items =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_firmware_cache_item_free);
+
+	g_return_val_if_fail(FU_IS_FIRMWARE_CACHE(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* nothing to do */
+	if (!g_file_test(self->path, G_FILE_TEST_IS_DIR))
+		return TRUE;
+
+	dir = g_dir_open(self->path, 0, error);
+	if (dir == NULL) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	while ((fn = g_dir_read_name(dir))) {
+		GStatBuf bufstat = {0};
+		g_autoptr(FuFirmwareCacheItem) item = NULL;
+		g_autofree gchar *filename = NULL;
+
+		filename = g_build_filename(self->path, fn, NULL);
+		if (g_stat(filename, &bufstat) != 0)
+			continue;
+
+		/* not being written by another thread or process */
+		if (g_str_has_prefix(fn, "incoming-") && g_str_has_suffix(fn, ".tmp")) {
+			if (now - bufstat.st_mtime < FU_FIRMWARE_CACHE_INCOMING_AGE_MAX)
+				continue;
+			g_info("deleting stale %s from cache", filename);
+			if (g_unlink(filename) != 0)
+				g_debug("failed to delete %s: %s", filename, g_strerror(errno));
+			continue;
+		}
+		if (!g_str_has_suffix(fn, ".cab"))
+			continue;
+		item = g_new0(FuFirmwareCacheItem, 1);
+		item->filename = g_steal_pointer(&filename);
+		item->size = bufstat.st_size;
+		item->mtime = bufstat.st_mtime;
+		size_total += item->size;
+		g_ptr_array_add(items, g_steal_pointer(&item));
+	}
+
+	/* delete the oldest first */
+	g_ptr_array_sort(items, fu_firmware_cache_item_sort_cb);
+	for (guint i = 0; i < items->len && size_total > self->size_max; i++) {
+		FuFirmwareCacheItem *item = g_ptr_array_index(items, i);
+		g_info("evicting %s from cache", item->filename);
+		if (g_unlink(item->filename) != 0) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_WRITE,
+				    "failed to delete %s: %s",
+				    item->filename,
+				    g_strerror(errno));
+			return FALSE;
+		}
+		size_total -= item->size;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static void
+fu_firmware_cache_init(FuFirmwareCache *self)
+{
+}
+
+static void
+fu_firmware_cache_finalize(GObject *obj)
+{
+	FuFirmwareCache *self = FU_FIRMWARE_CACHE(obj);
+	g_free(self->path);
+	G_OBJECT_CLASS(fu_firmware_cache_parent_class)->finalize(obj);
+}
+
+static void
+fu_firmware_cache_class_init(FuFirmwareCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_firmware_cache_finalize;
+}
+
+/**
+ * fu_firmware_cache_new:
+ * @path: a directory, e.g. `/var/cache/fwupd/firmware`
+ *
+ * Creates a new firmware cache.
+ *
+ * Returns: a #FuFirmwareCache
+ **/
+FuFirmwareCache *
+fu_firmware_cache_new(const gchar *path)
+{
+	FuFirmwareCache *self = g_object_new(FU_TYPE_FIRMWARE_CACHE, NULL);
+	self->path = g_strdup(path);
+	return self;
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupdplugin.h>
+
+#define FU_TYPE_FIRMWARE_CACHE (fu_firmware_cache_get_type())
+G_DECLARE_FINAL_TYPE(FuFirmwareCache, fu_firmware_cache, FU, FIRMWARE_CACHE, GObject)
+
+FuFirmwareCache *
+fu_firmware_cache_new(const gchar *path) G_GNUC_NON_NULL(1);
+const gchar *
+fu_firmware_cache_get_path(FuFirmwareCache *self) G_GNUC_NON_NULL(1);
+void
+fu_firmware_cache_set_size_max(FuFirmwareCache *self, guint64 size_max) G_GNUC_NON_NULL(1);
+gchar *
+fu_firmware_cache_lookup(FuFirmwareCache *self, const gchar *checksum, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
+gchar *
+fu_firmware_cache_add_stream(FuFirmwareCache *self, GInputStream *stream, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_firmware_cache_evict(FuFirmwareCache *self, GError **error) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1);
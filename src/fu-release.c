@@ -175,6 +175,20 @@ fu_release_get_stream(FuRelease *self)
 	return self->stream;
 }
 
+/**
+ * fu_release_set_stream:
+ * @self: a #FuRelease
+ * @stream: (nullable): a #GInputStream
+ *
+ * Sets the firmware stream to use when installing this release.
+ **/
+void
+fu_release_set_stream(FuRelease *self, GInputStream *stream)
+{
+	g_return_if_fail(FU_IS_RELEASE(self));
+	g_set_object(&self->stream, stream);
+}
+
 /**
  * fu_release_get_soft_reqs:
  * @self: a #FuRelease
@@ -1031,6 +1045,14 @@ fu_release_load(FuRelease *self,
 			}
 		}
 	}
+	if (fwupd_release_get_checksums(FWUPD_RELEASE(self))->len == 0 && cabinet != NULL) {
+		GChecksumType csum_kinds[] = {G_CHECKSUM_SHA256, G_CHECKSUM_SHA1};
+		for (guint i = 0; i < G_N_ELEMENTS(csum_kinds); i++) {
+			tmp = fu_cabinet_get_container_checksum(cabinet, csum_kinds[i]);
+			if (tmp != NULL)
+				fwupd_release_add_checksum(FWUPD_RELEASE(self), tmp);
+		}
+	}
 	if (fwupd_release_get_size(FWUPD_RELEASE(self)) == 0) {
 		tmp64 = xb_node_query_text_as_uint(rel, "size[@type='installed']", NULL);
 		if (tmp64 != G_MAXUINT64)
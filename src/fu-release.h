@@ -72,6 +72,8 @@ fu_release_set_device(FuRelease *self, FuDevice *device) G_GNUC_NON_NULL(1);
 void
 fu_release_set_remote(FuRelease *self, FwupdRemote *remote) G_GNUC_NON_NULL(1);
 void
+fu_release_set_stream(FuRelease *self, GInputStream *stream) G_GNUC_NON_NULL(1);
+void
 fu_release_set_config(FuRelease *self, FuEngineConfig *config) G_GNUC_NON_NULL(1);
 
 gboolean
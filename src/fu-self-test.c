@@ -18,6 +18,7 @@
 
 #include "../plugins/test/fu-test-plugin.h"
 #include "fu-bios-settings-private.h"
+#include "fu-cabinet-cache.h"
 #include "fu-cabinet.h"
 #include "fu-client-list.h"
 #include "fu-config-private.h"
@@ -25,10 +26,13 @@
 #include "fu-context-private.h"
 #include "fu-device-list.h"
 #include "fu-device-private.h"
+#include "fu-device-variant-cache.h"
 #include "fu-engine-config.h"
+#include "fu-engine-emulator.h"
 #include "fu-engine-helper.h"
 #include "fu-engine-requirements.h"
 #include "fu-engine.h"
+#include "fu-firmware-cache.h"
 #include "fu-history.h"
 #include "fu-idle.h"
 #include "fu-plugin-list.h"
@@ -203,6 +207,235 @@ fu_idle_func(void)
 	g_assert_false(fu_idle_has_inhibit(idle, FU_IDLE_INHIBIT_SIGNALS));
 }
 
+static gsize
+fu_device_variant_cache_count(GVariant *val)
+{
+	g_autoptr(GVariant) devices = g_variant_get_child_value(val, 0);
+	return g_variant_n_children(devices);
+}
+
+static void
+fu_device_variant_cache_func(void)
+{
+	guint64 generation;
+	g_autoptr(FuDevice) device1 = fu_device_new(NULL);
+	g_autoptr(FuDevice) device2 = fu_device_new(NULL);
+	g_autoptr(FuDeviceVariantCache) cache = fu_device_variant_cache_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = g_ptr_array_new();
+	g_autoptr(GVariant) devices1 = NULL;
+	g_autoptr(GVariant) devices2 = NULL;
+	g_autoptr(GVariant) devices3 = NULL;
+	g_autoptr(GVariant) devices4 = NULL;
+	g_autoptr(GVariant) devices5 = NULL;
+	g_autoptr(GVariant) val1 = NULL;
+	g_autoptr(GVariant) val2 = NULL;
+	g_autoptr(GVariant) val3 = NULL;
+	g_autoptr(GVariant) val4 = NULL;
+	g_autofree const gchar **removed_ids = NULL;
+	g_autofree const gchar **removed_ids2 = NULL;
+
+	fu_device_set_id(device1, "d1");
+	fu_device_set_id(device2, "d2");
+	g_ptr_array_add(devices, device1);
+	g_ptr_array_add(devices, device2);
+
+	/* serialized once, then reused until changed */
+	val1 = fu_device_variant_cache_get(cache, device1, FWUPD_CODEC_FLAG_NONE);
+	val2 = fu_device_variant_cache_get(cache, device1, FWUPD_CODEC_FLAG_NONE);
+	g_assert_true(val1 == val2);
+	val3 = fu_device_variant_cache_get(cache, device1, FWUPD_CODEC_FLAG_TRUSTED);
+	g_assert_true(val1 != val3);
+	fu_device_add_flag(device1, FWUPD_DEVICE_FLAG_UPDATABLE);
+	val4 = fu_device_variant_cache_get(cache, device1, FWUPD_CODEC_FLAG_NONE);
+	g_assert_true(val1 != val4);
+
+	/* everything */
+	devices1 = fu_device_variant_cache_array_to_variant_since(cache,
+								  devices,
+								  0,
+								  FWUPD_CODEC_FLAG_NONE,
+								  &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(devices1);
+	g_assert_cmpstr(g_variant_get_type_string(devices1), ==, "(aa{sv}ast)");
+	g_assert_cmpint(fu_device_variant_cache_count(devices1), ==, 2);
+	g_variant_get_child(devices1, 2, "t", &generation);
+	g_assert_cmpint(generation, ==, fu_device_variant_cache_get_generation(cache));
+
+	/* nothing changed */
+	devices2 = fu_device_variant_cache_array_to_variant_since(cache,
+								  devices,
+								  generation,
+								  FWUPD_CODEC_FLAG_NONE,
+								  &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(devices2);
+	g_assert_cmpint(fu_device_variant_cache_count(devices2), ==, 0);
+
+	/* one changed, one removed */
+	fu_device_add_flag(device1, FWUPD_DEVICE_FLAG_REQUIRE_AC);
+	fu_device_variant_cache_remove(cache, device2);
+	g_ptr_array_remove(devices, device2);
+	devices3 = fu_device_variant_cache_array_to_variant_since(cache,
+								  devices,
+								  generation,
+								  FWUPD_CODEC_FLAG_NONE,
+								  &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(devices3);
+	g_assert_cmpint(fu_device_variant_cache_count(devices3), ==, 1);
+	g_variant_get_child(devices3, 1, "^a&s", &removed_ids);
+	g_assert_cmpint(g_strv_length((gchar **)removed_ids), ==, 1);
+	g_assert_cmpstr(removed_ids[0], ==, fu_device_get_id(device2));
+
+	/* removed then added again is only reported as changed */
+	g_ptr_array_add(devices, device2);
+	devices5 = fu_device_variant_cache_array_to_variant_since(cache,
+								  devices,
+								  generation,
+								  FWUPD_CODEC_FLAG_NONE,
+								  &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(devices5);
+	g_assert_cmpint(fu_device_variant_cache_count(devices5), ==, 2);
+	g_variant_get_child(devices5, 1, "^a&s", &removed_ids2);
+	g_assert_cmpint(g_strv_length((gchar **)removed_ids2), ==, 0);
+
+	/* from the future */
+	devices4 = fu_device_variant_cache_array_to_variant_since(cache,
+								  devices,
+								  G_MAXUINT64,
+								  FWUPD_CODEC_FLAG_NONE,
+								  &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_null(devices4);
+}
+
+static void
+fu_firmware_cache_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *checksum1 = NULL;
+	g_autofree gchar *checksum2 = NULL;
+	g_autofree gchar *checksum3 = NULL;
+	g_autofree gchar *filename1 = NULL;
+	g_autofree gchar *filename2 = NULL;
+	g_autofree gchar *filename3 = NULL;
+	g_autofree gchar *filename_incoming1 = NULL;
+	g_autofree gchar *filename_incoming2 = NULL;
+	g_autofree gchar *path = NULL;
+	GStatBuf statbuf = {0};
+	g_autoptr(FuFirmwareCache) cache = NULL;
+	g_autoptr(GBytes) blob1 = g_bytes_new_static("hello", 5);
+	g_autoptr(GBytes) blob2 = g_bytes_new_static("world", 5);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GFile) file1 = NULL;
+	g_autoptr(GFile) file_incoming1 = NULL;
+	g_autoptr(GInputStream) stream1 = g_memory_input_stream_new_from_bytes(blob1);
+	g_autoptr(GInputStream) stream2 = g_memory_input_stream_new_from_bytes(blob2);
+
+	path = g_build_filename("/tmp/fwupd-self-test", "var", "cache", "fwupd", "firmware", NULL);
+	cache = fu_firmware_cache_new(path);
+	g_assert_cmpstr(fu_firmware_cache_get_path(cache), ==, path);
+
+	/* disabled by default */
+	checksum1 = fu_firmware_cache_add_stream(cache, stream1, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_null(checksum1);
+	g_clear_error(&error);
+	fu_firmware_cache_set_size_max(cache, 0x100000);
+
+	/* add, then check it can be found by the content checksum */
+	checksum1 = fu_firmware_cache_add_stream(cache, stream1, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(checksum1,
+			==,
+			"2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824");
+	filename1 = fu_firmware_cache_lookup(cache, checksum1, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(filename1);
+	g_assert_true(g_str_has_suffix(filename1, ".cab"));
+
+	/* the archive may not be public */
+	ret = g_stat(filename1, &statbuf) == 0;
+	g_assert_true(ret);
+	g_assert_cmpint(statbuf.st_mode & 0777, ==, 0600);
+
+	/* invalid or missing */
+	filename3 = fu_firmware_cache_lookup(cache, "../../etc/passwd", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_null(filename3);
+	g_clear_error(&error);
+	filename3 = fu_firmware_cache_lookup(
+	    cache,
+	    "0000000000000000000000000000000000000000000000000000000000000000",
+	    &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(filename3);
+	g_clear_error(&error);
+
+	/* make the first archive look old */
+	file1 = g_file_new_for_path(filename1);
+	ret = g_file_set_attribute_uint64(file1,
+					  G_FILE_ATTRIBUTE_TIME_MODIFIED,
+					  1,
+					  G_FILE_QUERY_INFO_NONE,
+					  NULL,
+					  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* only room for one archive, so the least recently used is deleted */
+	fu_firmware_cache_set_size_max(cache, 5);
+	checksum2 = fu_firmware_cache_add_stream(cache, stream2, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(checksum2);
+	g_assert_false(g_file_test(filename1, G_FILE_TEST_EXISTS));
+	filename2 = fu_firmware_cache_lookup(cache, checksum2, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(filename2);
+
+	/* adding again just marks it as used */
+	checksum3 = fu_firmware_cache_add_stream(cache, stream2, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(checksum3, ==, checksum2);
+	g_assert_true(g_file_test(filename2, G_FILE_TEST_EXISTS));
+
+	/* a partial archive is only deleted when it is stale */
+	filename_incoming1 = g_build_filename(path, "incoming-00000001.tmp", NULL);
+	ret = g_file_set_contents(filename_incoming1, "partial", -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	file_incoming1 = g_file_new_for_path(filename_incoming1);
+	ret = g_file_set_attribute_uint64(file_incoming1,
+					  G_FILE_ATTRIBUTE_TIME_MODIFIED,
+					  1,
+					  G_FILE_QUERY_INFO_NONE,
+					  NULL,
+					  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	filename_incoming2 = g_build_filename(path, "incoming-00000002.tmp", NULL);
+	ret = g_file_set_contents(filename_incoming2, "partial", -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_firmware_cache_evict(cache, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_false(g_file_test(filename_incoming1, G_FILE_TEST_EXISTS));
+	g_assert_true(g_file_test(filename_incoming2, G_FILE_TEST_EXISTS));
+	g_assert_true(g_file_test(filename2, G_FILE_TEST_EXISTS));
+	(void)g_unlink(filename_incoming2);
+
+	/* disabled */
+	fu_firmware_cache_set_size_max(cache, 0);
+	g_free(checksum3);
+	checksum3 = fu_firmware_cache_add_stream(cache, stream2, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_null(checksum3);
+}
+
 static void
 fu_engine_generate_md_func(gconstpointer user_data)
 {
@@ -2275,8 +2508,11 @@ fu_engine_get_details_added_func(gconstpointer user_data)
 {
 	FuTest *self = (FuTest *)user_data;
 	FuDevice *device_tmp;
+	FuMetrics *metrics = fu_context_get_metrics(self->ctx);
 	FwupdRelease *release;
 	gboolean ret;
+	guint64 cache_hits;
+	guint64 cache_misses;
 	g_autofree gchar *checksum_sha256 = NULL;
 	g_autofree gchar *filename = NULL;
 	g_autoptr(FuDevice) device = fu_device_new(self->ctx);
@@ -2286,11 +2522,18 @@ fu_engine_get_details_added_func(gconstpointer user_data)
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GInputStream) stream = NULL;
 	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) devices2 = NULL;
 	g_autoptr(XbSilo) silo_empty = xb_silo_new();
 
 	/* no metadata in daemon */
 	fu_engine_set_silo(engine, silo_empty);
 
+	/* the parsed archive cache is disabled by default */
+	fu_config_set_default(FU_CONFIG(fu_engine_get_config(engine)),
+			      "fwupd",
+			      "CabinetCacheSizeMax",
+			      "67108864");
+
 	/* load engine to get FuConfig set up */
 	ret = fu_engine_load(engine, FU_ENGINE_LOAD_FLAG_NO_CACHE, progress, &error);
 	g_assert_no_error(error);
@@ -2317,9 +2560,13 @@ fu_engine_get_details_added_func(gconstpointer user_data)
 	checksum_sha256 = fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA256, &error);
 	g_assert_no_error(error);
 	g_assert_nonnull(checksum_sha256);
+	cache_hits = fu_metrics_get_counter(metrics, "CabinetCacheHit");
+	cache_misses = fu_metrics_get_counter(metrics, "CabinetCacheMiss");
 	devices = fu_engine_get_details(engine, request, stream, &error);
 	g_assert_no_error(error);
 	g_assert_nonnull(devices);
+	g_assert_cmpint(fu_metrics_get_counter(metrics, "CabinetCacheHit"), ==, cache_hits);
+	g_assert_cmpint(fu_metrics_get_counter(metrics, "CabinetCacheMiss"), ==, cache_misses + 1);
 	g_assert_cmpint(devices->len, ==, 1);
 	device_tmp = g_ptr_array_index(devices, 0);
 	g_assert_cmpstr(fu_device_get_name(device_tmp), ==, "test device");
@@ -2327,6 +2574,17 @@ fu_engine_get_details_added_func(gconstpointer user_data)
 	g_assert_nonnull(release);
 	g_assert_cmpstr(fwupd_release_get_version(release), ==, "1.2.3");
 	g_assert_true(fwupd_release_has_checksum(release, checksum_sha256));
+
+	/* the same archive again uses the parsed cabinet */
+	devices2 = fu_engine_get_details(engine, request, stream, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(devices2);
+	g_assert_cmpint(devices2->len, ==, 1);
+	g_assert_cmpint(fu_metrics_get_counter(metrics, "CabinetCacheHit"), ==, cache_hits + 1);
+	g_assert_cmpint(fu_metrics_get_counter(metrics, "CabinetCacheMiss"), ==, cache_misses + 1);
+	release = fu_device_get_release_default(g_ptr_array_index(devices2, 0));
+	g_assert_nonnull(release);
+	g_assert_true(fwupd_release_has_checksum(release, checksum_sha256));
 }
 
 static void
@@ -2374,13 +2632,18 @@ static void
 fu_engine_downgrade_func(gconstpointer user_data)
 {
 	FuTest *self = (FuTest *)user_data;
+	FuMetrics *metrics = fu_context_get_metrics(self->ctx);
 	FwupdRelease *rel;
 	gboolean ret;
+	guint64 silo_index_hits;
+	guint64 silo_index_misses;
+	g_autofree gchar *remote_id = NULL;
 	g_autoptr(FuDevice) device = fu_device_new(self->ctx);
 	g_autoptr(FuEngine) engine = fu_engine_new(self->ctx);
 	g_autoptr(FuEngineRequest) request = fu_engine_request_new(NULL);
 	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_unknown = NULL;
 	g_autoptr(GPtrArray) devices = NULL;
 	g_autoptr(GPtrArray) devices_pre = NULL;
 	g_autoptr(GPtrArray) releases_dg = NULL;
@@ -2516,11 +2779,20 @@ fu_engine_downgrade_func(gconstpointer user_data)
 	g_assert_true(fu_device_has_flag(device, FWUPD_DEVICE_FLAG_SUPPORTED));
 	g_assert_true(fu_device_has_private_flag(device, FU_DEVICE_PRIVATE_FLAG_REGISTERED));
 
-	/* get the releases for one device */
+	/* get the releases for one device, using the GUID index */
+	silo_index_hits = fu_metrics_get_counter(metrics, "SiloIndexHit");
 	releases = fu_engine_get_releases(engine, request, fu_device_get_id(device), &error);
 	g_assert_no_error(error);
 	g_assert_nonnull(releases);
 	g_assert_cmpint(releases->len, ==, 4);
+	g_assert_cmpint(fu_metrics_get_counter(metrics, "SiloIndexHit"), >, silo_index_hits);
+
+	/* not in any remote, using the checksum index for both SHA256 and SHA1 */
+	stream_unknown = g_memory_input_stream_new_from_data("hello", 5, NULL);
+	silo_index_misses = fu_metrics_get_counter(metrics, "SiloIndexMiss");
+	remote_id = fu_engine_get_remote_id_for_stream(engine, stream_unknown);
+	g_assert_null(remote_id);
+	g_assert_cmpint(fu_metrics_get_counter(metrics, "SiloIndexMiss"), ==, silo_index_misses + 2);
 
 	/* no upgrades, as no firmware is approved */
 	releases_up = fu_engine_get_upgrades(engine, request, fu_device_get_id(device), &error);
@@ -2562,6 +2834,189 @@ fu_engine_downgrade_func(gconstpointer user_data)
 	g_assert_null(releases_up2);
 }
 
+static gchar *
+fu_engine_emulator_normalize_json(const gchar *json, gsize jsonsz)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(JsonGenerator) json_generator = json_generator_new();
+	g_autoptr(JsonParser) parser = json_parser_new();
+	gboolean ret;
+
+	ret = json_parser_load_from_data(parser, json, jsonsz, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	json_generator_set_pretty(json_generator, TRUE);
+	json_generator_set_root(json_generator, json_parser_get_root(parser));
+	return json_generator_to_data(json_generator, NULL);
+}
+
+static void
+fu_engine_emulator_binary_func(void)
+{
+	const gchar *json = "{\"UsbDevices\":[{\"GType\":\"FuUsbDevice\","
+			    "\"BackendId\":\"usb:01:00:06\","
+			    "\"UsbEvents\":["
+			    "{\"Id\":\"GetCustomIndex:ClassId=0xff,SubclassId=0x01\","
+			    "\"Data\":\"Aw==\"},"
+			    "{\"Id\":\"#f9f98a90\",\"Rc\":-1}],"
+			    "\"Events\":[{\"Id\":\"#deadbeef\",\"Error\":3,\"ErrorMsg\":\"x\"}],"
+			    "\"Created\":\"2024-01-01T00:00:00Z\"}]}";
+	g_autofree gchar *json_expected = NULL;
+	g_autofree gchar *json_actual = NULL;
+	g_autoptr(FuArchive) archive = NULL;
+	g_autoptr(GBytes) blob_bin = NULL;
+	g_autoptr(GBytes) blob_bin_trunc = NULL;
+	g_autoptr(GBytes) blob_json = g_bytes_new_static(json, strlen(json));
+	g_autoptr(GBytes) blob_setup = NULL;
+	g_autoptr(GBytes) blob_zip = NULL;
+	g_autoptr(GBytes) blob_zip_trunc = NULL;
+	g_autoptr(GError) error = NULL;
+
+#ifndef HAVE_LIBARCHIVE
+	g_test_skip("no libarchive support");
+	return;
+#endif
+
+	/* JSON to binary */
+	blob_bin = fu_engine_emulator_convert(blob_json,
+					      FU_ENGINE_EMULATOR_FORMAT_BINARY,
+					      FU_ENGINE_EMULATOR_COMPRESSION_NONE,
+					      &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_bin);
+
+	/* and back, with the uncompressed event ID and the member order preserved */
+	blob_zip = fu_engine_emulator_convert(blob_bin,
+					      FU_ENGINE_EMULATOR_FORMAT_JSON,
+					      FU_ENGINE_EMULATOR_COMPRESSION_NONE,
+					      &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_zip);
+	archive = fu_archive_new(blob_zip, FU_ARCHIVE_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(archive);
+	blob_setup = fu_archive_lookup_by_fn(archive, "setup.json", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_setup);
+	json_expected = fu_engine_emulator_normalize_json(json, strlen(json));
+	json_actual = fu_engine_emulator_normalize_json(g_bytes_get_data(blob_setup, NULL),
+							g_bytes_get_size(blob_setup));
+	g_assert_cmpstr(json_actual, ==, json_expected);
+
+	/* truncated */
+	blob_bin_trunc = g_bytes_new_from_bytes(blob_bin, 0, g_bytes_get_size(blob_bin) - 1);
+	blob_zip_trunc = fu_engine_emulator_convert(blob_bin_trunc,
+						    FU_ENGINE_EMULATOR_FORMAT_JSON,
+						    FU_ENGINE_EMULATOR_COMPRESSION_NONE,
+						    &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_null(blob_zip_trunc);
+}
+
+static void
+fu_engine_metadata_silos_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	FuMetrics *metrics = fu_context_get_metrics(self->ctx);
+	gboolean ret;
+	guint64 silo_hits;
+	guint64 silo_misses;
+	g_autofree gchar *cachedir = fu_path_from_kind(FU_PATH_KIND_CACHEDIR_PKG);
+	g_autofree gchar *fn_orphan = NULL;
+	g_autofree gchar *fn_stable = NULL;
+	g_autoptr(FuEngine) engine = fu_engine_new(self->ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GError) error = NULL;
+
+	/* ensure empty tree */
+	fu_self_test_mkroot();
+	ret = g_file_set_contents("/tmp/fwupd-self-test/stable.xml", "<components/>", -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = g_file_set_contents("/tmp/fwupd-self-test/testing.xml", "<components/>", -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_engine_load(engine, FU_ENGINE_LOAD_FLAG_REMOTES, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* namespaced so that a remote called local cannot use the local silo */
+	fn_stable = g_build_filename(cachedir, "metadata", "remote-stable.xmlb", NULL);
+	g_assert_true(g_file_test(fn_stable, G_FILE_TEST_EXISTS));
+
+	/* a remote that no longer exists */
+	fn_orphan = g_build_filename(cachedir, "metadata", "remote-deleted.xmlb", NULL);
+	ret = g_file_set_contents(fn_orphan, "XBDB", -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* only the changed remote is recompiled */
+	ret = g_file_set_contents("/tmp/fwupd-self-test/testing.xml",
+				  "<components><component/></components>",
+				  -1,
+				  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	silo_hits = fu_metrics_get_counter(metrics, "MetadataSiloHit");
+	silo_misses = fu_metrics_get_counter(metrics, "MetadataSiloMiss");
+	ret = fu_engine_reload_metadata(engine, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_metrics_get_counter(metrics, "MetadataSiloHit"), ==, silo_hits + 1);
+	g_assert_cmpint(fu_metrics_get_counter(metrics, "MetadataSiloMiss"), ==, silo_misses + 1);
+
+	/* orphaned silos are deleted */
+	g_assert_true(g_file_test(fn_stable, G_FILE_TEST_EXISTS));
+	g_assert_false(g_file_test(fn_orphan, G_FILE_TEST_EXISTS));
+}
+
+static void
+fu_engine_update_metadata_not_modified_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	FwupdRemote *remote;
+	gboolean ret;
+	g_autofree gchar *checksum = NULL;
+	g_autoptr(FuEngine) engine = fu_engine_new(self->ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GBytes) bytes_raw = g_bytes_new(NULL, 0);
+	g_autoptr(GBytes) bytes_sig = g_bytes_new_static("hello", 5);
+	g_autoptr(GBytes) bytes_sig2 = g_bytes_new_static("world", 5);
+	g_autoptr(GError) error = NULL;
+
+	/* ensure empty tree */
+	fu_self_test_mkroot();
+	ret = g_file_set_contents("/tmp/fwupd-self-test/stable.xml", "<components/>", -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_engine_load(engine,
+			     FU_ENGINE_LOAD_FLAG_REMOTES | FU_ENGINE_LOAD_FLAG_NO_CACHE,
+			     progress,
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* pretend the daemon already verified this signature a long time ago */
+	remote = fu_engine_get_remote_by_id(engine, "stable", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(remote);
+	checksum = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, bytes_sig);
+	fwupd_remote_set_checksum_sig(remote, checksum);
+	fwupd_remote_set_mtime(remote, 0);
+	g_assert_cmpint(fwupd_remote_get_age(remote), >, 1000000);
+
+	/* HTTP 304 Not Modified, so the client only sends the signature */
+	ret = fu_engine_update_metadata_bytes(engine, "stable", bytes_raw, bytes_sig, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fwupd_remote_get_age(remote), <, 60);
+
+	/* a different signature always needs the metadata */
+	ret = fu_engine_update_metadata_bytes(engine, "stable", bytes_raw, bytes_sig2, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_false(ret);
+}
+
 static void
 fu_engine_md_verfmt_func(gconstpointer user_data)
 {
@@ -3253,6 +3708,248 @@ fu_engine_multiple_rels_func(gconstpointer user_data)
 	g_assert_true(ret);
 }
 
+static FuDevice *
+fu_engine_install_parallel_device_new(FuTest *self, const gchar *id)
+{
+	FuDevice *device = fu_device_new(self->ctx);
+	fu_device_set_version_format(device, FWUPD_VERSION_FORMAT_TRIPLET);
+	fu_device_set_version(device, "1.2.2");
+	fu_device_set_id(device, id);
+	fu_device_build_vendor_id_u16(device, "USB", 0xFFFF);
+	fu_device_add_protocol(device, "com.acme");
+	fu_device_set_name(device, "Test Device");
+	fu_device_set_plugin(device, "test");
+	fu_device_add_instance_id(device, "12345678-1234-1234-1234-123456789012");
+	fu_device_add_flag(device, FWUPD_DEVICE_FLAG_UPDATABLE);
+	fu_device_add_flag(device, FWUPD_DEVICE_FLAG_UNSIGNED_PAYLOAD);
+	fu_device_add_flag(device, FWUPD_DEVICE_FLAG_INSTALL_ALL_RELEASES);
+	fu_device_set_created_usec(device, 1515338000ull * G_USEC_PER_SEC);
+	fu_device_set_metadata_integer(device, "nr-update", 0);
+	return device;
+}
+
+static FuEngine *
+fu_engine_install_parallel_engine_new(FuTest *self)
+{
+	FuEngine *engine = fu_engine_new(self->ctx);
+	gboolean ret;
+	g_autoptr(FuPlugin) plugin = fu_plugin_new_from_gtype(fu_test_plugin_get_type(), self->ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new();
+
+	/* ensure empty tree */
+	fu_self_test_mkroot();
+
+	/* no metadata in daemon */
+	fu_engine_set_silo(engine, silo_empty);
+
+	/* set up dummy plugin */
+	ret = fu_plugin_reset_config_values(plugin, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_engine_add_plugin(engine, plugin);
+
+	ret = fu_engine_load(engine, FU_ENGINE_LOAD_FLAG_NO_CACHE, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	return engine;
+}
+
+/* install every release of the cabinet on every device at the same time */
+static gboolean
+fu_engine_install_parallel_install(FuEngine *engine, GPtrArray *devices, GError **error)
+{
+	gboolean ret;
+	g_autofree gchar *filename = NULL;
+	g_autoptr(FuCabinet) cabinet = NULL;
+	g_autoptr(FuEngineRequest) request = fu_engine_request_new(NULL);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(GPtrArray) releases = NULL;
+	g_autoptr(GPtrArray) rels = NULL;
+	g_autoptr(XbNode) component = NULL;
+
+	filename = g_test_build_filename(G_TEST_BUILT,
+					 "tests",
+					 "multiple-rels",
+					 "multiple-rels-1.2.4.cab",
+					 NULL);
+	stream = fu_input_stream_from_path(filename, &error_local);
+	g_assert_no_error(error_local);
+	g_assert_nonnull(stream);
+	cabinet = fu_engine_build_cabinet_from_stream(engine, stream, &error_local);
+	g_assert_no_error(error_local);
+	g_assert_nonnull(cabinet);
+	component = fu_cabinet_get_component(cabinet, "com.hughski.test.firmware", &error_local);
+	g_assert_no_error(error_local);
+	g_assert_nonnull(component);
+	rels = xb_node_query(component, "releases/release", 0, &error_local);
+	g_assert_no_error(error_local);
+	g_assert_nonnull(rels);
+
+	releases = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	for (guint j = 0; j < devices->len; j++) {
+		FuDevice *device = g_ptr_array_index(devices, j);
+		for (guint i = 0; i < rels->len; i++) {
+			XbNode *rel = g_ptr_array_index(rels, i);
+			g_autoptr(FuRelease) release = fu_release_new();
+			fu_release_set_device(release, device);
+			ret = fu_release_load(release,
+					      cabinet,
+					      component,
+					      rel,
+					      FWUPD_INSTALL_FLAG_NONE,
+					      &error_local);
+			g_assert_no_error(error_local);
+			g_assert_true(ret);
+			g_ptr_array_add(releases, g_steal_pointer(&release));
+		}
+	}
+	ret = fu_engine_install_releases(engine,
+					 request,
+					 releases,
+					 cabinet,
+					 progress,
+					 FWUPD_INSTALL_FLAG_PARALLEL,
+					 error);
+	if (ret)
+		g_assert_cmpint(fu_progress_get_percentage(progress), ==, 100);
+	return ret;
+}
+
+static void
+fu_engine_install_parallel_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	gboolean ret;
+	g_autoptr(FuEngine) engine = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+
+#ifndef HAVE_LIBARCHIVE
+	g_test_skip("no libarchive support");
+	return;
+#endif
+
+	engine = fu_engine_install_parallel_engine_new(self);
+
+	/* add some independent devices so each gets its own lane */
+	for (guint i = 0; i < 3; i++) {
+		g_autofree gchar *id = g_strdup_printf("test_device_%u", i);
+		g_autoptr(FuDevice) device = fu_engine_install_parallel_device_new(self, id);
+		fu_engine_add_device(engine, device);
+		g_ptr_array_add(devices, g_steal_pointer(&device));
+	}
+
+	/* install them all at the same time */
+	ret = fu_engine_install_parallel_install(engine, devices, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* check each lane did 1.2.2 -> 1.2.3 -> 1.2.4 */
+	for (guint j = 0; j < devices->len; j++) {
+		FuDevice *device = g_ptr_array_index(devices, j);
+		g_assert_cmpint(fu_device_get_metadata_integer(device, "nr-update"), ==, 2);
+		g_assert_cmpstr(fu_device_get_version(device), ==, "1.2.4");
+	}
+}
+
+static void
+fu_engine_install_parallel_composite_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	gboolean ret;
+	g_autoptr(FuDevice) parent = fu_device_new(self->ctx);
+	g_autoptr(FuEngine) engine = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+
+#ifndef HAVE_LIBARCHIVE
+	g_test_skip("no libarchive support");
+	return;
+#endif
+
+	engine = fu_engine_install_parallel_engine_new(self);
+
+	/* two children of one composite device share a lane */
+	fu_device_set_id(parent, "test_parent");
+	fu_device_set_plugin(parent, "test");
+	for (guint i = 0; i < 2; i++) {
+		g_autofree gchar *id = g_strdup_printf("test_child_%u", i);
+		g_autoptr(FuDevice) device = fu_engine_install_parallel_device_new(self, id);
+		fu_device_add_child(parent, device);
+		g_ptr_array_add(devices, g_steal_pointer(&device));
+	}
+
+	/* an independent device gets another lane in the same wave */
+	g_ptr_array_add(devices, fu_engine_install_parallel_device_new(self, "test_device"));
+
+	/* a device with an explicit later order is installed in a wave of its own */
+	g_ptr_array_add(devices, fu_engine_install_parallel_device_new(self, "test_device_later"));
+	fu_device_add_private_flag(g_ptr_array_index(devices, 3),
+				   FU_DEVICE_PRIVATE_FLAG_EXPLICIT_ORDER);
+	fu_device_set_order(g_ptr_array_index(devices, 3), 1);
+	for (guint i = 0; i < devices->len; i++)
+		fu_engine_add_device(engine, g_ptr_array_index(devices, i));
+
+	ret = fu_engine_install_parallel_install(engine, devices, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	for (guint j = 0; j < devices->len; j++) {
+		FuDevice *device = g_ptr_array_index(devices, j);
+		g_assert_cmpint(fu_device_get_metadata_integer(device, "nr-update"), ==, 2);
+		g_assert_cmpstr(fu_device_get_version(device), ==, "1.2.4");
+	}
+}
+
+static void
+fu_engine_install_parallel_failure_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	FuPowerState power_state = fu_context_get_power_state(self->ctx);
+	gboolean ret;
+	g_autoptr(FuEngine) engine = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+
+#ifndef HAVE_LIBARCHIVE
+	g_test_skip("no libarchive support");
+	return;
+#endif
+
+	engine = fu_engine_install_parallel_engine_new(self);
+	for (guint i = 0; i < 3; i++) {
+		g_autofree gchar *id = g_strdup_printf("test_device_%u", i);
+		g_autoptr(FuDevice) device = fu_engine_install_parallel_device_new(self, id);
+		fu_engine_add_device(engine, device);
+		g_ptr_array_add(devices, g_steal_pointer(&device));
+	}
+
+	/* the first device cannot be updated when on battery */
+	fu_device_add_flag(g_ptr_array_index(devices, 0), FWUPD_DEVICE_FLAG_REQUIRE_AC);
+	fu_context_set_power_state(self->ctx, FU_POWER_STATE_BATTERY_DISCHARGING);
+	ret = fu_engine_install_parallel_install(engine, devices, &error);
+	fu_context_set_power_state(self->ctx, power_state);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_AC_POWER_REQUIRED);
+	g_assert_false(ret);
+
+	/* the failure is recorded, and the other lanes still completed */
+	for (guint j = 0; j < devices->len; j++) {
+		FuDevice *device = g_ptr_array_index(devices, j);
+		if (j == 0) {
+			g_assert_cmpint(fu_device_get_update_state(device),
+					==,
+					FWUPD_UPDATE_STATE_FAILED);
+			g_assert_cmpstr(fu_device_get_version(device), ==, "1.2.2");
+			continue;
+		}
+		g_assert_cmpint(fu_device_get_metadata_integer(device, "nr-update"), ==, 2);
+		g_assert_cmpstr(fu_device_get_version(device), ==, "1.2.4");
+	}
+}
+
 static void
 fu_engine_history_inherit(gconstpointer user_data)
 {
@@ -4299,6 +4996,80 @@ fu_device_list_equivalent_id_func(gconstpointer user_data)
 	g_assert_null(device);
 }
 
+static void
+fu_device_list_stress_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	const guint devices_cnt = 5000;
+	g_autoptr(FuDeviceList) device_list = fu_device_list_new();
+	g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func(g_object_unref);
+	g_autoptr(GPtrArray) devices_all = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	/* add lots of devices, each of which will look up the ID and connection */
+	for (guint i = 0; i < devices_cnt; i++) {
+		g_autoptr(FuDevice) device = fu_device_new(self->ctx);
+		g_autofree gchar *id = g_strdup_printf("device%u", i);
+		g_autofree gchar *physical_id = g_strdup_printf("usb:%02x:%02x", i / 0x100, i % 0x100);
+		g_autofree gchar *instance_id = g_strdup_printf("USB\\VID_273F&PID_%04X", i);
+		fu_device_set_id(device, id);
+		fu_device_set_physical_id(device, physical_id);
+		fu_device_set_logical_id(device, "logical");
+		fu_device_add_instance_id(device, instance_id);
+		fu_device_list_add(device_list, device);
+		g_ptr_array_add(devices, g_steal_pointer(&device));
+	}
+	g_debug("added %u devices in %.2fms", devices_cnt, g_timer_elapsed(timer, NULL) * 1000.f);
+
+	/* find each one by ID, abbreviated ID and GUID */
+	g_timer_reset(timer);
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index(devices, i);
+		g_autofree gchar *id_short = g_strndup(fu_device_get_id(device), 12);
+		g_autofree gchar *instance_id = g_strdup_printf("USB\\VID_273F&PID_%04X", i);
+		g_autoptr(FuDevice) device_tmp1 = NULL;
+		g_autoptr(FuDevice) device_tmp2 = NULL;
+		g_autoptr(FuDevice) device_tmp3 = NULL;
+		g_autoptr(GError) error = NULL;
+
+		device_tmp1 = fu_device_list_get_by_id(device_list, fu_device_get_id(device), &error);
+		g_assert_no_error(error);
+		g_assert_true(device_tmp1 == device);
+		device_tmp2 = fu_device_list_get_by_id(device_list, id_short, &error);
+		g_assert_no_error(error);
+		g_assert_true(device_tmp2 == device);
+		device_tmp3 = fu_device_list_get_by_guid(device_list, instance_id, &error);
+		g_assert_no_error(error);
+		g_assert_true(device_tmp3 == device);
+	}
+	g_debug("found %u devices in %.2fms", devices_cnt, g_timer_elapsed(timer, NULL) * 1000.f);
+
+	/* changing the ID after adding updates the index */
+	{
+		FuDevice *device = g_ptr_array_index(devices, 0);
+		g_autofree gchar *id_old = g_strdup(fu_device_get_id(device));
+		g_autoptr(FuDevice) device_tmp1 = NULL;
+		g_autoptr(FuDevice) device_tmp2 = NULL;
+		g_autoptr(GError) error = NULL;
+
+		fu_device_set_id(device, "renamed");
+		device_tmp1 = fu_device_list_get_by_id(device_list, fu_device_get_id(device), &error);
+		g_assert_no_error(error);
+		g_assert_true(device_tmp1 == device);
+		device_tmp2 = fu_device_list_get_by_id(device_list, id_old, &error);
+		g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+		g_assert_null(device_tmp2);
+	}
+
+	/* remove them all */
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index(devices, i);
+		fu_device_list_remove(device_list, device);
+	}
+	devices_all = fu_device_list_get_all(device_list);
+	g_assert_cmpint(devices_all->len, ==, 0);
+}
+
 static void
 fu_device_list_unconnected_no_delay_func(gconstpointer user_data)
 {
@@ -4395,10 +5166,41 @@ fu_device_list_func(gconstpointer user_data)
 	g_assert_cmpstr(fu_device_get_id(device), ==, "1a8d0d9a96ad3e67ba76cf3033623625dc6d6882");
 	g_clear_object(&device);
 
+	/* find by GUID in a different case */
+	device =
+	    fu_device_list_get_by_guid(device_list, "579A3B1C-D1DB-5BDC-B6B9-E2C1B28D5B8A", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(device);
+	g_assert_cmpstr(fu_device_get_id(device), ==, "1a8d0d9a96ad3e67ba76cf3033623625dc6d6882");
+	g_clear_object(&device);
+
 	/* find by missing GUID */
 	device = fu_device_list_get_by_guid(device_list, "notfound", &error);
 	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
 	g_assert_null(device);
+	g_clear_error(&error);
+
+	/* find by a GUID added after the device was indexed */
+	fu_device_add_instance_id(device2, "later");
+	device = fu_device_list_get_by_guid(device_list, "later", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(device);
+	g_assert_true(device == device2);
+	g_clear_object(&device);
+
+	/* find by an ID changed after the device was indexed */
+	fu_device_set_id(device1, "device1-renamed");
+	device = fu_device_list_get_by_id(device_list, fu_device_get_id(device1), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(device);
+	g_assert_true(device == device1);
+	g_clear_object(&device);
+	device = fu_device_list_get_by_id(device_list,
+					  "99249eb1bd9ef0b6e192b271a8cb6a3090cfec7a",
+					  &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(device);
+	g_clear_error(&error);
 
 	/* remove device */
 	added_cnt = removed_cnt = changed_cnt = 0;
@@ -5001,6 +5803,91 @@ fu_test_build_cab(gboolean compressed, ...)
 	return g_steal_pointer(&cabinet_blob);
 }
 
+static FuCabinet *
+fu_test_build_cabinet(const gchar *version)
+{
+	gboolean ret;
+	g_autofree gchar *xml = NULL;
+	g_autoptr(FuCabinet) cabinet = fu_cabinet_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	xml = g_strdup_printf("<component type=\"firmware\">\n"
+			      "  <id>com.acme.example.firmware</id>\n"
+			      "  <provides>\n"
+			      "    <firmware type=\"flashed\">"
+			      "b585990a-003e-5270-89d5-3705a17f9a43</firmware>\n"
+			      "  </provides>\n"
+			      "  <releases>\n"
+			      "    <release version=\"%s\"/>\n"
+			      "  </releases>\n"
+			      "</component>",
+			      version);
+	blob = fu_test_build_cab(FALSE, "acme.metainfo.xml", xml, "firmware.bin", version, NULL);
+	ret = fu_firmware_parse_bytes(FU_FIRMWARE(cabinet),
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NONE,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	return g_steal_pointer(&cabinet);
+}
+
+static void
+fu_cabinet_cache_func(void)
+{
+	gboolean ret;
+	guint64 size;
+	g_autoptr(FuCabinet) cabinet1 = fu_test_build_cabinet("1.2.3");
+	g_autoptr(FuCabinet) cabinet2 = fu_test_build_cabinet("1.2.4");
+	g_autoptr(FuCabinet) cabinet_tmp1 = NULL;
+	g_autoptr(FuCabinet) cabinet_tmp2 = NULL;
+	g_autoptr(FuCabinet) cabinet_tmp3 = NULL;
+	g_autoptr(FuCabinet) cabinet_tmp4 = NULL;
+	g_autoptr(FuCabinetCache) cache = fu_cabinet_cache_new();
+	g_autoptr(GError) error = NULL;
+
+	/* disabled by default */
+	ret = fu_cabinet_cache_add(cache, "csum1", cabinet1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_cabinet_cache_get_size(cache), ==, 0);
+
+	/* add, then find by checksum */
+	fu_cabinet_cache_set_size_max(cache, G_MAXUINT64);
+	ret = fu_cabinet_cache_add(cache, "csum1", cabinet1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	size = fu_cabinet_cache_get_size(cache);
+	g_assert_cmpint(size, >, 0);
+	cabinet_tmp1 = fu_cabinet_cache_lookup(cache, "csum1");
+	g_assert_true(cabinet_tmp1 == cabinet1);
+	g_assert_null(fu_cabinet_cache_lookup(cache, "csum2"));
+
+	/* only room for one archive, so the least recently used is dropped */
+	fu_cabinet_cache_set_size_max(cache, size * 3 / 2);
+	ret = fu_cabinet_cache_add(cache, "csum2", cabinet2, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	cabinet_tmp2 = fu_cabinet_cache_lookup(cache, "csum1");
+	g_assert_null(cabinet_tmp2);
+	cabinet_tmp3 = fu_cabinet_cache_lookup(cache, "csum2");
+	g_assert_true(cabinet_tmp3 == cabinet2);
+
+	/* clear */
+	fu_cabinet_cache_clear(cache);
+	g_assert_cmpint(fu_cabinet_cache_get_size(cache), ==, 0);
+
+	/* disabled */
+	fu_cabinet_cache_set_size_max(cache, 0);
+	ret = fu_cabinet_cache_add(cache, "csum1", cabinet1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	cabinet_tmp4 = fu_cabinet_cache_lookup(cache, "csum1");
+	g_assert_null(cabinet_tmp4);
+}
+
 static void
 fu_test_plugin_composite_device_added_cb(FuPlugin *plugin, FuDevice *device, gpointer user_data)
 {
@@ -7137,6 +8024,55 @@ fu_test_engine_fake_usb(gconstpointer user_data)
 	g_assert_cmpstr(fu_device_get_logical_id(device), ==, NULL);
 }
 
+static void
+fu_test_engine_fake_parallel_coldplug(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	gboolean ret;
+	g_autoptr(FuDevice) device_hidraw = NULL;
+	g_autoptr(FuDevice) device_usb = NULL;
+	g_autoptr(FuEngine) engine = fu_engine_new(self->ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GError) error = NULL;
+
+	/* non-linux */
+	if (!fu_context_has_backend(self->ctx, "udev")) {
+		g_test_skip("no Udev backend");
+		return;
+	}
+
+	/* the hidraw device is a child of the USB device, so both are probed in one worker */
+	fu_config_set_default(FU_CONFIG(fu_engine_get_config(engine)),
+			      "fwupd",
+			      "ParallelColdplug",
+			      "true");
+	fu_engine_add_plugin_filter(engine, "hughski_colorhug");
+	fu_engine_add_plugin_filter(engine, "pixart_rf");
+	ret = fu_engine_load(engine,
+			     FU_ENGINE_LOAD_FLAG_COLDPLUG | FU_ENGINE_LOAD_FLAG_BUILTIN_PLUGINS |
+				 FU_ENGINE_LOAD_FLAG_NO_IDLE_SOURCES | FU_ENGINE_LOAD_FLAG_READONLY,
+			     progress,
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_true(fu_engine_config_get_parallel_coldplug(fu_engine_get_config(engine)));
+
+	/* same results as the serial coldplug */
+	device_usb =
+	    fu_engine_get_device(engine, "d787669ee4a103fe0b361fe31c10ea037c72f27c", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(device_usb);
+	g_assert_cmpstr(fu_device_get_plugin(device_usb), ==, "hughski_colorhug");
+	g_assert_cmpstr(fu_device_get_physical_id(device_usb), ==, "1-1");
+	device_hidraw =
+	    fu_engine_get_device(engine, "6acd27f1feb25ba3b604063de4c13b604776b2f5", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(device_hidraw);
+	g_assert_cmpstr(fu_device_get_plugin(device_hidraw), ==, "pixart_rf");
+	g_assert_cmpstr(fu_device_get_name(device_hidraw), ==, "PIXART Pixart dual-mode mouse");
+	g_assert_cmpstr(fu_device_get_physical_id(device_hidraw), ==, "usb-0000:00:14.0-1/input1");
+}
+
 static void
 fu_test_engine_fake_v4l(gconstpointer user_data)
 {
@@ -7431,6 +8367,9 @@ main(int argc, char **argv)
 		g_test_add_data_func("/fwupd/console", self, fu_console_func);
 	}
 	g_test_add_func("/fwupd/idle", fu_idle_func);
+	g_test_add_func("/fwupd/firmware-cache", fu_firmware_cache_func);
+	g_test_add_func("/fwupd/cabinet-cache", fu_cabinet_cache_func);
+	g_test_add_func("/fwupd/device-variant-cache", fu_device_variant_cache_func);
 	g_test_add_func("/fwupd/client-list", fu_client_list_func);
 	g_test_add_func("/fwupd/remote{download}", fu_remote_download_func);
 	g_test_add_func("/fwupd/remote{base-uri}", fu_remote_baseuri_func);
@@ -7453,6 +8392,7 @@ main(int argc, char **argv)
 	g_test_add_data_func("/fwupd/device-list{equivalent-id}",
 			     self,
 			     fu_device_list_equivalent_id_func);
+	g_test_add_data_func("/fwupd/device-list{stress}", self, fu_device_list_stress_func);
 	g_test_add_data_func("/fwupd/device-list{delay}", self, fu_device_list_delay_func);
 	g_test_add_data_func("/fwupd/device-list{explicit-order}",
 			     self,
@@ -7511,6 +8451,15 @@ main(int argc, char **argv)
 	g_test_add_data_func("/fwupd/engine{multiple-releases}",
 			     self,
 			     fu_engine_multiple_rels_func);
+	g_test_add_data_func("/fwupd/engine{install-parallel}",
+			     self,
+			     fu_engine_install_parallel_func);
+	g_test_add_data_func("/fwupd/engine{install-parallel-composite}",
+			     self,
+			     fu_engine_install_parallel_composite_func);
+	g_test_add_data_func("/fwupd/engine{install-parallel-failure}",
+			     self,
+			     fu_engine_install_parallel_failure_func);
 	g_test_add_data_func("/fwupd/engine{install-loop-restart}",
 			     self,
 			     fu_engine_install_loop_restart_func);
@@ -7521,6 +8470,9 @@ main(int argc, char **argv)
 	g_test_add_data_func("/fwupd/engine{history-error}", self, fu_engine_history_error_func);
 	g_test_add_data_func("/fwupd/engine{fake-hidraw}", self, fu_test_engine_fake_hidraw);
 	g_test_add_data_func("/fwupd/engine{fake-usb}", self, fu_test_engine_fake_usb);
+	g_test_add_data_func("/fwupd/engine{fake-parallel-coldplug}",
+			     self,
+			     fu_test_engine_fake_parallel_coldplug);
 	g_test_add_data_func("/fwupd/engine{fake-serio}", self, fu_test_engine_fake_serio);
 	g_test_add_data_func("/fwupd/engine{fake-nvme}", self, fu_test_engine_fake_nvme);
 	g_test_add_data_func("/fwupd/engine{fake-block}", self, fu_test_engine_fake_block);
@@ -7543,6 +8495,11 @@ main(int argc, char **argv)
 	g_test_add_data_func("/fwupd/engine{partial-hash}", self, fu_engine_partial_hash_func);
 	g_test_add_data_func("/fwupd/engine{downgrade}", self, fu_engine_downgrade_func);
 	g_test_add_data_func("/fwupd/engine{md-verfmt}", self, fu_engine_md_verfmt_func);
+	g_test_add_data_func("/fwupd/engine{metadata-silos}", self, fu_engine_metadata_silos_func);
+	g_test_add_func("/fwupd/engine{emulator-binary}", fu_engine_emulator_binary_func);
+	g_test_add_data_func("/fwupd/engine{update-metadata-not-modified}",
+			     self,
+			     fu_engine_update_metadata_not_modified_func);
 	g_test_add_data_func("/fwupd/engine{requirements-success}",
 			     self,
 			     fu_engine_requirements_func);
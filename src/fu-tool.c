@@ -33,6 +33,7 @@
 #include "fu-context-private.h"
 #include "fu-debug.h"
 #include "fu-device-private.h"
+#include "fu-engine-emulator.h"
 #include "fu-engine-helper.h"
 #include "fu-engine-requirements.h"
 #include "fu-engine.h"
@@ -1503,6 +1504,8 @@ fu_util_install_release(FuUtilPrivate *priv, FwupdDevice *dev, FwupdRelease *rel
 	GPtrArray *locations;
 	const gchar *remote_id;
 	const gchar *uri_tmp;
+	g_autofree gchar *fn_cache = NULL;
+	g_autoptr(GError) error_cache = NULL;
 	g_auto(GStrv) argv = NULL;
 
 	if (!fwupd_device_has_flag(dev, FWUPD_DEVICE_FLAG_UPDATABLE)) {
@@ -1545,6 +1548,10 @@ fu_util_install_release(FuUtilPrivate *priv, FwupdDevice *dev, FwupdRelease *rel
 		return FALSE;
 
 	argv = g_new0(gchar *, 2);
+	fn_cache = fu_engine_lookup_firmware_cache(priv->engine, rel, &error_cache);
+	if (fn_cache == NULL)
+		g_debug("not using firmware cache: %s", error_cache->message);
+
 	/* local remotes may have the firmware already */
 	if (fwupd_remote_get_kind(remote) == FWUPD_REMOTE_KIND_LOCAL && !fu_util_is_url(uri_tmp)) {
 		const gchar *fn_cache = fwupd_remote_get_filename_cache(remote);
@@ -1552,6 +1559,9 @@ fu_util_install_release(FuUtilPrivate *priv, FwupdDevice *dev, FwupdRelease *rel
 		argv[0] = g_build_filename(path, uri_tmp, NULL);
 	} else if (fwupd_remote_get_kind(remote) == FWUPD_REMOTE_KIND_DIRECTORY) {
 		argv[0] = g_strdup(uri_tmp + 7);
+		/* already downloaded and installed on another device */
+	} else if (fn_cache != NULL) {
+		argv[0] = g_steal_pointer(&fn_cache);
 		/* web remote, fu_util_install will download file */
 	} else {
 		argv[0] = fwupd_remote_build_firmware_uri(remote, uri_tmp, error);
@@ -3911,7 +3921,7 @@ fu_util_emulation_untag(FuUtilPrivate *priv, gchar **values, GError **error)
 static gboolean
 fu_util_emulation_load(FuUtilPrivate *priv, gchar **values, GError **error)
 {
-	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(GBytes) blob = NULL;
 
 	/* check args */
 	if (g_strv_length(values) < 1) {
@@ -3936,11 +3946,11 @@ fu_util_emulation_load(FuUtilPrivate *priv, gchar **values, GError **error)
 		return FALSE;
 	fu_progress_step_done(priv->progress);
 
-	/* load emulation */
-	stream = fu_input_stream_from_path(values[0], error);
-	if (stream == NULL)
+	/* load emulation, mapping the file if possible */
+	blob = fu_bytes_get_contents(values[0], error);
+	if (blob == NULL)
 		return FALSE;
-	if (!fu_engine_emulation_load(priv->engine, stream, error))
+	if (!fu_engine_emulation_load_bytes(priv->engine, blob, error))
 		return FALSE;
 	fu_progress_step_done(priv->progress);
 
@@ -3968,6 +3978,38 @@ fu_util_emulation_load(FuUtilPrivate *priv, gchar **values, GError **error)
 	return TRUE;
 }
 
+static gboolean
+fu_util_emulation_convert(FuUtilPrivate *priv, gchar **values, GError **error)
+{
+	FuEngineEmulatorFormat format = FU_ENGINE_EMULATOR_FORMAT_BINARY;
+	FuEngineEmulatorCompression compression = FU_ENGINE_EMULATOR_COMPRESSION_NONE;
+	g_autoptr(GBytes) blob_src = NULL;
+	g_autoptr(GBytes) blob_dst = NULL;
+
+	/* check args */
+	if (g_strv_length(values) != 2) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_ARGS,
+				    "Invalid arguments, expected FILE-IN FILE-OUT");
+		return FALSE;
+	}
+
+	/* the output format is chosen using the file extension */
+	if (g_str_has_suffix(values[1], ".zip")) {
+		format = FU_ENGINE_EMULATOR_FORMAT_JSON;
+	} else if (g_str_has_suffix(values[1], ".xz")) {
+		compression = FU_ENGINE_EMULATOR_COMPRESSION_LZMA;
+	}
+	blob_src = fu_bytes_get_contents(values[0], error);
+	if (blob_src == NULL)
+		return FALSE;
+	blob_dst = fu_engine_emulator_convert(blob_src, format, compression, error);
+	if (blob_dst == NULL)
+		return FALSE;
+	return fu_bytes_set_contents(values[1], blob_dst, error);
+}
+
 static gboolean
 _g_str_equal0(gconstpointer str1, gconstpointer str2)
 {
@@ -4681,7 +4723,8 @@ fu_util_efivar_files(FuUtilPrivate *priv, gchar **values, GError **error)
 	files = fu_context_get_esp_files(priv->ctx,
 					 FU_CONTEXT_ESP_FILE_FLAG_INCLUDE_FIRST_STAGE |
 					     FU_CONTEXT_ESP_FILE_FLAG_INCLUDE_SECOND_STAGE |
-					     FU_CONTEXT_ESP_FILE_FLAG_INCLUDE_REVOCATIONS,
+					     FU_CONTEXT_ESP_FILE_FLAG_INCLUDE_REVOCATIONS |
+					     FU_CONTEXT_ESP_FILE_FLAG_USE_CHECKSUM_CACHE,
 					 error);
 	if (files == NULL)
 		return FALSE;
@@ -4852,6 +4895,7 @@ main(int argc, char *argv[])
 	gboolean allow_reinstall = FALSE;
 	gboolean force = FALSE;
 	gboolean no_search = FALSE;
+	gboolean parallel = FALSE;
 	gboolean ret;
 	gboolean version = FALSE;
 	gboolean ignore_checksum = FALSE;
@@ -4930,6 +4974,14 @@ main(int argc, char *argv[])
 	     /* TRANSLATORS: command line option */
 	     N_("Ignore non-critical firmware requirements"),
 	     NULL},
+	    {"parallel",
+	     '\0',
+	     0,
+	     G_OPTION_ARG_NONE,
+	     &parallel,
+	     /* TRANSLATORS: command line option */
+	     N_("Install firmware on independent devices at the same time"),
+	     NULL},
 	    {"no-reboot-check",
 	     '\0',
 	     0,
@@ -5365,6 +5417,13 @@ main(int argc, char *argv[])
 			      /* TRANSLATORS: command description */
 			      _("Load device emulation data"),
 			      fu_util_emulation_load);
+	fu_util_cmd_array_add(cmd_array,
+			      "emulation-convert",
+			      /* TRANSLATORS: command argument: uppercase, spaces->dashes */
+			      _("FILE-IN FILE-OUT"),
+			      /* TRANSLATORS: command description */
+			      _("Convert device emulation data to a different format"),
+			      fu_util_emulation_convert);
 	fu_util_cmd_array_add(cmd_array,
 			      "esp-mount",
 			      NULL,
@@ -5669,6 +5728,8 @@ main(int argc, char *argv[])
 		priv->parse_flags |= FU_FIRMWARE_PARSE_FLAG_IGNORE_VID_PID;
 	if (ignore_requirements)
 		priv->flags |= FWUPD_INSTALL_FLAG_IGNORE_REQUIREMENTS;
+	if (parallel)
+		priv->flags |= FWUPD_INSTALL_FLAG_PARALLEL;
 
 	/* load engine */
 	priv->ctx = fu_context_new();
@@ -25,6 +25,8 @@ struct _FuUsbBackend {
 	guint idle_events_id;
 	guint hotplug_poll_id;
 	guint hotplug_poll_interval;
+	guint hotplug_poll_interval_idle; /* ms, or 0 when libusb delivers hotplug events */
+	GHashTable *replug_pending;	  /* (element-type FuDevice) */
 #endif
 };
 
@@ -42,6 +44,25 @@ fu_usb_backend_get_usb_device_backend_id(libusb_device *usb_device)
 			       libusb_get_device_address(usb_device));
 }
 
+/* the bus and address are reused after a replug, so also include the physical location */
+static gchar *
+fu_usb_backend_get_usb_device_index_key(libusb_device *usb_device)
+{
+	guint8 port_numbers[8] = {0x0}; /* USB 3.0 allows a maximum hub depth of 7 */
+	gint port_numbers_len;
+	g_autoptr(GString) str = g_string_new(NULL);
+
+	g_string_append_printf(str,
+			       "%02x:%02x",
+			       libusb_get_bus_number(usb_device),
+			       libusb_get_device_address(usb_device));
+	port_numbers_len =
+	    libusb_get_port_numbers(usb_device, port_numbers, sizeof(port_numbers));
+	for (gint i = 0; i < port_numbers_len; i++)
+		g_string_append_printf(str, "%c%u", i == 0 ? '-' : '.', port_numbers[i]);
+	return g_string_free(g_steal_pointer(&str), FALSE);
+}
+
 static FuUsbDevice *
 fu_usb_backend_create_device(FuUsbBackend *self, libusb_device *usb_device)
 {
@@ -82,40 +103,52 @@ fu_usb_backend_remove_device(FuUsbBackend *self, libusb_device *usb_device)
 static void
 fu_usb_backend_rescan(FuUsbBackend *self)
 {
+	GHashTableIter iter;
+	gpointer value = NULL;
 	libusb_device **dev_list = NULL;
-	g_autoptr(GList) existing_devices = NULL;
-	g_autoptr(GPtrArray) devices = fu_backend_get_devices(FU_BACKEND(self));
+	ssize_t dev_list_len;
+	g_autoptr(GHashTable) index = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
 
 	/* skip actual enumeration */
 	if (g_getenv("FWUPD_SELF_TEST") != NULL)
 		return;
 
-	/* copy to a context so we can remove from the array */
-	for (guint i = 0; i < devices->len; i++) {
-		FuUsbDevice *device = g_ptr_array_index(devices, i);
-		existing_devices = g_list_prepend(existing_devices, device);
+	dev_list_len = libusb_get_device_list(self->ctx, &dev_list);
+	if (dev_list_len < 0) {
+		g_debug("failed to get device list: %s [%i]",
+			libusb_strerror((gint)dev_list_len),
+			(gint)dev_list_len);
+		return;
 	}
 
-	/* look for any removed devices */
-	libusb_get_device_list(self->ctx, &dev_list);
-	for (GList *l = existing_devices; l != NULL; l = l->next) {
-		FuUsbDevice *device = FU_USB_DEVICE(l->data);
-		gboolean found = FALSE;
-		for (guint i = 0; dev_list != NULL && dev_list[i] != NULL; i++) {
-			if (libusb_get_bus_number(dev_list[i]) == fu_usb_device_get_bus(device) &&
-			    libusb_get_device_address(dev_list[i]) ==
-				fu_usb_device_get_address(device)) {
-				found = TRUE;
-				break;
-			}
-		}
-		if (!found)
+	/* index the enumerated devices so each lookup is not a scan of the whole tree */
+	index = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	for (ssize_t i = 0; i < dev_list_len; i++) {
+		g_hash_table_insert(index,
+				    fu_usb_backend_get_usb_device_index_key(dev_list[i]),
+				    dev_list[i]);
+	}
+
+	/* look for any removed devices, leaving only the new devices in the index */
+	devices = fu_backend_get_devices(FU_BACKEND(self));
+	for (guint i = 0; i < devices->len; i++) {
+		FuUsbDevice *device = g_ptr_array_index(devices, i);
+		libusb_device *usb_device = fu_usb_device_get_dev(device);
+		g_autofree gchar *key = NULL;
+
+		/* not enumerated by libusb, e.g. emulated */
+		if (usb_device == NULL)
+			continue;
+		key = fu_usb_backend_get_usb_device_index_key(usb_device);
+		if (!g_hash_table_remove(index, key))
 			fu_backend_device_removed(FU_BACKEND(self), FU_DEVICE(device));
 	}
 
-	/* add any devices not yet added (duplicates will be filtered */
-	for (guint i = 0; dev_list != NULL && dev_list[i] != NULL; i++)
-		fu_usb_backend_add_device(self, dev_list[i]);
+	/* add any devices not yet added (duplicates will be filtered) */
+	g_hash_table_iter_init(&iter, index);
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+		fu_usb_backend_add_device(self, value);
 
 	libusb_free_device_list(dev_list, 1);
 }
@@ -149,31 +182,35 @@ fu_usb_backend_set_hotplug_poll_interval(FuUsbBackend *self, guint hotplug_poll_
 		return;
 
 	self->hotplug_poll_interval = hotplug_poll_interval;
-
-	/* if already running then change the existing timeout */
-	if (self->hotplug_poll_id > 0)
-		fu_usb_backend_ensure_rescan_timeout(self);
+	fu_usb_backend_ensure_rescan_timeout(self);
 }
 
-#ifdef _WIN32
 static void
 fu_usb_backend_device_notify_flags_cb(FuDevice *device, GParamSpec *pspec, FuBackend *backend)
 {
 	FuUsbBackend *self = FU_USB_BACKEND(backend);
 
-	/* if waiting for a disconnect, set win32 to poll insanely fast -- and set it
-	 * back to the default when the device removal was detected */
+	/* track which devices are waiting so that each notify is not a scan of every device */
 	if (fu_device_has_flag(device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG)) {
-		g_debug("setting USB poll interval to %ums to detect replug",
-			(guint)FU_USB_BACKEND_POLL_INTERVAL_WAIT_REPLUG);
+		if (!g_hash_table_contains(self->replug_pending, device))
+			g_hash_table_add(self->replug_pending, g_object_ref(device));
+	} else {
+		g_hash_table_remove(self->replug_pending, device);
+	}
+
+	/* if waiting for a disconnect, poll insanely fast -- and set it back to the idle interval
+	 * when no device is waiting, which is no polling at all if there are hotplug events */
+	if (g_hash_table_size(self->replug_pending) > 0) {
+		if (self->hotplug_poll_interval != FU_USB_BACKEND_POLL_INTERVAL_WAIT_REPLUG) {
+			g_debug("setting USB poll interval to %ums to detect replug",
+				(guint)FU_USB_BACKEND_POLL_INTERVAL_WAIT_REPLUG);
+		}
 		fu_usb_backend_set_hotplug_poll_interval(self,
 							 FU_USB_BACKEND_POLL_INTERVAL_WAIT_REPLUG);
 	} else {
-		fu_usb_backend_set_hotplug_poll_interval(self,
-							 FU_USB_BACKEND_POLL_INTERVAL_DEFAULT);
+		fu_usb_backend_set_hotplug_poll_interval(self, self->hotplug_poll_interval_idle);
 	}
 }
-#endif
 
 typedef struct {
 	FuUsbBackend *self;
@@ -335,8 +372,7 @@ fu_usb_backend_setup(FuBackend *backend,
 			return FALSE;
 		}
 	} else {
-		fu_usb_backend_set_hotplug_poll_interval(self,
-							 FU_USB_BACKEND_POLL_INTERVAL_DEFAULT);
+		self->hotplug_poll_interval_idle = FU_USB_BACKEND_POLL_INTERVAL_DEFAULT;
 	}
 #endif
 
@@ -350,23 +386,24 @@ fu_usb_backend_coldplug(FuBackend *backend, FuProgress *progress, GError **error
 {
 	FuUsbBackend *self = FU_USB_BACKEND(backend);
 	fu_usb_backend_rescan(self);
+
+	/* only poll for changes if libusb cannot tell us */
+	fu_usb_backend_set_hotplug_poll_interval(self, self->hotplug_poll_interval_idle);
 	return TRUE;
 }
 
 static void
 fu_usb_backend_registered(FuBackend *backend, FuDevice *device)
 {
-#ifdef _WIN32
 	/* not required */
 	if (!FU_IS_USB_DEVICE(device))
 		return;
 
-	/* on win32 we need to poll the context faster */
+	/* poll the context faster while waiting for the device to replug */
 	g_signal_connect(FU_DEVICE(device),
 			 "notify::flags",
 			 G_CALLBACK(fu_usb_backend_device_notify_flags_cb),
 			 backend);
-#endif
 }
 
 static FuDevice *
@@ -411,6 +448,7 @@ fu_usb_backend_finalize(GObject *object)
 	if (self->ctx != NULL)
 		libusb_exit(self->ctx);
 	g_clear_pointer(&self->idle_events, g_ptr_array_unref);
+	g_clear_pointer(&self->replug_pending, g_hash_table_unref);
 	g_mutex_clear(&self->idle_events_mutex);
 #endif
 
@@ -435,6 +473,8 @@ fu_usb_backend_init(FuUsbBackend *self)
 	g_mutex_init(&self->idle_events_mutex);
 	self->idle_events =
 	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_usb_backend_idle_helper_free);
+	self->replug_pending =
+	    g_hash_table_new_full(g_direct_hash, g_direct_equal, g_object_unref, NULL);
 #endif
 }
 
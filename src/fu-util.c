@@ -3837,6 +3837,49 @@ fu_util_get_approved_firmware(FuUtilPrivate *priv, gchar **values, GError **erro
 	return TRUE;
 }
 
+static gboolean
+fu_util_get_metrics(FuUtilPrivate *priv, gchar **values, GError **error)
+{
+	g_autoptr(GHashTable) metrics = NULL;
+	g_autoptr(GList) keys = NULL;
+
+	/* check args */
+	if (g_strv_length(values) != 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_ARGS,
+				    "Invalid arguments: none expected");
+		return FALSE;
+	}
+
+	/* call into daemon */
+	metrics = fwupd_client_get_metrics(priv->client, priv->cancellable, error);
+	if (metrics == NULL)
+		return FALSE;
+	keys = g_list_sort(g_hash_table_get_keys(metrics), (GCompareFunc)g_strcmp0);
+	if (priv->as_json) {
+		g_autoptr(JsonBuilder) builder = json_builder_new();
+		json_builder_begin_object(builder);
+		json_builder_set_member_name(builder, "Metrics");
+		json_builder_begin_object(builder);
+		for (GList *l = keys; l != NULL; l = l->next) {
+			const gchar *key = l->data;
+			guint64 *value = g_hash_table_lookup(metrics, key);
+			json_builder_set_member_name(builder, key);
+			json_builder_add_int_value(builder, *value);
+		}
+		json_builder_end_object(builder);
+		json_builder_end_object(builder);
+		return fu_util_print_builder(priv->console, builder, error);
+	}
+	for (GList *l = keys; l != NULL; l = l->next) {
+		const gchar *key = l->data;
+		guint64 *value = g_hash_table_lookup(metrics, key);
+		fu_console_print(priv->console, "%s: %" G_GUINT64_FORMAT, key, *value);
+	}
+	return TRUE;
+}
+
 static gboolean
 fu_util_modify_config(FuUtilPrivate *priv, gchar **values, GError **error)
 {
@@ -5046,6 +5089,7 @@ main(int argc, char *argv[])
 	gboolean only_p2p = FALSE;
 	gboolean is_interactive = FALSE;
 	gboolean no_history = FALSE;
+	gboolean parallel = FALSE;
 	gboolean no_authenticate = FALSE;
 	gboolean ret;
 	gboolean verbose = FALSE;
@@ -5191,6 +5235,14 @@ main(int argc, char *argv[])
 	     /* TRANSLATORS: command line option */
 	     N_("Do not write to the history database"),
 	     NULL},
+	    {"parallel",
+	     '\0',
+	     0,
+	     G_OPTION_ARG_NONE,
+	     &parallel,
+	     /* TRANSLATORS: command line option */
+	     N_("Install firmware on independent devices at the same time"),
+	     NULL},
 	    {"show-all",
 	     '\0',
 	     0,
@@ -5450,6 +5502,12 @@ main(int argc, char *argv[])
 			      /* TRANSLATORS: firmware approved by the admin */
 			      _("Gets the list of approved firmware"),
 			      fu_util_get_approved_firmware);
+	fu_util_cmd_array_add(cmd_array,
+			      "get-metrics",
+			      NULL,
+			      /* TRANSLATORS: timing and counter values recorded by the daemon */
+			      _("Gets the performance metrics recorded by the daemon"),
+			      fu_util_get_metrics);
 	fu_util_cmd_array_add(cmd_array,
 			      "set-approved-firmware",
 			      /* TRANSLATORS: command argument: uppercase, spaces->dashes */
@@ -5762,6 +5820,8 @@ main(int argc, char *argv[])
 	}
 	if (no_history)
 		priv->flags |= FWUPD_INSTALL_FLAG_NO_HISTORY;
+	if (parallel)
+		priv->flags |= FWUPD_INSTALL_FLAG_PARALLEL;
 
 	/* use peer-to-peer for metadata and firmware *only* if specified */
 	if (only_p2p)